@@ -24,6 +24,7 @@
  */
 #include "fossil/maip/common.h"
 #include <stdio.h>
+#include <signal.h>
 
 // *****************************************************************************
 // macro definitions
@@ -44,25 +45,22 @@ fossil_maip_cli_theme_t G_MAIP_THEME = MAIP_THEME_FOSSIL;
 // *****************************************************************************
 
 // HASH Algorithm magic
+//
+// XXH64-compatible core: four independent 64-bit lanes eat 32-byte stripes a
+// word at a time, so the loop pipelines well and auto-vectorises. The low
+// half of the 128-bit digest is plain XXH64; the high half finishes the same
+// lanes with different rotations and primes, so it costs no extra pass.
+
+#define MAIP_HASH_P1 0x9E3779B185EBCA87ULL
+#define MAIP_HASH_P2 0xC2B2AE3D27D4EB4FULL
+#define MAIP_HASH_P3 0x165667B19E3779F9ULL
+#define MAIP_HASH_P4 0x85EBCA77C2B2AE63ULL
+#define MAIP_HASH_P5 0x27D4EB2F165667C5ULL
 
-#if defined(_WIN32) || defined(_WIN64)
-#include <windows.h>
-uint64_t get_maip_time_microseconds(void)
-{
-    FILETIME ft;
-    GetSystemTimeAsFileTime(&ft);
-    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
-    return t / 10; // 100-nanosecond intervals to microseconds
-}
-#else
-#include <sys/time.h>
 uint64_t get_maip_time_microseconds(void)
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000000ULL + tv.tv_usec;
+    return maip_sys_time_now_ns() / 1000ULL;
 }
-#endif
 
 static uint64_t get_maip_device_salt(void)
 {
@@ -100,62 +98,228 @@ static uint64_t get_maip_device_salt(void)
     return hash;
 }
 
-void fossil_maip_hash(const char *input, const char *output, uint8_t *hash_out)
+static inline uint64_t maip_hash_rotl(uint64_t value, int bits)
 {
-    const uint64_t PRIME = 0x100000001b3ULL;
-    static uint64_t SALT = 0;
-    if (SALT == 0)
-        SALT = get_maip_device_salt(); // Initialize salt once
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Little-endian loads keep digests identical across hosts
+static inline uint64_t maip_hash_read64(const uint8_t *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
 
-    uint64_t state1 = 0xcbf29ce484222325ULL ^ SALT;
-    uint64_t state2 = 0x84222325cbf29ce4ULL ^ ~SALT;
+static inline uint32_t maip_hash_read32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static inline uint64_t maip_hash_round(uint64_t acc, uint64_t input)
+{
+    acc += input * MAIP_HASH_P2;
+    acc = maip_hash_rotl(acc, 31);
+    return acc * MAIP_HASH_P1;
+}
+
+static inline uint64_t maip_hash_merge(uint64_t acc, uint64_t lane)
+{
+    acc ^= maip_hash_round(0, lane);
+    return acc * MAIP_HASH_P1 + MAIP_HASH_P4;
+}
 
-    size_t in_len = strlen(input);
-    size_t out_len = strlen(output);
+static inline uint64_t maip_hash_avalanche(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= MAIP_HASH_P2;
+    hash ^= hash >> 29;
+    hash *= MAIP_HASH_P3;
+    hash ^= hash >> 32;
+    return hash;
+}
 
-    uint64_t nonce = get_maip_time_microseconds(); // Microsecond resolution
+// Consumes whole stripes and returns the number of bytes used
+static size_t maip_hash_stripes(uint64_t *lanes, const uint8_t *data, size_t len)
+{
+    uint64_t v1 = lanes[0], v2 = lanes[1], v3 = lanes[2], v4 = lanes[3];
+    const uint8_t *p = data;
+    const uint8_t *limit = data + (len & ~(size_t)31);
+    while (p < limit)
+    {
+        v1 = maip_hash_round(v1, maip_hash_read64(p));
+        v2 = maip_hash_round(v2, maip_hash_read64(p + 8));
+        v3 = maip_hash_round(v3, maip_hash_read64(p + 16));
+        v4 = maip_hash_round(v4, maip_hash_read64(p + 24));
+        p += 32;
+    }
+    lanes[0] = v1;
+    lanes[1] = v2;
+    lanes[2] = v3;
+    lanes[3] = v4;
+    return (size_t)(p - data);
+}
 
-    for (size_t i = 0; i < in_len; ++i)
+// Shared finish; `high` is optional and receives the second half
+static uint64_t maip_hash_finish(const fossil_maip_hash_state_t *state, uint64_t *high)
+{
+    const uint64_t *v = state->lanes;
+    uint64_t low, upper;
+    if (state->total >= 32)
+    {
+        low = maip_hash_rotl(v[0], 1) + maip_hash_rotl(v[1], 7) +
+              maip_hash_rotl(v[2], 12) + maip_hash_rotl(v[3], 18);
+        upper = maip_hash_rotl(v[0], 3) + maip_hash_rotl(v[1], 11) +
+                maip_hash_rotl(v[2], 19) + maip_hash_rotl(v[3], 29);
+        for (int i = 0; i < 4; i++)
+        {
+            low = maip_hash_merge(low, v[i]);
+            upper = maip_hash_merge(upper, v[3 - i]);
+        }
+    }
+    else
     {
-        state1 ^= (uint8_t)input[i];
-        state1 *= PRIME;
-        state1 ^= (state1 >> 27);
-        state1 ^= (state1 << 33);
+        low = state->seed + MAIP_HASH_P5;
+        upper = state->seed + MAIP_HASH_P3;
     }
+    low += state->total;
+    upper += state->total;
 
-    for (size_t i = 0; i < out_len; ++i)
+    const uint8_t *p = state->buffer;
+    size_t left = state->buffered;
+    for (; left >= 8; p += 8, left -= 8)
+    {
+        uint64_t k = maip_hash_round(0, maip_hash_read64(p));
+        low = maip_hash_rotl(low ^ k, 27) * MAIP_HASH_P1 + MAIP_HASH_P4;
+        upper = maip_hash_rotl(upper ^ k, 29) * MAIP_HASH_P3 + MAIP_HASH_P2;
+    }
+    if (left >= 4)
     {
-        state2 ^= (uint8_t)output[i];
-        state2 *= PRIME;
-        state2 ^= (state2 >> 29);
-        state2 ^= (state2 << 31);
+        uint64_t k = maip_hash_read32(p);
+        low = maip_hash_rotl(low ^ (k * MAIP_HASH_P1), 23) * MAIP_HASH_P2 + MAIP_HASH_P3;
+        upper = maip_hash_rotl(upper ^ (k * MAIP_HASH_P2), 17) * MAIP_HASH_P1 + MAIP_HASH_P5;
+        p += 4;
+        left -= 4;
     }
+    for (; left > 0; p++, left--)
+    {
+        low = maip_hash_rotl(low ^ (*p * MAIP_HASH_P5), 11) * MAIP_HASH_P1;
+        upper = maip_hash_rotl(upper ^ (*p * MAIP_HASH_P1), 13) * MAIP_HASH_P5;
+    }
+
+    low = maip_hash_avalanche(low);
+    if (high)
+        *high = maip_hash_avalanche(upper ^ maip_hash_rotl(low, 32));
+    return low;
+}
 
-    // Nonce and length entropy
-    state1 ^= nonce ^ ((uint64_t)in_len << 32);
-    state2 ^= ~nonce ^ ((uint64_t)out_len << 16);
+void fossil_maip_hash_init(fossil_maip_hash_state_t *state, uint64_t seed)
+{
+    memset(state, 0, sizeof(*state));
+    state->seed = seed;
+    state->lanes[0] = seed + MAIP_HASH_P1 + MAIP_HASH_P2;
+    state->lanes[1] = seed + MAIP_HASH_P2;
+    state->lanes[2] = seed;
+    state->lanes[3] = seed - MAIP_HASH_P1;
+}
+
+void fossil_maip_hash_update(fossil_maip_hash_state_t *state, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    if (!p || len == 0)
+        return;
+    state->total += len;
 
-    // Mixing rounds
-    for (int i = 0; i < 6; ++i)
+    // Top up a partial stripe first, then stream straight from the input
+    if (state->buffered > 0)
     {
-        state1 += (state2 ^ (state1 >> 17));
-        state2 += (state1 ^ (state2 >> 13));
-        state1 ^= (state1 << 41);
-        state2 ^= (state2 << 37);
-        state1 *= PRIME;
-        state2 *= PRIME;
+        size_t take = sizeof(state->buffer) - state->buffered;
+        if (take > len)
+            take = len;
+        memcpy(state->buffer + state->buffered, p, take);
+        state->buffered += take;
+        p += take;
+        len -= take;
+        if (state->buffered < sizeof(state->buffer))
+            return;
+        maip_hash_stripes(state->lanes, state->buffer, sizeof(state->buffer));
+        state->buffered = 0;
     }
 
-    for (size_t i = 0; i < FOSSIL_MAIP_HASH_SIZE; ++i)
+    size_t used = maip_hash_stripes(state->lanes, p, len);
+    memcpy(state->buffer, p + used, len - used);
+    state->buffered = len - used;
+}
+
+uint64_t fossil_maip_hash_final64(const fossil_maip_hash_state_t *state)
+{
+    return maip_hash_finish(state, null);
+}
+
+void fossil_maip_hash_final128(const fossil_maip_hash_state_t *state, uint8_t *hash_out)
+{
+    uint64_t high;
+    uint64_t low = maip_hash_finish(state, &high);
+    for (size_t i = 0; i < 8; ++i)
     {
-        uint64_t mixed = (i % 2 == 0) ? state1 : state2;
-        mixed ^= (mixed >> ((i % 7) + 13));
-        mixed *= PRIME;
-        mixed ^= SALT;
-        hash_out[i] = (uint8_t)((mixed >> (8 * (i % 8))) & 0xFF);
+        hash_out[i] = (uint8_t)(low >> (8 * i));
+        hash_out[8 + i] = (uint8_t)(high >> (8 * i));
     }
 }
 
+uint64_t fossil_maip_hash64(const void *data, size_t len, uint64_t seed)
+{
+    fossil_maip_hash_state_t state;
+    fossil_maip_hash_init(&state, seed);
+    fossil_maip_hash_update(&state, data, len);
+    return fossil_maip_hash_final64(&state);
+}
+
+void fossil_maip_hash128(const void *data, size_t len, uint64_t seed, uint8_t *hash_out)
+{
+    fossil_maip_hash_state_t state;
+    fossil_maip_hash_init(&state, seed);
+    fossil_maip_hash_update(&state, data, len);
+    fossil_maip_hash_final128(&state, hash_out);
+}
+
+uint64_t fossil_maip_hash_salt(void)
+{
+    static uint64_t SALT = 0;
+    if (SALT == 0)
+        SALT = get_maip_device_salt();
+    return SALT;
+}
+
+void fossil_maip_hash_seeded(const char *input, const char *output, uint64_t seed, uint8_t *hash_out)
+{
+    if (!input)
+        input = cempty;
+    if (!output)
+        output = cempty;
+
+    // The terminator of `input` separates the two strings, so moving bytes
+    // across the boundary changes the digest.
+    fossil_maip_hash_state_t state;
+    fossil_maip_hash_init(&state, seed);
+    fossil_maip_hash_update(&state, input, strlen(input) + 1);
+    fossil_maip_hash_update(&state, output, strlen(output));
+    fossil_maip_hash_final128(&state, hash_out);
+}
+
+void fossil_maip_hash(const char *input, const char *output, uint8_t *hash_out)
+{
+    fossil_maip_hash_seeded(input, output, 0, hash_out);
+}
+
 // *****************************************************************************
 // command pallet
 // *****************************************************************************
@@ -202,16 +366,17 @@ static void _show_help(void)
     maip_io_printf("{blue}Options:{reset}\n");
     maip_io_printf("{cyan}  --version -v       {white}Show version information{reset}\n");
     maip_io_printf("{cyan}  --help    -h       {white}Show this help message{reset}\n");
+    maip_io_printf("{cyan}  --timeout <seconds> {white}Abort any test running longer than this (default: 60 seconds){reset}\n");
     maip_io_printf("{blue}Commands:{reset}\n");
     maip_io_printf("{cyan}  run                {white}Execute tests with optional parameters{reset}\n");
     maip_io_printf("{cyan}  filter             {white}Filter tests based on criteria{reset}\n");
     maip_io_printf("{cyan}  sort               {white}Sort tests by specified criteria{reset}\n");
     maip_io_printf("{cyan}  shuffle            {white}Shuffle tests with optional parameters{reset}\n");
     maip_io_printf("{cyan}  show               {white}Show test cases with optional parameters{reset}\n");
+    maip_io_printf("{cyan}  mark               {white}Save or compare benchmark baselines{reset}\n");
     maip_io_printf("{cyan}  color <mode>       {white}Set color mode (enable, disable, auto){reset}\n");
     maip_io_printf("{cyan}  theme <name>       {white}Set the theme (fossil, catch, doctest, etc.){reset}\n");
     maip_io_printf("{cyan}  info               {white}Show detailed information about the environment{reset}\n");
-    maip_io_printf("{cyan}  timeout=<seconds>  {white}Set the timeout for commands (default: 60 seconds){reset}\n");
     exit(EXIT_SUCCESS);
 }
 
@@ -230,9 +395,19 @@ static void _show_subhelp_run(void)
 {
     maip_io_printf("{blue}Run command options:{reset}\n");
     maip_io_printf("{cyan}  --fail-fast        {white}Stop on the first failure{reset}\n");
-    maip_io_printf("{cyan}  --only <test>      {white}Run only the specified test{reset}\n");
-    maip_io_printf("{cyan}  --skip <test>      {white}Skip the specified test{reset}\n");
+    maip_io_printf("{cyan}  --only <tests>     {white}Run only the matching tests (comma separated, '*' and '?' globs){reset}\n");
+    maip_io_printf("{cyan}  --skip <tests>     {white}Skip the matching tests (comma separated, '*' and '?' globs){reset}\n");
     maip_io_printf("{cyan}  --repeat <count>   {white}Repeat the test a specified number of times{reset}\n");
+    maip_io_printf("{cyan}  --repeat-jobs <n>  {white}Run the repeats of a case on n threads (0 = CPU count){reset}\n");
+    maip_io_printf("{cyan}  --jobs <count>     {white}Run test cases on parallel worker threads (0 = one per CPU){reset}\n");
+    maip_io_printf("{cyan}  --isolate <count>  {white}Run test cases in forked worker processes that survive crashes (0 = one per CPU){reset}\n");
+    maip_io_printf("{cyan}  --timeout <seconds> {white}Abort any test running longer than this{reset}\n");
+    maip_io_printf("{cyan}  --no-recover       {white}Let a crash in a test end the run instead of failing the test{reset}\n");
+    maip_io_printf("{cyan}  --bundle <paths>   {white}Load test groups from shared objects (comma separated){reset}\n");
+    maip_io_printf("{cyan}  --history <file>   {white}Keep per-case durations and failures; run recent failures and long cases first{reset}\n");
+    maip_io_printf("{cyan}  --shard-index <n>  {white}Run only the n-th (0-based) of --shard-count shards{reset}\n");
+    maip_io_printf("{cyan}  --shard-count <n>  {white}Split the selected cases across this many shards{reset}\n");
+    maip_io_printf("{cyan}  --shard-by <mode>  {white}Partition by case hash, or balance --history durations (hash, duration){reset}\n");
     exit(EXIT_SUCCESS);
 }
 
@@ -242,6 +417,7 @@ static void _show_subhelp_filter(void)
     maip_io_printf("{cyan}  --test-name <name> {white}Filter by test name{reset}\n");
     maip_io_printf("{cyan}  --suite-name <name> {white}Filter by suite name{reset}\n");
     maip_io_printf("{cyan}  --tag <tag>        {white}Filter by tag{reset}\n");
+    maip_io_printf("{cyan}  --expr <expr>      {white}Filter by expression, e.g. \"tag:fast & !tag:net | name:io_*\"{reset}\n");
     maip_io_printf("{cyan}  --help             {white}Show help for filter command{reset}\n");
     maip_io_printf("{cyan}  --options          {white}Show all valid tags{reset}\n");
     exit(EXIT_SUCCESS);
@@ -250,8 +426,18 @@ static void _show_subhelp_filter(void)
 static void _show_subhelp_report(void)
 {
     maip_io_printf("{blue}Report command options:{reset}\n");
-    maip_io_printf("{cyan}  --format <json/fson/yaml/csv>       {white}Set the output format{reset}\n");
+    maip_io_printf("{cyan}  --format <json/junit/csv/tap/yaml>  {white}Stream one record per case in this format{reset}\n");
     maip_io_printf("{cyan}  --destination <file/stdout>        {white}Set the output destination (default: stdout){reset}\n");
+    maip_io_printf("{cyan}  --merge <files>                    {white}Score and report shard results from json reports instead of running (comma separated){reset}\n");
+    exit(EXIT_SUCCESS);
+}
+
+static void _show_subhelp_mark(void)
+{
+    maip_io_printf("{blue}Mark command options:{reset}\n");
+    maip_io_printf("{cyan}  --save-baseline <file> {white}Write benchmark sample distributions to a baseline file{reset}\n");
+    maip_io_printf("{cyan}  --compare <file>       {white}Compare benchmarks against a baseline and fail on regressions{reset}\n");
+    maip_io_printf("{cyan}  --threshold <percent>  {white}Allowed median slowdown before a regression (default: 5){reset}\n");
     exit(EXIT_SUCCESS);
 }
 
@@ -260,6 +446,7 @@ static void _show_subhelp_sort(void)
     maip_io_printf("{blue}Sort command options:{reset}\n");
     maip_io_printf("{cyan}  --by <criteria>    {white}Sort by specified criteria{reset}\n");
     maip_io_printf("{cyan}  --order <asc|desc> {white}Sort in ascending or descending order{reset}\n");
+    maip_io_printf("{cyan}  --then-by <keys>   {white}Break ties by more criteria, e.g. result:desc,name (up to 3){reset}\n");
     maip_io_printf("{cyan}  --help             {white}Show help for sort command{reset}\n");
     maip_io_printf("{cyan}  --options          {white}Show all valid criteria{reset}\n");
     exit(EXIT_SUCCESS);
@@ -268,9 +455,10 @@ static void _show_subhelp_sort(void)
 static void _show_subhelp_shuffle(void)
 {
     maip_io_printf("{blue}Shuffle command options:{reset}\n");
-    maip_io_printf("{cyan}  --seed <seed>      {white}Specify the seed for shuffling{reset}\n");
-    maip_io_printf("{cyan}  --count <count>    {white}Number of items to shuffle{reset}\n");
-    maip_io_printf("{cyan}  --by <criteria>    {white}Shuffle by specified criteria{reset}\n");
+    maip_io_printf("{cyan}  --seed <seed>      {white}Specify the seed for shuffling (printed when omitted){reset}\n");
+    maip_io_printf("{cyan}  --count <count>    {white}Draw only this many cases to run first; the rest keep their order{reset}\n");
+    maip_io_printf("{cyan}  --mode <mode>      {white}uniform (default) or weighted{reset}\n");
+    maip_io_printf("{cyan}  --by <criteria>    {white}Weight for --mode weighted: priority (default) or failures{reset}\n");
     maip_io_printf("{cyan}  --help             {white}Show help for shuffle command{reset}\n");
     maip_io_printf("{cyan}  --options          {white}Show all valid criteria for shuffling{reset}\n");
     exit(EXIT_SUCCESS);
@@ -316,6 +504,10 @@ static void _show_info(fossil_maip_pallet_t *pallet)
         maip_io_printf("{cyan}  Version: {green}%s{reset}\n", FOSSIL_MAIP_VERSION);
         maip_io_printf("{cyan}  Author: {green}%s{reset}\n", FOSSIL_MAIP_AUTHOR);
         maip_io_printf("{cyan}  Website: {green}%s{reset}\n", FOSSIL_MAIP_WEBSITE);
+        maip_io_printf("{cyan}  Clock: {green}%s{cyan} (resolution {green}%llu ns{cyan}, overhead {green}%llu ns{cyan}){reset}\n",
+                       maip_sys_time_source(),
+                       (unsigned long long)maip_sys_time_resolution_ns(),
+                       (unsigned long long)maip_sys_time_overhead_ns());
         return;
     }
 
@@ -410,7 +602,8 @@ typedef enum
     MAIP_CMD_HELP,
     MAIP_CMD_COLOR,
     MAIP_CMD_THEME,
-    MAIP_CMD_INFO
+    MAIP_CMD_INFO,
+    MAIP_CMD_MARK
 } fossil_maip_cmd_t;
 
 typedef struct
@@ -430,6 +623,7 @@ static fossil_cmd_map_t CMD_MAP[] = {
     {MAIP_CMD_COLOR, "color"},
     {MAIP_CMD_THEME, "theme"},
     {MAIP_CMD_INFO, "info"},
+    {MAIP_CMD_MARK, "mark"},
     {MAIP_CMD_NONE, NULL}};
 
 static int fossil_maip_parse_run(fossil_maip_pallet_t *p, int argc, char **argv, int i)
@@ -438,7 +632,15 @@ static int fossil_maip_parse_run(fossil_maip_pallet_t *p, int argc, char **argv,
     p->run.only_cases = null;
     p->run.only_count = 0;
     p->run.repeat = 1;
+    p->run.repeat_jobs = 1;
     p->run.fail_fast = 0;
+    p->run.jobs = 1;
+    p->run.isolate = 0;
+    p->run.bundles = null;
+    p->run.bundle_count = 0;
+    p->run.shard_index = 0;
+    p->run.shard_count = 1;
+    p->run.shard_by = "hash";
 
     for (int j = i + 1; j < argc; j++)
     {
@@ -457,12 +659,79 @@ static int fossil_maip_parse_run(fossil_maip_pallet_t *p, int argc, char **argv,
         {
             p->run.repeat = atoi(argv[++j]);
         }
+        else if (maip_io_cstr_compare(arg, "--repeat-jobs") == 0 && j + 1 < argc)
+        {
+            p->run.repeat_jobs = atoi(argv[++j]);
+            if (p->run.repeat_jobs == 0)
+            {
+                p->run.repeat_jobs = maip_sys_cpu_count();
+            }
+        }
+        else if (maip_io_cstr_compare(arg, "--timeout") == 0 && j + 1 < argc)
+        {
+            p->run.timeout = atoi(argv[++j]);
+        }
+        else if (maip_io_cstr_compare(arg, "--no-recover") == 0)
+        {
+            p->run.no_recover = 1;
+        }
+        else if (maip_io_cstr_compare(arg, "--isolate") == 0 && j + 1 < argc)
+        {
+            p->run.isolate = atoi(argv[++j]);
+            if (p->run.isolate == 0)
+            {
+                p->run.isolate = maip_sys_cpu_count();
+            }
+        }
+        else if (maip_io_cstr_compare(arg, "--jobs") == 0 && j + 1 < argc)
+        {
+            p->run.jobs = atoi(argv[++j]);
+            if (p->run.jobs == 0)
+            {
+                p->run.jobs = maip_sys_cpu_count();
+            }
+        }
         else if (maip_io_cstr_compare(arg, "--only") == 0 && j + 1 < argc)
         {
             j++;
             size_t count = 0;
+            p->run.only = argv[j];
             p->run.only_cases = maip_io_cstr_split(argv[j], ',', &count);
             p->run.only_count = count;
+            p->run.only_has_wildcard = strpbrk(argv[j], "*?") != null;
+        }
+        else if (maip_io_cstr_compare(arg, "--skip") == 0 && j + 1 < argc)
+        {
+            p->run.skip = argv[++j];
+        }
+        else if (maip_io_cstr_compare(arg, "--bundle") == 0 && j + 1 < argc)
+        {
+            j++;
+            size_t count = 0;
+            p->run.bundles = maip_io_cstr_split(argv[j], ',', &count);
+            p->run.bundle_count = count;
+        }
+        else if (maip_io_cstr_compare(arg, "--history") == 0 && j + 1 < argc)
+        {
+            p->run.history = argv[++j];
+        }
+        else if (maip_io_cstr_compare(arg, "--shard-index") == 0 && j + 1 < argc)
+        {
+            p->run.shard_index = atoi(argv[++j]);
+        }
+        else if (maip_io_cstr_compare(arg, "--shard-count") == 0 && j + 1 < argc)
+        {
+            p->run.shard_count = atoi(argv[++j]);
+        }
+        else if (maip_io_cstr_compare(arg, "--shard-by") == 0 && j + 1 < argc)
+        {
+            p->run.shard_by = argv[++j];
+            if (maip_io_cstr_compare(p->run.shard_by, "hash") != 0 &&
+                maip_io_cstr_compare(p->run.shard_by, "duration") != 0)
+            {
+                maip_io_printf("{red}Invalid shard mode: %s (hash, duration){reset}\n", p->run.shard_by);
+                exit(EXIT_FAILURE);
+            }
         }
         else if (maip_io_cstr_compare(arg, "--help") == 0)
         {
@@ -470,6 +739,12 @@ static int fossil_maip_parse_run(fossil_maip_pallet_t *p, int argc, char **argv,
         }
     }
 
+    if (p->run.shard_count > 1 && (p->run.shard_index < 0 || p->run.shard_index >= p->run.shard_count))
+    {
+        maip_io_printf("{red}Shard index %d is outside 0..%d{reset}\n", p->run.shard_index, p->run.shard_count - 1);
+        exit(EXIT_FAILURE);
+    }
+
     return argc;
 }
 
@@ -479,6 +754,7 @@ static int fossil_maip_parse_filter(fossil_maip_pallet_t *p, int argc, char **ar
     p->filter.test_name = null;
     p->filter.name = null;
     p->filter.tag = "fossil"; // default tag
+    p->filter.expr = null;
 
     for (int j = i + 1; j < argc; j++)
     {
@@ -501,6 +777,10 @@ static int fossil_maip_parse_filter(fossil_maip_pallet_t *p, int argc, char **ar
         {
             p->filter.tag = argv[++j];
         }
+        else if (maip_io_cstr_compare(arg, "--expr") == 0 && j + 1 < argc)
+        {
+            p->filter.expr = argv[++j];
+        }
         else if (maip_io_cstr_compare(arg, "--help") == 0)
         {
             _show_subhelp_filter();
@@ -515,6 +795,7 @@ static int fossil_maip_parse_sort(fossil_maip_pallet_t *p, int argc, char **argv
     // set defaults for sort command
     p->sort.by = "name";
     p->sort.order = "asc";
+    p->sort.then_by = null;
 
     for (int j = i + 1; j < argc; j++)
     {
@@ -533,6 +814,10 @@ static int fossil_maip_parse_sort(fossil_maip_pallet_t *p, int argc, char **argv
         {
             p->sort.order = argv[++j];
         }
+        else if (maip_io_cstr_compare(arg, "--then-by") == 0 && j + 1 < argc)
+        {
+            p->sort.then_by = argv[++j];
+        }
         else if (maip_io_cstr_compare(arg, "--help") == 0)
         {
             _show_subhelp_sort();
@@ -545,9 +830,11 @@ static int fossil_maip_parse_sort(fossil_maip_pallet_t *p, int argc, char **argv
 static int fossil_maip_parse_shuffle(fossil_maip_pallet_t *p, int argc, char **argv, int i)
 {
     // set defaults for shuffle command
+    p->shuffle.enabled = 1;
     p->shuffle.seed = 0;    // default seed (0 means use time/device entropy)
     p->shuffle.count = 0;   // default to shuffle all items
-    p->shuffle.by = "name"; // default shuffle criteria
+    p->shuffle.by = "priority"; // weight source for --mode weighted
+    p->shuffle.mode = "uniform";
 
     for (int j = i + 1; j < argc; j++)
     {
@@ -569,6 +856,22 @@ static int fossil_maip_parse_shuffle(fossil_maip_pallet_t *p, int argc, char **a
         else if (maip_io_cstr_compare(arg, "--by") == 0 && j + 1 < argc)
         {
             p->shuffle.by = argv[++j];
+            if (maip_io_cstr_compare(p->shuffle.by, "priority") != 0 &&
+                maip_io_cstr_compare(p->shuffle.by, "failures") != 0)
+            {
+                maip_io_printf("{red}Unknown shuffle weight: %s (expected priority or failures){reset}\n", p->shuffle.by);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (maip_io_cstr_compare(arg, "--mode") == 0 && j + 1 < argc)
+        {
+            p->shuffle.mode = argv[++j];
+            if (maip_io_cstr_compare(p->shuffle.mode, "uniform") != 0 &&
+                maip_io_cstr_compare(p->shuffle.mode, "weighted") != 0)
+            {
+                maip_io_printf("{red}Unknown shuffle mode: %s (expected uniform or weighted){reset}\n", p->shuffle.mode);
+                exit(EXIT_FAILURE);
+            }
         }
         else if (maip_io_cstr_compare(arg, "--help") == 0)
         {
@@ -651,6 +954,13 @@ static int fossil_maip_parse_report(fossil_maip_pallet_t *p, int argc, char **ar
         {
             p->report.destination = argv[++j];
         }
+        else if (maip_io_cstr_compare(arg, "--merge") == 0 && j + 1 < argc)
+        {
+            j++;
+            size_t count = 0;
+            p->report.merge = maip_io_cstr_split(argv[j], ',', &count);
+            p->report.merge_count = count;
+        }
         else if (maip_io_cstr_compare(arg, "--help") == 0)
         {
             _show_subhelp_report();
@@ -660,6 +970,41 @@ static int fossil_maip_parse_report(fossil_maip_pallet_t *p, int argc, char **ar
     return argc;
 }
 
+static int fossil_maip_parse_mark(fossil_maip_pallet_t *p, int argc, char **argv, int i)
+{
+    // set defaults for mark command
+    p->mark.threshold = 5.0;
+
+    for (int j = i + 1; j < argc; j++)
+    {
+        const char *arg = argv[j];
+
+        if (arg[0] != '-')
+        {
+            return j - 1; // stop when next command starts
+        }
+
+        if (maip_io_cstr_compare(arg, "--save-baseline") == 0 && j + 1 < argc)
+        {
+            p->mark.save_baseline = argv[++j];
+        }
+        else if (maip_io_cstr_compare(arg, "--compare") == 0 && j + 1 < argc)
+        {
+            p->mark.compare = argv[++j];
+        }
+        else if (maip_io_cstr_compare(arg, "--threshold") == 0 && j + 1 < argc)
+        {
+            p->mark.threshold = atof(argv[++j]);
+        }
+        else if (maip_io_cstr_compare(arg, "--help") == 0)
+        {
+            _show_subhelp_mark();
+        }
+    }
+
+    return argc;
+}
+
 static int fossil_maip_parse_help(int argc, char **argv, int i)
 {
     if (i + 1 < argc)
@@ -689,6 +1034,10 @@ static int fossil_maip_parse_help(int argc, char **argv, int i)
         {
             _show_subhelp_report();
         }
+        else if (maip_io_cstr_compare(subcmd, "mark") == 0)
+        {
+            _show_subhelp_mark();
+        }
         else if (maip_io_cstr_compare(subcmd, "color") == 0)
         {
             _show_subhelp_color();
@@ -925,6 +1274,12 @@ fossil_maip_pallet_t fossil_maip_pallet_create(int argc, char **argv)
             continue;
         }
 
+        if (maip_io_cstr_compare(arg, "--timeout") == 0 && i + 1 < argc)
+        {
+            pallet.run.timeout = atoi(argv[++i]);
+            continue;
+        }
+
         if (arg[0] == '-')
         {
             /* Unknown global flag: report and exit */
@@ -960,6 +1315,10 @@ fossil_maip_pallet_t fossil_maip_pallet_create(int argc, char **argv)
             i = fossil_maip_parse_report(&pallet, argc, argv, i);
             break;
 
+        case MAIP_CMD_MARK:
+            i = fossil_maip_parse_mark(&pallet, argc, argv, i);
+            break;
+
         case MAIP_CMD_HELP:
             i = fossil_maip_parse_help(argc, argv, i);
             break;
@@ -2081,84 +2440,448 @@ bool maip_sys_memory_is_valid(const maip_sys_memory_t ptr)
     return true;
 }
 
-// *****************************************************************************
-// output management
-// *****************************************************************************
+// Runner sections: quiet sections and console locks the framework holds on
+// this thread. A case that crashes inside one leaves it open; recovery closes
+// it again with maip_sys_section_restore(). A timeout, which can wait, is
+// deferred until the outermost section closes instead.
+static FOSSIL_MAIP_THREAD_LOCAL volatile sig_atomic_t maip_sys_memory_quiet_depth = 0;
+static FOSSIL_MAIP_THREAD_LOCAL volatile sig_atomic_t maip_io_lock_depth = 0;
+static FOSSIL_MAIP_THREAD_LOCAL volatile sig_atomic_t maip_sys_section_deferred = 0;
+static void (*maip_sys_section_resume)(void) = null;
 
-maip_fstream_t *MAIP_STDIN;
-maip_fstream_t *MAIP_STDOUT;
-maip_fstream_t *MAIP_STDERR;
+// Takes the deferred jump once the outermost section has closed
+static void maip_sys_section_leave(void)
+{
+    if (maip_sys_memory_quiet_depth == 0 && maip_io_lock_depth == 0 && maip_sys_section_deferred)
+    {
+        maip_sys_section_deferred = 0;
+        if (maip_sys_section_resume)
+            maip_sys_section_resume();
+    }
+}
 
-int32_t MAIP_IO_COLOR_ENABLE = 1; // Flag to enable/disable color output
+void maip_sys_memory_quiet_begin(void)
+{
+    ++maip_sys_memory_quiet_depth;
+}
 
-// ================================================================
-// RESET
-// ================================================================
-#define FOSSIL_IO_COLOR_RESET "\033[0m"
+void maip_sys_memory_quiet_end(void)
+{
+    if (maip_sys_memory_quiet_depth > 0)
+        --maip_sys_memory_quiet_depth;
+    maip_sys_section_leave();
+}
 
-// ================================================================
-// DARK (STANDARD) COLORS
-// ================================================================
-#define FOSSIL_IO_COLOR_BLACK "\033[30m"
-#define FOSSIL_IO_COLOR_RED "\033[31m"
-#define FOSSIL_IO_COLOR_GREEN "\033[32m"
-#define FOSSIL_IO_COLOR_YELLOW "\033[33m"
-#define FOSSIL_IO_COLOR_BLUE "\033[34m"
-#define FOSSIL_IO_COLOR_MAGENTA "\033[35m"
-#define FOSSIL_IO_COLOR_CYAN "\033[36m"
-#define FOSSIL_IO_COLOR_WHITE "\033[37m"
-#define FOSSIL_IO_COLOR_GRAY "\033[90m"
-#define FOSSIL_IO_COLOR_ORANGE "\033[38;5;208m"
-#define FOSSIL_IO_COLOR_PINK "\033[38;5;205m"
-#define FOSSIL_IO_COLOR_PURPLE "\033[38;5;93m"
-#define FOSSIL_IO_COLOR_BROWN "\033[38;5;94m"
-#define FOSSIL_IO_COLOR_TEAL "\033[38;5;30m"
-#define FOSSIL_IO_COLOR_SILVER "\033[38;5;7m"
+bool maip_sys_memory_quiet(void)
+{
+    return maip_sys_memory_quiet_depth > 0;
+}
 
-// ================================================================
-// BRIGHT COLORS
-// ================================================================
-#define FOSSIL_IO_COLOR_BRIGHT_BLACK "\033[90m"
-#define FOSSIL_IO_COLOR_BRIGHT_RED "\033[91m"
-#define FOSSIL_IO_COLOR_BRIGHT_GREEN "\033[92m"
-#define FOSSIL_IO_COLOR_BRIGHT_YELLOW "\033[93m"
-#define FOSSIL_IO_COLOR_BRIGHT_BLUE "\033[94m"
-#define FOSSIL_IO_COLOR_BRIGHT_MAGENTA "\033[95m"
-#define FOSSIL_IO_COLOR_BRIGHT_CYAN "\033[96m"
-#define FOSSIL_IO_COLOR_BRIGHT_WHITE "\033[97m"
+maip_sys_section_t maip_sys_section_save(void)
+{
+    maip_sys_section_t saved;
+    saved.quiet = maip_sys_memory_quiet_depth;
+    saved.locks = maip_io_lock_depth;
+    return saved;
+}
 
-// ================================================================
-// BACKGROUND COLORS
-// ================================================================
-#define FOSSIL_IO_BG_BLACK "\033[40m"
-#define FOSSIL_IO_BG_RED "\033[41m"
-#define FOSSIL_IO_BG_GREEN "\033[42m"
-#define FOSSIL_IO_BG_YELLOW "\033[43m"
-#define FOSSIL_IO_BG_BLUE "\033[44m"
-#define FOSSIL_IO_BG_MAGENTA "\033[45m"
-#define FOSSIL_IO_BG_CYAN "\033[46m"
-#define FOSSIL_IO_BG_WHITE "\033[47m"
-#define FOSSIL_IO_BG_GRAY "\033[100m"
-#define FOSSIL_IO_BG_ORANGE "\033[48;5;208m"
-#define FOSSIL_IO_BG_PINK "\033[48;5;205m"
-#define FOSSIL_IO_BG_PURPLE "\033[48;5;93m"
-#define FOSSIL_IO_BG_BROWN "\033[48;5;94m"
-#define FOSSIL_IO_BG_TEAL "\033[48;5;30m"
-#define FOSSIL_IO_BG_SILVER "\033[48;5;7m"
+void maip_sys_section_restore(maip_sys_section_t saved)
+{
+    while (maip_io_lock_depth > saved.locks)
+    {
+        --maip_io_lock_depth;
+#ifdef _WIN32
+        _unlock_file(stdout);
+#else
+        funlockfile(stdout);
+#endif
+    }
+    if (maip_sys_memory_quiet_depth > saved.quiet)
+        maip_sys_memory_quiet_depth = saved.quiet;
+    maip_sys_section_deferred = 0;
+}
 
-// Bright background colors
-#define FOSSIL_IO_BG_BRIGHT_BLACK "\033[100m"
-#define FOSSIL_IO_BG_BRIGHT_RED "\033[101m"
-#define FOSSIL_IO_BG_BRIGHT_GREEN "\033[102m"
-#define FOSSIL_IO_BG_BRIGHT_YELLOW "\033[103m"
-#define FOSSIL_IO_BG_BRIGHT_BLUE "\033[104m"
-#define FOSSIL_IO_BG_BRIGHT_MAGENTA "\033[105m"
-#define FOSSIL_IO_BG_BRIGHT_CYAN "\033[106m"
-#define FOSSIL_IO_BG_BRIGHT_WHITE "\033[107m"
+bool maip_sys_section_defer(void)
+{
+    if (maip_sys_memory_quiet_depth == 0 && maip_io_lock_depth == 0)
+        return false;
+    maip_sys_section_deferred = 1;
+    return true;
+}
 
-// ================================================================
-// TEXT ATTRIBUTES
-// ================================================================
+void maip_sys_section_set_resume(void (*resume)(void))
+{
+    maip_sys_section_resume = resume;
+}
+
+// *****************************************************************************
+// timing
+// *****************************************************************************
+
+#if defined(FOSSIL_MAIP_USE_TSC) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+#define MAIP_TIME_HAS_TSC 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+// The system monotonic clock every other source is calibrated against
+static uint64_t maip_sys_time_clock_ns(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    uint64_t ticks = (uint64_t)counter.QuadPart;
+    uint64_t freq = (uint64_t)frequency.QuadPart;
+    return (ticks / freq) * 1000000000ULL + (ticks % freq) * 1000000000ULL / freq;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase = {0, 0};
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#ifdef MAIP_TIME_HAS_TSC
+static pthread_once_t maip_sys_time_tsc_once = PTHREAD_ONCE_INIT;
+static int maip_sys_time_tsc_ready = 0;
+static uint64_t maip_sys_time_tsc_base = 0;
+static uint64_t maip_sys_time_ns_base = 0;
+static uint64_t maip_sys_time_tsc_mult = 0; // ns per tick in 32.32 fixed point
+
+static void maip_sys_time_tsc_calibrate(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8)))
+        return; // no invariant TSC: stay on the system clock
+
+    uint64_t ns0 = maip_sys_time_clock_ns();
+    uint64_t tsc0 = __rdtsc();
+    while (maip_sys_time_clock_ns() - ns0 < 10000000ULL) // 10 ms window
+    {
+    }
+    uint64_t ns1 = maip_sys_time_clock_ns();
+    uint64_t tsc1 = __rdtsc();
+
+    if (tsc1 <= tsc0)
+        return;
+
+    maip_sys_time_tsc_mult = (uint64_t)((((unsigned __int128)(ns1 - ns0)) << 32) / (tsc1 - tsc0));
+    maip_sys_time_tsc_base = tsc1;
+    maip_sys_time_ns_base = ns1;
+    maip_sys_time_tsc_ready = maip_sys_time_tsc_mult != 0;
+}
+#endif
+
+uint64_t maip_sys_time_now_ns(void)
+{
+#ifdef MAIP_TIME_HAS_TSC
+    pthread_once(&maip_sys_time_tsc_once, maip_sys_time_tsc_calibrate);
+    if (maip_sys_time_tsc_ready)
+    {
+        uint64_t delta = __rdtsc() - maip_sys_time_tsc_base;
+        return maip_sys_time_ns_base + (uint64_t)(((unsigned __int128)delta * maip_sys_time_tsc_mult) >> 32);
+    }
+#endif
+    return maip_sys_time_clock_ns();
+}
+
+static uint64_t maip_sys_time_measured_resolution = 0;
+static uint64_t maip_sys_time_measured_overhead = 0;
+
+#ifdef _WIN32
+static INIT_ONCE maip_sys_time_measure_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t maip_sys_time_measure_once = PTHREAD_ONCE_INIT;
+#endif
+
+static void maip_sys_time_measure_impl(void)
+{
+    enum { CALLS = 10000, STEPS = 64 };
+
+    uint64_t begin = maip_sys_time_now_ns();
+    for (int i = 0; i < CALLS; ++i)
+        (void)maip_sys_time_now_ns();
+    uint64_t end = maip_sys_time_now_ns();
+    uint64_t overhead = (end - begin) / CALLS;
+
+    // Smallest non-zero step over a handful of transitions
+    uint64_t resolution = UINT64_MAX;
+    uint64_t last = maip_sys_time_now_ns();
+    for (int seen = 0, spins = 0; seen < STEPS && spins < 10000000; ++spins)
+    {
+        uint64_t now = maip_sys_time_now_ns();
+        if (now != last)
+        {
+            if (now - last < resolution)
+                resolution = now - last;
+            last = now;
+            seen++;
+        }
+    }
+
+    maip_sys_time_measured_overhead = overhead;
+    maip_sys_time_measured_resolution = resolution == UINT64_MAX ? 1 : resolution;
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK maip_sys_time_measure_win(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+    (void)once; (void)param; (void)context;
+    maip_sys_time_measure_impl();
+    return TRUE;
+}
+#endif
+
+// Measures once; workers asking concurrently wait for the first measurement
+static void maip_sys_time_measure(void)
+{
+#ifdef _WIN32
+    InitOnceExecuteOnce(&maip_sys_time_measure_once, maip_sys_time_measure_win, NULL, NULL);
+#else
+    pthread_once(&maip_sys_time_measure_once, maip_sys_time_measure_impl);
+#endif
+}
+
+uint64_t maip_sys_time_resolution_ns(void)
+{
+    maip_sys_time_measure();
+    return maip_sys_time_measured_resolution;
+}
+
+uint64_t maip_sys_time_overhead_ns(void)
+{
+    maip_sys_time_measure();
+    return maip_sys_time_measured_overhead;
+}
+
+const char *maip_sys_time_source(void)
+{
+#ifdef MAIP_TIME_HAS_TSC
+    pthread_once(&maip_sys_time_tsc_once, maip_sys_time_tsc_calibrate);
+    if (maip_sys_time_tsc_ready)
+        return "tsc";
+#endif
+#if defined(_WIN32)
+    return "qpc";
+#elif defined(__APPLE__)
+    return "mach";
+#elif defined(CLOCK_MONOTONIC_RAW)
+    return "monotonic_raw";
+#else
+    return "monotonic";
+#endif
+}
+
+// *****************************************************************************
+// threading
+// *****************************************************************************
+
+#ifdef _WIN32
+typedef struct
+{
+    maip_sys_thread_func_t func;
+    void *arg;
+} maip_sys_thread_start_t;
+
+static DWORD WINAPI maip_sys_thread_trampoline(LPVOID param)
+{
+    maip_sys_thread_start_t start = *(maip_sys_thread_start_t *)param;
+    free(param);
+    start.func(start.arg);
+    return 0;
+}
+#endif
+
+int maip_sys_thread_create(maip_sys_thread_t *thread, maip_sys_thread_func_t func, void *arg)
+{
+    if (!thread || !func)
+    {
+        return -1;
+    }
+
+#ifdef _WIN32
+    maip_sys_thread_start_t *start = (maip_sys_thread_start_t *)malloc(sizeof(*start));
+    if (!start)
+    {
+        return -1;
+    }
+    start->func = func;
+    start->arg = arg;
+
+    *thread = CreateThread(null, 0, maip_sys_thread_trampoline, start, 0, null);
+    if (*thread == null)
+    {
+        free(start);
+        return -1;
+    }
+    return 0;
+#else
+    // libc keeps the new thread's TLS block cached after the join
+    maip_sys_memory_quiet_begin();
+    int rc = pthread_create(thread, null, func, arg);
+    maip_sys_memory_quiet_end();
+    return rc == 0 ? 0 : -1;
+#endif
+}
+
+int maip_sys_thread_join(maip_sys_thread_t thread)
+{
+#ifdef _WIN32
+    if (WaitForSingleObject(thread, INFINITE) != WAIT_OBJECT_0)
+    {
+        return -1;
+    }
+    CloseHandle(thread);
+    return 0;
+#else
+    return pthread_join(thread, null) == 0 ? 0 : -1;
+#endif
+}
+
+int maip_sys_mutex_init(maip_sys_mutex_t *mutex)
+{
+    if (!mutex)
+    {
+        return -1;
+    }
+#ifdef _WIN32
+    InitializeCriticalSection(mutex);
+    return 0;
+#else
+    return pthread_mutex_init(mutex, null) == 0 ? 0 : -1;
+#endif
+}
+
+void maip_sys_mutex_lock(maip_sys_mutex_t *mutex)
+{
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void maip_sys_mutex_unlock(maip_sys_mutex_t *mutex)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+void maip_sys_mutex_destroy(maip_sys_mutex_t *mutex)
+{
+#ifdef _WIN32
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+int maip_sys_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    return sysinfo.dwNumberOfProcessors > 0 ? (int)sysinfo.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#else
+    return 1;
+#endif
+}
+
+// *****************************************************************************
+// output management
+// *****************************************************************************
+
+maip_fstream_t *MAIP_STDIN;
+maip_fstream_t *MAIP_STDOUT;
+maip_fstream_t *MAIP_STDERR;
+
+int32_t MAIP_IO_COLOR_ENABLE = 1; // Flag to enable/disable color output
+
+// ================================================================
+// RESET
+// ================================================================
+#define FOSSIL_IO_COLOR_RESET "\033[0m"
+
+// ================================================================
+// DARK (STANDARD) COLORS
+// ================================================================
+#define FOSSIL_IO_COLOR_BLACK "\033[30m"
+#define FOSSIL_IO_COLOR_RED "\033[31m"
+#define FOSSIL_IO_COLOR_GREEN "\033[32m"
+#define FOSSIL_IO_COLOR_YELLOW "\033[33m"
+#define FOSSIL_IO_COLOR_BLUE "\033[34m"
+#define FOSSIL_IO_COLOR_MAGENTA "\033[35m"
+#define FOSSIL_IO_COLOR_CYAN "\033[36m"
+#define FOSSIL_IO_COLOR_WHITE "\033[37m"
+#define FOSSIL_IO_COLOR_GRAY "\033[90m"
+#define FOSSIL_IO_COLOR_ORANGE "\033[38;5;208m"
+#define FOSSIL_IO_COLOR_PINK "\033[38;5;205m"
+#define FOSSIL_IO_COLOR_PURPLE "\033[38;5;93m"
+#define FOSSIL_IO_COLOR_BROWN "\033[38;5;94m"
+#define FOSSIL_IO_COLOR_TEAL "\033[38;5;30m"
+#define FOSSIL_IO_COLOR_SILVER "\033[38;5;7m"
+
+// ================================================================
+// BRIGHT COLORS
+// ================================================================
+#define FOSSIL_IO_COLOR_BRIGHT_BLACK "\033[90m"
+#define FOSSIL_IO_COLOR_BRIGHT_RED "\033[91m"
+#define FOSSIL_IO_COLOR_BRIGHT_GREEN "\033[92m"
+#define FOSSIL_IO_COLOR_BRIGHT_YELLOW "\033[93m"
+#define FOSSIL_IO_COLOR_BRIGHT_BLUE "\033[94m"
+#define FOSSIL_IO_COLOR_BRIGHT_MAGENTA "\033[95m"
+#define FOSSIL_IO_COLOR_BRIGHT_CYAN "\033[96m"
+#define FOSSIL_IO_COLOR_BRIGHT_WHITE "\033[97m"
+
+// ================================================================
+// BACKGROUND COLORS
+// ================================================================
+#define FOSSIL_IO_BG_BLACK "\033[40m"
+#define FOSSIL_IO_BG_RED "\033[41m"
+#define FOSSIL_IO_BG_GREEN "\033[42m"
+#define FOSSIL_IO_BG_YELLOW "\033[43m"
+#define FOSSIL_IO_BG_BLUE "\033[44m"
+#define FOSSIL_IO_BG_MAGENTA "\033[45m"
+#define FOSSIL_IO_BG_CYAN "\033[46m"
+#define FOSSIL_IO_BG_WHITE "\033[47m"
+#define FOSSIL_IO_BG_GRAY "\033[100m"
+#define FOSSIL_IO_BG_ORANGE "\033[48;5;208m"
+#define FOSSIL_IO_BG_PINK "\033[48;5;205m"
+#define FOSSIL_IO_BG_PURPLE "\033[48;5;93m"
+#define FOSSIL_IO_BG_BROWN "\033[48;5;94m"
+#define FOSSIL_IO_BG_TEAL "\033[48;5;30m"
+#define FOSSIL_IO_BG_SILVER "\033[48;5;7m"
+
+// Bright background colors
+#define FOSSIL_IO_BG_BRIGHT_BLACK "\033[100m"
+#define FOSSIL_IO_BG_BRIGHT_RED "\033[101m"
+#define FOSSIL_IO_BG_BRIGHT_GREEN "\033[102m"
+#define FOSSIL_IO_BG_BRIGHT_YELLOW "\033[103m"
+#define FOSSIL_IO_BG_BRIGHT_BLUE "\033[104m"
+#define FOSSIL_IO_BG_BRIGHT_MAGENTA "\033[105m"
+#define FOSSIL_IO_BG_BRIGHT_CYAN "\033[106m"
+#define FOSSIL_IO_BG_BRIGHT_WHITE "\033[107m"
+
+// ================================================================
+// TEXT ATTRIBUTES
+// ================================================================
 // Standard attributes
 #define FOSSIL_IO_ATTR_BOLD "\033[1m"
 #define FOSSIL_IO_ATTR_DIM "\033[2m"
@@ -2197,181 +2920,331 @@ int32_t MAIP_IO_COLOR_ENABLE = 1; // Flag to enable/disable color output
 
 #define FOSSIL_IO_BUFFER_SIZE 1000
 
-// Function to apply color
-void maip_io_apply_color(const char *color)
+// Markup engine: {color,attribute} and {pos:name} tags in a format string are
+// resolved to escape codes once and cached by format pointer. Each call is then
+// one vsnprintf, a scan for tags carried in by %s arguments, and one fwrite.
+
+typedef struct
 {
-    if (maip_io_cstr_compare(color, "red") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_RED);
-    }
-    else if (maip_io_cstr_compare(color, "green") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_GREEN);
-    }
-    else if (maip_io_cstr_compare(color, "yellow") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_YELLOW);
-    }
-    else if (maip_io_cstr_compare(color, "blue") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_BLUE);
-    }
-    else if (maip_io_cstr_compare(color, "magenta") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_MAGENTA);
-    }
-    else if (maip_io_cstr_compare(color, "cyan") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_CYAN);
-    }
-    else if (maip_io_cstr_compare(color, "white") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_WHITE);
-    }
-    else if (maip_io_cstr_compare(color, "black") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_BLACK);
-    }
-    else if (maip_io_cstr_compare(color, "orange") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_ORANGE);
-    }
-    else if (maip_io_cstr_compare(color, "gray") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_GRAY);
-    }
-    else if (maip_io_cstr_compare(color, "pink") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_PINK);
-    }
-    else if (maip_io_cstr_compare(color, "purple") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_PURPLE);
-    }
-    else if (maip_io_cstr_compare(color, "brown") == 0)
-    {
-        printf(FOSSIL_IO_COLOR_BROWN);
+    const char *name;
+    const char *code;
+} maip_io_markup_t;
+
+static const maip_io_markup_t MAIP_IO_MARKUP_COLORS[] = {
+    {"red", FOSSIL_IO_COLOR_RED},
+    {"green", FOSSIL_IO_COLOR_GREEN},
+    {"yellow", FOSSIL_IO_COLOR_YELLOW},
+    {"blue", FOSSIL_IO_COLOR_BLUE},
+    {"magenta", FOSSIL_IO_COLOR_MAGENTA},
+    {"cyan", FOSSIL_IO_COLOR_CYAN},
+    {"white", FOSSIL_IO_COLOR_WHITE},
+    {"black", FOSSIL_IO_COLOR_BLACK},
+    {"orange", FOSSIL_IO_COLOR_ORANGE},
+    {"gray", FOSSIL_IO_COLOR_GRAY},
+    {"pink", FOSSIL_IO_COLOR_PINK},
+    {"purple", FOSSIL_IO_COLOR_PURPLE},
+    {"brown", FOSSIL_IO_COLOR_BROWN},
+    {"teal", FOSSIL_IO_COLOR_TEAL},
+    {"silver", FOSSIL_IO_COLOR_SILVER},
+    {"bright_red", FOSSIL_IO_COLOR_BRIGHT_RED},
+    {"bright_green", FOSSIL_IO_COLOR_BRIGHT_GREEN},
+    {"bright_yellow", FOSSIL_IO_COLOR_BRIGHT_YELLOW},
+    {"bright_blue", FOSSIL_IO_COLOR_BRIGHT_BLUE},
+    {"bright_magenta", FOSSIL_IO_COLOR_BRIGHT_MAGENTA},
+    {"bright_cyan", FOSSIL_IO_COLOR_BRIGHT_CYAN},
+    {"bright_white", FOSSIL_IO_COLOR_BRIGHT_WHITE},
+    {"bright_black", FOSSIL_IO_COLOR_BRIGHT_BLACK},
+    {null, null}};
+
+static const maip_io_markup_t MAIP_IO_MARKUP_ATTRIBUTES[] = {
+    {"bold", FOSSIL_IO_ATTR_BOLD},
+    {"underline", FOSSIL_IO_ATTR_UNDERLINE},
+    {"reversed", FOSSIL_IO_ATTR_REVERSED},
+    {"blink", FOSSIL_IO_ATTR_BLINK},
+    {"hidden", FOSSIL_IO_ATTR_HIDDEN},
+    {"normal", FOSSIL_IO_ATTR_NORMAL},
+    {"italic", FOSSIL_IO_ATTR_ITALIC},
+    {"strikethrough", FOSSIL_IO_ATTR_STRIKETHROUGH},
+    {"dim", FOSSIL_IO_ATTR_DIM},
+    {"reset", FOSSIL_IO_ATTR_NORMAL},
+    {null, null}};
+
+static const maip_io_markup_t MAIP_IO_MARKUP_POSITIONS[] = {
+    {"top", "\033[H"},
+    {"bottom", "\033[999;1H"},  // within reasonable bounds
+    {"left", "\033[1;1H"},
+    {"right", "\033[1;999H"},
+    {"center", "\033[12;40H"},
+    {null, null}};
+
+static const char *maip_io_markup_lookup(const maip_io_markup_t *table, const char *name, size_t length)
+{
+    for (size_t i = 0; table[i].name; i++)
+    {
+        if (strncmp(table[i].name, name, length) == 0 && table[i].name[length] == '\0')
+        {
+            return table[i].code;
+        }
     }
-    else if (maip_io_cstr_compare(color, "teal") == 0)
+    return null;
+}
+
+// Output line, written with a single fwrite unless it overflows
+#define MAIP_IO_LINE_SIZE 4096
+
+typedef struct
+{
+    char data[MAIP_IO_LINE_SIZE];
+    size_t length;
+} maip_io_line_t;
+
+static void maip_io_line_flush(maip_io_line_t *line)
+{
+    if (line->length > 0)
     {
-        printf(FOSSIL_IO_COLOR_TEAL);
+        fwrite(line->data, 1, line->length, stdout);
+        line->length = 0;
     }
-    else if (maip_io_cstr_compare(color, "silver") == 0)
+}
+
+static void maip_io_line_append(maip_io_line_t *line, const char *text, size_t length)
+{
+    if (line->length + length > sizeof(line->data))
     {
-        printf(FOSSIL_IO_COLOR_SILVER);
+        maip_io_line_flush(line);
+        if (length > sizeof(line->data))
+        {
+            fwrite(text, 1, length, stdout);
+            return;
+        }
     }
+    memcpy(line->data + line->length, text, length);
+    line->length += length;
+}
+
+// Appends the escape codes for one tag body (the text between the braces).
+// "{color,attribute}": an unknown color resets, an unknown attribute is ignored.
+static void maip_io_markup_resolve(maip_io_line_t *line, const char *tag, size_t length, int color)
+{
+    const char *comma = memchr(tag, ',', length);
+    size_t first = comma ? (size_t)(comma - tag) : length;
 
-    // Bright colors
-    else if (maip_io_cstr_compare(color, "bright_red") == 0)
+    if (first >= 4 && strncmp(tag, "pos:", 4) == 0)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_RED);
+        const char *code = maip_io_markup_lookup(MAIP_IO_MARKUP_POSITIONS, tag + 4, first - 4);
+        if (code)
+            maip_io_line_append(line, code, strlen(code));
+        return;
     }
-    else if (maip_io_cstr_compare(color, "bright_green") == 0)
+
+    if (color)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_GREEN);
+        const char *code = maip_io_markup_lookup(MAIP_IO_MARKUP_COLORS, tag, first);
+        if (!code)
+            code = FOSSIL_IO_COLOR_RESET;
+        maip_io_line_append(line, code, strlen(code));
     }
-    else if (maip_io_cstr_compare(color, "bright_yellow") == 0)
+    if (comma)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_YELLOW);
+        const char *code = maip_io_markup_lookup(MAIP_IO_MARKUP_ATTRIBUTES, comma + 1, length - first - 1);
+        if (code)
+            maip_io_line_append(line, code, strlen(code));
     }
-    else if (maip_io_cstr_compare(color, "bright_blue") == 0)
+}
+
+// Copies text to the line, resolving any tags; an unmatched '{' is literal
+static void maip_io_markup_render(maip_io_line_t *line, const char *text, int color)
+{
+    const char *start;
+    while ((start = strchr(text, '{')) != null)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_BLUE);
+        const char *end = strchr(start + 1, '}');
+        if (!end)
+            break;
+        maip_io_line_append(line, text, (size_t)(start - text));
+        maip_io_markup_resolve(line, start + 1, (size_t)(end - start - 1), color);
+        text = end + 1;
     }
-    else if (maip_io_cstr_compare(color, "bright_magenta") == 0)
+    maip_io_line_append(line, text, strlen(text));
+}
+
+// Compiled formats, keyed by format pointer and checked against a copy of the
+// text in case the pointer is a reused buffer. Guarded by the stdout lock.
+#define MAIP_IO_MARKUP_CACHE 512
+#define MAIP_IO_MARKUP_PROBE 8
+
+typedef struct
+{
+    const char *key;
+    char *source;
+    char *compiled[2]; // Without and with color
+} maip_io_markup_entry_t;
+
+static maip_io_markup_entry_t maip_io_markup_cache[MAIP_IO_MARKUP_CACHE];
+
+static char *maip_io_markup_compile_text(const char *format, int color)
+{
+    maip_io_line_t *line = (maip_io_line_t *)malloc(sizeof(*line));
+    if (!line)
+        return null;
+    line->length = 0;
+
+    // A format that does not fit is left uncompiled and rendered per call
+    const char *start;
+    const char *text = format;
+    while ((start = strchr(text, '{')) != null)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_MAGENTA);
+        const char *end = strchr(start + 1, '}');
+        if (!end)
+            break;
+        if (line->length + (size_t)(start - text) > sizeof(line->data) - 64)
+        {
+            free(line);
+            return null;
+        }
+        maip_io_line_append(line, text, (size_t)(start - text));
+        maip_io_markup_resolve(line, start + 1, (size_t)(end - start - 1), color);
+        text = end + 1;
     }
-    else if (maip_io_cstr_compare(color, "bright_cyan") == 0)
+    size_t rest = strlen(text);
+    if (line->length + rest + 1 > sizeof(line->data))
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_CYAN);
+        free(line);
+        return null;
     }
-    else if (maip_io_cstr_compare(color, "bright_white") == 0)
+    maip_io_line_append(line, text, rest);
+
+    char *compiled = (char *)malloc(line->length + 1);
+    if (compiled)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_WHITE);
+        memcpy(compiled, line->data, line->length);
+        compiled[line->length] = '\0';
     }
-    else if (maip_io_cstr_compare(color, "bright_black") == 0)
+    free(line);
+    return compiled;
+}
+
+// Returns the cached compiled format, or null when it can't be cached
+static const char *maip_io_markup_compile(const char *format, int color)
+{
+    size_t slot = (size_t)(((uintptr_t)format >> 3) * 2654435761u) % MAIP_IO_MARKUP_CACHE;
+
+    for (size_t probe = 0; probe < MAIP_IO_MARKUP_PROBE; probe++)
     {
-        printf(FOSSIL_IO_COLOR_BRIGHT_BLACK);
+        maip_io_markup_entry_t *entry = &maip_io_markup_cache[(slot + probe) % MAIP_IO_MARKUP_CACHE];
+
+        if (entry->key == format && strcmp(entry->source, format) != 0)
+        {
+            // Same buffer, new text: start this entry over
+            free(entry->source);
+            free(entry->compiled[0]);
+            free(entry->compiled[1]);
+            maip_sys_memory_set(entry, 0, sizeof(*entry));
+        }
+        if (entry->key == null)
+        {
+            size_t length = strlen(format);
+            entry->source = (char *)malloc(length + 1);
+            if (!entry->source)
+                return null;
+            memcpy(entry->source, format, length + 1);
+            entry->key = format;
+        }
+        if (entry->key == format)
+        {
+            if (!entry->compiled[color])
+                entry->compiled[color] = maip_io_markup_compile_text(format, color);
+            return entry->compiled[color];
+        }
     }
+    return null;
+}
+
+void maip_io_lock(void)
+{
+    ++maip_io_lock_depth; // counted first, so a signal while we wait is deferred
+#ifdef _WIN32
+    _lock_file(stdout);
+#else
+    flockfile(stdout);
+#endif
+}
+
+void maip_io_unlock(void)
+{
+#ifdef _WIN32
+    _unlock_file(stdout);
+#else
+    funlockfile(stdout);
+#endif
+    if (maip_io_lock_depth > 0)
+        --maip_io_lock_depth;
+    maip_sys_section_leave();
+}
+
+static void maip_io_markup_vprintf(int color, const char *format, va_list args)
+{
+    char buffer[FOSSIL_IO_BUFFER_SIZE];
+    maip_io_line_t line;
+    line.length = 0;
+
+    // Hold the stdout lock so lines from parallel workers don't interleave
+    maip_io_lock();
+
+    // The format cache and stdio buffers belong to the runner, not the case printing
+    maip_sys_memory_quiet_begin();
+    const char *compiled = maip_io_markup_compile(format, color);
+    vsnprintf(buffer, sizeof(buffer), compiled ? compiled : format, args);
+
+    // Tags can still arrive through %s arguments, e.g. a colored result name
+    if (!compiled || strchr(buffer, '{'))
+        maip_io_markup_render(&line, buffer, color);
     else
-    {
-        printf(FOSSIL_IO_COLOR_RESET); // Reset to default if color not recognized
-    }
+        maip_io_line_append(&line, buffer, strlen(buffer));
+    maip_io_line_flush(&line);
+    maip_sys_memory_quiet_end();
+
+    maip_io_unlock();
+}
+
+// Prints text as-is apart from markup; '%' is not interpreted
+static void maip_io_markup_puts(const char *text)
+{
+    maip_io_line_t line;
+    line.length = 0;
+
+    maip_io_lock();
+
+    maip_io_markup_render(&line, text, MAIP_IO_COLOR_ENABLE ? 1 : 0);
+    maip_io_line_flush(&line);
+
+    maip_io_unlock();
+}
+
+// Function to apply color
+void maip_io_apply_color(const char *color)
+{
+    const char *code = color ? maip_io_markup_lookup(MAIP_IO_MARKUP_COLORS, color, strlen(color)) : null;
+    fputs(code ? code : FOSSIL_IO_COLOR_RESET, stdout); // Reset to default if color not recognized
 }
 
 // Function to apply text attributes (e.g., bold, underline)
 void maip_io_apply_attribute(const char *attribute)
 {
-    if (maip_io_cstr_compare(attribute, "bold") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_BOLD);
-    }
-    else if (maip_io_cstr_compare(attribute, "underline") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_UNDERLINE);
-    }
-    else if (maip_io_cstr_compare(attribute, "reversed") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_REVERSED);
-    }
-    else if (maip_io_cstr_compare(attribute, "blink") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_BLINK);
-    }
-    else if (maip_io_cstr_compare(attribute, "hidden") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_HIDDEN);
-    }
-    else if (maip_io_cstr_compare(attribute, "normal") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_NORMAL);
-    }
-    else if (maip_io_cstr_compare(attribute, "italic") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_ITALIC);
-    }
-    else if (maip_io_cstr_compare(attribute, "strikethrough") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_STRIKETHROUGH);
-    }
-    else if (maip_io_cstr_compare(attribute, "dim") == 0)
+    const char *code = attribute ? maip_io_markup_lookup(MAIP_IO_MARKUP_ATTRIBUTES, attribute, strlen(attribute)) : null;
+    if (code)
     {
-        printf(FOSSIL_IO_ATTR_DIM);
-    }
-    else if (maip_io_cstr_compare(attribute, "reset") == 0)
-    {
-        printf(FOSSIL_IO_ATTR_NORMAL); // Reset to normal if attribute not recognized
+        fputs(code, stdout);
     }
 }
 
 // Function to handle named positions (like top, bottom, left, right)
 void maip_io_apply_position(const char *pos)
 {
-    if (maip_io_cstr_compare(pos, "top") == 0)
-    {
-        // Apply position logic for top
-        printf("\033[H"); // Move cursor to the top
-    }
-    else if (maip_io_cstr_compare(pos, "bottom") == 0)
-    {
-        // Apply position logic for bottom
-        printf("\033[999;1H"); // Move cursor to the bottom (example within reasonable bounds)
-    }
-    else if (maip_io_cstr_compare(pos, "left") == 0)
-    {
-        // Apply position logic for left
-        printf("\033[1;1H"); // Move cursor to the top-left corner
-    }
-    else if (maip_io_cstr_compare(pos, "right") == 0)
-    {
-        // Apply position logic for right
-        printf("\033[1;999H"); // Move cursor to the top-right corner (example within reasonable bounds)
-    }
-    else if (maip_io_cstr_compare(pos, "center") == 0)
+    const char *code = pos ? maip_io_markup_lookup(MAIP_IO_MARKUP_POSITIONS, pos, strlen(pos)) : null;
+    if (code)
     {
-        // Apply position logic for center
-        printf("\033[12;40H"); // Move cursor to the center (example within reasonable bounds)
+        fputs(code, stdout);
     }
 }
 
@@ -2380,72 +3253,7 @@ void maip_io_print_with_attributes(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-
-    // Create a buffer to hold the formatted string
-    char buffer[FOSSIL_IO_BUFFER_SIZE];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-
-    // Variable to keep track of the current position in the buffer
-    const char *current_pos = buffer;
-    const char *start = null;
-    const char *end = null;
-
-    // Iterate over the buffer and process color/attribute/position inside `{}` and format specifiers
-    while ((start = strchr(current_pos, '{')) != null)
-    {
-        // Print text before '{'
-        printf("%.*s", (int)(start - current_pos), current_pos);
-
-        // Find the matching '}'
-        end = strchr(start, '}');
-        if (end)
-        {
-            // Extract attributes inside '{}'
-            size_t length = end - start - 1;
-            char attributes[length + 1];
-            strncpy(attributes, start + 1, length);
-            attributes[length] = '\0';
-
-            // Split by comma to separate color, attribute, or position
-            char *color = null;
-            char *attribute = null;
-            char *pos = null;
-            char *comma_pos = strchr(attributes, ',');
-            if (comma_pos)
-            {
-                *comma_pos = '\0';         // null-terminate the first part
-                color = attributes;        // Color or position part
-                attribute = comma_pos + 1; // Attribute part
-            }
-            else
-            {
-                color = attributes; // Only one part (could be color, attribute, or position)
-            }
-
-            // Handle positions (like {pos:name})
-            if (strstr(color, "pos:") == color)
-            {
-                pos = color + 4; // Skip the "pos:" prefix
-                maip_io_apply_position(pos);
-            }
-            else
-            {
-                // Apply color and/or attribute based on flags
-                if (MAIP_IO_COLOR_ENABLE && color)
-                {
-                    maip_io_apply_color(color);
-                }
-                maip_io_apply_attribute(attribute);
-            }
-
-            // Move past '}' and continue processing
-            current_pos = end + 1;
-        }
-    }
-
-    // Print remaining text after last '}'
-    printf("%s", current_pos);
-
+    maip_io_markup_vprintf(MAIP_IO_COLOR_ENABLE ? 1 : 0, format, args);
     va_end(args);
 }
 
@@ -2459,7 +3267,7 @@ void maip_io_fprint_with_attributes(maip_fstream_t *stream, const char *str)
         sanitized_str[sizeof(sanitized_str) - 1] = '\0'; // Ensure null termination
 
         // Apply color and attribute logic (same as the print version)
-        maip_io_print_with_attributes(sanitized_str);
+        maip_io_markup_puts(sanitized_str);
 
         // Write the sanitized string to the stream
         fputs(sanitized_str, stream->file);
@@ -2479,12 +3287,7 @@ void maip_io_puts(const char *str)
 {
     if (str != null)
     {
-        char sanitized_str[FOSSIL_IO_BUFFER_SIZE];
-        strncpy(sanitized_str, str, sizeof(sanitized_str));
-        sanitized_str[sizeof(sanitized_str) - 1] = '\0'; // Ensure null termination
-
-        // Print the sanitized string with attributes
-        maip_io_print_with_attributes(sanitized_str);
+        maip_io_markup_puts(str);
     }
     else
     {
@@ -2503,14 +3306,15 @@ void maip_io_printf(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
+    maip_io_markup_vprintf(MAIP_IO_COLOR_ENABLE ? 1 : 0, format, args);
+    va_end(args);
+}
 
-    // Create a buffer to hold the formatted string
-    char buffer[FOSSIL_IO_BUFFER_SIZE];
-    vsnprintf(buffer, sizeof(buffer), format, args);
-
-    // Print the sanitized output with attributes
-    maip_io_print_with_attributes(buffer);
-
+void maip_io_printf_color(int color, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    maip_io_markup_vprintf(color ? 1 : 0, format, args);
     va_end(args);
 }
 
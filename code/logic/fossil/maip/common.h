@@ -61,12 +61,14 @@
     #include <sys/sysctl.h>
     #include <sys/stat.h>
     #include <mach/mach_time.h>
+    #include <pthread.h>
 #else
     #include <sys/utsname.h>
     #include <sys/sysinfo.h>
     #include <sys/types.h>
     #include <sys/stat.h>
     #include <sys/time.h>
+    #include <pthread.h>
 #endif
 
 #ifdef __cplusplus
@@ -204,11 +206,106 @@ typedef const char* ccstr;
 // Hashing algorithm
 // *****************************************************************************
 
+/**
+ * @brief Incremental hashing state.
+ *
+ * Four 64-bit lanes consume 32-byte stripes; a partial stripe waits in the
+ * buffer until more input arrives or the digest is finalised.
+ */
+typedef struct {
+    uint64_t lanes[4];
+    uint64_t seed;
+    uint64_t total;
+    uint8_t buffer[32];
+    size_t buffered;
+} fossil_maip_hash_state_t;
+
+/**
+ * @brief Starts an incremental hash.
+ *
+ * @param state The state to initialise.
+ * @param seed The seed; 0 gives the unsalted digest.
+ */
+FOSSIL_MAIP_API void fossil_maip_hash_init(fossil_maip_hash_state_t *state, uint64_t seed);
+
+/**
+ * @brief Feeds bytes into an incremental hash.
+ *
+ * Splitting input across calls never changes the digest.
+ *
+ * @param state The state to update.
+ * @param data The bytes to add.
+ * @param len The number of bytes.
+ */
+FOSSIL_MAIP_API void fossil_maip_hash_update(fossil_maip_hash_state_t *state, const void *data, size_t len);
+
+/**
+ * @brief Returns the 64-bit digest of everything fed so far.
+ *
+ * The value matches XXH64 with the same seed. The state is left untouched,
+ * so more input may follow.
+ *
+ * @param state The state to read.
+ * @return The 64-bit digest.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_hash_final64(const fossil_maip_hash_state_t *state);
+
+/**
+ * @brief Writes the 128-bit digest of everything fed so far.
+ *
+ * The first 8 bytes are the little-endian 64-bit digest.
+ *
+ * @param state The state to read.
+ * @param hash_out Receives FOSSIL_MAIP_HASH_SIZE bytes.
+ */
+FOSSIL_MAIP_API void fossil_maip_hash_final128(const fossil_maip_hash_state_t *state, uint8_t *hash_out);
+
+/**
+ * @brief Computes the 64-bit digest of a buffer in one call.
+ *
+ * @param data The bytes to hash.
+ * @param len The number of bytes.
+ * @param seed The seed; 0 gives the unsalted digest.
+ * @return The 64-bit digest.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_hash64(const void *data, size_t len, uint64_t seed);
+
+/**
+ * @brief Computes the 128-bit digest of a buffer in one call.
+ *
+ * @param data The bytes to hash.
+ * @param len The number of bytes.
+ * @param seed The seed; 0 gives the unsalted digest.
+ * @param hash_out Receives FOSSIL_MAIP_HASH_SIZE bytes.
+ */
+FOSSIL_MAIP_API void fossil_maip_hash128(const void *data, size_t len, uint64_t seed, uint8_t *hash_out);
+
+/**
+ * @brief Returns a per-user, per-host salt.
+ *
+ * Derived from the environment and stable for the life of the process. Pass
+ * it as the seed where digests should not be comparable across machines.
+ *
+ * @return The salt.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_hash_salt(void);
+
+/**
+ * @brief Computes a seeded 128-bit hash of an input and output string pair.
+ *
+ * @param input The input string to hash.
+ * @param output The output string to combine with the input.
+ * @param seed The seed, for example fossil_maip_hash_salt().
+ * @param hash_out Pointer to an array where the resulting hash will be stored.
+ */
+FOSSIL_MAIP_API void fossil_maip_hash_seeded(const char *input, const char *output, uint64_t seed, uint8_t *hash_out);
+
 /**
  * @brief Computes a hash for the given input string.
  *
- * This function implements a simple hashing algorithm that combines the input
- * string with an output string to produce a fixed-size hash.
+ * Deterministic: the same pair gives the same FOSSIL_MAIP_HASH_SIZE bytes on
+ * every call and every host. Equivalent to fossil_maip_hash_seeded() with a
+ * zero seed.
  *
  * @param input The input string to hash.
  * @param output The output string to combine with the input.
@@ -243,8 +340,19 @@ typedef struct {
         int only_has_wildcard;     // 1 if any test case contains '*', 0 otherwise
         const char* skip;          // Value for --skip
         int repeat;                // Value for --repeat
+        int repeat_jobs;           // Value for --repeat-jobs (threads per repeated case, <= 1 runs in order)
         unsigned int random_seed;  // Optional random seed for reproducible runs
         int until_fail;            // Flag for --until-fail stress testing
+        int jobs;                  // Value for --jobs (worker threads, <= 1 runs serially)
+        int isolate;               // Value for --isolate (worker processes, 0 = in-process)
+        int timeout;               // Value for --timeout in seconds (0 = FOSSIL_MAIP_TIMEOUT)
+        int no_recover;            // Flag for --no-recover (crashes in a case end the run)
+        cstr *bundles;             // Shared objects from --bundle (split by ',')
+        size_t bundle_count;       // Number of entries in bundles
+        const char* history;       // Value for --history (run history file to schedule from)
+        int shard_index;           // Value for --shard-index (0-based)
+        int shard_count;           // Value for --shard-count (<= 1 runs every case)
+        const char* shard_by;      // Value for --shard-by (hash or duration)
     } run;                         // Run command flags
 
     struct {
@@ -263,19 +371,22 @@ typedef struct {
         cstr *tag_list;                 // Array of tags (split by ',')
         size_t tag_count;               // Number of tags
         int tag_has_wildcard;           // 1 if any tag contains '*', 0 otherwise
+
+        const char* expr;               // Value for --expr (tag:/name:/suite: terms with ! & | and parens)
     } filter;                      // Filter command flags
 
     struct {
         const char* by;                // Value for --by
         const char* order;             // Value for --order
-        const char* then_by;           // Secondary sort criterion
+        const char* then_by;           // Value for --then-by (comma-separated criteria[:asc|:desc])
     } sort;                        // Sort command flags
 
     struct {
         const char* seed;              // Value for --seed
         int count;                     // Value for --count
-        const char* by;                // Value for --by
+        const char* by;                // Value for --by (weight for weighted mode: priority/failures)
         const char* mode;              // Shuffle mode: uniform/weighted
+        int enabled;                   // Flag to indicate if shuffle command is enabled
     } shuffle;                     // Shuffle command flags
 
     struct {
@@ -289,10 +400,18 @@ typedef struct {
     } show;                        // Show command flags
 
     struct {
-        const char* format;            // Output format: json/fson/yaml/csv
+        const char* format;            // Output format: json (JSON Lines)/junit/csv/tap/yaml
         const char* destination;       // Output destination (file path or stdout)
+        cstr *merge;                   // JSON Lines reports from --merge (split by ',')
+        size_t merge_count;            // Number of entries in merge
     } report;                       // Report command flags
 
+    struct {
+        const char* save_baseline;     // Value for --save-baseline (file to write)
+        const char* compare;           // Value for --compare (baseline file to read)
+        double threshold;              // Value for --threshold (allowed median slowdown in percent)
+    } mark;                        // Mark command flags
+
     struct {
         int os;                       // Flag for --os
         int arch;                     // Flag for --arch
@@ -861,6 +980,180 @@ FOSSIL_MAIP_API maip_sys_memory_t maip_sys_memory_resize(maip_sys_memory_t ptr,
  */
 FOSSIL_MAIP_API bool maip_sys_memory_is_valid(const maip_sys_memory_t ptr);
 
+/**
+ * Keep the calling thread's allocations out of per-case allocation tracking
+ * until the matching maip_sys_memory_quiet_end(). Used around framework state
+ * that outlives a test case, such as caches and shared fixtures. Calls nest.
+ */
+FOSSIL_MAIP_API void maip_sys_memory_quiet_begin(void);
+
+/**
+ * End a section opened by maip_sys_memory_quiet_begin().
+ */
+FOSSIL_MAIP_API void maip_sys_memory_quiet_end(void);
+
+/**
+ * Check whether the calling thread is inside a quiet section.
+ *
+ * @return true if allocations are currently not attributed to a test case.
+ */
+FOSSIL_MAIP_API bool maip_sys_memory_quiet(void);
+
+/**
+ * Runner sections held by the calling thread: quiet sections and console
+ * locks taken through maip_io_lock().
+ */
+typedef struct {
+    int quiet;
+    int locks;
+} maip_sys_section_t;
+
+/**
+ * Record the calling thread's open runner sections, before running a case.
+ *
+ * @return The current section depths.
+ */
+FOSSIL_MAIP_API maip_sys_section_t maip_sys_section_save(void);
+
+/**
+ * Close the sections a longjmp out of the case left open: releases the
+ * console locks and ends the quiet sections above `saved`.
+ *
+ * @param saved Depths from maip_sys_section_save().
+ */
+FOSSIL_MAIP_API void maip_sys_section_restore(maip_sys_section_t saved);
+
+/**
+ * Async-signal-safe. Called by a handler that wants to unwind the case: if
+ * the thread is inside a runner section the jump is deferred, and the resume
+ * hook runs when the outermost section closes.
+ *
+ * @return true if deferred, false if the handler may jump now.
+ */
+FOSSIL_MAIP_API bool maip_sys_section_defer(void);
+
+/**
+ * Set the hook that takes a deferred jump.
+ *
+ * @param resume Called on the thread that deferred, outside any section.
+ */
+FOSSIL_MAIP_API void maip_sys_section_set_resume(void (*resume)(void));
+
+// *****************************************************************************
+// Timing
+// *****************************************************************************
+
+/**
+ * Read the framework clock.
+ *
+ * The clock is monotonic and unaffected by NTP slewing: CLOCK_MONOTONIC_RAW on
+ * Linux, mach_absolute_time on Apple and QueryPerformanceCounter on Windows.
+ * Building with FOSSIL_MAIP_USE_TSC (meson -Dwith_tsc=enabled) reads the
+ * invariant TSC on x86-64 instead, calibrated once against the system clock.
+ *
+ * @return Nanoseconds since an arbitrary fixed point.
+ */
+FOSSIL_MAIP_API uint64_t maip_sys_time_now_ns(void);
+
+/**
+ * Retrieve the smallest step the clock was observed to advance by.
+ *
+ * @return The measured resolution in nanoseconds.
+ */
+FOSSIL_MAIP_API uint64_t maip_sys_time_resolution_ns(void);
+
+/**
+ * Retrieve the average cost of one maip_sys_time_now_ns() call.
+ *
+ * @return The measured overhead in nanoseconds.
+ */
+FOSSIL_MAIP_API uint64_t maip_sys_time_overhead_ns(void);
+
+/**
+ * Retrieve the name of the clock source in use.
+ *
+ * @return "tsc", "monotonic_raw", "monotonic", "mach" or "qpc".
+ */
+FOSSIL_MAIP_API const char *maip_sys_time_source(void);
+
+// *****************************************************************************
+// Threading
+// *****************************************************************************
+
+// Storage class for per-thread engine state (jump buffers, counters)
+#if defined(__cplusplus)
+#  define FOSSIL_MAIP_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#  define FOSSIL_MAIP_THREAD_LOCAL __declspec(thread)
+#else
+#  define FOSSIL_MAIP_THREAD_LOCAL _Thread_local
+#endif
+
+#ifdef _WIN32
+typedef HANDLE maip_sys_thread_t;
+typedef CRITICAL_SECTION maip_sys_mutex_t;
+#else
+typedef pthread_t maip_sys_thread_t;
+typedef pthread_mutex_t maip_sys_mutex_t;
+#endif
+
+// Thread entry point
+typedef void *(*maip_sys_thread_func_t)(void *arg);
+
+/**
+ * Start a new thread.
+ *
+ * @param thread Receives the handle of the new thread.
+ * @param func The entry point of the thread.
+ * @param arg The argument passed to the entry point.
+ * @return 0 on success, or a negative error code on failure.
+ */
+FOSSIL_MAIP_API int maip_sys_thread_create(maip_sys_thread_t *thread, maip_sys_thread_func_t func, void *arg);
+
+/**
+ * Wait for a thread to finish and release its handle.
+ *
+ * @param thread The thread to join.
+ * @return 0 on success, or a negative error code on failure.
+ */
+FOSSIL_MAIP_API int maip_sys_thread_join(maip_sys_thread_t thread);
+
+/**
+ * Initialize a mutex.
+ *
+ * @param mutex The mutex to initialize.
+ * @return 0 on success, or a negative error code on failure.
+ */
+FOSSIL_MAIP_API int maip_sys_mutex_init(maip_sys_mutex_t *mutex);
+
+/**
+ * Lock a mutex.
+ *
+ * @param mutex The mutex to lock.
+ */
+FOSSIL_MAIP_API void maip_sys_mutex_lock(maip_sys_mutex_t *mutex);
+
+/**
+ * Unlock a mutex.
+ *
+ * @param mutex The mutex to unlock.
+ */
+FOSSIL_MAIP_API void maip_sys_mutex_unlock(maip_sys_mutex_t *mutex);
+
+/**
+ * Destroy a mutex.
+ *
+ * @param mutex The mutex to destroy.
+ */
+FOSSIL_MAIP_API void maip_sys_mutex_destroy(maip_sys_mutex_t *mutex);
+
+/**
+ * Retrieve the number of online processors.
+ *
+ * @return The number of logical CPUs, never less than 1.
+ */
+FOSSIL_MAIP_API int maip_sys_cpu_count(void);
+
 // *****************************************************************************
 // output management
 // *****************************************************************************
@@ -918,13 +1211,12 @@ extern int32_t MAIP_IO_COLOR_ENABLE; // Flag to enable/disable color output
  *    fine-grained control over the text output. The system is flexible enough to be extended with more attributes, 
  *    colors, and positioning options as required.
  *
- * 5. **Implementation Details** - The function `maip_io_print_with_attributes` processes the format string 
- *    provided to it, looking for `{}` markers. When it encounters a `{}`, it checks if the enclosed string specifies 
- *    a color, attribute, or position, and then calls the respective helper functions (`maip_io_apply_color` and 
- *    `maip_io_apply_attribute`) to modify the terminal output accordingly. If a position marker is found (e.g., 
- *    `{pos:top}`), it adjusts the cursor position in the terminal to the specified location. The code uses standard 
- *    C string manipulation functions like `strchr`, `strncpy`, and `vsnprintf` to process the format string and apply 
- *    the requested changes to the output.
+ * 5. **Implementation Details** - Each format string is compiled once: its `{}` markers are resolved to escape 
+ *    codes (colors, attributes, or `{pos:...}` cursor moves) and the result is cached by format pointer, one 
+ *    variant per color mode. A call then formats the compiled string with `vsnprintf`, resolves any markers that 
+ *    arrived through `%s` arguments, and writes the whole line with a single `fwrite` while holding the stdout 
+ *    lock. Arguments are formatted exactly once, so a `%` inside an argument is printed literally, and an 
+ *    unmatched `{` is printed as-is.
  * 
  * In summary, this system provides a highly customizable and intuitive way to format terminal text with colors, 
  * attributes, and positions, making it ideal for developers who want to build visually rich and interactive 
@@ -1003,6 +1295,18 @@ FOSSIL_MAIP_API void maip_io_puts(const char *str);
  */
 FOSSIL_MAIP_API void maip_io_printf(const char *format, ...);
 
+/**
+ * Prints a formatted string like `maip_io_printf`, with color chosen per call.
+ *
+ * Markup is rendered with escape codes when `color` is nonzero and stripped
+ * otherwise, whatever `MAIP_IO_COLOR_ENABLE` is set to.
+ *
+ * @param color Nonzero to emit color and attribute codes.
+ * @param format The format string, with optional `{}` markup.
+ * @param ... The arguments for the format specifiers.
+ */
+FOSSIL_MAIP_API void maip_io_printf_color(int color, const char *format, ...);
+
 /**
  * Prints a formatted string to a buffer using a va_list.
  *
@@ -1136,6 +1440,17 @@ FOSSIL_MAIP_API void maip_io_draw_vertical_line(int length, char ch);
  */
 FOSSIL_MAIP_API void maip_io_flush(void);
 
+/**
+ * Takes the console lock so a multi-line block is not interleaved with other
+ * threads. Recursive; maip_io_printf takes it too.
+ */
+FOSSIL_MAIP_API void maip_io_lock(void);
+
+/**
+ * Releases the console lock taken by maip_io_lock().
+ */
+FOSSIL_MAIP_API void maip_io_unlock(void);
+
 // *****************************************************************************
 // string management
 // *****************************************************************************
@@ -39,6 +39,80 @@ extern "C" {
  * the total duration, the minimum and maximum durations, and a flag to indicate if the
  * benchmark is currently running.
  */
+/**
+ * @brief Outlier rejection applied by fossil_benchmark_run.
+ */
+typedef enum {
+    FOSSIL_MARK_OUTLIER_NONE,  // Keep every sample
+    FOSSIL_MARK_OUTLIER_MAD,   // Drop samples with a modified z-score above 3.5
+    FOSSIL_MARK_OUTLIER_TUKEY  // Drop samples outside 1.5 IQR of the quartiles
+} fossil_mark_outlier_t;
+
+/**
+ * @brief Configuration for the statistical benchmark driver.
+ *
+ * Zero fields are replaced by the defaults from fossil_benchmark_config_default.
+ */
+typedef struct {
+    uint64_t warmup_ns;             // Time spent running the function before measuring
+    uint64_t target_ns;             // Total measurement time to aim for
+    uint64_t min_sample_ns;         // Shortest acceptable sample, sets the batch size
+    size_t min_samples;             // Lower bound on the number of samples
+    size_t max_samples;             // Upper bound on the number of samples
+    double confidence;              // Confidence level of the reported interval
+    fossil_mark_outlier_t outliers; // Outlier rejection method
+} fossil_mark_config_t;
+
+/**
+ * @brief Per-operation statistics produced by fossil_benchmark_run.
+ *
+ * All times are nanoseconds per call of the benchmarked function.
+ */
+typedef struct {
+    size_t samples;    // Samples kept after outlier rejection
+    size_t outliers;   // Samples rejected as outliers
+    uint64_t batch;    // Calls timed together in one sample
+    uint64_t warmup;   // Calls made during warmup
+    double mean_ns;
+    double stddev_ns;
+    double ci_low_ns;  // Lower bound of the confidence interval for the mean
+    double ci_high_ns; // Upper bound of the confidence interval for the mean
+    double min_ns;
+    double max_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double p999_ns;
+    double confidence;
+} fossil_mark_stats_t;
+
+/**
+ * @brief Hardware and software counters sampled around benchmark iterations.
+ */
+typedef enum {
+    FOSSIL_MARK_COUNTER_CYCLES,
+    FOSSIL_MARK_COUNTER_INSTRUCTIONS,
+    FOSSIL_MARK_COUNTER_CACHE_MISSES,
+    FOSSIL_MARK_COUNTER_BRANCH_MISSES,
+    FOSSIL_MARK_COUNTER_TASK_CLOCK,  // Nanoseconds on the CPU
+    FOSSIL_MARK_COUNTER_COUNT
+} fossil_mark_counter_t;
+
+/**
+ * @brief Counter group state of one benchmark (Linux perf_event_open).
+ */
+typedef struct {
+    int enabled;                              // Counters were requested
+    int available;                            // Number of counters that opened
+    int error;                                // errno of the first counter that failed
+    int leader;                               // Group leader fd, -1 if none
+    int fds[FOSSIL_MARK_COUNTER_COUNT];       // Per-counter fd, -1 if unavailable
+    int slot[FOSSIL_MARK_COUNTER_COUNT];      // Position in the group read, -1 if unavailable
+    uint64_t begin[FOSSIL_MARK_COUNTER_COUNT];
+    uint64_t totals[FOSSIL_MARK_COUNTER_COUNT];
+    uint64_t iterations;                      // Iterations covered by totals
+} fossil_mark_counters_t;
+
 typedef struct {
     const char* name;
     uint64_t start_time;
@@ -55,6 +129,8 @@ typedef struct {
     double std_dev;
     int running;
     uint32_t num_samples;
+    fossil_mark_stats_t stats; // Filled by fossil_benchmark_run
+    fossil_mark_counters_t counters; // Opt-in via fossil_benchmark_enable_counters
 } fossil_mark_t;
 
 /**
@@ -116,6 +192,117 @@ FOSSIL_MAIP_API void fossil_benchmark_reset(fossil_mark_t* benchmark);
  */
 FOSSIL_MAIP_API void fossil_benchmark_report(const fossil_mark_t* benchmark);
 
+/**
+ * @brief Releases the sample storage owned by a benchmark.
+ * @param benchmark The fossil_mark_t object to destroy.
+ */
+FOSSIL_MAIP_API void fossil_benchmark_destroy(fossil_mark_t* benchmark);
+
+/**
+ * @brief Sets how many leading start/stop pairs are discarded as warmup.
+ * @param benchmark The fossil_mark_t object to configure.
+ * @param warmup The number of iterations to discard.
+ */
+FOSSIL_MAIP_API void fossil_benchmark_set_warmup(fossil_mark_t* benchmark, size_t warmup);
+
+/**
+ * @brief Opens a perf_event_open counter group for a benchmark.
+ *
+ * Cycles, instructions, cache misses, branch misses and task clock are read
+ * around every start/stop pair and around the fossil_benchmark_run sampling
+ * loop. Counters that cannot be opened (non-Linux hosts, containers, a
+ * restrictive perf_event_paranoid) are skipped, and the benchmark keeps
+ * working on wall-clock time alone.
+ *
+ * @param benchmark The fossil_mark_t object to instrument.
+ * @return The number of counters that opened, 0 if none are available.
+ */
+FOSSIL_MAIP_API int fossil_benchmark_enable_counters(fossil_mark_t* benchmark);
+
+/**
+ * @brief Gets the average value of a counter per measured iteration.
+ * @param benchmark The fossil_mark_t object to query.
+ * @param counter The counter to read.
+ * @return The per-iteration average, or -1.0 if the counter is unavailable.
+ */
+FOSSIL_MAIP_API double fossil_benchmark_counter(const fossil_mark_t* benchmark, fossil_mark_counter_t counter);
+
+/**
+ * @brief Fills a configuration with the default driver settings.
+ *
+ * Defaults: 100 ms warmup, 1 s of measurement, samples of at least 10 us
+ * (and 1000x the clock resolution), 30 to 1000 samples, a 95% confidence
+ * interval and MAD outlier rejection.
+ *
+ * @param config The configuration to fill.
+ */
+FOSSIL_MAIP_API void fossil_benchmark_config_default(fossil_mark_config_t* config);
+
+/**
+ * @brief Runs a function under the statistical benchmark driver.
+ *
+ * The function is warmed up, then called in batches sized so each sample is
+ * well above the clock overhead. The number of samples is scaled to the
+ * target time. Outliers are rejected, and the remaining per-call times give
+ * the mean with its confidence interval and the p50/p90/p99/p999 percentiles.
+ * The results are stored in benchmark->stats, and the classic fields
+ * (mean, median, min, max, std_dev) are updated to match.
+ *
+ * @param benchmark The fossil_mark_t object to fill.
+ * @param func The function to measure.
+ * @param context Passed to every call of func.
+ * @param config The driver settings, or null for the defaults.
+ * @return 0 on success, or a negative error code on failure.
+ */
+FOSSIL_MAIP_API int fossil_benchmark_run(fossil_mark_t* benchmark, void (*func)(void*), void* context, const fossil_mark_config_t* config);
+
+/**
+ * @brief Opens the benchmark baseline store for this run.
+ *
+ * Once open, every benchmark finished by fossil_benchmark_run or printed
+ * by fossil_benchmark_report records its sample distribution. If a compare
+ * file is given, each recorded benchmark is checked against its baseline
+ * with a one-sided Mann-Whitney U test. It counts as a regression when the
+ * slowdown is significant (p < 0.05) and the median grew by more than the
+ * threshold.
+ *
+ * @param save_path File written by fossil_benchmark_baseline_close, or null.
+ * @param compare_path Baseline file to compare against, or null.
+ * @param threshold Allowed median slowdown in percent.
+ * @return 0 on success, or a negative error code if the compare file is
+ *         unreadable, in which case the store stays closed.
+ */
+FOSSIL_MAIP_API int fossil_benchmark_baseline_open(const char* save_path, const char* compare_path, double threshold);
+
+/**
+ * @brief Records a benchmark's samples in the open baseline store.
+ *
+ * Does nothing if no store is open, or if the name is 256 bytes or longer.
+ * A later record with the same name replaces the earlier one.
+ *
+ * @param benchmark The fossil_mark_t object to record.
+ */
+FOSSIL_MAIP_API void fossil_benchmark_baseline_record(const fossil_mark_t* benchmark);
+
+/**
+ * @brief Writes the save file, if any, and closes the baseline store.
+ * @return The number of benchmarks that regressed against the compare file.
+ */
+FOSSIL_MAIP_API size_t fossil_benchmark_baseline_close(void);
+
+/**
+ * @brief One-sided Mann-Whitney U test that current is slower than baseline.
+ *
+ * Uses the normal approximation with tie correction.
+ *
+ * @param baseline Samples from the baseline run.
+ * @param baseline_count The number of baseline samples.
+ * @param current Samples from the current run.
+ * @param current_count The number of current samples.
+ * @return The p-value; small values mean current is stochastically larger.
+ */
+FOSSIL_MAIP_API double fossil_benchmark_mann_whitney(const double* baseline, size_t baseline_count, const double* current, size_t current_count);
+
 typedef struct {
     fossil_mark_t* benchmark;
 } fossil_scoped_mark_t;
@@ -216,6 +403,30 @@ FOSSIL_MAIP_API uint64_t fossil_test_stop_benchmark(void);
     fossil_scoped_mark_t scoped_benchmark_##name; \
     fossil_scoped_benchmark_init(&scoped_benchmark_##name, &benchmark_##name)
 
+/**
+ * @brief Define macro for enabling hardware counters on a benchmark.
+ * 
+ * This macro is used to open the perf counter group of a given benchmark.
+ * It falls back to wall-clock timing when counters are unavailable.
+ * 
+ * @param name The name of the benchmark.
+ */
+#define _MARK_COUNTERS(name) \
+    fossil_benchmark_enable_counters(&benchmark_##name)
+
+/**
+ * @brief Define macro for running a benchmark under the statistical driver.
+ * 
+ * This macro is used to measure a function with a given benchmark. The
+ * function is warmed up, batched and sampled with the default settings.
+ * 
+ * @param name The name of the benchmark.
+ * @param func The function to measure, taking a void pointer.
+ * @param context The argument passed to the function.
+ */
+#define _MARK_RUN(name, func, context) \
+    fossil_benchmark_run(&benchmark_##name, func, context, null)
+
 // =================================================================
 // Bench specific commands
 // =================================================================
@@ -429,6 +640,30 @@ FOSSIL_MAIP_API uint64_t fossil_test_stop_benchmark(void);
 #define MARK_SCOPED(name) \
     _MARK_SCOPED(name)
 
+/**
+ * @brief Define macro for enabling hardware counters on a benchmark.
+ * 
+ * This macro is used to open the perf counter group of a given benchmark.
+ * It falls back to wall-clock timing when counters are unavailable.
+ * 
+ * @param name The name of the benchmark.
+ */
+#define MARK_COUNTERS(name) \
+    _MARK_COUNTERS(name)
+
+/**
+ * @brief Define macro for running a benchmark under the statistical driver.
+ * 
+ * This macro is used to measure a function with a given benchmark. The
+ * function is warmed up, batched and sampled with the default settings.
+ * 
+ * @param name The name of the benchmark.
+ * @param func The function to measure, taking a void pointer.
+ * @param context The argument passed to the function.
+ */
+#define MARK_RUN(name, func, context) \
+    _MARK_RUN(name, func, context)
+
 // =================================================================
 // Bench specific commands
 // =================================================================
@@ -49,6 +49,13 @@ typedef enum
     FOSSIL_MAIP_CASE_UNEXPECTED
 } fossil_maip_state_t;
 
+// --- Tag Sets ---
+enum
+{
+    FOSSIL_MAIP_TAG_WORDS = 4,                              // 256-bit tag set per case
+    FOSSIL_MAIP_TAG_OVERFLOW = FOSSIL_MAIP_TAG_WORDS * 64 - 1 // Set for tags past the table
+};
+
 // --- Score Struct ---
 typedef struct
 {
@@ -60,6 +67,55 @@ typedef struct
     int empty;
 } fossil_maip_score_t;
 
+// --- Repeat Statistics ---
+// Per-iteration samples of a case run with --repeat
+typedef struct
+{
+    uint64_t *values; // Elapsed time of each iteration, in run order
+    size_t count;
+    size_t capacity;
+
+    uint64_t min_ns;
+    uint64_t max_ns;
+    double mean_ns; // Running mean (Welford)
+    double m2;      // Running sum of squared deviations from the mean
+    int outcomes[FOSSIL_MAIP_CASE_UNEXPECTED + 1]; // Iterations per fossil_maip_state_t
+} fossil_maip_samples_t;
+
+// --- Allocation Statistics ---
+// Heap use of a case, filled when the runner is built with allocation tracking
+#define FOSSIL_MAIP_ALLOC_SITES 8
+
+// Call site that leaked, with the blocks it left behind
+typedef struct
+{
+    void *site;   // Return address of the allocating call
+    size_t count; // Leaked blocks
+    size_t bytes; // Leaked bytes
+} fossil_maip_alloc_site_t;
+
+typedef struct
+{
+    size_t allocations;  // malloc/calloc/realloc/aligned calls, across --repeat iterations
+    size_t frees;
+    size_t bytes;        // Total bytes requested
+    size_t live_bytes;   // Bytes currently held
+    size_t peak_bytes;   // Highest live_bytes seen
+    size_t live_blocks;
+    size_t leaks;        // Blocks still live after teardown
+    size_t leaked_bytes;
+    size_t site_count;
+    fossil_maip_alloc_site_t sites[FOSSIL_MAIP_ALLOC_SITES]; // Largest leak sites first
+} fossil_maip_alloc_stats_t;
+
+// --- Random Numbers ---
+// xoshiro256** generator; state is never all zero once seeded
+typedef struct
+{
+    uint64_t state[4];
+    uint64_t seed; // Seed the state was expanded from, for replay
+} fossil_maip_rng_t;
+
 // --- Test Case ---
 typedef struct
 {
@@ -74,6 +130,10 @@ typedef struct
     uint64_t elapsed_ns;               // Timing in nanoseconds
     int64_t priority;                  // Priority level (lower = higher priority)
     fossil_maip_state_t state; // Outcome of the test case
+    uint64_t timeout_ns;               // Per-case deadline (0 = use --timeout)
+    uint64_t tag_set[FOSSIL_MAIP_TAG_WORDS]; // Interned tags, filled by fossil_maip_add_case
+    fossil_maip_samples_t *samples;    // Iteration stats from --repeat (NULL for one iteration)
+    fossil_maip_alloc_stats_t *alloc;  // Heap use (NULL unless allocation tracking is built in)
 } fossil_maip_case_t;
 
 // --- Test Suite ---
@@ -107,8 +167,47 @@ typedef struct
     fossil_maip_score_t score;
 
     fossil_maip_pallet_t pallet; // CLI + config
+
+    struct fossil_maip_selection *selection; // Compiled filters (NULL selects every case)
+    struct fossil_maip_history *history;     // Run history from --history (NULL when off)
+    fossil_maip_rng_t *rng;                  // Shuffle generator (NULL when shuffle is off)
+    bool merge_failed;                       // A --merge shard report was missing or unreadable
+    bool quiet;                              // No per-case console output, e.g. an engine run from a case
 } fossil_maip_engine_t;
 
+// --- Test Group Registry ---
+// Every FOSSIL_TEST_GROUP defines one of these and links it in from a
+// constructor, so the engine finds groups without a generated runner.
+typedef struct fossil_maip_group
+{
+    const char *name;                           // Group name
+    void (*load)(fossil_maip_engine_t *engine); // Adds the group's suites
+    struct fossil_maip_group *next;             // Next group in link order
+    const fossil_maip_engine_t *engine;         // Engine it was last loaded into
+} fossil_maip_group_t;
+
+// --- Fixtures ---
+// Set up the first time a running case asks for them and torn down once at
+// the end of their scope, so deselected cases never pay for them.
+typedef enum
+{
+    FOSSIL_MAIP_SCOPE_CASE = 0, // Torn down after each run of the case
+    FOSSIL_MAIP_SCOPE_SUITE,    // Shared by the suite's cases, torn down after it
+    FOSSIL_MAIP_SCOPE_PROCESS   // Shared by every case, torn down by fossil_maip_end
+} fossil_maip_scope_t;
+
+typedef struct fossil_maip_fixture
+{
+    const char *name;                 // Fixture name
+    fossil_maip_scope_t scope;        // Lifetime of the value
+    void *(*setup)(void);             // Builds the value
+    void (*teardown)(void *value);    // Releases the value
+    void *value;                      // Shared value while ready
+    bool ready;                       // Set up and not yet torn down
+    struct fossil_maip_fixture *next; // Next active shared fixture
+    const void *owner;                // Suite that set up a suite fixture
+} fossil_maip_fixture_t;
+
 // --- Initialization ---
 
 /** * Initializes a new fossil_maip_engine_t instance.
@@ -135,8 +234,336 @@ FOSSIL_MAIP_API int fossil_maip_add_suite(fossil_maip_engine_t *engine, fossil_m
  */
 FOSSIL_MAIP_API int fossil_maip_add_case(fossil_maip_suite_t *suite, fossil_maip_case_t test_case);
 
+// --- Test Group Registry ---
+
+/** Links a test group into the registry; called from FOSSIL_TEST_GROUP constructors.
+ * @param group Pointer to the group's static record.
+ */
+FOSSIL_MAIP_API void fossil_maip_register_group(fossil_maip_group_t *group);
+
+/** Returns the first registered group, in link order.
+ * @return Head of the registry list, or NULL when empty.
+ */
+FOSSIL_MAIP_API const fossil_maip_group_t *fossil_maip_groups(void);
+
+/** Loads every registered group not yet loaded into the engine.
+ * @param engine Pointer to the engine instance.
+ * @return Number of groups loaded.
+ */
+FOSSIL_MAIP_API size_t fossil_maip_load_groups(fossil_maip_engine_t *engine);
+
+/** Loads one group unless it is already loaded into the engine.
+ * @param engine Pointer to the engine instance.
+ * @param load The group's load function.
+ */
+FOSSIL_MAIP_API void fossil_maip_import_group(fossil_maip_engine_t *engine, void (*load)(fossil_maip_engine_t *engine));
+
+/** Opens a shared object and loads the groups it registers.
+ * @param engine Pointer to the engine instance.
+ * @param path Path of the shared object.
+ * @return 0 on success (including a bundle dropped by the filters), -1 on failure.
+ */
+FOSSIL_MAIP_API int fossil_maip_load_bundle(fossil_maip_engine_t *engine, const char *path);
+
+// --- Fixtures ---
+
+/** Returns a fixture's value, setting it up on first use within its scope.
+ * @param fixture Pointer to the fixture.
+ * @return The value built by the fixture's setup.
+ */
+FOSSIL_MAIP_API void *fossil_maip_fixture_use(fossil_maip_fixture_t *fixture);
+
+// --- Selection ---
+
+/** Compiles the filter, --only and --skip options into the engine's selection.
+ * Expressions combine `tag:`, `name:` and `suite:` globs with `!`, `&`, `|`
+ * and parentheses, e.g. `tag:fast & !tag:net | name:io_*`.
+ * @param engine Pointer to the engine instance.
+ * @return 0 on success, -1 when an expression does not parse.
+ */
+FOSSIL_MAIP_API int fossil_maip_selection_compile(fossil_maip_engine_t *engine);
+
+/** Releases the engine's compiled selection.
+ * @param engine Pointer to the engine instance.
+ */
+FOSSIL_MAIP_API void fossil_maip_selection_free(fossil_maip_engine_t *engine);
+
+/** Collects pointers to the suite's cases that pass the filters.
+ * @param suite Pointer to the suite instance.
+ * @param engine Pointer to the engine instance.
+ * @param filtered_cases Output array with room for suite->count pointers.
+ * @return Number of selected cases.
+ */
+FOSSIL_MAIP_API size_t fossil_maip_filter_cases(fossil_maip_suite_t *suite, const fossil_maip_engine_t *engine, fossil_maip_case_t **filtered_cases);
+
+/** Orders a selection by the sort options; stable, the case records never move.
+ * @param cases Selection to reorder.
+ * @param count Number of cases in the selection.
+ * @param engine Pointer to the engine instance.
+ */
+FOSSIL_MAIP_API void fossil_maip_sort_cases(fossil_maip_case_t **cases, size_t count, const fossil_maip_engine_t *engine);
+
+/** Shuffles a selection when the shuffle command is given. Uniform mode
+ * draws a Fisher-Yates permutation from the engine's generator; weighted
+ * mode draws an order biased toward high-priority cases. Weighting by
+ * history failure rate needs the suite and applies inside fossil_maip_run_suite.
+ * @param cases Selection to reorder.
+ * @param count Number of cases in the selection.
+ * @param engine Pointer to the engine instance.
+ */
+FOSSIL_MAIP_API void fossil_maip_shuffle_cases(fossil_maip_case_t **cases, size_t count, const fossil_maip_engine_t *engine);
+
+// --- Run History ---
+
+typedef struct fossil_maip_history fossil_maip_history_t;
+
+/** Maps a run history file, creating it when missing. Each open counts as one run.
+ * @param path File holding per-case duration estimates and outcomes.
+ * @return The history, or NULL when the file cannot be mapped.
+ */
+FOSSIL_MAIP_API fossil_maip_history_t *fossil_maip_history_open(const char *path);
+
+/** Flushes and unmaps a run history.
+ * @param history History to close; NULL is ignored.
+ */
+FOSSIL_MAIP_API void fossil_maip_history_close(fossil_maip_history_t *history);
+
+/** Folds the outcome and duration of every finished case into the history.
+ * @param history Pointer to the history.
+ * @param suite Suite the cases belong to.
+ * @param cases Cases that were run.
+ * @param count Number of cases.
+ */
+FOSSIL_MAIP_API void fossil_maip_history_record(fossil_maip_history_t *history, const fossil_maip_suite_t *suite,
+                                                fossil_maip_case_t **cases, size_t count);
+
+/** Orders a selection from history: recently failed cases first, then new
+ * ones, then the rest. Within each group the longest expected case comes
+ * first when `parallel` is set (LPT), otherwise the shortest.
+ * @param history Pointer to the history.
+ * @param suite Suite the cases belong to.
+ * @param cases Selection to reorder.
+ * @param count Number of cases in the selection.
+ * @param parallel Whether the cases go to a worker pool.
+ */
+FOSSIL_MAIP_API void fossil_maip_history_schedule(const fossil_maip_history_t *history, const fossil_maip_suite_t *suite,
+                                                  fossil_maip_case_t **cases, size_t count, bool parallel);
+
+/** Looks up the rolling duration estimate of a case.
+ * @param history Pointer to the history.
+ * @param suite_name Name of the case's suite.
+ * @param case_name Name of the case.
+ * @return Expected duration in nanoseconds, 0 when the case has no history.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_history_expected_ns(const fossil_maip_history_t *history,
+                                                         const char *suite_name, const char *case_name);
+
+/** Looks up the smoothed failure rate of a case, (failures + 1) / (runs + 2).
+ * @param history Pointer to the history.
+ * @param suite_name Name of the case's suite.
+ * @param case_name Name of the case.
+ * @return Failure rate in (0, 1); 0.5 when the case has no history.
+ */
+FOSSIL_MAIP_API double fossil_maip_history_failure_rate(const fossil_maip_history_t *history,
+                                                        const char *suite_name, const char *case_name);
+
+// --- Random Numbers ---
+
+/** Seeds a generator; the seed is expanded with splitmix64.
+ * @param rng The generator.
+ * @param seed Any value, including 0.
+ */
+FOSSIL_MAIP_API void fossil_maip_rng_seed(fossil_maip_rng_t *rng, uint64_t seed);
+
+/** Returns the next 64 random bits.
+ * @param rng The generator.
+ * @return A uniformly distributed 64-bit value.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_rng_next(fossil_maip_rng_t *rng);
+
+/** Returns an unbiased value in [0, bound).
+ * @param rng The generator.
+ * @param bound Exclusive upper bound, 0 returns 0.
+ * @return A uniformly distributed value below bound.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_rng_below(fossil_maip_rng_t *rng, uint64_t bound);
+
+/** Returns a double in [0, 1) with 53 random bits.
+ * @param rng The generator.
+ * @return A uniformly distributed value.
+ */
+FOSSIL_MAIP_API double fossil_maip_rng_unit(fossil_maip_rng_t *rng);
+
+// --- Failure Index ---
+
+/** One cluster of failed assertions sharing a fingerprint. */
+typedef struct
+{
+    uint64_t fingerprint; // Site and message with digit runs folded
+    const char *file;
+    const char *func;
+    int line;
+    size_t count;        // Failures in the cluster
+    const char *message; // First message seen, owned by the index
+} fossil_maip_failure_cluster_t;
+
+/** Fingerprints a failure by its site and message. Runs of digits in the
+ * message are folded, so values that change between runs do not split a cluster.
+ * @param file Source file of the assertion.
+ * @param line Source line of the assertion.
+ * @param func Function of the assertion.
+ * @param message Failure message, may be NULL.
+ * @return A non-zero 64-bit fingerprint.
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_failure_fingerprint(const char *file, int line, const char *func, const char *message);
+
+/** Counts a failure in the calling thread's table; assertions call this.
+ * @param file Source file of the assertion.
+ * @param line Source line of the assertion.
+ * @param func Function of the assertion.
+ * @param message Failure message, may be NULL.
+ * @return How often this thread has seen the fingerprint since its last flush.
+ */
+FOSSIL_MAIP_API size_t fossil_maip_failure_record(const char *file, int line, const char *func, const char *message);
+
+/** Merges the calling thread's table into the shared index. Worker threads
+ * flush when they finish; the summary flushes the main thread.
+ */
+FOSSIL_MAIP_API void fossil_maip_failure_flush(void);
+
+/** Reads the totals of the shared index.
+ * @param failures Receives the number of failures, may be NULL.
+ * @param clusters Receives the number of distinct fingerprints, may be NULL.
+ * @param sites Receives the number of distinct assertion sites, may be NULL.
+ */
+FOSSIL_MAIP_API void fossil_maip_failure_totals(size_t *failures, size_t *clusters, size_t *sites);
+
+/** Copies the largest clusters of the shared index, largest first.
+ * @param out Array receiving the clusters.
+ * @param max Capacity of out.
+ * @return Number of clusters written.
+ */
+FOSSIL_MAIP_API size_t fossil_maip_failure_top(fossil_maip_failure_cluster_t *out, size_t max);
+
+/** Empties the shared index and the calling thread's table. */
+FOSSIL_MAIP_API void fossil_maip_failure_reset(void);
+
+// --- Root Cause Vocabulary ---
+
+/** Classifies a failure message in one pass over its bytes.
+ * @param message The message, may be NULL.
+ * @return Bit n is set when a keyword of cause code n occurs in the message.
+ */
+FOSSIL_MAIP_API uint32_t fossil_maip_root_cause_scan(const char *message);
+
+/** Classifies a failure message with the historical return convention.
+ * @param message The message, may be NULL.
+ * @return 0 when nothing matched, the cause code when one cause matched,
+ *         otherwise the bitmask from fossil_maip_root_cause_scan().
+ */
+FOSSIL_MAIP_API int fossil_maip_root_cause_detect(const char *message);
+
+/** Defines a project-specific cause, or finds an existing one by label.
+ * Codes 1..9 are built in ("Logic error", "Timeout", "Memory error", ...).
+ * @param label Label printed in failure reports; copied.
+ * @return The cause code (10..31 for defined causes), or -1 when all codes are taken.
+ */
+FOSSIL_MAIP_API int fossil_maip_root_cause_define(const char *label);
+
+/** Adds a case-sensitive keyword to a cause. Built-in causes accept keywords too.
+ * @param code A built-in code or one returned by fossil_maip_root_cause_define().
+ * @param pattern The keyword; copied.
+ * @return FOSSIL_MAIP_SUCCESS, or FOSSIL_MAIP_FAILURE for an unknown code.
+ */
+FOSSIL_MAIP_API int fossil_maip_root_cause_add(int code, const char *pattern);
+
+/** Writes the labels of the causes in a mask, separated by commas.
+ * @param mask A mask from fossil_maip_root_cause_scan().
+ * @param buffer Receives the text.
+ * @param size Capacity of buffer.
+ * @return Length of the text, 0 when no labelled cause is set.
+ */
+FOSSIL_MAIP_API size_t fossil_maip_root_cause_describe(uint32_t mask, char *buffer, size_t size);
+
+/** Drops every defined cause and added keyword, keeping the built-in vocabulary. */
+FOSSIL_MAIP_API void fossil_maip_root_cause_reset(void);
+
+// --- Allocation Tracking ---
+
+/** Reports whether malloc interposition is built in (`-Dwith_memtrack=enabled`, glibc only).
+ * @return true when fossil_maip_alloc_begin() records anything.
+ */
+FOSSIL_MAIP_API bool fossil_maip_alloc_tracking(void);
+
+/** Attributes the calling thread's allocations to a stats block until
+ * fossil_maip_alloc_end(). The runner does this around every case.
+ * @param stats Receives the counts; must outlive the scope.
+ */
+FOSSIL_MAIP_API void fossil_maip_alloc_begin(fossil_maip_alloc_stats_t *stats);
+
+/** Closes the calling thread's scope: blocks it allocated that are still
+ * live become leaks in its stats and stop being tracked.
+ */
+FOSSIL_MAIP_API void fossil_maip_alloc_end(void);
+
+// --- Repeat Statistics ---
+
+/** Records one iteration of a repeated case.
+ * @param samples The sample buffer.
+ * @param elapsed_ns Elapsed time of the iteration.
+ * @param state Outcome of the iteration.
+ * @return FOSSIL_MAIP_SUCCESS, or FOSSIL_MAIP_FAILURE when the buffer cannot grow.
+ */
+FOSSIL_MAIP_API int fossil_maip_samples_add(fossil_maip_samples_t *samples, uint64_t elapsed_ns, fossil_maip_state_t state);
+
+/** Returns the sample standard deviation of the recorded times.
+ * @param samples The sample buffer.
+ * @return Standard deviation in nanoseconds (0 for fewer than two samples).
+ */
+FOSSIL_MAIP_API double fossil_maip_samples_stddev(const fossil_maip_samples_t *samples);
+
+/** Returns a nearest-rank percentile of the recorded times.
+ * @param samples The sample buffer.
+ * @param percent Percentile in 0..100.
+ * @return The percentile in nanoseconds (0 when empty).
+ */
+FOSSIL_MAIP_API uint64_t fossil_maip_samples_percentile(const fossil_maip_samples_t *samples, double percent);
+
+/** Frees a sample buffer allocated by the runner.
+ * @param samples The sample buffer, may be NULL.
+ */
+FOSSIL_MAIP_API void fossil_maip_samples_free(fossil_maip_samples_t *samples);
+
+// --- Sharding ---
+
+/** Assigns the selected cases to shards by expected duration, longest first
+ * onto the least loaded shard. Only needed for `--shard-by duration`;
+ * fossil_maip_run_all calls it before running.
+ * @param engine Pointer to the engine instance.
+ * @return 0 on success, -1 when out of memory.
+ */
+FOSSIL_MAIP_API int fossil_maip_shard_plan(fossil_maip_engine_t *engine);
+
+/** Scores JSON Lines shard reports onto the engine's suites instead of running
+ * them, and streams them to the active report sink.
+ * @param engine Pointer to the engine instance.
+ * @param paths Report files written by `report --format json` in each shard.
+ * @param count Number of report files.
+ * @return 0 on success, -1 when a file cannot be read.
+ */
+FOSSIL_MAIP_API int fossil_maip_merge_reports(fossil_maip_engine_t *engine, const char *const *paths, size_t count);
+
 // --- Execution ---
 
+/** Runs one case with the engine's run options (repeat, timeout, skips) and
+ * scores it into its suite; suite setup and fixtures are left alone.
+ * @param engine Pointer to the engine instance.
+ * @param test_case Pointer to the case to run.
+ * @param suite Pointer to the suite the case belongs to.
+ */
+FOSSIL_MAIP_API void fossil_maip_run_test(const fossil_maip_engine_t *engine, fossil_maip_case_t *test_case,
+                                          fossil_maip_suite_t *suite);
+
 /** Runs a single test suite.
  * @param suite Pointer to the suite instance.
  * @return 0 on success, -1 on failure.
@@ -175,11 +602,21 @@ FOSSIL_MAIP_API int32_t fossil_maip_end(fossil_maip_engine_t *engine);
  */
 FOSSIL_MAIP_API void maip_test_assert_internal(bool condition, const char *message, const char *file, int line, const char *func);
 
+/**
+ * @brief Internal function to record a passing assertion.
+ *
+ * This function is the fast path used by the assumption macros when the
+ * condition holds. It only counts the assertion and never touches the message.
+ */
+FOSSIL_MAIP_API void maip_test_assert_pass(void);
+
 /**
  * @brief Internal function to handle assertions with message formatting.
  *
  * This function is used internally by the test framework to handle assertions
- * and format messages. It is not intended to be called directly.
+ * and format messages. It is not intended to be called directly. The assumption
+ * macros only call it on the failure path, and the returned buffer is owned by
+ * the framework and reused by the next failing assertion.
  *
  * @param message The message to format.
  * @return A formatted message string.
@@ -279,7 +716,11 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
         test_name##_run,                                 \
         0,                                               \
         0,                                               \
-        FOSSIL_MAIP_CASE_EMPTY};                        \
+        FOSSIL_MAIP_CASE_EMPTY,                          \
+        0,                                               \
+        {0},                                             \
+        nullptr,                                         \
+        nullptr};                                        \
     extern "C" void test_name##_run(void)
 #else
 #define _FOSSIL_TEST(test_name)                          \
@@ -293,7 +734,11 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
         .run = test_name##_run,                          \
         .elapsed_ns = 0,                                 \
         .priority = 0,                                   \
-        .state = FOSSIL_MAIP_CASE_EMPTY};              \
+        .state = FOSSIL_MAIP_CASE_EMPTY,                 \
+        .timeout_ns = 0,                                 \
+        .tag_set = {0},                                  \
+        .samples = NULL,                                 \
+        .alloc = NULL};                                  \
     void test_name##_run(void)
 #endif
 
@@ -342,6 +787,17 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 #define _FOSSIL_TEST_SET_CRITERIA(test_name, criteria) \
     test_case_##test_name.criteria = criteria
 
+/** @brief Macro to set a test case's timeout.
+ *
+ * This macro is used to give a test case its own deadline. A case that is
+ * still running when the deadline passes is aborted and recorded as a timeout.
+ *
+ * @param test_name The name of the test case.
+ * @param ms The timeout in milliseconds (0 uses the global --timeout).
+ */
+#define _FOSSIL_TEST_SET_TIMEOUT(test_name, ms) \
+    test_case_##test_name.timeout_ns = (uint64_t)(ms) * 1000000ULL
+
 /** @brief Macro to set a test case's setup function.
  *
  * This macro is used to specify a setup function for a test case. The setup
@@ -451,6 +907,54 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 #define _FOSSIL_AFTER(test_teardown) \
     inline void teardown_after_##test_teardown(void)
 
+/** @brief Macro to define a lazy fixture.
+ *
+ * The body that follows is the fixture's setup and returns the shared value.
+ * It runs the first time a case uses the fixture within its scope, never for
+ * cases that are filtered out. A matching _FOSSIL_FIXTURE_TEARDOWN is required.
+ *
+ * @param fixture The name of the fixture to define.
+ * @param lifetime FOSSIL_MAIP_SCOPE_CASE, FOSSIL_MAIP_SCOPE_SUITE or FOSSIL_MAIP_SCOPE_PROCESS.
+ */
+#ifdef __cplusplus
+#define _FOSSIL_FIXTURE(fixture, lifetime)                               \
+    static void *fixture_setup_##fixture(void);                          \
+    static void fixture_teardown_##fixture(void *value);                 \
+    static fossil_maip_fixture_t fixture_##fixture = {                   \
+        #fixture, lifetime, fixture_setup_##fixture,                        \
+        fixture_teardown_##fixture, nullptr, false, nullptr, nullptr};   \
+    static void *fixture_setup_##fixture(void)
+#else
+#define _FOSSIL_FIXTURE(fixture, lifetime)                               \
+    static void *fixture_setup_##fixture(void);                          \
+    static void fixture_teardown_##fixture(void *value);                 \
+    static fossil_maip_fixture_t fixture_##fixture = {                   \
+        .name = #fixture,                                                \
+        .scope = lifetime,                                               \
+        .setup = fixture_setup_##fixture,                                \
+        .teardown = fixture_teardown_##fixture,                          \
+        .value = NULL,                                                   \
+        .ready = false,                                                  \
+        .next = NULL,                                                    \
+        .owner = NULL};                                                  \
+    static void *fixture_setup_##fixture(void)
+#endif
+
+/** @brief Macro to define a fixture's teardown.
+ *
+ * @param fixture The name of the fixture.
+ * @param value The name given to the value returned by the setup.
+ */
+#define _FOSSIL_FIXTURE_TEARDOWN(fixture, value) \
+    static void fixture_teardown_##fixture(void *value)
+
+/** @brief Macro to get a fixture's value, setting it up on first use.
+ *
+ * @param fixture The name of the fixture.
+ */
+#define _FOSSIL_FIXTURE_USE(fixture) \
+    fossil_maip_fixture_use(&fixture_##fixture)
+
 /** @brief Macro to add a test case to a specific suite.
  *
  * This macro is used to add a test case to a specific test suite that has been
@@ -534,21 +1038,63 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 #define _FOSSIL_ADD_SUITE(suite) \
     fossil_maip_add_suite(engine, suite_##suite)
 
+/**
+ * @brief Macro to run a function before main.
+ *
+ * Used by test groups to register themselves. Static constructors in C++,
+ * the constructor attribute on GCC and Clang, and a .CRT$XCU entry on MSVC.
+ *
+ * @param fn The name of the static function to define.
+ */
+#if defined(__cplusplus)
+#define _FOSSIL_MAIP_CONSTRUCTOR(fn)                          \
+    static void fn(void);                                    \
+    static const int fn##_registered = (fn(), 0);            \
+    static void fn(void)
+#elif defined(_MSC_VER)
+#pragma section(".CRT$XCU", read)
+#define _FOSSIL_MAIP_CONSTRUCTOR(fn)                          \
+    static void __cdecl fn(void);                            \
+    __declspec(allocate(".CRT$XCU")) void(__cdecl * fn##_ptr)(void) = fn; \
+    static void __cdecl fn(void)
+#else
+#define _FOSSIL_MAIP_CONSTRUCTOR(fn)                          \
+    static void fn(void) __attribute__((constructor));       \
+    static void fn(void)
+#endif
+
 /**
  * @brief Macro to define a test group.
  *
  * This macro is used to define a test group, which is a collection of test cases
- * that are related to each other. The test group can be executed as a whole to
- * verify the correctness of a group of functionalities.
+ * that are related to each other. The group registers itself before main runs,
+ * and fossil_maip_start loads every registered group into the engine.
  *
  * @param name The name of the test group.
  */
 #ifdef __cplusplus
-#define _FOSSIL_TEST_GROUP(name) \
+#define _FOSSIL_TEST_GROUP(name)                                           \
+    extern "C" void name##_test_group(fossil_maip_engine_t *engine);       \
+    static fossil_maip_group_t fossil_maip_group_##name = {               \
+        #name, name##_test_group, nullptr, nullptr};                       \
+    _FOSSIL_MAIP_CONSTRUCTOR(fossil_maip_group_register_##name)            \
+    {                                                                      \
+        fossil_maip_register_group(&fossil_maip_group_##name);             \
+    }                                                                      \
     extern "C" void name##_test_group(fossil_maip_engine_t *engine)
 #else
-#define _FOSSIL_TEST_GROUP(name) \
-    void name##_test_group(fossil_maip_engine_t *engine)
+#define _FOSSIL_TEST_GROUP(group)                                          \
+    void group##_test_group(fossil_maip_engine_t *engine);                 \
+    static fossil_maip_group_t fossil_maip_group_##group = {              \
+        .name = #group,                                                    \
+        .load = group##_test_group,                                        \
+        .next = NULL,                                                      \
+        .engine = NULL};                                                   \
+    _FOSSIL_MAIP_CONSTRUCTOR(fossil_maip_group_register_##group)           \
+    {                                                                      \
+        fossil_maip_register_group(&fossil_maip_group_##group);            \
+    }                                                                      \
+    void group##_test_group(fossil_maip_engine_t *engine)
 #endif
 
 /**
@@ -570,8 +1116,8 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 /**
  * @brief Macro to import a test group.
  *
- * This macro is used to import a test group into the test runner. The test group
- * will be executed when the test runner is run.
+ * Kept for hand-written runners. Groups are already loaded by
+ * fossil_maip_start, so importing one again does nothing.
  *
  * @param name The name of the test group to import.
  */
@@ -580,7 +1126,7 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
     extern "C" void name##_test_group(fossil_maip_engine_t *engine)
 #else
 #define _FOSSIL_TEST_IMPORT(name) \
-    name##_test_group(&engine)
+    fossil_maip_import_group(&engine, name##_test_group)
 #endif
 
 /**
@@ -588,9 +1134,13 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
  * This macro is used to assert that a specific condition is true within a test
  * runner. If the condition is false, the test runner will output the specified
  * message and may abort the execution of the test case or test suite.
+ *
+ * The message expression is only evaluated when the condition fails, so a
+ * passing assumption never formats, hashes or classifies its message.
  */
 #define _FOSSIL_TEST_ASSUME(condition, message) \
-    maip_test_assert_internal((condition), (message), __FILE__, __LINE__, __func__)
+    ((condition) ? maip_test_assert_pass() \
+                 : maip_test_assert_internal(false, (message), __FILE__, __LINE__, __func__))
 
 /**
  * @brief Macro to assume a condition in a test runner.
@@ -599,7 +1149,8 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
  * message and may abort the execution of the test case or test suite.
  */
 #define _FOSSIL_TEST_ASSERT(condition, message) \
-    maip_test_assert_internal((condition), (message), __FILE__, __LINE__, __func__)
+    ((condition) ? maip_test_assert_pass() \
+                 : maip_test_assert_internal(false, (message), __FILE__, __LINE__, __func__))
 
 /**
  * @brief Macro to assume a condition in a test runner.
@@ -738,6 +1289,17 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 #define FOSSIL_TEST_SET_CRITERIA(test_name, criteria) \
     _FOSSIL_TEST_SET_CRITERIA(test_name, criteria)
 
+/** @brief Macro to set a test case's timeout.
+ *
+ * This macro is used to give a test case its own deadline. A case that is
+ * still running when the deadline passes is aborted and recorded as a timeout.
+ *
+ * @param test_name The name of the test case.
+ * @param ms The timeout in milliseconds (0 uses the global --timeout).
+ */
+#define FOSSIL_TEST_SET_TIMEOUT(test_name, ms) \
+    _FOSSIL_TEST_SET_TIMEOUT(test_name, ms)
+
 /** @brief Macro to set a test case's setup function.
  *
  * This macro is used to specify a setup function for a test case. The setup
@@ -817,6 +1379,40 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 #define FOSSIL_AFTER(test_teardown) \
     _FOSSIL_AFTER(test_teardown)
 
+/** @brief Macro to define a lazy fixture.
+ *
+ * This macro is used to define a fixture whose value is built the first time
+ * a running case asks for it and shared across the cases in its scope. The
+ * body returns the value. Setup must not assert, since a failing assertion
+ * would unwind through it.
+ *
+ * @param fixture The name of the fixture to define.
+ * @param scope FOSSIL_MAIP_SCOPE_CASE, FOSSIL_MAIP_SCOPE_SUITE or FOSSIL_MAIP_SCOPE_PROCESS.
+ */
+#define FOSSIL_FIXTURE(fixture, scope) \
+    _FOSSIL_FIXTURE(fixture, scope)
+
+/** @brief Macro to define a fixture's teardown.
+ *
+ * This macro is used to define the function that releases a fixture's value.
+ * It runs once at the end of the fixture's scope, and only if it was set up.
+ *
+ * @param fixture The name of the fixture.
+ * @param value The name given to the value returned by the setup.
+ */
+#define FOSSIL_FIXTURE_TEARDOWN(fixture, value) \
+    _FOSSIL_FIXTURE_TEARDOWN(fixture, value)
+
+/** @brief Macro to get a fixture's value.
+ *
+ * This macro is used inside a test case to obtain a fixture's value, setting
+ * the fixture up if this is its first use within its scope.
+ *
+ * @param fixture The name of the fixture.
+ */
+#define FOSSIL_FIXTURE_USE(fixture) \
+    _FOSSIL_FIXTURE_USE(fixture)
+
 /** @brief Macro to add a test case to a specific suite.
  *
  * This macro is used to add a test case to a specific test suite that has been
@@ -922,8 +1518,9 @@ FOSSIL_MAIP_API void _on_skip(const char *description);
 /**
  * @brief Macro to import a test group.
  *
- * This macro is used to import a test group into the test runner. The test group
- * will be executed when the test runner is run.
+ * This macro is used to import a test group into a hand-written test runner.
+ * Registered groups are loaded by FOSSIL_TEST_START, so this is only needed
+ * for groups the runner wants to load explicitly.
  *
  * @param name The name of the test group to import.
  */
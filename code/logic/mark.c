@@ -22,51 +22,28 @@
  * Copyright (C) 2013-Current Fossil Logic. All rights reserved.
  * -----------------------------------------------------------------------------
  */
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE // syscall() for perf_event_open
+#endif
 #include "fossil/maip/mark.h"
 #include "fossil/maip/common.h"
+#include <errno.h>
 
-#if defined(_WIN32)
-static LARGE_INTEGER frequency;
-static LARGE_INTEGER start_time;
-#elif defined(__APPLE__)
-clock_t start_time;
-#else
-clock_t start_time;
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
 #endif
 
-#ifndef CLOCK_MONOTONIC
-#define CLOCK_MONOTONIC 1
-#endif
+// Start point for TEST_BENCHMARK()/TEST_CURRENT_TIME(); fossil_mark_t keeps its own
+static uint64_t start_time;
 
 void fossil_test_start_benchmark(void) {
-#if defined(_WIN32)
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&start_time);
-#elif defined(__APPLE__)
-    start_time = mach_absolute_time();
-#else
-    struct timeval tv;
-    gettimeofday(&tv, null);
-    start_time = (uint64_t)tv.tv_sec * 1e6 + tv.tv_usec;
-#endif
+    start_time = maip_sys_time_now_ns();
 }
 
 uint64_t fossil_test_stop_benchmark(void) {
-#if defined(_WIN32)
-    LARGE_INTEGER end_time;
-    QueryPerformanceCounter(&end_time);
-    return (uint64_t)((end_time.QuadPart - start_time.QuadPart) * 1e9 / frequency.QuadPart);
-#elif defined(__APPLE__)
-    uint64_t end_time = mach_absolute_time();
-    mach_timebase_info_data_t timebase;
-    mach_timebase_info(&timebase);
-    return (end_time - start_time) * timebase.numer / timebase.denom;
-#else
-    struct timeval tv;
-    gettimeofday(&tv, null);
-    uint64_t end_time = (uint64_t)tv.tv_sec * 1e6 + tv.tv_usec;
-    return (end_time - start_time) * 1e3;
-#endif
+    return maip_sys_time_now_ns() - start_time;
 }
 
 void assume_duration(double expected, double actual, double unit) {
@@ -110,6 +87,140 @@ void fossil_test_benchmark(char* duration_type, double expected, double actual)
     }
 } // end of func
 
+// Hardware counters: one perf_event_open group per benchmark, read as a snapshot
+
+#ifdef __linux__
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} fossil_mark_counter_events[FOSSIL_MARK_COUNTER_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK }
+};
+
+static int fossil_mark_counter_open(int counter, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = fossil_mark_counter_events[counter].type;
+    attr.config = fossil_mark_counter_events[counter].config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+static void fossil_mark_counters_clear(fossil_mark_counters_t* counters) {
+    memset(counters, 0, sizeof(*counters));
+    counters->leader = -1;
+    for (int i = 0; i < FOSSIL_MARK_COUNTER_COUNT; i++) {
+        counters->fds[i] = -1;
+        counters->slot[i] = -1;
+    }
+}
+
+static void fossil_mark_counters_close(fossil_mark_counters_t* counters) {
+#ifdef __linux__
+    for (int i = 0; i < FOSSIL_MARK_COUNTER_COUNT; i++) {
+        if (counters->fds[i] != -1) {
+            close(counters->fds[i]);
+        }
+    }
+#endif
+    fossil_mark_counters_clear(counters);
+}
+
+// Reads the group into values[counter], scaled for multiplexing; returns 0 on success
+static int fossil_mark_counters_read(const fossil_mark_counters_t* counters, uint64_t* values) {
+#ifdef __linux__
+    uint64_t buffer[3 + FOSSIL_MARK_COUNTER_COUNT];
+    if (counters->leader == -1 || read(counters->leader, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t))) {
+        return -1;
+    }
+    double scale = (buffer[2] > 0 && buffer[2] < buffer[1]) ? (double)buffer[1] / (double)buffer[2] : 1.0;
+    for (int i = 0; i < FOSSIL_MARK_COUNTER_COUNT; i++) {
+        int slot = counters->slot[i];
+        values[i] = (slot >= 0 && (uint64_t)slot < buffer[0]) ? (uint64_t)((double)buffer[3 + slot] * scale) : 0;
+    }
+    return 0;
+#else
+    (void)counters;
+    (void)values;
+    return -1;
+#endif
+}
+
+static void fossil_mark_counters_begin(fossil_mark_counters_t* counters) {
+    if (counters->available > 0) {
+        fossil_mark_counters_read(counters, counters->begin);
+    }
+}
+
+static void fossil_mark_counters_end(fossil_mark_counters_t* counters, uint64_t iterations) {
+    uint64_t now[FOSSIL_MARK_COUNTER_COUNT];
+    if (counters->available == 0 || fossil_mark_counters_read(counters, now) != 0) {
+        return;
+    }
+    for (int i = 0; i < FOSSIL_MARK_COUNTER_COUNT; i++) {
+        if (now[i] > counters->begin[i]) {
+            counters->totals[i] += now[i] - counters->begin[i];
+        }
+    }
+    counters->iterations += iterations;
+}
+
+int fossil_benchmark_enable_counters(fossil_mark_t* benchmark) {
+    if (benchmark == null) {
+        maip_io_printf("Error: benchmark is null\n");
+        return 0;
+    }
+
+    fossil_mark_counters_t* counters = &benchmark->counters;
+    fossil_mark_counters_close(counters);
+    counters->enabled = 1;
+
+#ifdef __linux__
+    // Cycles lead the group; task clock leads when hardware counters are missing
+    for (int i = 0; i < FOSSIL_MARK_COUNTER_COUNT; i++) {
+        int fd = fossil_mark_counter_open(i, counters->leader);
+        if (fd == -1) {
+            if (counters->error == 0) {
+                counters->error = errno;
+            }
+            continue;
+        }
+        if (counters->leader == -1) {
+            counters->leader = fd;
+        }
+        counters->fds[i] = fd;
+        counters->slot[i] = counters->available++;
+    }
+    if (counters->leader != -1) {
+        ioctl(counters->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(counters->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    counters->error = ENOSYS;
+#endif
+    return counters->available;
+}
+
+double fossil_benchmark_counter(const fossil_mark_t* benchmark, fossil_mark_counter_t counter) {
+    if (benchmark == null || (int)counter < 0 || (int)counter >= FOSSIL_MARK_COUNTER_COUNT) {
+        return -1.0;
+    }
+    const fossil_mark_counters_t* counters = &benchmark->counters;
+    if (counters->slot[counter] < 0 || counters->iterations == 0) {
+        return -1.0;
+    }
+    return (double)counters->totals[counter] / (double)counters->iterations;
+}
+
 void fossil_benchmark_init(fossil_mark_t* benchmark, const char* name) {
     if (benchmark == null) {
         maip_io_printf("Error: benchmark is null\n");
@@ -131,9 +242,13 @@ void fossil_benchmark_init(fossil_mark_t* benchmark, const char* name) {
     benchmark->mean_duration = 0.0;
     benchmark->median_duration = 0.0;
     benchmark->std_dev = 0.0;
+    benchmark->start_time = 0;
+    benchmark->end_time = 0;
     benchmark->capacity = 100;
     benchmark->iteration_times = (uint64_t*)malloc(benchmark->capacity * sizeof(uint64_t));
     benchmark->running = 0;
+    memset(&benchmark->stats, 0, sizeof(benchmark->stats));
+    fossil_mark_counters_clear(&benchmark->counters);
 }
 
 void fossil_benchmark_start(fossil_mark_t* benchmark) {
@@ -143,8 +258,9 @@ void fossil_benchmark_start(fossil_mark_t* benchmark) {
     }
 
     if (!benchmark->running) {
-        fossil_test_start_benchmark();
         benchmark->running = 1;
+        fossil_mark_counters_begin(&benchmark->counters);
+        benchmark->start_time = maip_sys_time_now_ns();
     }
 }
 
@@ -155,9 +271,11 @@ void fossil_benchmark_stop(fossil_mark_t* benchmark) {
     }
 
     if (benchmark->running) {
-        uint64_t elapsed = fossil_test_stop_benchmark();
-        
+        benchmark->end_time = maip_sys_time_now_ns();
+        uint64_t elapsed = benchmark->end_time - benchmark->start_time;
+
         if (benchmark->num_iterations >= benchmark->num_warmup) {
+            fossil_mark_counters_end(&benchmark->counters, 1);
             if (benchmark->num_iterations >= benchmark->capacity) {
                 benchmark->capacity *= 2;
                 benchmark->iteration_times = (uint64_t*)realloc(benchmark->iteration_times, 
@@ -202,6 +320,690 @@ void fossil_benchmark_calculate_stats(fossil_mark_t* benchmark) {
     benchmark->std_dev = sqrt(variance / benchmark->num_samples);
 }
 
+void fossil_benchmark_set_warmup(fossil_mark_t* benchmark, size_t warmup) {
+    if (benchmark == null) {
+        maip_io_printf("Error: benchmark is null\n");
+        return;
+    }
+    benchmark->num_warmup = warmup;
+}
+
+// Statistical driver: warmup, batched samples, outlier rejection, percentiles
+
+void fossil_benchmark_config_default(fossil_mark_config_t* config) {
+    if (config == null) {
+        return;
+    }
+    config->warmup_ns = 100000000ULL;   // 100 ms
+    config->target_ns = 1000000000ULL;  // 1 s
+    config->min_sample_ns = 10000ULL;   // 10 us
+    config->min_samples = 30;
+    config->max_samples = 1000;
+    config->confidence = 0.95;
+    config->outliers = FOSSIL_MARK_OUTLIER_MAD;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between closest ranks of a sorted array
+static double fossil_mark_percentile(const double* sorted, size_t count, double p) {
+    if (count == 0) {
+        return 0.0;
+    }
+    double rank = p * (double)(count - 1);
+    size_t lo = (size_t)rank;
+    size_t hi = (lo + 1 < count) ? lo + 1 : lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - (double)lo);
+}
+
+// Inverse of the standard normal CDF (Acklam's rational approximation)
+static double fossil_mark_normal_quantile(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    double q, r;
+
+    if (p <= 0.0 || p >= 1.0) {
+        return 0.0;
+    }
+    if (p < 0.02425) {
+        q = sqrt(-2.0 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - 0.02425) {
+        return -fossil_mark_normal_quantile(1.0 - p);
+    }
+    q = p - 0.5;
+    r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// Two-sided Student t critical value via the Cornish-Fisher expansion
+static double fossil_mark_t_critical(double confidence, size_t df) {
+    double z = fossil_mark_normal_quantile(0.5 + confidence / 2.0);
+    double n = (double)(df > 0 ? df : 1);
+    double z3 = z * z * z;
+    double z5 = z3 * z * z;
+    double z7 = z5 * z * z;
+    return z + (z3 + z) / (4.0 * n)
+             + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * n * n)
+             + (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z) / (384.0 * n * n * n);
+}
+
+// Compacts the samples kept by the outlier filter to the front; returns the new count
+static size_t fossil_mark_reject_outliers(double* samples, size_t count, fossil_mark_outlier_t method) {
+    double lo = -DBL_MAX;
+    double hi = DBL_MAX;
+
+    if (count < 4 || method == FOSSIL_MARK_OUTLIER_NONE) {
+        return count;
+    }
+
+    double* sorted = (double*)malloc(count * sizeof(double));
+    if (sorted == null) {
+        return count;
+    }
+    memcpy(sorted, samples, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_double);
+
+    if (method == FOSSIL_MARK_OUTLIER_TUKEY) {
+        double q1 = fossil_mark_percentile(sorted, count, 0.25);
+        double q3 = fossil_mark_percentile(sorted, count, 0.75);
+        lo = q1 - 1.5 * (q3 - q1);
+        hi = q3 + 1.5 * (q3 - q1);
+    } else {
+        double median = fossil_mark_percentile(sorted, count, 0.5);
+        for (size_t i = 0; i < count; i++) {
+            sorted[i] = fabs(samples[i] - median);
+        }
+        qsort(sorted, count, sizeof(double), compare_double);
+        double mad = fossil_mark_percentile(sorted, count, 0.5);
+        if (mad > 0.0) {
+            // Modified z-score 0.6745 * |x - median| / MAD above 3.5
+            lo = median - 3.5 * mad / 0.6745;
+            hi = median + 3.5 * mad / 0.6745;
+        }
+    }
+    free(sorted);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (samples[i] >= lo && samples[i] <= hi) {
+            samples[kept++] = samples[i];
+        }
+    }
+    return kept;
+}
+
+static void fossil_mark_baseline_store(const char* name, const double* sorted, size_t count);
+
+int fossil_benchmark_run(fossil_mark_t* benchmark, void (*func)(void*), void* context, const fossil_mark_config_t* config) {
+    fossil_mark_config_t cfg;
+    fossil_mark_stats_t* stats;
+
+    if (benchmark == null) {
+        maip_io_printf("Error: benchmark is null\n");
+        return -1;
+    }
+    if (func == null) {
+        maip_io_printf("Error: func is null\n");
+        return -1;
+    }
+
+    fossil_benchmark_config_default(&cfg);
+    if (config != null) {
+        if (config->warmup_ns > 0) cfg.warmup_ns = config->warmup_ns;
+        if (config->target_ns > 0) cfg.target_ns = config->target_ns;
+        if (config->min_sample_ns > 0) cfg.min_sample_ns = config->min_sample_ns;
+        if (config->min_samples > 0) cfg.min_samples = config->min_samples;
+        if (config->max_samples > 0) cfg.max_samples = config->max_samples;
+        if (config->confidence > 0.0 && config->confidence < 1.0) cfg.confidence = config->confidence;
+        cfg.outliers = config->outliers;
+    }
+    if (cfg.min_samples < 2) {
+        cfg.min_samples = 2;
+    }
+    if (cfg.max_samples < cfg.min_samples) {
+        cfg.max_samples = cfg.min_samples;
+    }
+
+    // A sample must dwarf the clock's resolution and read overhead
+    uint64_t overhead = maip_sys_time_overhead_ns();
+    uint64_t floor_ns = 1000 * (maip_sys_time_resolution_ns() + overhead);
+    if (cfg.min_sample_ns < floor_ns) {
+        cfg.min_sample_ns = floor_ns;
+    }
+
+    // Warmup doubles as the per-call cost estimate
+    uint64_t warmup = 0;
+    uint64_t start = maip_sys_time_now_ns();
+    uint64_t elapsed = 0;
+    do {
+        func(context);
+        warmup++;
+        elapsed = maip_sys_time_now_ns() - start;
+    } while (elapsed < cfg.warmup_ns);
+
+    double per_call = (double)elapsed / (double)warmup;
+    if (per_call < 1.0) {
+        per_call = 1.0;
+    }
+    uint64_t batch = (uint64_t)ceil((double)cfg.min_sample_ns / per_call);
+    if (batch == 0) {
+        batch = 1;
+    }
+    double sample_ns = per_call * (double)batch;
+    size_t count = (size_t)((double)cfg.target_ns / sample_ns);
+    if (count < cfg.min_samples) {
+        count = cfg.min_samples;
+    } else if (count > cfg.max_samples) {
+        count = cfg.max_samples;
+    }
+
+    double* samples = (double*)malloc(count * sizeof(double));
+    if (samples == null) {
+        maip_io_printf("Error: out of memory\n");
+        return -1;
+    }
+
+    double total = 0.0;
+    fossil_mark_counters_begin(&benchmark->counters);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t t0 = maip_sys_time_now_ns();
+        for (uint64_t j = 0; j < batch; j++) {
+            func(context);
+        }
+        uint64_t span = maip_sys_time_now_ns() - t0;
+        total += (double)span;
+        span = (span > overhead) ? span - overhead : 0;
+        samples[i] = (double)span / (double)batch;
+    }
+    fossil_mark_counters_end(&benchmark->counters, batch * count);
+
+    size_t kept = fossil_mark_reject_outliers(samples, count, cfg.outliers);
+    qsort(samples, kept, sizeof(double), compare_double);
+
+    stats = &benchmark->stats;
+    memset(stats, 0, sizeof(*stats));
+    stats->samples = kept;
+    stats->outliers = count - kept;
+    stats->batch = batch;
+    stats->warmup = warmup;
+    stats->confidence = cfg.confidence;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < kept; i++) {
+        sum += samples[i];
+    }
+    stats->mean_ns = sum / (double)kept;
+
+    double variance = 0.0;
+    for (size_t i = 0; i < kept; i++) {
+        double diff = samples[i] - stats->mean_ns;
+        variance += diff * diff;
+    }
+    stats->stddev_ns = kept > 1 ? sqrt(variance / (double)(kept - 1)) : 0.0;
+
+    double margin = fossil_mark_t_critical(cfg.confidence, kept - 1) * stats->stddev_ns / sqrt((double)kept);
+    stats->ci_low_ns = stats->mean_ns - margin;
+    stats->ci_high_ns = stats->mean_ns + margin;
+    stats->min_ns = samples[0];
+    stats->max_ns = samples[kept - 1];
+    stats->p50_ns = fossil_mark_percentile(samples, kept, 0.50);
+    stats->p90_ns = fossil_mark_percentile(samples, kept, 0.90);
+    stats->p99_ns = fossil_mark_percentile(samples, kept, 0.99);
+    stats->p999_ns = fossil_mark_percentile(samples, kept, 0.999);
+
+    // Mirror the kept samples into the classic per-iteration fields
+    if (kept > benchmark->capacity || benchmark->iteration_times == null) {
+        uint64_t* times = (uint64_t*)realloc(benchmark->iteration_times, kept * sizeof(uint64_t));
+        if (times != null) {
+            benchmark->iteration_times = times;
+            benchmark->capacity = kept;
+        }
+    }
+    if (benchmark->iteration_times != null && benchmark->capacity >= kept) {
+        for (size_t i = 0; i < kept; i++) {
+            benchmark->iteration_times[i] = (uint64_t)(samples[i] + 0.5);
+        }
+    }
+    benchmark->num_samples = (uint32_t)kept;
+    benchmark->num_iterations = (size_t)(batch * count);
+    benchmark->num_warmup = (size_t)warmup;
+    benchmark->total_duration = total / 1e9;
+    benchmark->mean_duration = stats->mean_ns / 1e9;
+    benchmark->median_duration = stats->p50_ns / 1e9;
+    benchmark->min_duration = stats->min_ns / 1e9;
+    benchmark->max_duration = stats->max_ns / 1e9;
+    benchmark->std_dev = stats->stddev_ns / 1e9;
+
+    fossil_mark_baseline_store(benchmark->name, samples, kept);
+    free(samples);
+    return 0;
+}
+
+// Baseline store: persisted sample distributions and regression checks
+
+#define FOSSIL_MARK_BASELINE_MAGIC "FMB1"
+#define FOSSIL_MARK_BASELINE_MAX 1024   // Samples kept per benchmark
+#define FOSSIL_MARK_BASELINE_NAME 256   // Name buffer per benchmark, terminator included
+#define FOSSIL_MARK_BASELINE_ALPHA 0.05 // Significance level of the regression test
+
+typedef struct {
+    char* name;
+    float* samples; // Sorted, nanoseconds
+    uint32_t count;
+} fossil_mark_entry_t;
+
+typedef struct {
+    fossil_mark_entry_t* items;
+    size_t count;
+    size_t capacity;
+} fossil_mark_table_t;
+
+static struct {
+    int open;
+    const char* save_path;
+    const char* compare_path;
+    double threshold;
+    size_t regressions;
+    fossil_mark_table_t baseline;
+    fossil_mark_table_t current;
+    maip_sys_mutex_t lock;
+} fossil_mark_store;
+
+static fossil_mark_entry_t* fossil_mark_table_find(fossil_mark_table_t* table, const char* name) {
+    for (size_t i = 0; i < table->count; i++) {
+        if (strcmp(table->items[i].name, name) == 0) {
+            return &table->items[i];
+        }
+    }
+    return null;
+}
+
+// Takes ownership of samples
+static int fossil_mark_table_put(fossil_mark_table_t* table, const char* name, float* samples, uint32_t count) {
+    fossil_mark_entry_t* entry = fossil_mark_table_find(table, name);
+    if (entry != null) {
+        free(entry->samples);
+        entry->samples = samples;
+        entry->count = count;
+        return 0;
+    }
+
+    if (table->count >= table->capacity) {
+        size_t capacity = table->capacity ? table->capacity * 2 : 16;
+        fossil_mark_entry_t* items = (fossil_mark_entry_t*)realloc(table->items, capacity * sizeof(*items));
+        if (items == null) {
+            free(samples);
+            return -1;
+        }
+        table->items = items;
+        table->capacity = capacity;
+    }
+
+    size_t length = strlen(name);
+    char* copy = (char*)malloc(length + 1);
+    if (copy == null) {
+        free(samples);
+        return -1;
+    }
+    memcpy(copy, name, length + 1);
+
+    entry = &table->items[table->count++];
+    entry->name = copy;
+    entry->samples = samples;
+    entry->count = count;
+    return 0;
+}
+
+static void fossil_mark_table_free(fossil_mark_table_t* table) {
+    for (size_t i = 0; i < table->count; i++) {
+        free(table->items[i].name);
+        free(table->items[i].samples);
+    }
+    free(table->items);
+    memset(table, 0, sizeof(*table));
+}
+
+// The file is little-endian regardless of host byte order
+static int fossil_mark_write_u32(FILE* file, uint32_t value) {
+    unsigned char bytes[4] = {
+        (unsigned char)value, (unsigned char)(value >> 8),
+        (unsigned char)(value >> 16), (unsigned char)(value >> 24)
+    };
+    return fwrite(bytes, 1, 4, file) == 4 ? 0 : -1;
+}
+
+static int fossil_mark_read_u32(FILE* file, uint32_t* value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, 4, file) != 4) {
+        return -1;
+    }
+    *value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+             ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    return 0;
+}
+
+static int fossil_mark_write_entry(FILE* file, const fossil_mark_entry_t* entry) {
+    uint32_t length = (uint32_t)strlen(entry->name);
+    if (fossil_mark_write_u32(file, length) != 0 ||
+        fwrite(entry->name, 1, length, file) != length ||
+        fossil_mark_write_u32(file, entry->count) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < entry->count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &entry->samples[i], sizeof(bits));
+        if (fossil_mark_write_u32(file, bits) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int fossil_mark_baseline_load(const char* path, fossil_mark_table_t* table) {
+    FILE* file = fopen(path, "rb");
+    if (file == null) {
+        return -1;
+    }
+
+    char magic[4];
+    uint32_t entries = 0;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, FOSSIL_MARK_BASELINE_MAGIC, 4) != 0 ||
+        fossil_mark_read_u32(file, &entries) != 0) {
+        fclose(file);
+        return -1;
+    }
+
+    for (uint32_t e = 0; e < entries; e++) {
+        uint32_t length = 0;
+        uint32_t count = 0;
+        char name[FOSSIL_MARK_BASELINE_NAME];
+
+        if (fossil_mark_read_u32(file, &length) != 0 || length >= sizeof(name) ||
+            fread(name, 1, length, file) != length ||
+            fossil_mark_read_u32(file, &count) != 0 || count > FOSSIL_MARK_BASELINE_MAX) {
+            fclose(file);
+            return -1;
+        }
+        name[length] = '\0';
+
+        float* samples = (float*)malloc((count ? count : 1) * sizeof(float));
+        if (samples == null) {
+            fclose(file);
+            return -1;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t bits;
+            if (fossil_mark_read_u32(file, &bits) != 0) {
+                free(samples);
+                fclose(file);
+                return -1;
+            }
+            memcpy(&samples[i], &bits, sizeof(bits));
+        }
+        if (fossil_mark_table_put(table, name, samples, count) != 0) {
+            fclose(file);
+            return -1;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static int fossil_mark_baseline_save(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == null) {
+        return -1;
+    }
+
+    // Saving over the compared file keeps baselines of benchmarks not run this time
+    int merge = fossil_mark_store.compare_path != null && strcmp(path, fossil_mark_store.compare_path) == 0;
+    uint32_t entries = (uint32_t)fossil_mark_store.current.count;
+    if (merge) {
+        for (size_t i = 0; i < fossil_mark_store.baseline.count; i++) {
+            if (fossil_mark_table_find(&fossil_mark_store.current, fossil_mark_store.baseline.items[i].name) == null) {
+                entries++;
+            }
+        }
+    }
+
+    int status = 0;
+    if (fwrite(FOSSIL_MARK_BASELINE_MAGIC, 1, 4, file) != 4 || fossil_mark_write_u32(file, entries) != 0) {
+        status = -1;
+    }
+    for (size_t i = 0; status == 0 && i < fossil_mark_store.current.count; i++) {
+        status = fossil_mark_write_entry(file, &fossil_mark_store.current.items[i]);
+    }
+    for (size_t i = 0; merge && status == 0 && i < fossil_mark_store.baseline.count; i++) {
+        const fossil_mark_entry_t* entry = &fossil_mark_store.baseline.items[i];
+        if (fossil_mark_table_find(&fossil_mark_store.current, entry->name) == null) {
+            status = fossil_mark_write_entry(file, entry);
+        }
+    }
+
+    if (fclose(file) != 0) {
+        status = -1;
+    }
+    return status;
+}
+
+typedef struct {
+    double value;
+    int current;
+} fossil_mark_ranked_t;
+
+static int compare_ranked(const void* a, const void* b) {
+    double x = ((const fossil_mark_ranked_t*)a)->value;
+    double y = ((const fossil_mark_ranked_t*)b)->value;
+    return (x > y) - (x < y);
+}
+
+double fossil_benchmark_mann_whitney(const double* baseline, size_t baseline_count, const double* current, size_t current_count) {
+    if (baseline == null || current == null || baseline_count == 0 || current_count == 0) {
+        return 1.0;
+    }
+
+    size_t total = baseline_count + current_count;
+    fossil_mark_ranked_t* ranked = (fossil_mark_ranked_t*)malloc(total * sizeof(*ranked));
+    if (ranked == null) {
+        return 1.0;
+    }
+    for (size_t i = 0; i < baseline_count; i++) {
+        ranked[i].value = baseline[i];
+        ranked[i].current = 0;
+    }
+    for (size_t i = 0; i < current_count; i++) {
+        ranked[baseline_count + i].value = current[i];
+        ranked[baseline_count + i].current = 1;
+    }
+    qsort(ranked, total, sizeof(*ranked), compare_ranked);
+
+    // Tied values share the average of their ranks
+    double rank_sum = 0.0;
+    double ties = 0.0;
+    for (size_t i = 0; i < total;) {
+        size_t j = i;
+        while (j < total && ranked[j].value == ranked[i].value) {
+            j++;
+        }
+        double rank = (double)(i + 1 + j) / 2.0;
+        double group = (double)(j - i);
+        ties += group * group * group - group;
+        for (size_t k = i; k < j; k++) {
+            if (ranked[k].current) {
+                rank_sum += rank;
+            }
+        }
+        i = j;
+    }
+    free(ranked);
+
+    double n1 = (double)baseline_count;
+    double n2 = (double)current_count;
+    double n = n1 + n2;
+    double u = rank_sum - n2 * (n2 + 1.0) / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1.0) - (n > 1.0 ? ties / (n * (n - 1.0)) : 0.0));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+    double z = (u - n1 * n2 / 2.0 - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+static double fossil_mark_median_f(const float* sorted, uint32_t count) {
+    if (count == 0) {
+        return 0.0;
+    }
+    if (count % 2 == 0) {
+        return ((double)sorted[count / 2 - 1] + (double)sorted[count / 2]) / 2.0;
+    }
+    return (double)sorted[count / 2];
+}
+
+// Called with the store lock held
+static void fossil_mark_baseline_check(const char* name, const float* samples, uint32_t count) {
+    fossil_mark_entry_t* base = fossil_mark_table_find(&fossil_mark_store.baseline, name);
+    if (base == null || base->count == 0 || count == 0) {
+        return;
+    }
+
+    double* a = (double*)malloc(base->count * sizeof(double));
+    double* b = (double*)malloc(count * sizeof(double));
+    if (a == null || b == null) {
+        free(a);
+        free(b);
+        return;
+    }
+    for (uint32_t i = 0; i < base->count; i++) {
+        a[i] = base->samples[i];
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        b[i] = samples[i];
+    }
+    double p = fossil_benchmark_mann_whitney(a, base->count, b, count);
+    free(a);
+    free(b);
+
+    double before = fossil_mark_median_f(base->samples, base->count);
+    double after = fossil_mark_median_f(samples, count);
+    double ratio = before > 0.0 ? after / before : 1.0;
+    int regressed = p < FOSSIL_MARK_BASELINE_ALPHA && ratio > 1.0 + fossil_mark_store.threshold / 100.0;
+
+    if (regressed) {
+        fossil_mark_store.regressions++;
+    }
+    maip_io_printf("%sBaseline  : %s median %.2f -> %.2f ns (x%.3f, p=%.4f) %s{reset}\n",
+                    regressed ? "{red,bold}" : "{cyan}", name, before, after, ratio, p,
+                    regressed ? "REGRESSED" : "ok");
+}
+
+// Stores up to FOSSIL_MARK_BASELINE_MAX evenly spaced order statistics of sorted samples.
+// Names too long for the loader's buffer are not stored, so every saved file reads back.
+static void fossil_mark_baseline_store(const char* name, const double* sorted, size_t count) {
+    if (!fossil_mark_store.open || name == null || count == 0 ||
+        strlen(name) >= FOSSIL_MARK_BASELINE_NAME) {
+        return;
+    }
+
+    uint32_t kept = (uint32_t)(count < FOSSIL_MARK_BASELINE_MAX ? count : FOSSIL_MARK_BASELINE_MAX);
+    float* samples = (float*)malloc(kept * sizeof(float));
+    if (samples == null) {
+        return;
+    }
+    for (uint32_t i = 0; i < kept; i++) {
+        size_t index = kept > 1 ? (size_t)((double)i * (double)(count - 1) / (double)(kept - 1) + 0.5) : 0;
+        samples[i] = (float)sorted[index];
+    }
+
+    maip_sys_mutex_lock(&fossil_mark_store.lock);
+    fossil_mark_baseline_check(name, samples, kept);
+    fossil_mark_table_put(&fossil_mark_store.current, name, samples, kept);
+    maip_sys_mutex_unlock(&fossil_mark_store.lock);
+}
+
+int fossil_benchmark_baseline_open(const char* save_path, const char* compare_path, double threshold) {
+    if (fossil_mark_store.open) {
+        fossil_benchmark_baseline_close();
+    }
+
+    memset(&fossil_mark_store, 0, sizeof(fossil_mark_store));
+    if (maip_sys_mutex_init(&fossil_mark_store.lock) != 0) {
+        return -1;
+    }
+    fossil_mark_store.save_path = save_path;
+    fossil_mark_store.compare_path = compare_path;
+    fossil_mark_store.threshold = threshold;
+    fossil_mark_store.open = 1;
+
+    if (compare_path != null && fossil_mark_baseline_load(compare_path, &fossil_mark_store.baseline) != 0) {
+        maip_io_printf("{red}Error: cannot read benchmark baseline %s{reset}\n", compare_path);
+        fossil_mark_table_free(&fossil_mark_store.baseline);
+        maip_sys_mutex_destroy(&fossil_mark_store.lock);
+        fossil_mark_store.open = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void fossil_benchmark_baseline_record(const fossil_mark_t* benchmark) {
+    if (benchmark == null || !fossil_mark_store.open || benchmark->num_samples == 0 ||
+        benchmark->iteration_times == null) {
+        return;
+    }
+
+    double* sorted = (double*)malloc(benchmark->num_samples * sizeof(double));
+    if (sorted == null) {
+        return;
+    }
+    for (uint32_t i = 0; i < benchmark->num_samples; i++) {
+        sorted[i] = (double)benchmark->iteration_times[i];
+    }
+    qsort(sorted, benchmark->num_samples, sizeof(double), compare_double);
+    maip_sys_memory_quiet_begin(); // the table outlives the case recording into it
+    fossil_mark_baseline_store(benchmark->name, sorted, benchmark->num_samples);
+    maip_sys_memory_quiet_end();
+    free(sorted);
+}
+
+size_t fossil_benchmark_baseline_close(void) {
+    if (!fossil_mark_store.open) {
+        return 0;
+    }
+
+    size_t regressions = fossil_mark_store.regressions;
+    if (fossil_mark_store.save_path != null) {
+        if (fossil_mark_baseline_save(fossil_mark_store.save_path) == 0) {
+            maip_io_printf("{cyan}Saved %zu benchmark baseline(s) to %s{reset}\n",
+                            fossil_mark_store.current.count, fossil_mark_store.save_path);
+        } else {
+            maip_io_printf("{red}Error: cannot write benchmark baseline %s{reset}\n", fossil_mark_store.save_path);
+        }
+    }
+    if (regressions > 0) {
+        maip_io_printf("{red,bold}Benchmark regressions: %zu{reset}\n", regressions);
+    }
+
+    fossil_mark_table_free(&fossil_mark_store.baseline);
+    fossil_mark_table_free(&fossil_mark_store.current);
+    maip_sys_mutex_destroy(&fossil_mark_store.lock);
+    fossil_mark_store.open = 0;
+    return regressions;
+}
+
 double fossil_benchmark_elapsed_seconds(const fossil_mark_t* benchmark) {
     if (benchmark == null) {
         maip_io_printf("Error: benchmark is null\n");
@@ -263,6 +1065,9 @@ void fossil_benchmark_reset(fossil_mark_t* benchmark) {
     benchmark->mean_duration = 0.0;
     benchmark->median_duration = 0.0;
     benchmark->std_dev = 0.0;
+    memset(&benchmark->stats, 0, sizeof(benchmark->stats));
+    memset(benchmark->counters.totals, 0, sizeof(benchmark->counters.totals));
+    benchmark->counters.iterations = 0;
 }
 
 void fossil_benchmark_report(const fossil_mark_t* benchmark) {
@@ -271,6 +1076,10 @@ void fossil_benchmark_report(const fossil_mark_t* benchmark) {
         return;
     }
     maip_io_printf("{blue,bold}Benchmark : %s{reset}\n", benchmark->name);
+    maip_io_printf("{cyan}Clock     : %s (resolution %llu ns, overhead %llu ns){reset}\n",
+                    maip_sys_time_source(),
+                    (unsigned long long)maip_sys_time_resolution_ns(),
+                    (unsigned long long)maip_sys_time_overhead_ns());
     maip_io_printf("{cyan}Iterations: %zu (warmup: %zu){reset}\n", benchmark->num_samples, benchmark->num_warmup);
     maip_io_printf("{cyan}Total Time: %.6f seconds{reset}\n", fossil_benchmark_elapsed_seconds(benchmark));
     maip_io_printf("{cyan}Mean Time : %.6f seconds{reset}\n", fossil_benchmark_avg_time(benchmark));
@@ -280,6 +1089,40 @@ void fossil_benchmark_report(const fossil_mark_t* benchmark) {
     maip_io_printf("{cyan}Std Dev   : %.6f seconds (±%.2f%%){reset}\n", 
                     fossil_benchmark_std_dev(benchmark),
                     (fossil_benchmark_std_dev(benchmark) / fossil_benchmark_avg_time(benchmark)) * 100.0);
+
+    const fossil_mark_stats_t* stats = &benchmark->stats;
+    if (stats->samples == 0) {
+        fossil_benchmark_baseline_record(benchmark); // fossil_benchmark_run records its own samples
+    } else {
+        maip_io_printf("{cyan}Samples   : %zu x %llu calls (%zu outliers rejected){reset}\n",
+                        stats->samples, (unsigned long long)stats->batch, stats->outliers);
+        maip_io_printf("{cyan}Per Call  : %.2f ns (CI %.2f .. %.2f at %.2f){reset}\n",
+                        stats->mean_ns, stats->ci_low_ns, stats->ci_high_ns, stats->confidence);
+        maip_io_printf("{cyan}Percentile: p50 %.2f, p90 %.2f, p99 %.2f, p999 %.2f ns{reset}\n",
+                        stats->p50_ns, stats->p90_ns, stats->p99_ns, stats->p999_ns);
+    }
+
+    const fossil_mark_counters_t* counters = &benchmark->counters;
+    if (counters->enabled && counters->available == 0) {
+        maip_io_printf("{cyan}Counters  : unavailable (%s){reset}\n", strerror(counters->error));
+    } else if (counters->enabled && counters->iterations > 0) {
+        double cycles = fossil_benchmark_counter(benchmark, FOSSIL_MARK_COUNTER_CYCLES);
+        double instructions = fossil_benchmark_counter(benchmark, FOSSIL_MARK_COUNTER_INSTRUCTIONS);
+        if (cycles > 0.0 && instructions >= 0.0) {
+            maip_io_printf("{cyan}IPC       : %.2f (%.1f instructions, %.1f cycles per iteration){reset}\n",
+                            instructions / cycles, instructions, cycles);
+        }
+        double cache = fossil_benchmark_counter(benchmark, FOSSIL_MARK_COUNTER_CACHE_MISSES);
+        double branch = fossil_benchmark_counter(benchmark, FOSSIL_MARK_COUNTER_BRANCH_MISSES);
+        if (cache >= 0.0 || branch >= 0.0) {
+            maip_io_printf("{cyan}Misses    : %.3f cache, %.3f branch per iteration{reset}\n",
+                            cache >= 0.0 ? cache : 0.0, branch >= 0.0 ? branch : 0.0);
+        }
+        double task = fossil_benchmark_counter(benchmark, FOSSIL_MARK_COUNTER_TASK_CLOCK);
+        if (task >= 0.0) {
+            maip_io_printf("{cyan}Task Clock: %.1f ns per iteration{reset}\n", task);
+        }
+    }
 }
 
 void fossil_benchmark_destroy(fossil_mark_t* benchmark) {
@@ -290,6 +1133,7 @@ void fossil_benchmark_destroy(fossil_mark_t* benchmark) {
         free(benchmark->iteration_times);
         benchmark->iteration_times = null;
     }
+    fossil_mark_counters_close(&benchmark->counters);
 }
 
 void fossil_scoped_benchmark_init(fossil_scoped_mark_t* scoped_benchmark, fossil_mark_t* benchmark) {
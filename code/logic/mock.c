@@ -304,6 +304,22 @@ void fossil_mock_print_ai_context(const fossil_mock_ai_context_t *ai_context) {
     maip_io_printf("    {blue}Notes:{reset} %s\n", ai_context->ai_notes ? ai_context->ai_notes : "NULL");
 }
 
+static void fossil_mock_stdout_lock(void) {
+#ifdef _WIN32
+    _lock_file(stdout);
+#else
+    flockfile(stdout);
+#endif
+}
+
+static void fossil_mock_stdout_unlock(void) {
+#ifdef _WIN32
+    _unlock_file(stdout);
+#else
+    funlockfile(stdout);
+#endif
+}
+
 int fossil_mock_capture_output(char *buffer, size_t size, void (*function)(void)) {
     if (!buffer || size == 0 || !function) {
         return -1;
@@ -314,15 +330,21 @@ int fossil_mock_capture_output(char *buffer, size_t size, void (*function)(void)
         return -1;
     }
 
+    // Hold the stdout lock for the whole swap so parallel workers can't
+    // write into the capture; the lock is recursive for this thread
+    fossil_mock_stdout_lock();
+
     int original_stdout_fd = dup(STDOUT_FILENO);
     if (original_stdout_fd == -1) {
         fclose(temp_file);
+        fossil_mock_stdout_unlock();
         return -1;
     }
     fflush(stdout);
     if (dup2(fileno(temp_file), STDOUT_FILENO) == -1) {
         fclose(temp_file);
         close(original_stdout_fd);
+        fossil_mock_stdout_unlock();
         return -1;
     }
 
@@ -331,6 +353,7 @@ int fossil_mock_capture_output(char *buffer, size_t size, void (*function)(void)
     fflush(stdout);
     dup2(original_stdout_fd, STDOUT_FILENO);
     close(original_stdout_fd);
+    fossil_mock_stdout_unlock();
 
     rewind(temp_file);
     size_t read_size = fread(buffer, 1, size - 1, temp_file);
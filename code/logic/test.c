@@ -22,839 +22,6031 @@
  * Copyright (C) 2013-Current Fossil Logic. All rights reserved.
  * -----------------------------------------------------------------------------
  */
+// sigaltstack and the si_code values used by crash recovery are XSI
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 600
+#endif
+
 #include "fossil/maip/test.h"
+#include "fossil/maip/mark.h"
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <unistd.h>
 #include <setjmp.h>
 #include <stdio.h>
 #include <time.h>
-#include <sys/time.h>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define FOSSIL_MAIP_HAVE_BACKTRACE 1
+#endif
+#endif
+
+// sigsetjmp/siglongjmp where available so the timeout watchdog can unwind
+// a case from its signal handler
+#ifdef _WIN32
+typedef jmp_buf fossil_maip_jmp_buf_t;
+#define fossil_maip_setjmp(env) setjmp(env)
+#define fossil_maip_longjmp(env, val) longjmp(env, val)
+#else
+typedef sigjmp_buf fossil_maip_jmp_buf_t;
+#define fossil_maip_setjmp(env) sigsetjmp(env, 0)
+#define fossil_maip_longjmp(env, val) siglongjmp(env, val)
+#endif
+
+// Values passed through test_jump_buffer
+enum
+{
+    FOSSIL_MAIP_JUMP_FAIL = 1,
+    FOSSIL_MAIP_JUMP_TIMEOUT = 2,
+    FOSSIL_MAIP_JUMP_CRASH = 3
+};
 
-jmp_buf test_jump_buffer;     // This will hold the jump buffer for longjmp
-static int _ASSERT_COUNT = 0; // Counter for the number of assertions
+// Per-thread so that --jobs workers can each unwind their own failing case
+FOSSIL_MAIP_THREAD_LOCAL fossil_maip_jmp_buf_t test_jump_buffer; // This will hold the jump buffer for longjmp
+static FOSSIL_MAIP_THREAD_LOCAL int _ASSERT_COUNT = 0; // Counter for the number of assertions
+static FOSSIL_MAIP_THREAD_LOCAL char fossil_maip_failure[256]; // Message of the last failed assertion, for reports
 
 // --- Internal helper for timing ---
 static uint64_t fossil_maip_now_ns(void)
 {
-    struct timeval tv;
-    gettimeofday(&tv, null);
-    return (uint64_t)tv.tv_sec * 1000000000ULL + (uint64_t)tv.tv_usec * 1000ULL;
+    return maip_sys_time_now_ns();
 }
 
-// --- Start ---
-int fossil_maip_start(fossil_maip_engine_t *engine, int argc, char **argv)
+// --- Fixtures ---
+// Suite and process fixtures are shared by every worker and kept on one
+// stack; a suite fixture belongs to the suite that first used it, so a suite
+// run nested inside a case leaves the enclosing suite's fixtures alone. Case
+// fixtures belong to the thread running the case.
+
+enum
 {
-    if (!engine || !argv)
-        return FOSSIL_MAIP_FAILURE;
+    FOSSIL_MAIP_CASE_FIXTURES = 16 // Case fixtures kept without allocating; more spill to the heap
+};
 
-    maip_sys_memory_set(engine, 0, sizeof(*engine));
+typedef struct
+{
+    fossil_maip_fixture_t *fixture;
+    void *value;
+} fossil_maip_fixture_slot_t;
+
+static maip_sys_mutex_t fossil_maip_fixture_lock;
+static bool fossil_maip_fixture_lock_ready = false;
+static fossil_maip_fixture_t *fossil_maip_fixture_stack = null; // Newest first
+static FOSSIL_MAIP_THREAD_LOCAL int fossil_maip_fixture_depth = 0; // Lock held by this thread
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_fixture_slot_t fossil_maip_case_fixture_inline[FOSSIL_MAIP_CASE_FIXTURES];
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_fixture_slot_t *fossil_maip_case_fixture_heap = null;
+static FOSSIL_MAIP_THREAD_LOCAL size_t fossil_maip_case_fixture_capacity = FOSSIL_MAIP_CASE_FIXTURES;
+static FOSSIL_MAIP_THREAD_LOCAL size_t fossil_maip_case_fixture_count = 0;
+static FOSSIL_MAIP_THREAD_LOCAL const void *fossil_maip_fixture_suite = null; // Suite running on this thread
+
+static fossil_maip_fixture_slot_t *fossil_maip_case_fixtures(void)
+{
+    return fossil_maip_case_fixture_heap ? fossil_maip_case_fixture_heap : fossil_maip_case_fixture_inline;
+}
 
-    engine->suites = NULL;
-    engine->count = 0;
-    engine->capacity = 0;
-    engine->score_total = 0;
-    engine->score_possible = 0;
+static bool fossil_maip_case_fixture_grow(void)
+{
+    size_t capacity = fossil_maip_case_fixture_capacity * 2;
+    fossil_maip_fixture_slot_t *slots =
+        (fossil_maip_fixture_slot_t *)maip_sys_memory_alloc(capacity * sizeof(*slots));
+    if (!slots)
+        return false;
+    memcpy(slots, fossil_maip_case_fixtures(), fossil_maip_case_fixture_count * sizeof(*slots));
+    if (fossil_maip_case_fixture_heap)
+        maip_sys_memory_free(fossil_maip_case_fixture_heap);
+    fossil_maip_case_fixture_heap = slots;
+    fossil_maip_case_fixture_capacity = capacity;
+    return true;
+}
 
-    maip_sys_memory_set(&engine->score, 0, sizeof(engine->score));
+static void *fossil_maip_fixture_use_case(fossil_maip_fixture_t *fixture)
+{
+    for (size_t i = 0; i < fossil_maip_case_fixture_count; ++i)
+    {
+        if (fossil_maip_case_fixtures()[i].fixture == fixture)
+            return fossil_maip_case_fixtures()[i].value;
+    }
 
-    engine->pallet = fossil_maip_pallet_create(argc, argv);
+    if (fossil_maip_case_fixture_count >= fossil_maip_case_fixture_capacity && !fossil_maip_case_fixture_grow())
+    {
+        maip_io_printf("{red}Error: out of memory setting up case fixture %s{reset}\n",
+                       fixture->name ? fixture->name : "");
+        return null;
+    }
 
-    return FOSSIL_MAIP_SUCCESS;
+    // Reserve the slot first so a nested use of the same fixture can't recurse;
+    // setup may use more fixtures and move the slots, so index them afresh
+    size_t index = fossil_maip_case_fixture_count++;
+    fossil_maip_case_fixtures()[index].fixture = fixture;
+    fossil_maip_case_fixtures()[index].value = null;
+    void *value = fixture->setup ? fixture->setup() : null;
+    fossil_maip_case_fixtures()[index].value = value;
+    return value;
 }
 
-// --- Add Suite ---
-int fossil_maip_add_suite(fossil_maip_engine_t *engine, fossil_maip_suite_t suite)
+void *fossil_maip_fixture_use(fossil_maip_fixture_t *fixture)
 {
-    if (!engine)
-        return FOSSIL_MAIP_FAILURE;
+    if (!fixture)
+        return null;
 
-    // Resize if needed
-    if (engine->count >= engine->capacity)
+    if (fixture->scope == FOSSIL_MAIP_SCOPE_CASE || !fossil_maip_fixture_lock_ready)
+        return fossil_maip_fixture_use_case(fixture);
+
+    // Re-entrant so a fixture's setup may use other fixtures
+    if (fossil_maip_fixture_depth++ == 0)
+        maip_sys_mutex_lock(&fossil_maip_fixture_lock);
+
+    if (!fixture->ready)
     {
-        size_t new_cap = engine->capacity ? engine->capacity * 2 : 4;
-        fossil_maip_suite_t *resized = maip_sys_memory_realloc(engine->suites, new_cap * sizeof(*engine->suites));
-        if (!resized)
-            return FOSSIL_MAIP_FAILURE;
-        engine->suites = resized;
-        engine->capacity = new_cap;
+        maip_sys_memory_quiet_begin(); // outlives the case that first used it
+        fixture->value = fixture->setup ? fixture->setup() : null;
+        maip_sys_memory_quiet_end();
+        fixture->owner = fixture->scope == FOSSIL_MAIP_SCOPE_SUITE ? fossil_maip_fixture_suite : null;
+        fixture->ready = true;
+        fixture->next = fossil_maip_fixture_stack;
+        fossil_maip_fixture_stack = fixture;
     }
+    void *value = fixture->value;
 
-    // Add to engine
-    engine->suites[engine->count++] = suite;
-    return FOSSIL_MAIP_SUCCESS;
+    if (--fossil_maip_fixture_depth == 0)
+        maip_sys_mutex_unlock(&fossil_maip_fixture_lock);
+    return value;
 }
 
-// --- Add Case ---
+// Tears down this thread's case fixtures, newest first
+static void fossil_maip_fixture_release_case(void)
+{
+    while (fossil_maip_case_fixture_count > 0)
+    {
+        fossil_maip_fixture_slot_t slot = fossil_maip_case_fixtures()[--fossil_maip_case_fixture_count];
+        if (slot.fixture->teardown)
+            slot.fixture->teardown(slot.value);
+    }
+    if (fossil_maip_case_fixture_heap)
+    {
+        maip_sys_memory_free(fossil_maip_case_fixture_heap);
+        fossil_maip_case_fixture_heap = null;
+        fossil_maip_case_fixture_capacity = FOSSIL_MAIP_CASE_FIXTURES;
+    }
+}
 
-int fossil_maip_add_case(fossil_maip_suite_t *suite, fossil_maip_case_t test_case)
+// Tears down, newest first, every shared fixture whose scope is at most
+// `scope`; with a suite, only the suite fixtures that suite set up
+static void fossil_maip_fixture_release(fossil_maip_scope_t scope, const void *suite)
 {
-    if (!suite)
-        return FOSSIL_MAIP_FAILURE;
+    if (!fossil_maip_fixture_lock_ready)
+        return;
 
-    // Resize case array if needed
-    if (suite->count >= suite->capacity)
+    maip_sys_mutex_lock(&fossil_maip_fixture_lock);
+    fossil_maip_fixture_t **link = &fossil_maip_fixture_stack;
+    while (*link)
     {
-        size_t new_cap = suite->capacity ? suite->capacity * 2 : 4;
-        fossil_maip_case_t *resized = maip_sys_memory_realloc(suite->cases, new_cap * sizeof(*suite->cases));
-        if (!resized)
-            return FOSSIL_MAIP_FAILURE;
-        suite->cases = resized;
-        suite->capacity = new_cap;
+        fossil_maip_fixture_t *fixture = *link;
+        if (fixture->scope > scope || (suite && fixture->owner != suite))
+        {
+            link = &fixture->next;
+            continue;
+        }
+
+        *link = fixture->next;
+        if (fixture->teardown)
+            fixture->teardown(fixture->value);
+        fixture->value = null;
+        fixture->ready = false;
+        fixture->owner = null;
+        fixture->next = null;
     }
+    maip_sys_mutex_unlock(&fossil_maip_fixture_lock);
+}
 
-    // Add test case to suite
-    suite->cases[suite->count++] = test_case;
-    return FOSSIL_MAIP_SUCCESS;
+// --- Failure Index ---
+// Each thread counts failures in a small private table and merges it into
+// the shared index when the table fills, when the thread finishes and
+// before the summary, so failing assertions never wait on each other.
+
+enum
+{
+    FOSSIL_MAIP_FAILURE_LOCAL = 32,  // Slots in a thread's table (power of two)
+    FOSSIL_MAIP_FAILURE_SAMPLE = 96, // Bytes of the first message kept per cluster
+    FOSSIL_MAIP_FAILURE_QUIET = 3    // Repeats a thread prints in full before going terse
+};
+
+typedef struct
+{
+    uint64_t fingerprint; // 0 marks a free slot
+    uint64_t site;        // Hash of file, line and function
+    const char *file;     // __FILE__ and __func__ literals live as long as the program
+    const char *func;
+    int line;
+    size_t count;
+    char message[FOSSIL_MAIP_FAILURE_SAMPLE];
+} fossil_maip_failure_entry_t;
+
+typedef struct
+{
+    fossil_maip_failure_entry_t *entries;
+    size_t capacity; // Power of two
+    size_t count;    // Used slots
+} fossil_maip_failure_table_t;
+
+static maip_sys_mutex_t fossil_maip_failure_lock;
+static bool fossil_maip_failure_lock_ready = false;
+static fossil_maip_failure_table_t fossil_maip_failure_index = {null, 0, 0};
+static size_t fossil_maip_failure_total = 0;
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_failure_entry_t fossil_maip_failure_local[FOSSIL_MAIP_FAILURE_LOCAL];
+static FOSSIL_MAIP_THREAD_LOCAL size_t fossil_maip_failure_local_count = 0;
+
+// Site of the failure in fossil_maip_failure, sent back by --isolate workers
+typedef struct
+{
+    const char *file;
+    const char *func;
+    int line;
+} fossil_maip_failure_at_t;
+
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_failure_at_t fossil_maip_failure_at;
+
+// Starts a digest of "file:line:func"; the fingerprint carries on from it
+static void fossil_maip_failure_site_init(fossil_maip_hash_state_t *state, const char *file, int line, const char *func)
+{
+    char number[16];
+    int length = snprintf(number, sizeof(number), ":%d:", line);
+    fossil_maip_hash_init(state, 0);
+    fossil_maip_hash_update(state, file, file ? strlen(file) : 0);
+    fossil_maip_hash_update(state, number, length > 0 ? (size_t)length : 0);
+    fossil_maip_hash_update(state, func, func ? strlen(func) : 0);
 }
 
-// --- Update Score ---
-void fossil_maip_update_score(fossil_maip_case_t *test_case, fossil_maip_suite_t *suite)
+static uint64_t fossil_maip_failure_site(const char *file, int line, const char *func)
 {
-    if (!test_case || !suite)
-        return;
+    fossil_maip_hash_state_t state;
+    fossil_maip_failure_site_init(&state, file, line, func);
+    return fossil_maip_hash_final64(&state);
+}
 
-    if (test_case->state != FOSSIL_MAIP_CASE_EMPTY)
+uint64_t fossil_maip_failure_fingerprint(const char *file, int line, const char *func, const char *message)
+{
+    fossil_maip_hash_state_t state;
+    fossil_maip_failure_site_init(&state, file, line, func);
+
+    // Digit runs fold to one '#'; the folded text goes in a chunk at a time
+    char chunk[64];
+    size_t used = 0;
+    bool in_digits = false;
+    for (const char *p = message; p && *p; ++p)
     {
-        switch (test_case->state)
+        bool digit = *p >= '0' && *p <= '9';
+        if (digit && in_digits)
+            continue;
+        in_digits = digit;
+        chunk[used++] = digit ? '#' : *p;
+        if (used == sizeof(chunk))
         {
-        case FOSSIL_MAIP_CASE_PASS:
-            suite->score.passed++;
-            break;
-        case FOSSIL_MAIP_CASE_FAIL:
-            suite->score.failed++;
-            break;
-        case FOSSIL_MAIP_CASE_TIMEOUT:
-            suite->score.timeout++;
-            break;
-        case FOSSIL_MAIP_CASE_SKIPPED:
-            suite->score.skipped++;
-            break;
-        case FOSSIL_MAIP_CASE_UNEXPECTED:
-            suite->score.unexpected++;
-            break;
-        case FOSSIL_MAIP_CASE_EMPTY:
-        default:
-            suite->score.empty++;
-            break;
+            fossil_maip_hash_update(&state, chunk, used);
+            used = 0;
         }
     }
+    fossil_maip_hash_update(&state, chunk, used);
 
-    // --- Recompute suite totals for safety ---
-    suite->total_score = suite->score.passed;
-    suite->total_possible = suite->score.passed +
-                            suite->score.failed +
-                            suite->score.timeout +
-                            suite->score.skipped +
-                            suite->score.unexpected +
-                            suite->score.empty;
+    uint64_t hash = fossil_maip_hash_final64(&state);
+    return hash ? hash : 1;
 }
 
-// --- Show Test Cases ---
-
-// Formats nanoseconds into a human-readable string and returns a heap-allocated string
-char *fossil_maip_format_ns(uint64_t ns)
+static fossil_maip_failure_entry_t *fossil_maip_failure_slot(fossil_maip_failure_entry_t *entries, size_t capacity,
+                                                             uint64_t fingerprint)
 {
-    uint64_t hours = ns / 3600000000000ULL;
-    uint64_t minutes = (ns % 3600000000000ULL) / 60000000000ULL;
-    uint64_t seconds = (ns % 60000000000ULL) / 1000000000ULL;
-    uint64_t microseconds = (ns % 1000000000ULL) / 1000ULL;
-    uint64_t nanoseconds = ns % 1000ULL;
-    char *buffer = (char *)maip_sys_memory_alloc(32);
+    size_t mask = capacity - 1;
+    for (size_t slot = (size_t)fingerprint & mask;; slot = (slot + 1) & mask)
+    {
+        if (entries[slot].fingerprint == fingerprint || entries[slot].fingerprint == 0)
+            return &entries[slot];
+    }
+}
 
-    if (buffer)
+// Adds a thread's entry to the shared index; the caller holds the lock
+static void fossil_maip_failure_merge(const fossil_maip_failure_entry_t *entry)
+{
+    fossil_maip_failure_table_t *index = &fossil_maip_failure_index;
+    if (2 * (index->count + 1) > index->capacity)
     {
-        snprintf(buffer, 32, "%02lu:%02lu:%02lu.%06lu,%03lu",
-                 (unsigned long)hours,
-                 (unsigned long)minutes,
-                 (unsigned long)seconds,
-                 (unsigned long)microseconds,
-                 (unsigned long)nanoseconds);
+        size_t capacity = index->capacity ? index->capacity * 2 : 64;
+        fossil_maip_failure_entry_t *entries =
+            (fossil_maip_failure_entry_t *)maip_sys_memory_calloc(capacity, sizeof(*entries));
+        if (!entries)
+            return;
+        for (size_t i = 0; i < index->capacity; ++i)
+        {
+            if (index->entries[i].fingerprint)
+                *fossil_maip_failure_slot(entries, capacity, index->entries[i].fingerprint) = index->entries[i];
+        }
+        maip_sys_memory_free(index->entries);
+        index->entries = entries;
+        index->capacity = capacity;
     }
 
-    return buffer;
+    fossil_maip_failure_entry_t *slot = fossil_maip_failure_slot(index->entries, index->capacity, entry->fingerprint);
+    if (slot->fingerprint == 0)
+    {
+        *slot = *entry;
+        index->count++;
+    }
+    else
+    {
+        slot->count += entry->count;
+    }
+    fossil_maip_failure_total += entry->count;
 }
 
-void fossil_maip_show_cases(const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case, const fossil_maip_engine_t *engine)
+void fossil_maip_failure_flush(void)
 {
-    if (!test_case)
+    if (fossil_maip_failure_local_count == 0)
         return;
 
-    // Determine mode (list, tree, graph), default to list
-    const char *mode = (engine && engine->pallet.show.mode) ? engine->pallet.show.mode : "list";
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_lock(&fossil_maip_failure_lock);
+    for (size_t i = 0; i < FOSSIL_MAIP_FAILURE_LOCAL; ++i)
+    {
+        if (fossil_maip_failure_local[i].fingerprint)
+            fossil_maip_failure_merge(&fossil_maip_failure_local[i]);
+    }
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_unlock(&fossil_maip_failure_lock);
 
-    const char *result_str =
-        (test_case->state == FOSSIL_MAIP_CASE_EMPTY) ? "{cyan}empty{reset}" : (test_case->state == FOSSIL_MAIP_CASE_PASS)     ? "{green}pass{reset}"
-                                                                            : (test_case->state == FOSSIL_MAIP_CASE_FAIL)       ? "{red}fail{reset}"
-                                                                            : (test_case->state == FOSSIL_MAIP_CASE_TIMEOUT)    ? "{yellow}timeout{reset}"
-                                                                            : (test_case->state == FOSSIL_MAIP_CASE_SKIPPED)    ? "{yellow}skipped{reset}"
-                                                                            : (test_case->state == FOSSIL_MAIP_CASE_UNEXPECTED) ? "{magenta}unexpected{reset}"
-                                                                                                                                  : "{white}unknown{reset}";
+    maip_sys_memory_set(fossil_maip_failure_local, 0, sizeof(fossil_maip_failure_local));
+    fossil_maip_failure_local_count = 0;
+}
 
-    // Filtering logic
-    // Apply filters only if they are set (not NULL)
-    if (engine && engine->pallet.show.test_name)
+size_t fossil_maip_failure_record(const char *file, int line, const char *func, const char *message)
+{
+    uint64_t fingerprint = fossil_maip_failure_fingerprint(file, line, func, message);
+    fossil_maip_failure_entry_t *slot =
+        fossil_maip_failure_slot(fossil_maip_failure_local, FOSSIL_MAIP_FAILURE_LOCAL, fingerprint);
+
+    if (slot->fingerprint == 0)
     {
-        if (maip_io_cstr_compare(test_case->name, engine->pallet.show.test_name) != 0)
-            return;
+        // Keep the table at most three quarters full so probes stay short
+        if (4 * (fossil_maip_failure_local_count + 1) > 3 * FOSSIL_MAIP_FAILURE_LOCAL)
+        {
+            fossil_maip_failure_flush();
+            slot = fossil_maip_failure_slot(fossil_maip_failure_local, FOSSIL_MAIP_FAILURE_LOCAL, fingerprint);
+        }
+        slot->fingerprint = fingerprint;
+        slot->site = fossil_maip_failure_site(file, line, func);
+        slot->file = file;
+        slot->func = func;
+        slot->line = line;
+        snprintf(slot->message, sizeof(slot->message), "%s", message ? message : "");
+        fossil_maip_failure_local_count++;
     }
+    return ++slot->count;
+}
 
-    if (engine && engine->pallet.show.name)
+static int fossil_maip_failure_site_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+void fossil_maip_failure_totals(size_t *failures, size_t *clusters, size_t *sites)
+{
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_lock(&fossil_maip_failure_lock);
+
+    const fossil_maip_failure_table_t *index = &fossil_maip_failure_index;
+    size_t distinct = 0;
+    uint64_t *keys = index->count ? (uint64_t *)maip_sys_memory_alloc(index->count * sizeof(*keys)) : null;
+    if (keys)
     {
-        if (maip_io_cstr_compare(suite->name, engine->pallet.show.name) != 0)
-            return;
+        size_t n = 0;
+        for (size_t i = 0; i < index->capacity; ++i)
+        {
+            if (index->entries[i].fingerprint)
+                keys[n++] = index->entries[i].site;
+        }
+        qsort(keys, n, sizeof(*keys), fossil_maip_failure_site_compare);
+        for (size_t i = 0; i < n; ++i)
+            distinct += i == 0 || keys[i] != keys[i - 1];
+        maip_sys_memory_free(keys);
     }
 
-    if (engine && engine->pallet.show.tag)
+    if (failures)
+        *failures = fossil_maip_failure_total;
+    if (clusters)
+        *clusters = index->count;
+    if (sites)
+        *sites = distinct;
+
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_unlock(&fossil_maip_failure_lock);
+}
+
+size_t fossil_maip_failure_top(fossil_maip_failure_cluster_t *out, size_t max)
+{
+    if (!out || max == 0)
+        return 0;
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_lock(&fossil_maip_failure_lock);
+
+    // Insertion into a short sorted list; max is a handful for the summary
+    size_t n = 0;
+    const fossil_maip_failure_table_t *index = &fossil_maip_failure_index;
+    for (size_t i = 0; i < index->capacity; ++i)
     {
-        if (!test_case->tags || !strstr(test_case->tags, engine->pallet.show.tag))
-            return;
+        const fossil_maip_failure_entry_t *entry = &index->entries[i];
+        if (!entry->fingerprint || (n == max && entry->count <= out[n - 1].count))
+            continue;
+
+        size_t at = n < max ? n++ : max - 1;
+        while (at > 0 && out[at - 1].count < entry->count)
+        {
+            out[at] = out[at - 1];
+            at--;
+        }
+        out[at].fingerprint = entry->fingerprint;
+        out[at].file = entry->file;
+        out[at].func = entry->func;
+        out[at].line = entry->line;
+        out[at].count = entry->count;
+        out[at].message = entry->message;
     }
 
-    // Result filtering: extract plain result value for comparison
-    if (engine && engine->pallet.show.result)
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_unlock(&fossil_maip_failure_lock);
+    return n;
+}
+
+void fossil_maip_failure_reset(void)
+{
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_lock(&fossil_maip_failure_lock);
+    maip_sys_memory_free(fossil_maip_failure_index.entries);
+    fossil_maip_failure_index.entries = null;
+    fossil_maip_failure_index.capacity = 0;
+    fossil_maip_failure_index.count = 0;
+    fossil_maip_failure_total = 0;
+    if (fossil_maip_failure_lock_ready)
+        maip_sys_mutex_unlock(&fossil_maip_failure_lock);
+
+    maip_sys_memory_set(fossil_maip_failure_local, 0, sizeof(fossil_maip_failure_local));
+    fossil_maip_failure_local_count = 0;
+}
+
+// --- Root Cause Vocabulary ---
+//
+// Failure messages are classified by a keyword vocabulary compiled into an
+// Aho-Corasick automaton, so one pass over the message finds every keyword.
+// Bytes that appear in no keyword share a class, which keeps the dense
+// transition table small. Codes 1..9 are built in; projects define more at
+// run time and the automaton is rebuilt on the next lookup.
+
+#define FOSSIL_MAIP_CAUSE_BUILTIN 10 // Codes below this are built in
+#define FOSSIL_MAIP_CAUSE_MAX 32     // One bit per code in a uint32_t mask
+
+typedef struct
+{
+    const char *pattern;
+    int code;
+} fossil_maip_cause_word_t;
+
+static const char *fossil_maip_cause_names[FOSSIL_MAIP_CAUSE_BUILTIN] = {
+    null, "Logic error", "Timeout", "Memory error", "I/O error", "Coverage/Empty",
+    "Range error", "Floating-point", "String/buffer", "Text/SOAP"};
+
+static const fossil_maip_cause_word_t fossil_maip_cause_words[] = {
+    // Source context
+    {".c:", 1}, {".cpp:", 1}, {".m:", 1}, {".mm:", 1}, {" in ", 1}, {" at ", 1},
+    {"function ", 1}, {"func=", 1},
+    // Memory
+    {"null pointer", 3}, {"NULL pointer", 3}, {"cnull", 3}, {"dangling pointer", 3},
+    {"invalid pointer", 3}, {"memory leak", 3}, {"buffer overflow", 3}, {"buffer underflow", 3},
+    {"out of bounds", 3}, {"valid memory", 3}, {"zeroed memory", 3}, {"not zeroed", 3},
+    {"uninitialized memory", 3}, {"double free", 3},
+    // Timeout
+    {"timeout", 2}, {"timed out", 2}, {"exceeded time limit", 2}, {"hang detected", 2},
+    // I/O
+    {"file not found", 4}, {"I/O error", 4}, {"io error", 4}, {"read error", 4},
+    {"write error", 4}, {"permission denied", 4}, {"disk full", 4}, {"cannot open file", 4},
+    // Range
+    {"out of range", 6}, {"within range", 6}, {"overflow", 6}, {"underflow", 6},
+    {"index out of bounds", 6}, {"exceeds maximum", 6}, {"below minimum", 6},
+    // Floating point
+    {"float", 7}, {"double", 7}, {"NaN", 7}, {"nan", 7}, {"infinity", 7}, {"infinite", 7},
+    {"tolerance", 7}, {"precision error", 7}, {"loss of significance", 7}, {"rounding error", 7},
+    // Strings and buffers
+    {"string", 8}, {"strlen", 8}, {"cstr", 8}, {"starts with", 8}, {"ends with", 8},
+    {"contains", 8}, {"not contain", 8}, {"length of", 8}, {"buffer overflow", 8},
+    {"buffer underflow", 8},
+    // Text and tone
+    {"soap", 9}, {"text", 9}, {"tone", 9}, {"rot-brain", 9}, {"sentiment", 9}, {"language model", 9},
+    // Coverage
+    {"empty", 5}, {"skipped", 5}, {"not implemented", 5}, {"unreachable code", 5},
+    {"not covered", 5}, {"todo", 5},
+    // Logic, the default for assumption failures
+    {"Expected", 1}, {"not be", 1}, {"to be", 1}, {"fail", 1}, {"logic", 1}, {"assert", 1},
+    {"incorrect result", 1}, {"unexpected value", 1}, {"condition failed", 1}, {"mismatch", 1},
+};
+
+static struct
+{
+    char *names[FOSSIL_MAIP_CAUSE_MAX]; // Labels of defined codes
+    fossil_maip_cause_word_t *words;    // Defined keywords, patterns owned
+    size_t count;
+    size_t capacity;
+    uint8_t classes[256]; // Byte to column; 0 for bytes in no keyword
+    size_t class_count;
+    uint32_t *next;   // states x class_count transitions
+    uint32_t *output; // Cause mask reported on entering a state
+    bool built;
+} fossil_maip_causes;
+
+static maip_sys_mutex_t fossil_maip_cause_lock;
+static bool fossil_maip_cause_lock_ready = false;
+
+static void fossil_maip_cause_lock_take(void)
+{
+    if (fossil_maip_cause_lock_ready)
+        maip_sys_mutex_lock(&fossil_maip_cause_lock);
+}
+
+static void fossil_maip_cause_lock_give(void)
+{
+    if (fossil_maip_cause_lock_ready)
+        maip_sys_mutex_unlock(&fossil_maip_cause_lock);
+}
+
+static const fossil_maip_cause_word_t *fossil_maip_cause_word(size_t i)
+{
+    size_t builtin = sizeof(fossil_maip_cause_words) / sizeof(fossil_maip_cause_words[0]);
+    return i < builtin ? &fossil_maip_cause_words[i] : &fossil_maip_causes.words[i - builtin];
+}
+
+static void fossil_maip_cause_discard(void)
+{
+    maip_sys_memory_free(fossil_maip_causes.next);
+    maip_sys_memory_free(fossil_maip_causes.output);
+    fossil_maip_causes.next = null;
+    fossil_maip_causes.output = null;
+    fossil_maip_causes.built = false;
+}
+
+// Builds the automaton; the caller holds the lock
+static bool fossil_maip_cause_build(void)
+{
+    fossil_maip_cause_discard();
+    size_t words = sizeof(fossil_maip_cause_words) / sizeof(fossil_maip_cause_words[0]) +
+                   fossil_maip_causes.count;
+
+    uint8_t *classes = fossil_maip_causes.classes;
+    maip_sys_memory_set(classes, 0, sizeof(fossil_maip_causes.classes));
+    size_t width = 1;
+    size_t capacity = 1; // The trie never has more states than keyword bytes plus the root
+    for (size_t i = 0; i < words; ++i)
     {
-        const char *result_plain = NULL;
-        if (test_case->state == FOSSIL_MAIP_CASE_EMPTY)
-            result_plain = "empty";
-        else if (test_case->state == FOSSIL_MAIP_CASE_PASS)
-            result_plain = "pass";
-        else if (test_case->state == FOSSIL_MAIP_CASE_FAIL)
-            result_plain = "fail";
-        else if (test_case->state == FOSSIL_MAIP_CASE_TIMEOUT)
-            result_plain = "timeout";
-        else if (test_case->state == FOSSIL_MAIP_CASE_SKIPPED)
-            result_plain = "skipped";
-        else if (test_case->state == FOSSIL_MAIP_CASE_UNEXPECTED)
-            result_plain = "unexpected";
+        for (const uint8_t *p = (const uint8_t *)fossil_maip_cause_word(i)->pattern; *p; ++p)
+        {
+            if (!classes[*p])
+                classes[*p] = (uint8_t)width++;
+            capacity++;
+        }
+    }
+    fossil_maip_causes.class_count = width;
 
-        if (!result_plain || maip_io_cstr_compare(result_plain, engine->pallet.show.result) != 0)
-            return;
+    uint32_t *next = (uint32_t *)maip_sys_memory_calloc(capacity * width, sizeof(uint32_t));
+    uint32_t *output = (uint32_t *)maip_sys_memory_calloc(capacity, sizeof(uint32_t));
+    uint32_t *fail = (uint32_t *)maip_sys_memory_calloc(capacity, sizeof(uint32_t));
+    uint32_t *queue = (uint32_t *)maip_sys_memory_alloc(capacity * sizeof(uint32_t));
+    if (!next || !output || !fail || !queue)
+    {
+        maip_sys_memory_free(next);
+        maip_sys_memory_free(output);
+        maip_sys_memory_free(fail);
+        maip_sys_memory_free(queue);
+        return false;
     }
 
-    // Output according to mode and theme
-    if (maip_io_cstr_compare(mode, "tree") == 0)
+    // Trie; while building, 0 means "no edge" since nothing points at the root
+    uint32_t states = 1;
+    for (size_t i = 0; i < words; ++i)
     {
-        switch (engine ? engine->pallet.theme : MAIP_THEME_FOSSIL)
+        const fossil_maip_cause_word_t *word = fossil_maip_cause_word(i);
+        uint32_t state = 0;
+        for (const uint8_t *p = (const uint8_t *)word->pattern; *p; ++p)
         {
-        case MAIP_THEME_FOSSIL:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            uint32_t *edge = &next[state * width + classes[*p]];
+            if (!*edge)
+                *edge = states++;
+            state = *edge;
+        }
+        output[state] |= 1u << word->code;
+    }
+
+    // Breadth-first failure links turn the trie into a complete automaton:
+    // a missing edge takes the edge of the longest proper suffix state.
+    size_t head = 0, tail = 0;
+    for (size_t c = 0; c < width; ++c)
+    {
+        if (next[c])
+            queue[tail++] = next[c];
+    }
+    while (head < tail)
+    {
+        uint32_t state = queue[head++];
+        output[state] |= output[fail[state]];
+        for (size_t c = 0; c < width; ++c)
+        {
+            uint32_t *edge = &next[state * width + c];
+            uint32_t fallback = next[fail[state] * width + c];
+            if (*edge)
             {
-                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset} {blue}[test case]{reset}\n", test_case->name);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset} {orange}[with tag]{reset}\n", test_case->tags);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset} {orange}[given criteria]{reset}\n", test_case->criteria);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset} {orange}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset} {orange}[the result]{reset}\n", result_str);
+                fail[*edge] = fallback;
+                queue[tail++] = *edge;
             }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            else
             {
-                maip_io_printf("  {blue}::TEST       :: %s{reset}\n", test_case->name);
-                maip_io_printf("    {blue}::TAGS     :: %s{reset}\n", test_case->tags);
-                maip_io_printf("    {blue}::CRITERIA :: %s{reset}\n", test_case->criteria);
-                maip_io_printf("    {blue}::TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("    {blue}::RESULT   :: %s{reset}\n", result_str);
+                *edge = fallback;
             }
-            else
-            { // plain or default
-                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset}\n", test_case->name);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset}\n", test_case->tags);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset}\n", test_case->criteria);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset}\n", result_str);
-            }
-            break;
-        case MAIP_THEME_LIGHT:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("  {bright_blue}├─{reset} {bright_cyan}%s{reset} {bright_blue}[test case]{reset}\n", test_case->name);
-                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Tags    {reset}: {gray}%s{reset} {orange}[with tag]{reset}\n", test_case->tags);
-                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Criteria{reset}: {gray}%s{reset} {orange}[given criteria]{reset}\n", test_case->criteria);
-                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Time    {reset}: {gray}%s{reset} {orange}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {bright_blue}│   └─{reset} {bright_cyan}Result  {reset}: {gray}%s{reset} {orange}[the result]{reset}\n", result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("  {bright_blue}::TEST       :: %s{reset}\n", test_case->name);
-                maip_io_printf("    {bright_blue}::TAGS     :: %s{reset}\n", test_case->tags);
-                maip_io_printf("    {bright_blue}::CRITERIA :: %s{reset}\n", test_case->criteria);
-                maip_io_printf("    {bright_blue}::TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("    {bright_blue}::RESULT   :: %s{reset}\n", result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("  {bright_blue}├─{reset} {bright_cyan}%s{reset}\n", test_case->name);
-                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Tags    {reset}: {gray}%s{reset}\n", test_case->tags);
-                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Criteria{reset}: {gray}%s{reset}\n", test_case->criteria);
-                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Time    {reset}: {gray}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {bright_blue}│   └─{reset} {bright_cyan}Result  {reset}: {gray}%s{reset}\n", result_str);
-            }
-            break;
-        case MAIP_THEME_DARK:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset} {blue}[test case]{reset}\n", test_case->name);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset} {orange}[with tag]{reset}\n", test_case->tags);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset} {orange}[given criteria]{reset}\n", test_case->criteria);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset} {orange}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset} {orange}[the result]{reset}\n", result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("  {blue}::TEST       :: %s{reset}\n", test_case->name);
-                maip_io_printf("    {blue}::TAGS     :: %s{reset}\n", test_case->tags);
-                maip_io_printf("    {blue}::CRITERIA :: %s{reset}\n", test_case->criteria);
-                maip_io_printf("    {blue}::TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("    {blue}::RESULT   :: %s{reset}\n", result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset}\n", test_case->name);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset}\n", test_case->tags);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset}\n", test_case->criteria);
-                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset}\n", result_str);
-            }
-            break;
-        case MAIP_THEME_MAGA:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("  {blue}├─{reset} {white}%s{reset} {red}[test case]{reset}\n", test_case->name);
-                maip_io_printf("  {blue}│   ├─{reset} {white}Tags    {reset}: {blue}%s{reset} {white}[with tag]{reset}\n", test_case->tags);
-                maip_io_printf("  {blue}│   ├─{reset} {red}Criteria{reset}: {blue}%s{reset} {red}[given criteria]{reset}\n", test_case->criteria);
-                maip_io_printf("  {blue}│   ├─{reset} {white}Time    {reset}: {blue}%s{reset} {white}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {blue}│   └─{reset} {red}Result  {reset}: {blue}%s{reset} {red}[the result]{reset}\n", result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+        }
+    }
+
+    maip_sys_memory_free(fail);
+    maip_sys_memory_free(queue);
+    fossil_maip_causes.next = next;
+    fossil_maip_causes.output = output;
+    fossil_maip_causes.built = true;
+    return true;
+}
+
+uint32_t fossil_maip_root_cause_scan(const char *message)
+{
+    if (!message)
+        return 0;
+
+    uint32_t mask = 0;
+    fossil_maip_cause_lock_take();
+    if (fossil_maip_causes.built || fossil_maip_cause_build())
+    {
+        const uint32_t *next = fossil_maip_causes.next;
+        const uint32_t *output = fossil_maip_causes.output;
+        const uint8_t *classes = fossil_maip_causes.classes;
+        size_t width = fossil_maip_causes.class_count;
+        uint32_t state = 0;
+        for (const uint8_t *p = (const uint8_t *)message; *p; ++p)
+        {
+            state = next[state * width + classes[*p]];
+            mask |= output[state];
+        }
+    }
+    fossil_maip_cause_lock_give();
+    return mask;
+}
+
+int fossil_maip_root_cause_detect(const char *message)
+{
+    uint32_t mask = fossil_maip_root_cause_scan(message);
+    if (mask == 0 || (mask & (mask - 1)) != 0)
+        return (int)mask; // Unknown, or several causes as a bitmask
+
+    int code = 0;
+    while (!(mask & (1u << code)))
+        ++code;
+    return code;
+}
+
+int fossil_maip_root_cause_define(const char *label)
+{
+    if (!label || !*label)
+        return -1;
+
+    int code = -1;
+    fossil_maip_cause_lock_take();
+    for (int i = 1; i < FOSSIL_MAIP_CAUSE_MAX && code < 0; ++i)
+    {
+        const char *name = i < FOSSIL_MAIP_CAUSE_BUILTIN ? fossil_maip_cause_names[i] : fossil_maip_causes.names[i];
+        if (name && strcmp(name, label) == 0)
+            code = i;
+    }
+    for (int i = FOSSIL_MAIP_CAUSE_BUILTIN; i < FOSSIL_MAIP_CAUSE_MAX && code < 0; ++i)
+    {
+        if (!fossil_maip_causes.names[i])
+        {
+            size_t len = strlen(label) + 1;
+            fossil_maip_causes.names[i] = (char *)maip_sys_memory_alloc(len);
+            if (fossil_maip_causes.names[i])
             {
-                maip_io_printf("  {blue}::TEST       :: %s{reset}\n", test_case->name);
-                maip_io_printf("    {blue}::TAGS     :: {white}%s{reset}\n", test_case->tags);
-                maip_io_printf("    {blue}::CRITERIA :: {red}%s{reset}\n", test_case->criteria);
-                maip_io_printf("    {blue}::TIME     :: {white}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("    {blue}::RESULT   :: {red}%s{reset}\n", result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("  {blue}├─{reset} {white}%s{reset}\n", test_case->name);
-                maip_io_printf("  {blue}│   ├─{reset} {white}Tags    {reset}: {blue}%s{reset}\n", test_case->tags);
-                maip_io_printf("  {blue}│   ├─{reset} {red}Criteria{reset}: {blue}%s{reset}\n", test_case->criteria);
-                maip_io_printf("  {blue}│   ├─{reset} {white}Time    {reset}: {blue}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {blue}│   └─{reset} {red}Result  {reset}: {blue}%s{reset}\n", result_str);
+                memcpy(fossil_maip_causes.names[i], label, len);
+                code = i;
             }
             break;
-        case MAIP_THEME_MINT:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("  {green}├─{white}%s{reset} {green}[test case]{reset}\n", test_case->name);
-                maip_io_printf("  {green}│   ├─{white}Tags    {reset}: {green}%s{white}[with tag]{reset}\n", test_case->tags);
-                maip_io_printf("  {green}│   ├─{white}Criteria{reset}: {green}%s{white}[given criteria]{reset}\n", test_case->criteria);
-                maip_io_printf("  {green}│   ├─{white}Time    {reset}: {green}%s{white}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {green}│   └─{white}Result  {reset}: {green}%s{white}[the result]{reset}\n", result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+        }
+    }
+    fossil_maip_cause_lock_give();
+    return code;
+}
+
+int fossil_maip_root_cause_add(int code, const char *pattern)
+{
+    if (code < 1 || code >= FOSSIL_MAIP_CAUSE_MAX || !pattern || !*pattern)
+        return FOSSIL_MAIP_FAILURE;
+
+    int status = FOSSIL_MAIP_FAILURE;
+    fossil_maip_cause_lock_take();
+    if (code < FOSSIL_MAIP_CAUSE_BUILTIN || fossil_maip_causes.names[code])
+    {
+        if (fossil_maip_causes.count == fossil_maip_causes.capacity)
+        {
+            size_t capacity = fossil_maip_causes.capacity ? fossil_maip_causes.capacity * 2 : 16;
+            fossil_maip_cause_word_t *words = (fossil_maip_cause_word_t *)maip_sys_memory_realloc(
+                fossil_maip_causes.words, capacity * sizeof(*words));
+            if (words)
             {
-                maip_io_printf("  {green}::{white}TEST       :: %s{reset}\n", test_case->name);
-                maip_io_printf("    {green}::{white}TAGS     :: %s{reset}\n", test_case->tags);
-                maip_io_printf("    {green}::{white}CRITERIA :: %s{reset}\n", test_case->criteria);
-                maip_io_printf("    {green}::{white}TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("    {green}::{white}RESULT   :: %s{reset}\n", result_str);
+                fossil_maip_causes.words = words;
+                fossil_maip_causes.capacity = capacity;
             }
-            else
-            { // plain or default
-                maip_io_printf("  {green}├─{bright_green}%s{reset}\n", test_case->name);
-                maip_io_printf("  {green}│   ├─{white}Tags    {reset}: {green}%s{white}[with tag]{reset}\n", test_case->tags);
-                maip_io_printf("  {green}│   ├─{white}Criteria{reset}: {green}%s{white}[given criteria]{reset}\n", test_case->criteria);
-                maip_io_printf("  {green}│   ├─{white}Time    {reset}: {green}%s{white}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
-                maip_io_printf("  {green}│   └─{white}Result  {reset}: {green}%s{white}[the result]{reset}\n", result_str);
-            }
-            break;
-        default:
-            maip_io_printf("- %s (Tags: %s, Criteria: %s, Time: %s, Result: %s)\n",
-                            test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            break;
         }
+        size_t len = strlen(pattern) + 1;
+        char *copy = fossil_maip_causes.count < fossil_maip_causes.capacity ? (char *)maip_sys_memory_alloc(len) : null;
+        if (copy)
+        {
+            memcpy(copy, pattern, len);
+            fossil_maip_causes.words[fossil_maip_causes.count].pattern = copy;
+            fossil_maip_causes.words[fossil_maip_causes.count].code = code;
+            fossil_maip_causes.count++;
+            fossil_maip_cause_discard(); // Rebuilt by the next lookup
+            status = FOSSIL_MAIP_SUCCESS;
+        }
+    }
+    fossil_maip_cause_lock_give();
+    return status;
+}
+
+size_t fossil_maip_root_cause_describe(uint32_t mask, char *buffer, size_t size)
+{
+    // Built-in causes keep their historical order; defined ones follow by code
+    static const int order[] = {3, 2, 4, 6, 7, 8, 9, 5, 1};
+    if (!buffer || size == 0)
+        return 0;
+    buffer[0] = '\0';
+
+    size_t used = 0;
+    fossil_maip_cause_lock_take();
+    for (int i = 0; i < FOSSIL_MAIP_CAUSE_MAX - 1; ++i)
+    {
+        int code = i < 9 ? order[i] : i + 1;
+        const char *name = code < FOSSIL_MAIP_CAUSE_BUILTIN ? fossil_maip_cause_names[code] : fossil_maip_causes.names[code];
+        if (!(mask & (1u << code)) || !name || used >= size)
+            continue;
+        int written = snprintf(buffer + used, size - used, "%s%s", used ? ", " : "", name);
+        if (written > 0)
+            used += (size_t)written < size - used ? (size_t)written : size - used - 1;
+    }
+    fossil_maip_cause_lock_give();
+    return used;
+}
+
+void fossil_maip_root_cause_reset(void)
+{
+    fossil_maip_cause_lock_take();
+    for (size_t i = 0; i < fossil_maip_causes.count; ++i)
+        maip_sys_memory_free((void *)fossil_maip_causes.words[i].pattern);
+    maip_sys_memory_free(fossil_maip_causes.words);
+    fossil_maip_causes.words = null;
+    fossil_maip_causes.count = 0;
+    fossil_maip_causes.capacity = 0;
+    for (int i = FOSSIL_MAIP_CAUSE_BUILTIN; i < FOSSIL_MAIP_CAUSE_MAX; ++i)
+    {
+        maip_sys_memory_free(fossil_maip_causes.names[i]);
+        fossil_maip_causes.names[i] = null;
+    }
+    fossil_maip_cause_discard();
+    fossil_maip_cause_lock_give();
+}
+
+// --- Allocation Tracking ---
+//
+// Built with -Dwith_memtrack=enabled on glibc, this file defines malloc,
+// calloc, realloc, free, posix_memalign and aligned_alloc. They forward to
+// glibc's own __libc_* entry points and, while a case runs on the calling
+// thread, keep each block in one table keyed by address, so a block may be
+// freed on any thread. Blocks of a case still live after its teardown are its
+// leaks. Without the option none of this is compiled in.
+
+// Sanitizers bring their own malloc; leave it to them
+#if defined(FOSSIL_MAIP_USE_MEMTRACK) && defined(__GLIBC__) && \
+    !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define FOSSIL_MAIP_HAVE_MEMTRACK 1
+#endif
+
+#ifdef FOSSIL_MAIP_HAVE_MEMTRACK
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+typedef struct
+{
+    void *ptr; // null marks a free slot
+    size_t size;
+    void *site;
+    fossil_maip_alloc_stats_t *owner;
+    uint64_t scope; // Case iteration that allocated the block
+} fossil_maip_alloc_entry_t;
+
+static pthread_mutex_t fossil_maip_alloc_lock = PTHREAD_MUTEX_INITIALIZER;
+static fossil_maip_alloc_entry_t *fossil_maip_alloc_table = null;
+static size_t fossil_maip_alloc_capacity = 0; // power of two
+static size_t fossil_maip_alloc_count = 0;    // read unlocked so free() can skip the lock
+static uint64_t fossil_maip_alloc_scopes = 0;
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_alloc_stats_t *fossil_maip_alloc_owner = null;
+static FOSSIL_MAIP_THREAD_LOCAL uint64_t fossil_maip_alloc_scope = 0;
+static FOSSIL_MAIP_THREAD_LOCAL bool fossil_maip_alloc_held = false;
+
+static void fossil_maip_alloc_lock_take(void)
+{
+    pthread_mutex_lock(&fossil_maip_alloc_lock);
+    fossil_maip_alloc_held = true;
+}
+
+static void fossil_maip_alloc_lock_give(void)
+{
+    fossil_maip_alloc_held = false;
+    pthread_mutex_unlock(&fossil_maip_alloc_lock);
+}
+
+static size_t fossil_maip_alloc_home(const void *ptr)
+{
+    uint64_t x = (uint64_t)(uintptr_t)ptr >> 4; // malloc aligns to 16
+    return (size_t)((x * 0x9E3779B97F4A7C15ULL) >> 32) & (fossil_maip_alloc_capacity - 1);
+}
+
+static bool fossil_maip_alloc_grow(void)
+{
+    size_t capacity = fossil_maip_alloc_capacity ? fossil_maip_alloc_capacity * 2 : 1024;
+    fossil_maip_alloc_entry_t *table = (fossil_maip_alloc_entry_t *)__libc_calloc(capacity, sizeof(*table));
+    if (!table)
+        return false;
+
+    fossil_maip_alloc_entry_t *old = fossil_maip_alloc_table;
+    size_t old_capacity = fossil_maip_alloc_capacity;
+    fossil_maip_alloc_table = table;
+    fossil_maip_alloc_capacity = capacity;
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (!old[i].ptr)
+            continue;
+        size_t slot = fossil_maip_alloc_home(old[i].ptr);
+        while (table[slot].ptr)
+            slot = (slot + 1) & (capacity - 1);
+        table[slot] = old[i];
+    }
+    __libc_free(old);
+    return true;
+}
+
+// Called with the lock held
+static void fossil_maip_alloc_insert(void *ptr, size_t size, void *site,
+                                     fossil_maip_alloc_stats_t *owner, uint64_t scope)
+{
+    if (2 * (fossil_maip_alloc_count + 1) > fossil_maip_alloc_capacity && !fossil_maip_alloc_grow())
+        return; // Out of memory for the table: the block goes unaccounted
+
+    size_t slot = fossil_maip_alloc_home(ptr);
+    while (fossil_maip_alloc_table[slot].ptr)
+        slot = (slot + 1) & (fossil_maip_alloc_capacity - 1);
+    fossil_maip_alloc_entry_t *entry = &fossil_maip_alloc_table[slot];
+    entry->ptr = ptr;
+    entry->size = size;
+    entry->site = site;
+    entry->owner = owner;
+    entry->scope = scope;
+    __atomic_store_n(&fossil_maip_alloc_count, fossil_maip_alloc_count + 1, __ATOMIC_RELAXED);
+
+    owner->allocations++;
+    owner->bytes += size;
+    owner->live_blocks++;
+    owner->live_bytes += size;
+    if (owner->live_bytes > owner->peak_bytes)
+        owner->peak_bytes = owner->live_bytes;
+}
+
+// Drops the entry in `slot`, shifting the rest of its probe run back so
+// lookups never need tombstones. Called with the lock held.
+static void fossil_maip_alloc_erase(size_t slot)
+{
+    fossil_maip_alloc_entry_t *table = fossil_maip_alloc_table;
+    size_t mask = fossil_maip_alloc_capacity - 1;
+
+    fossil_maip_alloc_stats_t *owner = table[slot].owner;
+    owner->live_blocks--;
+    owner->live_bytes -= table[slot].size;
+
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; table[next].ptr; next = (next + 1) & mask)
+    {
+        // Move the entry back unless its home lies cyclically in (hole, next]
+        size_t home = fossil_maip_alloc_home(table[next].ptr);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            table[hole] = table[next];
+            hole = next;
+        }
+    }
+    table[hole].ptr = null;
+    __atomic_store_n(&fossil_maip_alloc_count, fossil_maip_alloc_count - 1, __ATOMIC_RELAXED);
+}
+
+// Called with the lock held; returns the slot of ptr or SIZE_MAX
+static size_t fossil_maip_alloc_find(const void *ptr)
+{
+    if (fossil_maip_alloc_count == 0)
+        return SIZE_MAX;
+    size_t mask = fossil_maip_alloc_capacity - 1;
+    for (size_t slot = fossil_maip_alloc_home(ptr); fossil_maip_alloc_table[slot].ptr; slot = (slot + 1) & mask)
+    {
+        if (fossil_maip_alloc_table[slot].ptr == ptr)
+            return slot;
+    }
+    return SIZE_MAX;
+}
+
+static void fossil_maip_alloc_add(void *ptr, size_t size, void *site)
+{
+    if (!ptr || maip_sys_memory_quiet())
+        return;
+    fossil_maip_alloc_lock_take();
+    fossil_maip_alloc_insert(ptr, size, site, fossil_maip_alloc_owner, fossil_maip_alloc_scope);
+    fossil_maip_alloc_lock_give();
+}
+
+void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    if (fossil_maip_alloc_owner)
+        fossil_maip_alloc_add(ptr, size, __builtin_return_address(0));
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    void *ptr = __libc_calloc(count, size);
+    if (fossil_maip_alloc_owner)
+        fossil_maip_alloc_add(ptr, count * size, __builtin_return_address(0)); // no overflow: calloc checked it
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (!fossil_maip_alloc_owner && __atomic_load_n(&fossil_maip_alloc_count, __ATOMIC_RELAXED) == 0)
+        return __libc_realloc(ptr, size);
+
+    void *moved = __libc_realloc(ptr, size);
+    if (!moved && size > 0)
+        return null; // Failed: ptr is untouched
+
+    fossil_maip_alloc_lock_take();
+    size_t slot = ptr ? fossil_maip_alloc_find(ptr) : SIZE_MAX;
+    if (slot != SIZE_MAX)
+    {
+        // A tracked block stays with the case that allocated it
+        fossil_maip_alloc_entry_t entry = fossil_maip_alloc_table[slot];
+        fossil_maip_alloc_erase(slot);
+        if (moved)
+            fossil_maip_alloc_insert(moved, size, entry.site, entry.owner, entry.scope);
+        else
+            entry.owner->frees++;
+    }
+    else if (moved && fossil_maip_alloc_owner && !maip_sys_memory_quiet())
+    {
+        fossil_maip_alloc_insert(moved, size, __builtin_return_address(0), fossil_maip_alloc_owner,
+                                 fossil_maip_alloc_scope);
+    }
+    fossil_maip_alloc_lock_give();
+    return moved;
+}
+
+void free(void *ptr)
+{
+    if (ptr && __atomic_load_n(&fossil_maip_alloc_count, __ATOMIC_RELAXED) > 0)
+    {
+        fossil_maip_alloc_lock_take();
+        size_t slot = fossil_maip_alloc_find(ptr);
+        if (slot != SIZE_MAX)
+        {
+            fossil_maip_alloc_table[slot].owner->frees++;
+            fossil_maip_alloc_erase(slot);
+        }
+        fossil_maip_alloc_lock_give();
+    }
+    __libc_free(ptr);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void *ptr = __libc_memalign(alignment, size);
+    if (!ptr)
+        return ENOMEM;
+    if (fossil_maip_alloc_owner)
+        fossil_maip_alloc_add(ptr, size, __builtin_return_address(0));
+    *memptr = ptr;
+    return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    void *ptr = __libc_memalign(alignment, size);
+    if (fossil_maip_alloc_owner)
+        fossil_maip_alloc_add(ptr, size, __builtin_return_address(0));
+    return ptr;
+}
+
+bool fossil_maip_alloc_tracking(void)
+{
+    return true;
+}
+
+void fossil_maip_alloc_begin(fossil_maip_alloc_stats_t *stats)
+{
+    fossil_maip_alloc_scope = __atomic_add_fetch(&fossil_maip_alloc_scopes, 1, __ATOMIC_RELAXED);
+    fossil_maip_alloc_owner = stats;
+}
+
+// Adds one leaked block to its site, keeping the sites ordered by bytes
+static void fossil_maip_alloc_leak(fossil_maip_alloc_stats_t *stats, const fossil_maip_alloc_entry_t *entry)
+{
+    stats->leaks++;
+    stats->leaked_bytes += entry->size;
+
+    size_t i = 0;
+    while (i < stats->site_count && stats->sites[i].site != entry->site)
+        ++i;
+    if (i == stats->site_count)
+    {
+        if (i == FOSSIL_MAIP_ALLOC_SITES)
+            return; // Counted in the totals only
+        stats->sites[i].site = entry->site;
+        stats->sites[i].count = 0;
+        stats->sites[i].bytes = 0;
+        stats->site_count++;
+    }
+    stats->sites[i].count++;
+    stats->sites[i].bytes += entry->size;
+
+    for (; i > 0 && stats->sites[i].bytes > stats->sites[i - 1].bytes; --i)
+    {
+        fossil_maip_alloc_site_t swap = stats->sites[i];
+        stats->sites[i] = stats->sites[i - 1];
+        stats->sites[i - 1] = swap;
+    }
+}
+
+void fossil_maip_alloc_end(void)
+{
+    fossil_maip_alloc_stats_t *stats = fossil_maip_alloc_owner;
+    fossil_maip_alloc_owner = null;
+    if (!stats)
+        return;
+
+    fossil_maip_alloc_lock_take();
+    // Erasing shifts later entries back into the current slot, so recheck it
+    for (size_t slot = 0; stats->live_blocks > 0 && slot < fossil_maip_alloc_capacity;)
+    {
+        const fossil_maip_alloc_entry_t *entry = &fossil_maip_alloc_table[slot];
+        if (entry->ptr && entry->scope == fossil_maip_alloc_scope)
+        {
+            fossil_maip_alloc_leak(stats, entry);
+            fossil_maip_alloc_erase(slot);
+        }
+        else
+        {
+            ++slot;
+        }
+    }
+    fossil_maip_alloc_lock_give();
+}
+
+// A timeout or crash may unwind the case from inside the allocator
+static void fossil_maip_alloc_unwind(void)
+{
+    if (fossil_maip_alloc_held)
+        fossil_maip_alloc_lock_give();
+}
+
+#else
+
+bool fossil_maip_alloc_tracking(void)
+{
+    return false;
+}
+
+void fossil_maip_alloc_begin(fossil_maip_alloc_stats_t *stats)
+{
+    (void)stats;
+}
+
+void fossil_maip_alloc_end(void)
+{
+}
+
+static void fossil_maip_alloc_unwind(void)
+{
+}
+
+#endif
+
+// --- Start ---
+static uint64_t fossil_maip_shuffle_seed(const fossil_maip_engine_t *engine);
+
+int fossil_maip_start(fossil_maip_engine_t *engine, int argc, char **argv)
+{
+    if (!engine || !argv)
+        return FOSSIL_MAIP_FAILURE;
+
+    maip_sys_memory_set(engine, 0, sizeof(*engine));
+
+    engine->suites = NULL;
+    engine->count = 0;
+    engine->capacity = 0;
+    engine->score_total = 0;
+    engine->score_possible = 0;
+
+    maip_sys_memory_set(&engine->score, 0, sizeof(engine->score));
+
+    engine->pallet = fossil_maip_pallet_create(argc, argv);
+
+    if (!fossil_maip_fixture_lock_ready && maip_sys_mutex_init(&fossil_maip_fixture_lock) == 0)
+        fossil_maip_fixture_lock_ready = true;
+    if (!fossil_maip_failure_lock_ready && maip_sys_mutex_init(&fossil_maip_failure_lock) == 0)
+        fossil_maip_failure_lock_ready = true;
+    if (!fossil_maip_cause_lock_ready && maip_sys_mutex_init(&fossil_maip_cause_lock) == 0)
+        fossil_maip_cause_lock_ready = true;
+
+    if (engine->pallet.mark.save_baseline || engine->pallet.mark.compare)
+    {
+        if (fossil_benchmark_baseline_open(engine->pallet.mark.save_baseline,
+                                           engine->pallet.mark.compare,
+                                           engine->pallet.mark.threshold) != 0)
+            return FOSSIL_MAIP_FAILURE;
+    }
+
+    if (engine->pallet.run.history)
+    {
+        engine->history = fossil_maip_history_open(engine->pallet.run.history);
+        if (!engine->history)
+            return FOSSIL_MAIP_FAILURE;
+    }
+
+    if (engine->pallet.shuffle.enabled)
+    {
+        engine->rng = (fossil_maip_rng_t *)maip_sys_memory_alloc(sizeof(*engine->rng));
+        if (!engine->rng)
+            return FOSSIL_MAIP_FAILURE;
+        fossil_maip_rng_seed(engine->rng, fossil_maip_shuffle_seed(engine));
+        maip_io_printf("{blue}Shuffle seed: {cyan}%llu{blue} (replay with shuffle --seed %llu){reset}\n",
+                       (unsigned long long)engine->rng->seed, (unsigned long long)engine->rng->seed);
+    }
+
+    fossil_maip_load_groups(engine);
+    if (fossil_maip_selection_compile(engine) != FOSSIL_MAIP_SUCCESS)
+        return FOSSIL_MAIP_FAILURE;
+
+    for (size_t i = 0; i < engine->pallet.run.bundle_count; ++i)
+    {
+        if (fossil_maip_load_bundle(engine, engine->pallet.run.bundles[i]) != FOSSIL_MAIP_SUCCESS)
+            return FOSSIL_MAIP_FAILURE;
+    }
+
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+// --- Add Suite ---
+int fossil_maip_add_suite(fossil_maip_engine_t *engine, fossil_maip_suite_t suite)
+{
+    if (!engine)
+        return FOSSIL_MAIP_FAILURE;
+
+    // Resize if needed
+    if (engine->count >= engine->capacity)
+    {
+        size_t new_cap = engine->capacity ? engine->capacity * 2 : 4;
+        fossil_maip_suite_t *resized = maip_sys_memory_realloc(engine->suites, new_cap * sizeof(*engine->suites));
+        if (!resized)
+            return FOSSIL_MAIP_FAILURE;
+        engine->suites = resized;
+        engine->capacity = new_cap;
+    }
+
+    // Add to engine
+    engine->suites[engine->count++] = suite;
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+// --- Tag Interning ---
+// Every distinct tag gets a bit in the case tag sets. Registration is
+// single-threaded, and the table only grows, for the life of the process.
+
+enum
+{
+    FOSSIL_MAIP_TAG_SLOTS = 512 // Open-addressed index, twice the tag capacity
+};
+
+static char *fossil_maip_tags[FOSSIL_MAIP_TAG_OVERFLOW];
+static size_t fossil_maip_tag_count = 0;
+static uint16_t fossil_maip_tag_slots[FOSSIL_MAIP_TAG_SLOTS]; // Tag index + 1, 0 = free
+
+// Returns the tag's bit, FOSSIL_MAIP_TAG_OVERFLOW once the table is full
+static size_t fossil_maip_tag_intern(const char *text, size_t length)
+{
+    size_t slot = (size_t)fossil_maip_hash64(text, length, 0) & (FOSSIL_MAIP_TAG_SLOTS - 1);
+    for (;; slot = (slot + 1) & (FOSSIL_MAIP_TAG_SLOTS - 1))
+    {
+        uint16_t entry = fossil_maip_tag_slots[slot];
+        if (entry == 0)
+            break;
+        const char *tag = fossil_maip_tags[entry - 1];
+        if (strncmp(tag, text, length) == 0 && tag[length] == '\0')
+            return entry - 1;
+    }
+
+    if (fossil_maip_tag_count >= FOSSIL_MAIP_TAG_OVERFLOW)
+        return FOSSIL_MAIP_TAG_OVERFLOW;
+
+    char *copy = (char *)maip_sys_memory_alloc(length + 1);
+    if (!copy)
+        return FOSSIL_MAIP_TAG_OVERFLOW;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    fossil_maip_tags[fossil_maip_tag_count] = copy;
+    fossil_maip_tag_slots[slot] = (uint16_t)(fossil_maip_tag_count + 1);
+    return fossil_maip_tag_count++;
+}
+
+// Splits the comma-separated tags into the case's tag set
+static void fossil_maip_tag_set_fill(fossil_maip_case_t *test_case)
+{
+    maip_sys_memory_set(test_case->tag_set, 0, sizeof(test_case->tag_set));
+    for (const char *tag = test_case->tags; tag && *tag;)
+    {
+        while (*tag == ',' || *tag == ' ')
+            tag++;
+        size_t length = 0;
+        while (tag[length] && tag[length] != ',')
+            length++;
+        size_t trimmed = length;
+        while (trimmed > 0 && tag[trimmed - 1] == ' ')
+            trimmed--;
+
+        if (trimmed > 0)
+        {
+            size_t bit = fossil_maip_tag_intern(tag, trimmed);
+            test_case->tag_set[bit / 64] |= 1ULL << (bit % 64);
+        }
+        tag += length;
+    }
+}
+
+// --- Add Case ---
+
+int fossil_maip_add_case(fossil_maip_suite_t *suite, fossil_maip_case_t test_case)
+{
+    if (!suite)
+        return FOSSIL_MAIP_FAILURE;
+
+    // Resize case array if needed
+    if (suite->count >= suite->capacity)
+    {
+        size_t new_cap = suite->capacity ? suite->capacity * 2 : 4;
+        fossil_maip_case_t *resized = maip_sys_memory_realloc(suite->cases, new_cap * sizeof(*suite->cases));
+        if (!resized)
+            return FOSSIL_MAIP_FAILURE;
+        suite->cases = resized;
+        suite->capacity = new_cap;
+    }
+
+    // Add test case to suite
+    fossil_maip_tag_set_fill(&test_case);
+    suite->cases[suite->count++] = test_case;
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+// --- Test Group Registry ---
+
+// Filled by constructors before main, so no locking is needed
+static fossil_maip_group_t *fossil_maip_group_head = NULL;
+static fossil_maip_group_t **fossil_maip_group_tail = &fossil_maip_group_head;
+
+void fossil_maip_register_group(fossil_maip_group_t *group)
+{
+    if (!group || group->next || fossil_maip_group_tail == &group->next)
+        return; // Already linked in
+
+    group->next = NULL;
+    *fossil_maip_group_tail = group;
+    fossil_maip_group_tail = &group->next;
+}
+
+const fossil_maip_group_t *fossil_maip_groups(void)
+{
+    return fossil_maip_group_head;
+}
+
+size_t fossil_maip_load_groups(fossil_maip_engine_t *engine)
+{
+    if (!engine)
+        return 0;
+
+    size_t loaded = 0;
+    for (fossil_maip_group_t *group = fossil_maip_group_head; group; group = group->next)
+    {
+        if (group->engine == engine)
+            continue;
+        group->engine = engine;
+        group->load(engine);
+        loaded++;
+    }
+    return loaded;
+}
+
+void fossil_maip_import_group(fossil_maip_engine_t *engine, void (*load)(fossil_maip_engine_t *engine))
+{
+    if (!engine || !load)
+        return;
+
+    for (fossil_maip_group_t *group = fossil_maip_group_head; group; group = group->next)
+    {
+        if (group->load != load)
+            continue;
+        if (group->engine != engine)
+        {
+            group->engine = engine;
+            load(engine);
+        }
+        return;
+    }
+
+    load(engine); // Not registered (built without constructor support)
+}
+
+// --- Update Score ---
+static void fossil_maip_score_record(fossil_maip_score_t *score, const fossil_maip_case_t *test_case)
+{
+    if (test_case->state != FOSSIL_MAIP_CASE_EMPTY)
+    {
+        switch (test_case->state)
+        {
+        case FOSSIL_MAIP_CASE_PASS:
+            score->passed++;
+            break;
+        case FOSSIL_MAIP_CASE_FAIL:
+            score->failed++;
+            break;
+        case FOSSIL_MAIP_CASE_TIMEOUT:
+            score->timeout++;
+            break;
+        case FOSSIL_MAIP_CASE_SKIPPED:
+            score->skipped++;
+            break;
+        case FOSSIL_MAIP_CASE_UNEXPECTED:
+            score->unexpected++;
+            break;
+        case FOSSIL_MAIP_CASE_EMPTY:
+        default:
+            score->empty++;
+            break;
+        }
+    }
+}
+
+static void fossil_maip_score_merge(fossil_maip_score_t *dst, const fossil_maip_score_t *src)
+{
+    dst->passed += src->passed;
+    dst->failed += src->failed;
+    dst->skipped += src->skipped;
+    dst->timeout += src->timeout;
+    dst->unexpected += src->unexpected;
+    dst->empty += src->empty;
+}
+
+static void fossil_maip_update_totals(fossil_maip_suite_t *suite)
+{
+    suite->total_score = suite->score.passed;
+    suite->total_possible = suite->score.passed +
+                            suite->score.failed +
+                            suite->score.timeout +
+                            suite->score.skipped +
+                            suite->score.unexpected +
+                            suite->score.empty;
+}
+
+void fossil_maip_update_score(fossil_maip_case_t *test_case, fossil_maip_suite_t *suite)
+{
+    if (!test_case || !suite)
+        return;
+
+    fossil_maip_score_record(&suite->score, test_case);
+
+    // --- Recompute suite totals for safety ---
+    fossil_maip_update_totals(suite);
+}
+
+// --- Repeat Statistics ---
+
+// Adds one time to the buffer and the running min/max/mean (Welford)
+static int fossil_maip_samples_push(fossil_maip_samples_t *samples, uint64_t elapsed_ns)
+{
+    if (samples->count == samples->capacity)
+    {
+        size_t capacity = samples->capacity ? samples->capacity * 2 : 16;
+        uint64_t *values = (uint64_t *)maip_sys_memory_realloc(samples->values, capacity * sizeof(*values));
+        if (!values)
+            return FOSSIL_MAIP_FAILURE;
+        samples->values = values;
+        samples->capacity = capacity;
+    }
+
+    samples->values[samples->count++] = elapsed_ns;
+    if (samples->count == 1 || elapsed_ns < samples->min_ns)
+        samples->min_ns = elapsed_ns;
+    if (samples->count == 1 || elapsed_ns > samples->max_ns)
+        samples->max_ns = elapsed_ns;
+
+    double delta = (double)elapsed_ns - samples->mean_ns;
+    samples->mean_ns += delta / (double)samples->count;
+    samples->m2 += delta * ((double)elapsed_ns - samples->mean_ns);
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+// Empties the buffer for another run of the case, keeping its storage
+static void fossil_maip_samples_reset(fossil_maip_samples_t *samples)
+{
+    uint64_t *values = samples->values;
+    size_t capacity = samples->capacity;
+    maip_sys_memory_set(samples, 0, sizeof(*samples));
+    samples->values = values;
+    samples->capacity = capacity;
+}
+
+int fossil_maip_samples_add(fossil_maip_samples_t *samples, uint64_t elapsed_ns, fossil_maip_state_t state)
+{
+    if (!samples || fossil_maip_samples_push(samples, elapsed_ns) != FOSSIL_MAIP_SUCCESS)
+        return FOSSIL_MAIP_FAILURE;
+    if ((unsigned)state <= FOSSIL_MAIP_CASE_UNEXPECTED)
+        samples->outcomes[state]++;
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+double fossil_maip_samples_stddev(const fossil_maip_samples_t *samples)
+{
+    if (!samples || samples->count < 2)
+        return 0.0;
+    return sqrt(samples->m2 / (double)(samples->count - 1));
+}
+
+uint64_t fossil_maip_samples_percentile(const fossil_maip_samples_t *samples, double percent)
+{
+    if (!samples || samples->count == 0)
+        return 0;
+    if (percent <= 0.0)
+        return samples->min_ns;
+    if (percent >= 100.0)
+        return samples->max_ns;
+
+    // Nearest rank, found by quickselect on a copy so the run order is kept
+    size_t rank = (size_t)ceil(percent / 100.0 * (double)samples->count);
+    size_t k = rank > 0 ? rank - 1 : 0;
+    uint64_t *work = (uint64_t *)maip_sys_memory_alloc(samples->count * sizeof(*work));
+    if (!work)
+        return 0;
+    memcpy(work, samples->values, samples->count * sizeof(*work));
+
+    size_t lo = 0, hi = samples->count - 1;
+    while (lo < hi)
+    {
+        uint64_t pivot = work[lo + (hi - lo) / 2];
+        size_t i = lo, j = hi;
+        while (i <= j)
+        {
+            while (work[i] < pivot)
+                i++;
+            while (work[j] > pivot)
+                j--;
+            if (i <= j)
+            {
+                uint64_t tmp = work[i];
+                work[i] = work[j];
+                work[j] = tmp;
+                i++;
+                if (j == 0)
+                    break;
+                j--;
+            }
+        }
+        if (k <= j)
+            hi = j;
+        else if (k >= i)
+            lo = i;
+        else
+            break;
+    }
+
+    uint64_t value = work[k];
+    maip_sys_memory_free(work);
+    return value;
+}
+
+void fossil_maip_samples_free(fossil_maip_samples_t *samples)
+{
+    if (!samples)
+        return;
+    maip_sys_memory_free(samples->values);
+    maip_sys_memory_free(samples);
+}
+
+// --- Show Test Cases ---
+
+// Plain result name, as used by --result and the report sinks
+static const char *fossil_maip_state_name(fossil_maip_state_t state)
+{
+    switch (state)
+    {
+    case FOSSIL_MAIP_CASE_EMPTY:
+        return "empty";
+    case FOSSIL_MAIP_CASE_PASS:
+        return "pass";
+    case FOSSIL_MAIP_CASE_FAIL:
+        return "fail";
+    case FOSSIL_MAIP_CASE_TIMEOUT:
+        return "timeout";
+    case FOSSIL_MAIP_CASE_SKIPPED:
+        return "skipped";
+    case FOSSIL_MAIP_CASE_UNEXPECTED:
+        return "unexpected";
+    default:
+        return "unknown";
+    }
+}
+
+// Formats nanoseconds into a human-readable string and returns a heap-allocated string
+char *fossil_maip_format_ns(uint64_t ns)
+{
+    uint64_t hours = ns / 3600000000000ULL;
+    uint64_t minutes = (ns % 3600000000000ULL) / 60000000000ULL;
+    uint64_t seconds = (ns % 60000000000ULL) / 1000000000ULL;
+    uint64_t microseconds = (ns % 1000000000ULL) / 1000ULL;
+    uint64_t nanoseconds = ns % 1000ULL;
+    char *buffer = (char *)maip_sys_memory_alloc(32);
+
+    if (buffer)
+    {
+        snprintf(buffer, 32, "%02lu:%02lu:%02lu.%06lu,%03lu",
+                 (unsigned long)hours,
+                 (unsigned long)minutes,
+                 (unsigned long)seconds,
+                 (unsigned long)microseconds,
+                 (unsigned long)nanoseconds);
+    }
+
+    return buffer;
+}
+
+// Writes a duration with a unit that keeps 3-4 significant digits
+static const char *fossil_maip_format_span(uint64_t ns, char *buffer, size_t size)
+{
+    if (ns < 1000ULL)
+        snprintf(buffer, size, "%lluns", (unsigned long long)ns);
+    else if (ns < 1000000ULL)
+        snprintf(buffer, size, "%.3fus", (double)ns / 1e3);
+    else if (ns < 1000000000ULL)
+        snprintf(buffer, size, "%.3fms", (double)ns / 1e6);
+    else
+        snprintf(buffer, size, "%.3fs", (double)ns / 1e9);
+    return buffer;
+}
+
+// One line of --repeat statistics under a case
+static void fossil_maip_show_samples(const fossil_maip_samples_t *samples)
+{
+    char min[24], mean[24], max[24], dev[24], p50[24], p90[24], p99[24];
+    maip_io_printf("    {cyan}repeat{reset} x%zu {gray}min{reset} %s {gray}mean{reset} %s {gray}max{reset} %s {gray}stddev{reset} %s {gray}p50{reset} %s {gray}p90{reset} %s {gray}p99{reset} %s",
+                   samples->count,
+                   fossil_maip_format_span(samples->min_ns, min, sizeof(min)),
+                   fossil_maip_format_span((uint64_t)(samples->mean_ns + 0.5), mean, sizeof(mean)),
+                   fossil_maip_format_span(samples->max_ns, max, sizeof(max)),
+                   fossil_maip_format_span((uint64_t)(fossil_maip_samples_stddev(samples) + 0.5), dev, sizeof(dev)),
+                   fossil_maip_format_span(fossil_maip_samples_percentile(samples, 50.0), p50, sizeof(p50)),
+                   fossil_maip_format_span(fossil_maip_samples_percentile(samples, 90.0), p90, sizeof(p90)),
+                   fossil_maip_format_span(fossil_maip_samples_percentile(samples, 99.0), p99, sizeof(p99)));
+    for (int state = 0; state <= FOSSIL_MAIP_CASE_UNEXPECTED; ++state)
+    {
+        if (samples->outcomes[state] > 0)
+            maip_io_printf(" {gray}%s{reset} %d", fossil_maip_state_name((fossil_maip_state_t)state), samples->outcomes[state]);
+    }
+    maip_io_printf("\n");
+}
+
+// Writes a byte count with a binary unit
+static const char *fossil_maip_format_bytes(size_t bytes, char *buffer, size_t size)
+{
+    if (bytes < 1024)
+        snprintf(buffer, size, "%zuB", bytes);
+    else if (bytes < 1024 * 1024)
+        snprintf(buffer, size, "%.1fKiB", (double)bytes / 1024.0);
+    else if (bytes < 1024 * 1024 * 1024)
+        snprintf(buffer, size, "%.1fMiB", (double)bytes / (1024.0 * 1024.0));
+    else
+        snprintf(buffer, size, "%.1fGiB", (double)bytes / (1024.0 * 1024.0 * 1024.0));
+    return buffer;
+}
+
+// Heap use under a case, then one line per leaking call site
+static void fossil_maip_show_alloc(const fossil_maip_alloc_stats_t *alloc)
+{
+    char bytes[24], peak[24], leaked[24];
+    maip_io_printf("    {cyan}memory{reset} %zu {gray}allocs{reset} %s {gray}peak{reset} %s {gray}frees{reset} %zu",
+                   alloc->allocations,
+                   fossil_maip_format_bytes(alloc->bytes, bytes, sizeof(bytes)),
+                   fossil_maip_format_bytes(alloc->peak_bytes, peak, sizeof(peak)),
+                   alloc->frees);
+    if (alloc->leaks == 0)
+    {
+        maip_io_printf("\n");
+        return;
+    }
+    maip_io_printf(" {red}leaked %zu block%s (%s){reset}\n", alloc->leaks, alloc->leaks == 1 ? "" : "s",
+                   fossil_maip_format_bytes(alloc->leaked_bytes, leaked, sizeof(leaked)));
+
+    void *sites[FOSSIL_MAIP_ALLOC_SITES];
+    for (size_t i = 0; i < alloc->site_count; ++i)
+        sites[i] = alloc->sites[i].site;
+#ifdef FOSSIL_MAIP_HAVE_BACKTRACE
+    char **names = backtrace_symbols(sites, (int)alloc->site_count);
+#endif
+    for (size_t i = 0; i < alloc->site_count; ++i)
+    {
+#ifdef FOSSIL_MAIP_HAVE_BACKTRACE
+        if (names)
+        {
+            maip_io_printf("      {red}%s{reset} {gray}in %zu block%s from{reset} %s\n",
+                           fossil_maip_format_bytes(alloc->sites[i].bytes, leaked, sizeof(leaked)),
+                           alloc->sites[i].count, alloc->sites[i].count == 1 ? "" : "s", names[i]);
+            continue;
+        }
+#endif
+        maip_io_printf("      {red}%s{reset} {gray}in %zu block%s from{reset} %p\n",
+                       fossil_maip_format_bytes(alloc->sites[i].bytes, leaked, sizeof(leaked)),
+                       alloc->sites[i].count, alloc->sites[i].count == 1 ? "" : "s", sites[i]);
+    }
+#ifdef FOSSIL_MAIP_HAVE_BACKTRACE
+    free(names);
+#endif
+}
+
+void fossil_maip_show_cases(const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case, const fossil_maip_engine_t *engine)
+{
+    if (!test_case || (engine && engine->quiet))
+        return;
+
+    // Determine mode (list, tree, graph), default to list
+    const char *mode = (engine && engine->pallet.show.mode) ? engine->pallet.show.mode : "list";
+
+    const char *result_str =
+        (test_case->state == FOSSIL_MAIP_CASE_EMPTY) ? "{cyan}empty{reset}" : (test_case->state == FOSSIL_MAIP_CASE_PASS)     ? "{green}pass{reset}"
+                                                                            : (test_case->state == FOSSIL_MAIP_CASE_FAIL)       ? "{red}fail{reset}"
+                                                                            : (test_case->state == FOSSIL_MAIP_CASE_TIMEOUT)    ? "{yellow}timeout{reset}"
+                                                                            : (test_case->state == FOSSIL_MAIP_CASE_SKIPPED)    ? "{yellow}skipped{reset}"
+                                                                            : (test_case->state == FOSSIL_MAIP_CASE_UNEXPECTED) ? "{magenta}unexpected{reset}"
+                                                                                                                                  : "{white}unknown{reset}";
+
+    // Filtering logic
+    // Apply filters only if they are set (not NULL)
+    if (engine && engine->pallet.show.test_name)
+    {
+        if (maip_io_cstr_compare(test_case->name, engine->pallet.show.test_name) != 0)
+            return;
+    }
+
+    if (engine && engine->pallet.show.name)
+    {
+        if (maip_io_cstr_compare(suite->name, engine->pallet.show.name) != 0)
+            return;
+    }
+
+    if (engine && engine->pallet.show.tag)
+    {
+        if (!test_case->tags || !strstr(test_case->tags, engine->pallet.show.tag))
+            return;
+    }
+
+    // Result filtering: extract plain result value for comparison
+    if (engine && engine->pallet.show.result)
+    {
+        const char *result_plain = fossil_maip_state_name(test_case->state);
+
+        if (maip_io_cstr_compare(result_plain, engine->pallet.show.result) != 0)
+            return;
+    }
+
+    // Output according to mode and theme
+    if (maip_io_cstr_compare(mode, "tree") == 0)
+    {
+        switch (engine ? engine->pallet.theme : MAIP_THEME_FOSSIL)
+        {
+        case MAIP_THEME_FOSSIL:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset} {blue}[test case]{reset}\n", test_case->name);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset} {orange}[with tag]{reset}\n", test_case->tags);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset} {orange}[given criteria]{reset}\n", test_case->criteria);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset} {orange}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset} {orange}[the result]{reset}\n", result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("  {blue}::TEST       :: %s{reset}\n", test_case->name);
+                maip_io_printf("    {blue}::TAGS     :: %s{reset}\n", test_case->tags);
+                maip_io_printf("    {blue}::CRITERIA :: %s{reset}\n", test_case->criteria);
+                maip_io_printf("    {blue}::TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("    {blue}::RESULT   :: %s{reset}\n", result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset}\n", test_case->name);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset}\n", test_case->tags);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset}\n", test_case->criteria);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset}\n", result_str);
+            }
+            break;
+        case MAIP_THEME_LIGHT:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("  {bright_blue}├─{reset} {bright_cyan}%s{reset} {bright_blue}[test case]{reset}\n", test_case->name);
+                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Tags    {reset}: {gray}%s{reset} {orange}[with tag]{reset}\n", test_case->tags);
+                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Criteria{reset}: {gray}%s{reset} {orange}[given criteria]{reset}\n", test_case->criteria);
+                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Time    {reset}: {gray}%s{reset} {orange}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {bright_blue}│   └─{reset} {bright_cyan}Result  {reset}: {gray}%s{reset} {orange}[the result]{reset}\n", result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("  {bright_blue}::TEST       :: %s{reset}\n", test_case->name);
+                maip_io_printf("    {bright_blue}::TAGS     :: %s{reset}\n", test_case->tags);
+                maip_io_printf("    {bright_blue}::CRITERIA :: %s{reset}\n", test_case->criteria);
+                maip_io_printf("    {bright_blue}::TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("    {bright_blue}::RESULT   :: %s{reset}\n", result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("  {bright_blue}├─{reset} {bright_cyan}%s{reset}\n", test_case->name);
+                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Tags    {reset}: {gray}%s{reset}\n", test_case->tags);
+                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Criteria{reset}: {gray}%s{reset}\n", test_case->criteria);
+                maip_io_printf("  {bright_blue}│   ├─{reset} {bright_cyan}Time    {reset}: {gray}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {bright_blue}│   └─{reset} {bright_cyan}Result  {reset}: {gray}%s{reset}\n", result_str);
+            }
+            break;
+        case MAIP_THEME_DARK:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset} {blue}[test case]{reset}\n", test_case->name);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset} {orange}[with tag]{reset}\n", test_case->tags);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset} {orange}[given criteria]{reset}\n", test_case->criteria);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset} {orange}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset} {orange}[the result]{reset}\n", result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("  {blue}::TEST       :: %s{reset}\n", test_case->name);
+                maip_io_printf("    {blue}::TAGS     :: %s{reset}\n", test_case->tags);
+                maip_io_printf("    {blue}::CRITERIA :: %s{reset}\n", test_case->criteria);
+                maip_io_printf("    {blue}::TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("    {blue}::RESULT   :: %s{reset}\n", result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("  {blue}├─{reset} {cyan}%s{reset}\n", test_case->name);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Tags    {reset}: {gray}%s{reset}\n", test_case->tags);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Criteria{reset}: {gray}%s{reset}\n", test_case->criteria);
+                maip_io_printf("  {blue}│   ├─{reset} {cyan}Time    {reset}: {gray}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {blue}│   └─{reset} {cyan}Result  {reset}: {gray}%s{reset}\n", result_str);
+            }
+            break;
+        case MAIP_THEME_MAGA:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("  {blue}├─{reset} {white}%s{reset} {red}[test case]{reset}\n", test_case->name);
+                maip_io_printf("  {blue}│   ├─{reset} {white}Tags    {reset}: {blue}%s{reset} {white}[with tag]{reset}\n", test_case->tags);
+                maip_io_printf("  {blue}│   ├─{reset} {red}Criteria{reset}: {blue}%s{reset} {red}[given criteria]{reset}\n", test_case->criteria);
+                maip_io_printf("  {blue}│   ├─{reset} {white}Time    {reset}: {blue}%s{reset} {white}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {blue}│   └─{reset} {red}Result  {reset}: {blue}%s{reset} {red}[the result]{reset}\n", result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("  {blue}::TEST       :: %s{reset}\n", test_case->name);
+                maip_io_printf("    {blue}::TAGS     :: {white}%s{reset}\n", test_case->tags);
+                maip_io_printf("    {blue}::CRITERIA :: {red}%s{reset}\n", test_case->criteria);
+                maip_io_printf("    {blue}::TIME     :: {white}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("    {blue}::RESULT   :: {red}%s{reset}\n", result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("  {blue}├─{reset} {white}%s{reset}\n", test_case->name);
+                maip_io_printf("  {blue}│   ├─{reset} {white}Tags    {reset}: {blue}%s{reset}\n", test_case->tags);
+                maip_io_printf("  {blue}│   ├─{reset} {red}Criteria{reset}: {blue}%s{reset}\n", test_case->criteria);
+                maip_io_printf("  {blue}│   ├─{reset} {white}Time    {reset}: {blue}%s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {blue}│   └─{reset} {red}Result  {reset}: {blue}%s{reset}\n", result_str);
+            }
+            break;
+        case MAIP_THEME_MINT:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("  {green}├─{white}%s{reset} {green}[test case]{reset}\n", test_case->name);
+                maip_io_printf("  {green}│   ├─{white}Tags    {reset}: {green}%s{white}[with tag]{reset}\n", test_case->tags);
+                maip_io_printf("  {green}│   ├─{white}Criteria{reset}: {green}%s{white}[given criteria]{reset}\n", test_case->criteria);
+                maip_io_printf("  {green}│   ├─{white}Time    {reset}: {green}%s{white}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {green}│   └─{white}Result  {reset}: {green}%s{white}[the result]{reset}\n", result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("  {green}::{white}TEST       :: %s{reset}\n", test_case->name);
+                maip_io_printf("    {green}::{white}TAGS     :: %s{reset}\n", test_case->tags);
+                maip_io_printf("    {green}::{white}CRITERIA :: %s{reset}\n", test_case->criteria);
+                maip_io_printf("    {green}::{white}TIME     :: %s{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("    {green}::{white}RESULT   :: %s{reset}\n", result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("  {green}├─{bright_green}%s{reset}\n", test_case->name);
+                maip_io_printf("  {green}│   ├─{white}Tags    {reset}: {green}%s{white}[with tag]{reset}\n", test_case->tags);
+                maip_io_printf("  {green}│   ├─{white}Criteria{reset}: {green}%s{white}[given criteria]{reset}\n", test_case->criteria);
+                maip_io_printf("  {green}│   ├─{white}Time    {reset}: {green}%s{white}[the time]{reset}\n", fossil_maip_format_ns(test_case->elapsed_ns));
+                maip_io_printf("  {green}│   └─{white}Result  {reset}: {green}%s{white}[the result]{reset}\n", result_str);
+            }
+            break;
+        default:
+            maip_io_printf("- %s (Tags: %s, Criteria: %s, Time: %s, Result: %s)\n",
+                            test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            break;
+        }
+    }
+    else if (maip_io_cstr_compare(mode, "graph") == 0)
+    {
+        switch (engine ? engine->pallet.theme : MAIP_THEME_FOSSIL)
+        {
+        case MAIP_THEME_FOSSIL:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} {blue}[test case]{reset} --[{orange}tags:{reset}{white}%s{reset} {orange}[with tag]{reset},{orange}criteria:{reset}{white}%s{reset} {orange}[given criteria]{reset},{orange}time:{reset}{white}%s{reset} {orange}[the time]{reset},{orange}result:{reset}%s {orange}[the result]{reset}]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{cyan}CASE{gray}:: {cyan}%s{reset} --[{orange}::TAGS::{reset}{white} %s{reset},{orange}::CRITERIA::{reset}{white} %s{reset},{orange}::TIME::{reset}{white} %s{reset},{orange}::RESULT::{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} --[{orange}tags:{reset}{white}%s{reset},{orange}criteria:{reset}{white}%s{reset},{orange}time:{reset}{white}%s{reset},{orange}result:{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_LIGHT:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {bright_cyan}%s{reset} {bright_blue}[test case]{reset} --[{orange}tags:{reset}{white}%s{reset} {orange}[with tag]{reset},{orange}criteria:{reset}{white}%s{reset} {orange}[given criteria]{reset},{orange}time:{reset}{white}%s{reset} {orange}[the time]{reset},{orange}result:{reset}%s {orange}[the result]{reset}]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{cyan}CASE{gray}:: {bright_cyan}%s{reset} --[{orange}::TAGS::{reset}{white} %s{reset},{orange}::CRITERIA::{reset}{white} %s{reset},{orange}::TIME::{reset}{white} %s{reset},{orange}::RESULT::{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {bright_cyan}%s{reset} --[{orange}tags:{reset}{white}%s{reset},{orange}criteria:{reset}{white}%s{reset},{orange}time:{reset}{white}%s{reset},{orange}result:{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_DARK:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} {blue}[test case]{reset} --[{orange}tags:{reset}{white}%s{reset} {orange}[with tag]{reset},{orange}criteria:{reset}{white}%s{reset} {orange}[given criteria]{reset},{orange}time:{reset}{white}%s{reset} {orange}[the time]{reset},{orange}result:{reset}%s {orange}[the result]{reset}]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{cyan}CASE{gray}:: {cyan}%s{reset} --[{orange}::TAGS::{reset}{white} %s{reset},{orange}::CRITERIA::{reset}{white} %s{reset},{orange}::TIME::{reset}{white} %s{reset},{orange}::RESULT::{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} --[{orange}tags:{reset}{white}%s{reset},{orange}criteria:{reset}{white}%s{reset},{orange}time:{reset}{white}%s{reset},{orange}result:{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_MAGA:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} {red}[test case]{reset} --[{red}tags:{reset}{white}%s{reset} {red}[with tag]{reset},{red}criteria:{reset}{white}%s{reset} {red}[given criteria]{reset},{red}time:{reset}{white}%s{reset} {red}[the time]{reset},{red}result:{reset}%s {red}[the result]{reset}]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{red}CASE{gray}:: {white}%s{reset} --[{red}::TAGS::{reset}{white} %s{reset},{red}::CRITERIA::{reset}{white} %s{reset},{red}::TIME::{reset}{white} %s{reset},{red}::RESULT::{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} --[{red}tags:{reset}{white}%s{reset},{red}criteria:{reset}{white}%s{reset},{red}time:{reset}{white}%s{reset},{red}result:{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_MINT:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} {green}[test case]{reset} --[{green}tags:{reset}{bright_green}%s{reset} {green}[with tag]{reset},{green}criteria:{reset}{bright_green}%s{reset} {green}[given criteria]{reset},{green}time:{reset}{bright_green}%s{reset} {green}[the time]{reset},{green}result:{reset}%s {green}[the result]{reset}]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{green}CASE{gray}:: {white}%s{reset} --[{green}::TAGS::{reset}{bright_green} %s{reset},{green}::CRITERIA::{reset}{bright_green} %s{reset},{green}::TIME::{reset}{bright_green} %s{reset},{green}::RESULT::{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} --[{green}tags:{reset}{bright_green}%s{reset},{green}criteria:{reset}{bright_green}%s{reset},{green}time:{reset}{bright_green}%s{reset},{green}result:{reset} %s]\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        default:
+            maip_io_printf("- %s (Tags: %s, Criteria: %s, Time: %s, Result: %s)\n",
+                            test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            break;
+        }
+    }
+    else
+    { // list (default)
+        switch (engine ? engine->pallet.theme : MAIP_THEME_FOSSIL)
+        {
+        case MAIP_THEME_FOSSIL:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} {orange}[test case]{reset} ({orange}Tags:{reset} {white}%s{reset} {orange}[with tag]{reset}, {orange}Criteria:{reset} {white}%s{reset} {orange}[given criteria]{reset}, {orange}Time:{reset} {white}%s{reset} {orange}[the time]{reset}, {orange}Result:{reset} %s {orange}[the result]{reset})\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{cyan}CASE{gray}:: {cyan}%s{reset} ( {orange}::TAGS::{reset} {white}%s{reset}, {orange}::CRITERIA::{reset} {white}%s{reset}, {orange}::TIME::{reset} {white}%s{reset}, {orange}::RESULT::{reset} %s )\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{blue}CASE{gray}] {cyan}%s{reset} ({orange}Tags:{reset} {white}%s{reset}, {orange}Criteria:{reset} {white}%s{reset}, {orange}Time:{reset} {white}%s{reset}, {orange}Result:{reset} %s)\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_LIGHT:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{bright_blue}CASE{gray}] {cyan}%s{reset} {orange}[test case]{reset} ({orange}Tags:{reset} {white}%s{reset} {orange}[with tag]{reset}, {orange}Criteria:{reset} {white}%s{reset} {orange}[given criteria]{reset}, {orange}Time:{reset} {white}%s{reset} {orange}[the time]{reset}, {orange}Result:{reset} %s {orange}[the result]{reset})\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{bright_blue}CASE{gray}:: {cyan}%s{reset} ( {orange}::TAGS::{reset} {white}%s{reset}, {orange}::CRITERIA::{reset} {white}%s{reset}, {orange}::TIME::{reset} {white}%s{reset}, {orange}::RESULT::{reset} %s )\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{bright_blue}CASE{gray}] {cyan}%s{reset} ({orange}Tags:{reset} {white}%s{reset}, {orange}Criteria:{reset} {white}%s{reset}, {orange}Time:{reset} {white}%s{reset}, {orange}Result:{reset} %s)\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_DARK:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{blue}CASE{gray}] {cyan}%s{reset} {orange}[test case]{reset} ({orange}Tags:{reset} {white}%s{reset} {orange}[with tag]{reset}, {orange}Criteria:{reset} {white}%s{reset} {orange}[given criteria]{reset}, {orange}Time:{reset} {white}%s{reset} {orange}[the time]{reset}, {orange}Result:{reset} %s {orange}[the result]{reset})\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{blue}CASE{gray}:: {cyan}%s{reset} ( {orange}::TAGS::{reset} {white}%s{reset}, {orange}::CRITERIA::{reset} {white}%s{reset}, {orange}::TIME::{reset} {white}%s{reset}, {orange}::RESULT::{reset} %s )\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{blue}CASE{gray}] {cyan}%s{reset} ({orange}Tags:{reset} {white}%s{reset}, {orange}Criteria:{reset} {white}%s{reset}, {orange}Time:{reset} {white}%s{reset}, {orange}Result:{reset} %s)\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_MAGA:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} {red}[test case]{reset} ({red}Tags:{reset} {white}%s{reset} {red}[with tag]{reset}, {red}Criteria:{reset} {white}%s{reset} {red}[given criteria]{reset}, {red}Time:{reset} {white}%s{reset} {red}[the time]{reset}, {red}Result:{reset} %s {red}[the result]{reset})\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{red}CASE{gray}:: {white}%s{reset} ( {red}::TAGS::{reset} {white}%s{reset}, {red}::CRITERIA::{reset} {white}%s{reset}, {red}::TIME::{reset} {white}%s{reset}, {red}::RESULT::{reset} %s )\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} ({red}Tags:{reset} {white}%s{reset}, {red}Criteria:{reset} {white}%s{reset}, {red}Time:{reset} {white}%s{reset}, {red}Result:{reset} %s)\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        case MAIP_THEME_MINT:
+            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
+            {
+                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} {green}[test case]{reset} ({green}Tags:{reset} {white}%s{reset} {green}[with tag]{reset}, {green}Criteria:{reset} {white}%s{reset} {green}[given criteria]{reset}, {green}Time:{reset} {white}%s{reset} {green}[the time]{reset}, {green}Result:{reset} %s {green}[the result]{reset})\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
+            {
+                maip_io_printf("{gray}::{green}CASE{gray}:: {white}%s{reset} ( {green}::TAGS::{reset} {white}%s{reset}, {green}::CRITERIA::{reset} {white}%s{reset}, {green}::TIME::{reset} {white}%s{reset}, {green}::RESULT::{reset} %s )\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            else
+            { // plain or default
+                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} ({green}Tags:{reset} {white}%s{reset}, {green}Criteria:{reset} {white}%s{reset}, {green}Time:{reset} {white}%s{reset}, {green}Result:{reset} %s)\n",
+                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            }
+            break;
+        default:
+            maip_io_printf("- %s (Tags: %s, Criteria: %s, Time: %s, Result: %s)\n",
+                            test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+            break;
+        }
+    }
+
+    if (test_case->samples && test_case->samples->count > 1)
+        fossil_maip_show_samples(test_case->samples);
+    if (test_case->alloc && test_case->alloc->allocations > 0)
+        fossil_maip_show_alloc(test_case->alloc);
+}
+
+// --- Run One Test ---
+
+// Utility function to convert seconds to nanoseconds
+static uint64_t seconds_to_nanoseconds(uint64_t seconds)
+{
+    return seconds * 1000000000ULL;
+}
+
+// from sanity, should be implemented and placed in common.c
+extern uint64_t get_maip_time_microseconds(void);
+
+// Keeps a multi-line case report together when workers print concurrently;
+// the stream lock is recursive so nested maip_io_printf calls are fine.
+static void fossil_maip_output_lock(void)
+{
+    maip_io_lock();
+}
+
+static void fossil_maip_output_unlock(void)
+{
+    maip_io_unlock();
+}
+
+// --- Report Sinks ---
+
+// Streams one record per finished case to --destination as it completes.
+// The stream is fully buffered and nothing but a running score is kept, so
+// memory stays flat however large the run is.
+typedef enum
+{
+    FOSSIL_MAIP_REPORT_NONE,
+    FOSSIL_MAIP_REPORT_JSONL,
+    FOSSIL_MAIP_REPORT_JUNIT,
+    FOSSIL_MAIP_REPORT_CSV,
+    FOSSIL_MAIP_REPORT_TAP,
+    FOSSIL_MAIP_REPORT_YAML
+} fossil_maip_report_format_t;
+
+#define FOSSIL_MAIP_REPORT_BUFFER 65536
+
+static struct
+{
+    fossil_maip_report_format_t format;
+    FILE *out;
+    char *buffer;
+    size_t count;              // records written; numbers the TAP lines
+    fossil_maip_score_t score; // totals for the closing record
+    maip_sys_mutex_t lock;     // workers finish cases concurrently
+    const fossil_maip_engine_t *engine; // only this engine's cases are recorded
+} fossil_maip_report;
+
+// Double-quoted JSON string; also valid as a YAML double-quoted scalar
+static void fossil_maip_report_json_string(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)(text ? text : ""); *p; ++p)
+    {
+        switch (*p)
+        {
+        case '"':
+            fputs("\\\"", out);
+            break;
+        case '\\':
+            fputs("\\\\", out);
+            break;
+        case '\n':
+            fputs("\\n", out);
+            break;
+        case '\r':
+            fputs("\\r", out);
+            break;
+        case '\t':
+            fputs("\\t", out);
+            break;
+        default:
+            if (*p < 0x20)
+                fprintf(out, "\\u%04x", *p);
+            else
+                fputc(*p, out);
+            break;
+        }
+    }
+    fputc('"', out);
+}
+
+static void fossil_maip_report_xml_string(FILE *out, const char *text)
+{
+    for (const unsigned char *p = (const unsigned char *)(text ? text : ""); *p; ++p)
+    {
+        switch (*p)
+        {
+        case '&':
+            fputs("&amp;", out);
+            break;
+        case '<':
+            fputs("&lt;", out);
+            break;
+        case '>':
+            fputs("&gt;", out);
+            break;
+        case '"':
+            fputs("&quot;", out);
+            break;
+        case '\'':
+            fputs("&apos;", out);
+            break;
+        default:
+            if (*p < 0x20 && *p != '\t' && *p != '\n' && *p != '\r')
+                fputc(' ', out); // not representable in XML 1.0
+            else
+                fputc(*p, out);
+            break;
+        }
+    }
+}
+
+static void fossil_maip_report_csv_string(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (const char *p = text ? text : ""; *p; ++p)
+    {
+        if (*p == '"')
+            fputc('"', out);
+        fputc(*p, out);
+    }
+    fputc('"', out);
+}
+
+static void fossil_maip_report_open(const fossil_maip_engine_t *engine)
+{
+    const char *format = engine->pallet.report.format;
+    const char *destination = engine->pallet.report.destination;
+
+    maip_sys_memory_set(&fossil_maip_report, 0, sizeof(fossil_maip_report));
+    if (!format)
+        return;
+
+    fossil_maip_report_format_t kind = FOSSIL_MAIP_REPORT_NONE;
+    if (maip_io_cstr_compare(format, "json") == 0 || maip_io_cstr_compare(format, "jsonl") == 0)
+        kind = FOSSIL_MAIP_REPORT_JSONL;
+    else if (maip_io_cstr_compare(format, "junit") == 0 || maip_io_cstr_compare(format, "xml") == 0)
+        kind = FOSSIL_MAIP_REPORT_JUNIT;
+    else if (maip_io_cstr_compare(format, "csv") == 0)
+        kind = FOSSIL_MAIP_REPORT_CSV;
+    else if (maip_io_cstr_compare(format, "tap") == 0)
+        kind = FOSSIL_MAIP_REPORT_TAP;
+    else if (maip_io_cstr_compare(format, "yaml") == 0)
+        kind = FOSSIL_MAIP_REPORT_YAML;
+    else
+    {
+        maip_io_printf("{red}Unsupported report format: %s{reset}\n", format);
+        return;
+    }
+
+    FILE *out = stdout;
+    if (!destination || maip_io_cstr_compare(destination, "stdout") == 0)
+    {
+        // The report keeps the original stdout to itself; case lines, the
+        // summary and anything the cases print go to stderr instead.
+        fflush(stdout);
+        int fd = dup(fileno(stdout));
+        FILE *report = fd >= 0 ? fdopen(fd, "w") : null;
+        if (report && dup2(fileno(stderr), fileno(stdout)) >= 0)
+            out = report;
+        else if (report)
+            fclose(report);
+        else if (fd >= 0)
+            close(fd);
+    }
+    else
+    {
+        out = fopen(destination, "w");
+        if (!out)
+        {
+            maip_io_printf("{red}Cannot open report destination: %s{reset}\n", destination);
+            return;
+        }
+        fossil_maip_report.buffer = (char *)maip_sys_memory_alloc(FOSSIL_MAIP_REPORT_BUFFER);
+        if (fossil_maip_report.buffer)
+            setvbuf(out, fossil_maip_report.buffer, _IOFBF, FOSSIL_MAIP_REPORT_BUFFER);
+    }
+
+    if (maip_sys_mutex_init(&fossil_maip_report.lock) != 0)
+    {
+        if (out != stdout)
+            fclose(out);
+        maip_sys_memory_free(fossil_maip_report.buffer);
+        fossil_maip_report.buffer = null;
+        return;
+    }
+    fossil_maip_report.format = kind;
+    fossil_maip_report.out = out;
+    fossil_maip_report.engine = engine;
+
+    switch (kind)
+    {
+    case FOSSIL_MAIP_REPORT_JUNIT:
+        fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n", out);
+        break;
+    case FOSSIL_MAIP_REPORT_CSV:
+        fputs("suite,case,tags,result,elapsed_ns,message,"
+              "iterations,min_ns,mean_ns,max_ns,stddev_ns,p50_ns,p90_ns,p99_ns,"
+              "allocations,alloc_bytes,peak_bytes,leaks,leaked_bytes\n", out);
+        break;
+    case FOSSIL_MAIP_REPORT_TAP:
+        fputs("TAP version 13\n", out);
+        break;
+    case FOSSIL_MAIP_REPORT_YAML:
+        fputs("cases:\n", out);
+        break;
+    default:
+        break;
+    }
+}
+
+static void fossil_maip_report_suite(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite, bool begin)
+{
+    if (fossil_maip_report.engine != engine)
+        return;
+
+    // JSON Lines closes each suite with its elapsed time, for shard merging
+    if (fossil_maip_report.format == FOSSIL_MAIP_REPORT_JSONL && !begin)
+    {
+        maip_sys_mutex_lock(&fossil_maip_report.lock);
+        fputs("{\"type\":\"suite\",\"suite\":", fossil_maip_report.out);
+        fossil_maip_report_json_string(fossil_maip_report.out, suite->name);
+        fprintf(fossil_maip_report.out, ",\"elapsed_ns\":%llu}\n", (unsigned long long)suite->time_elapsed_ns);
+        maip_sys_mutex_unlock(&fossil_maip_report.lock);
+        return;
+    }
+    if (fossil_maip_report.format != FOSSIL_MAIP_REPORT_JUNIT)
+        return;
+
+    maip_sys_mutex_lock(&fossil_maip_report.lock);
+    if (begin)
+    {
+        fputs("  <testsuite name=\"", fossil_maip_report.out);
+        fossil_maip_report_xml_string(fossil_maip_report.out, suite->name);
+        fputs("\">\n", fossil_maip_report.out);
+    }
+    else
+    {
+        fputs("  </testsuite>\n", fossil_maip_report.out);
+    }
+    maip_sys_mutex_unlock(&fossil_maip_report.lock);
+}
+
+// --repeat statistics of one case, with the percentiles worked out once
+typedef struct
+{
+    uint64_t min_ns, mean_ns, max_ns, stddev_ns, p50_ns, p90_ns, p99_ns;
+} fossil_maip_report_stats_t;
+
+static void fossil_maip_report_stats(const fossil_maip_samples_t *samples, fossil_maip_report_stats_t *stats)
+{
+    stats->min_ns = samples->min_ns;
+    stats->mean_ns = (uint64_t)(samples->mean_ns + 0.5);
+    stats->max_ns = samples->max_ns;
+    stats->stddev_ns = (uint64_t)(fossil_maip_samples_stddev(samples) + 0.5);
+    stats->p50_ns = fossil_maip_samples_percentile(samples, 50.0);
+    stats->p90_ns = fossil_maip_samples_percentile(samples, 90.0);
+    stats->p99_ns = fossil_maip_samples_percentile(samples, 99.0);
+}
+
+// Writes the statistics as "<sep>name<eq>value" pairs, e.g. JSON members or YAML keys
+static void fossil_maip_report_stats_pairs(FILE *out, const fossil_maip_samples_t *samples,
+                                           const fossil_maip_report_stats_t *stats,
+                                           const char *sep, const char *quote, const char *eq)
+{
+    const struct
+    {
+        const char *name;
+        unsigned long long value;
+    } fields[] = {
+        {"iterations", (unsigned long long)samples->count},
+        {"min_ns", (unsigned long long)stats->min_ns},
+        {"mean_ns", (unsigned long long)stats->mean_ns},
+        {"max_ns", (unsigned long long)stats->max_ns},
+        {"stddev_ns", (unsigned long long)stats->stddev_ns},
+        {"p50_ns", (unsigned long long)stats->p50_ns},
+        {"p90_ns", (unsigned long long)stats->p90_ns},
+        {"p99_ns", (unsigned long long)stats->p99_ns},
+    };
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+        fprintf(out, "%s%s%s%s%s%llu", i ? sep : "", quote, fields[i].name, quote, eq, fields[i].value);
+    for (int state = 0; state <= FOSSIL_MAIP_CASE_UNEXPECTED; ++state)
+        fprintf(out, "%s%s%s%s%s%d", sep, quote, fossil_maip_state_name((fossil_maip_state_t)state), quote, eq,
+                samples->outcomes[state]);
+}
+
+// Writes the heap use of a case in the same "<sep>name<eq>value" form
+static void fossil_maip_report_alloc_pairs(FILE *out, const fossil_maip_alloc_stats_t *alloc,
+                                           const char *sep, const char *quote, const char *eq)
+{
+    const struct
+    {
+        const char *name;
+        size_t value;
+    } fields[] = {
+        {"allocations", alloc->allocations},
+        {"frees", alloc->frees},
+        {"bytes", alloc->bytes},
+        {"peak_bytes", alloc->peak_bytes},
+        {"leaks", alloc->leaks},
+        {"leaked_bytes", alloc->leaked_bytes},
+    };
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+        fprintf(out, "%s%s%s%s%s%zu", i ? sep : "", quote, fields[i].name, quote, eq, fields[i].value);
+}
+
+// Writes one finished case; message is the failure reason, may be null
+static void fossil_maip_report_case(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite,
+                                    const fossil_maip_case_t *test_case, const char *message)
+{
+    if (fossil_maip_report.format == FOSSIL_MAIP_REPORT_NONE || fossil_maip_report.engine != engine)
+        return;
+
+    FILE *out = fossil_maip_report.out;
+    const char *result = fossil_maip_state_name(test_case->state);
+    bool ok = test_case->state == FOSSIL_MAIP_CASE_PASS ||
+              test_case->state == FOSSIL_MAIP_CASE_SKIPPED ||
+              test_case->state == FOSSIL_MAIP_CASE_EMPTY;
+    if (message && !*message)
+        message = null;
+
+    const fossil_maip_samples_t *samples =
+        test_case->samples && test_case->samples->count > 1 ? test_case->samples : null;
+    fossil_maip_report_stats_t stats;
+    if (samples)
+        fossil_maip_report_stats(samples, &stats);
+    const fossil_maip_alloc_stats_t *alloc =
+        test_case->alloc && test_case->alloc->allocations > 0 ? test_case->alloc : null;
+
+    maip_sys_mutex_lock(&fossil_maip_report.lock);
+    fossil_maip_report.count++;
+    fossil_maip_score_record(&fossil_maip_report.score, test_case);
+
+    switch (fossil_maip_report.format)
+    {
+    case FOSSIL_MAIP_REPORT_JSONL:
+        fputs("{\"type\":\"case\",\"suite\":", out);
+        fossil_maip_report_json_string(out, suite->name);
+        fputs(",\"case\":", out);
+        fossil_maip_report_json_string(out, test_case->name);
+        fputs(",\"tags\":", out);
+        fossil_maip_report_json_string(out, test_case->tags);
+        fprintf(out, ",\"result\":\"%s\",\"elapsed_ns\":%llu", result, (unsigned long long)test_case->elapsed_ns);
+        if (samples)
+        {
+            fputs(",\"repeat\":{", out);
+            fossil_maip_report_stats_pairs(out, samples, &stats, ",", "\"", ":");
+            fputc('}', out);
+        }
+        if (alloc)
+        {
+            fputs(",\"alloc\":{", out);
+            fossil_maip_report_alloc_pairs(out, alloc, ",", "\"", ":");
+            fputc('}', out);
+        }
+        if (message)
+        {
+            fputs(",\"message\":", out);
+            fossil_maip_report_json_string(out, message);
+        }
+        fputs("}\n", out);
+        break;
+
+    case FOSSIL_MAIP_REPORT_JUNIT:
+        fputs("    <testcase classname=\"", out);
+        fossil_maip_report_xml_string(out, suite->name);
+        fputs("\" name=\"", out);
+        fossil_maip_report_xml_string(out, test_case->name);
+        fprintf(out, "\" time=\"%.9f\"", (double)test_case->elapsed_ns / 1e9);
+        if (test_case->state == FOSSIL_MAIP_CASE_PASS && !samples && !alloc)
+        {
+            fputs("/>\n", out);
+            break;
+        }
+        fputs(">\n", out);
+        if (samples || alloc)
+        {
+            fputs("      <properties>\n", out);
+            if (samples)
+            {
+                fputs("        <property name=\"repeat.", out);
+                fossil_maip_report_stats_pairs(out, samples, &stats, "\"/>\n        <property name=\"repeat.", "", "\" value=\"");
+                fputs("\"/>\n", out);
+            }
+            if (alloc)
+            {
+                fputs("        <property name=\"alloc.", out);
+                fossil_maip_report_alloc_pairs(out, alloc, "\"/>\n        <property name=\"alloc.", "", "\" value=\"");
+                fputs("\"/>\n", out);
+            }
+            fputs("      </properties>\n", out);
+        }
+        if (test_case->state != FOSSIL_MAIP_CASE_PASS)
+        {
+            const char *element = test_case->state == FOSSIL_MAIP_CASE_UNEXPECTED ? "error"
+                                : ok                                               ? "skipped"
+                                                                                   : "failure";
+            fprintf(out, "      <%s type=\"%s\" message=\"", element, result);
+            fossil_maip_report_xml_string(out, message ? message : result);
+            fputs("\"/>\n", out);
+        }
+        fputs("    </testcase>\n", out);
+        break;
+
+    case FOSSIL_MAIP_REPORT_CSV:
+        fossil_maip_report_csv_string(out, suite->name);
+        fputc(',', out);
+        fossil_maip_report_csv_string(out, test_case->name);
+        fputc(',', out);
+        fossil_maip_report_csv_string(out, test_case->tags);
+        fprintf(out, ",%s,%llu,", result, (unsigned long long)test_case->elapsed_ns);
+        fossil_maip_report_csv_string(out, message);
+        if (samples)
+            fprintf(out, ",%zu,%llu,%llu,%llu,%llu,%llu,%llu,%llu", samples->count,
+                    (unsigned long long)stats.min_ns, (unsigned long long)stats.mean_ns,
+                    (unsigned long long)stats.max_ns, (unsigned long long)stats.stddev_ns,
+                    (unsigned long long)stats.p50_ns, (unsigned long long)stats.p90_ns,
+                    (unsigned long long)stats.p99_ns);
+        else
+            fputs(",,,,,,,,", out);
+        if (alloc)
+            fprintf(out, ",%zu,%zu,%zu,%zu,%zu", alloc->allocations, alloc->bytes, alloc->peak_bytes,
+                    alloc->leaks, alloc->leaked_bytes);
+        else
+            fputs(",,,,,", out);
+        fputc('\n', out);
+        break;
+
+    case FOSSIL_MAIP_REPORT_TAP:
+        fprintf(out, "%s %zu - %s.%s", ok ? "ok" : "not ok", fossil_maip_report.count,
+                suite->name ? suite->name : "", test_case->name ? test_case->name : "");
+        if (test_case->state == FOSSIL_MAIP_CASE_SKIPPED || test_case->state == FOSSIL_MAIP_CASE_EMPTY)
+            fprintf(out, " # SKIP %s", result);
+        fputc('\n', out);
+        if (!ok || samples || alloc)
+        {
+            fprintf(out, "  ---\n  result: %s\n  elapsed_ns: %llu\n", result, (unsigned long long)test_case->elapsed_ns);
+            if (message)
+            {
+                fputs("  message: ", out);
+                fossil_maip_report_json_string(out, message);
+                fputc('\n', out);
+            }
+            if (samples)
+            {
+                fputs("  repeat: {", out);
+                fossil_maip_report_stats_pairs(out, samples, &stats, ", ", "", ": ");
+                fputs("}\n", out);
+            }
+            if (alloc)
+            {
+                fputs("  alloc: {", out);
+                fossil_maip_report_alloc_pairs(out, alloc, ", ", "", ": ");
+                fputs("}\n", out);
+            }
+            fputs("  ...\n", out);
+        }
+        break;
+
+    case FOSSIL_MAIP_REPORT_YAML:
+        fputs("  - suite: ", out);
+        fossil_maip_report_json_string(out, suite->name);
+        fputs("\n    case: ", out);
+        fossil_maip_report_json_string(out, test_case->name);
+        fputs("\n    tags: ", out);
+        fossil_maip_report_json_string(out, test_case->tags);
+        fprintf(out, "\n    result: %s\n    elapsed_ns: %llu\n", result, (unsigned long long)test_case->elapsed_ns);
+        if (samples)
+        {
+            fputs("    repeat: {", out);
+            fossil_maip_report_stats_pairs(out, samples, &stats, ", ", "", ": ");
+            fputs("}\n", out);
+        }
+        if (alloc)
+        {
+            fputs("    alloc: {", out);
+            fossil_maip_report_alloc_pairs(out, alloc, ", ", "", ": ");
+            fputs("}\n", out);
+        }
+        if (message)
+        {
+            fputs("    message: ", out);
+            fossil_maip_report_json_string(out, message);
+            fputc('\n', out);
+        }
+        break;
+
+    default:
+        break;
+    }
+    maip_sys_mutex_unlock(&fossil_maip_report.lock);
+}
+
+static void fossil_maip_report_close(void)
+{
+    if (fossil_maip_report.format == FOSSIL_MAIP_REPORT_NONE)
+        return;
+
+    FILE *out = fossil_maip_report.out;
+    const fossil_maip_score_t *score = &fossil_maip_report.score;
+
+    switch (fossil_maip_report.format)
+    {
+    case FOSSIL_MAIP_REPORT_JSONL:
+        fprintf(out, "{\"type\":\"summary\",\"passed\":%d,\"failed\":%d,\"skipped\":%d,\"timeout\":%d,\"unexpected\":%d,\"empty\":%d}\n",
+                score->passed, score->failed, score->skipped, score->timeout, score->unexpected, score->empty);
+        break;
+    case FOSSIL_MAIP_REPORT_JUNIT:
+        fputs("</testsuites>\n", out);
+        break;
+    case FOSSIL_MAIP_REPORT_TAP:
+        fprintf(out, "1..%zu\n", fossil_maip_report.count);
+        break;
+    case FOSSIL_MAIP_REPORT_YAML:
+        fprintf(out, "summary:\n  passed: %d\n  failed: %d\n  skipped: %d\n  timeout: %d\n  unexpected: %d\n  empty: %d\n",
+                score->passed, score->failed, score->skipped, score->timeout, score->unexpected, score->empty);
+        break;
+    default:
+        break;
+    }
+
+    if (out == stdout)
+        fflush(out);
+    else
+        fclose(out);
+    maip_sys_memory_free(fossil_maip_report.buffer);
+    maip_sys_mutex_destroy(&fossil_maip_report.lock);
+    maip_sys_memory_set(&fossil_maip_report, 0, sizeof(fossil_maip_report));
+}
+
+// --- Timeout Watchdog ---
+
+#ifndef FOSSIL_MAIP_TIMEOUT
+#define FOSSIL_MAIP_TIMEOUT 60
+#endif
+
+// Deadline for a single run of the case: its own timeout, then --timeout,
+// then the compiled-in default.
+static uint64_t fossil_maip_case_timeout_ns(const fossil_maip_engine_t *engine, const fossil_maip_case_t *test_case)
+{
+    if (test_case->timeout_ns > 0)
+        return test_case->timeout_ns;
+    if (engine->pallet.run.timeout > 0)
+        return seconds_to_nanoseconds((uint64_t)engine->pallet.run.timeout);
+    return seconds_to_nanoseconds(FOSSIL_MAIP_TIMEOUT);
+}
+
+#ifndef _WIN32
+
+// One entry per thread that is currently running a case. The watchdog thread
+// walks the armed entries and signals the owner of any expired deadline; the
+// SIGALRM handler then unwinds the case through test_jump_buffer.
+typedef struct fossil_maip_watch
+{
+    struct fossil_maip_watch *next;
+    struct fossil_maip_watch *prev;
+    pthread_t thread;
+    uint64_t deadline_ns;
+    volatile sig_atomic_t armed;
+    volatile sig_atomic_t fired;
+} fossil_maip_watch_t;
+
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_watch_t fossil_maip_watch_slot;
+static pthread_mutex_t fossil_maip_watch_lock = PTHREAD_MUTEX_INITIALIZER;
+static fossil_maip_watch_t *fossil_maip_watch_list = null;
+static pthread_t fossil_maip_watchdog_thread;
+static bool fossil_maip_watchdog_running = false;
+static bool fossil_maip_watchdog_stop = false;
+
+#define FOSSIL_MAIP_WATCHDOG_TICK_NS 10000000ULL // 10 ms upper bound on sleep
+
+static void fossil_maip_watch_signal(int sig)
+{
+    (void)sig;
+    // Stale signals (case already finished or a new one just started) are ignored.
+    // Inside the runner's own output or bookkeeping the jump waits for it to end.
+    if (fossil_maip_watch_slot.armed && fossil_maip_watch_slot.fired && !maip_sys_section_defer())
+        fossil_maip_longjmp(test_jump_buffer, FOSSIL_MAIP_JUMP_TIMEOUT);
+}
+
+// Takes a timeout deferred by fossil_maip_watch_signal
+static void fossil_maip_watch_resume(void)
+{
+    if (fossil_maip_watch_slot.armed && fossil_maip_watch_slot.fired)
+        fossil_maip_longjmp(test_jump_buffer, FOSSIL_MAIP_JUMP_TIMEOUT);
+}
+
+static void *fossil_maip_watchdog_main(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        uint64_t now = fossil_maip_now_ns();
+        uint64_t wait = FOSSIL_MAIP_WATCHDOG_TICK_NS;
+
+        pthread_mutex_lock(&fossil_maip_watch_lock);
+        if (fossil_maip_watchdog_stop)
+        {
+            pthread_mutex_unlock(&fossil_maip_watch_lock);
+            break;
+        }
+        for (fossil_maip_watch_t *w = fossil_maip_watch_list; w; w = w->next)
+        {
+            if (w->fired)
+                continue;
+            if (now >= w->deadline_ns)
+            {
+                w->fired = 1;
+                pthread_kill(w->thread, SIGALRM);
+            }
+            else if (w->deadline_ns - now < wait)
+            {
+                wait = w->deadline_ns - now;
+            }
+        }
+        pthread_mutex_unlock(&fossil_maip_watch_lock);
+
+        struct timespec ts;
+        ts.tv_sec = (time_t)(wait / 1000000000ULL);
+        ts.tv_nsec = (long)(wait % 1000000000ULL);
+        nanosleep(&ts, null);
+    }
+
+    return null;
+}
+
+// Called with fossil_maip_watch_lock held
+static bool fossil_maip_watchdog_start(void)
+{
+    if (fossil_maip_watchdog_running)
+        return true;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = fossil_maip_watch_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    if (sigaction(SIGALRM, &sa, null) != 0)
+        return false;
+    maip_sys_section_set_resume(fossil_maip_watch_resume);
+
+    fossil_maip_watchdog_stop = false;
+    maip_sys_memory_quiet_begin(); // started from inside the first case
+    int failed = pthread_create(&fossil_maip_watchdog_thread, null, fossil_maip_watchdog_main, null);
+    maip_sys_memory_quiet_end();
+    if (failed != 0)
+        return false;
+
+    fossil_maip_watchdog_running = true;
+    return true;
+}
+
+static void fossil_maip_watch_arm(uint64_t timeout_ns)
+{
+    fossil_maip_watch_t *w = &fossil_maip_watch_slot;
+
+    pthread_mutex_lock(&fossil_maip_watch_lock);
+    if (fossil_maip_watchdog_start())
+    {
+        w->thread = pthread_self();
+        w->deadline_ns = fossil_maip_now_ns() + timeout_ns;
+        w->fired = 0;
+        w->prev = null;
+        w->next = fossil_maip_watch_list;
+        if (fossil_maip_watch_list)
+            fossil_maip_watch_list->prev = w;
+        fossil_maip_watch_list = w;
+        w->armed = 1;
+    }
+    pthread_mutex_unlock(&fossil_maip_watch_lock);
+}
+
+// The handler left through siglongjmp, so SIGALRM is still blocked for this thread
+static void fossil_maip_watch_recover(void)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGALRM);
+    pthread_sigmask(SIG_UNBLOCK, &set, null);
+}
+
+static void fossil_maip_watch_disarm(void)
+{
+    fossil_maip_watch_t *w = &fossil_maip_watch_slot;
+    if (!w->armed)
+        return;
+
+    // Clear before locking: a late signal must not unwind us while we hold the lock
+    w->armed = 0;
+
+    pthread_mutex_lock(&fossil_maip_watch_lock);
+    if (w->prev)
+        w->prev->next = w->next;
+    else
+        fossil_maip_watch_list = w->next;
+    if (w->next)
+        w->next->prev = w->prev;
+    w->next = w->prev = null;
+    pthread_mutex_unlock(&fossil_maip_watch_lock);
+}
+
+static void fossil_maip_watchdog_shutdown(void)
+{
+    pthread_mutex_lock(&fossil_maip_watch_lock);
+    bool running = fossil_maip_watchdog_running;
+    fossil_maip_watchdog_stop = true;
+    fossil_maip_watchdog_running = false;
+    pthread_mutex_unlock(&fossil_maip_watch_lock);
+
+    if (running)
+        pthread_join(fossil_maip_watchdog_thread, null);
+}
+
+// A forked worker inherits the flags but not the thread; start from scratch
+static void fossil_maip_watchdog_after_fork(void)
+{
+    pthread_mutex_init(&fossil_maip_watch_lock, null);
+    fossil_maip_watch_list = null;
+    fossil_maip_watchdog_running = false;
+    fossil_maip_watchdog_stop = false;
+}
+
+#else
+
+// No preemption on Windows: deadlines are only checked after the case returns
+static void fossil_maip_watch_arm(uint64_t timeout_ns)
+{
+    (void)timeout_ns;
+}
+
+static void fossil_maip_watch_disarm(void)
+{
+}
+
+static void fossil_maip_watch_recover(void)
+{
+}
+
+static void fossil_maip_watchdog_shutdown(void)
+{
+}
+
+#endif
+
+// --- Crash Recovery ---
+//
+// SIGSEGV, SIGFPE, SIGBUS and SIGILL raised while a case body runs unwind the
+// case through test_jump_buffer instead of ending the process. The handlers
+// run on a per-thread alternate stack so a stack overflow can be caught too.
+// The handler only records the signal, address and raw frames; they are
+// described and symbolized after the jump, where allocation is safe again.
+
+#define FOSSIL_MAIP_CRASH_FRAMES 32
+#define FOSSIL_MAIP_CRASH_STACK (64 * 1024)
+
+typedef struct
+{
+    volatile sig_atomic_t armed;
+    int signal;
+    int code;
+    void *address;
+    void *frames[FOSSIL_MAIP_CRASH_FRAMES];
+    int depth;
+} fossil_maip_crash_t;
+
+static FOSSIL_MAIP_THREAD_LOCAL fossil_maip_crash_t fossil_maip_crash;
+
+#ifndef _WIN32
+
+static const int fossil_maip_crash_signals[] = {SIGSEGV, SIGFPE, SIGBUS, SIGILL};
+#define FOSSIL_MAIP_CRASH_SIGNALS (sizeof(fossil_maip_crash_signals) / sizeof(fossil_maip_crash_signals[0]))
+
+static struct sigaction fossil_maip_crash_previous[FOSSIL_MAIP_CRASH_SIGNALS];
+static pthread_once_t fossil_maip_crash_once = PTHREAD_ONCE_INIT;
+static pthread_key_t fossil_maip_crash_key;
+static bool fossil_maip_crash_ready = false;
+static FOSSIL_MAIP_THREAD_LOCAL void *fossil_maip_crash_stack = null;
+
+static void fossil_maip_crash_signal(int sig, siginfo_t *info, void *context)
+{
+    (void)context;
+    fossil_maip_crash_t *crash = &fossil_maip_crash;
+    if (!crash->armed)
+    {
+        // Not inside a case body: hand the signal back to whoever had it
+        for (size_t i = 0; i < FOSSIL_MAIP_CRASH_SIGNALS; ++i)
+        {
+            if (fossil_maip_crash_signals[i] == sig)
+                sigaction(sig, &fossil_maip_crash_previous[i], null);
+        }
+        raise(sig);
+        return;
+    }
+
+    crash->armed = 0;
+    crash->signal = sig;
+    crash->code = info ? info->si_code : 0;
+    crash->address = info ? info->si_addr : null;
+#ifdef FOSSIL_MAIP_HAVE_BACKTRACE
+    crash->depth = backtrace(crash->frames, FOSSIL_MAIP_CRASH_FRAMES);
+#else
+    crash->depth = 0;
+#endif
+    fossil_maip_longjmp(test_jump_buffer, FOSSIL_MAIP_JUMP_CRASH);
+}
+
+// Runs when a thread that armed recovery exits
+static void fossil_maip_crash_stack_free(void *stack)
+{
+    stack_t none;
+    memset(&none, 0, sizeof(none));
+    none.ss_flags = SS_DISABLE;
+    sigaltstack(&none, null);
+    maip_sys_memory_free(stack);
+}
+
+static void fossil_maip_crash_install(void)
+{
+#ifdef FOSSIL_MAIP_HAVE_BACKTRACE
+    // The first backtrace() may load the unwinder; do that outside a handler
+    void *frame;
+    backtrace(&frame, 1);
+#endif
+    if (pthread_key_create(&fossil_maip_crash_key, fossil_maip_crash_stack_free) != 0)
+        return;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = fossil_maip_crash_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    for (size_t i = 0; i < FOSSIL_MAIP_CRASH_SIGNALS; ++i)
+        sigaction(fossil_maip_crash_signals[i], &sa, &fossil_maip_crash_previous[i]);
+    fossil_maip_crash_ready = true;
+}
+
+static void fossil_maip_crash_arm(bool recover)
+{
+    if (!recover)
+        return;
+    // The install warms up backtrace(); that belongs to the runner, not the first case
+    maip_sys_memory_quiet_begin();
+    pthread_once(&fossil_maip_crash_once, fossil_maip_crash_install);
+    maip_sys_memory_quiet_end();
+    if (!fossil_maip_crash_ready)
+        return;
+
+    if (!fossil_maip_crash_stack)
+    {
+        maip_sys_memory_quiet_begin(); // lives as long as the thread
+        void *stack = maip_sys_memory_alloc(FOSSIL_MAIP_CRASH_STACK);
+        if (stack)
+        {
+            stack_t alt;
+            memset(&alt, 0, sizeof(alt));
+            alt.ss_sp = stack;
+            alt.ss_size = FOSSIL_MAIP_CRASH_STACK;
+            if (sigaltstack(&alt, null) == 0)
+            {
+                fossil_maip_crash_stack = stack;
+                pthread_setspecific(fossil_maip_crash_key, stack);
+            }
+            else
+            {
+                maip_sys_memory_free(stack);
+            }
+        }
+        maip_sys_memory_quiet_end();
+        if (!fossil_maip_crash_stack)
+            return;
+    }
+    fossil_maip_crash.armed = 1;
+}
+
+static void fossil_maip_crash_disarm(void)
+{
+    fossil_maip_crash.armed = 0;
+}
+
+// The handler left through siglongjmp, so its signal is still blocked
+static void fossil_maip_crash_recover(void)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, fossil_maip_crash.signal);
+    pthread_sigmask(SIG_UNBLOCK, &set, null);
+}
+
+static const char *fossil_maip_crash_name(int sig)
+{
+    switch (sig)
+    {
+    case SIGSEGV:
+        return "SIGSEGV";
+    case SIGFPE:
+        return "SIGFPE";
+    case SIGBUS:
+        return "SIGBUS";
+    case SIGILL:
+        return "SIGILL";
+    default:
+        return "signal";
+    }
+}
+
+static const char *fossil_maip_crash_reason(int sig, int code)
+{
+    if (code <= 0)
+        return "raised";
+    switch (sig)
+    {
+    case SIGSEGV:
+        return code == SEGV_MAPERR ? "address not mapped" : code == SEGV_ACCERR ? "invalid permissions" : "invalid access";
+    case SIGBUS:
+        return code == BUS_ADRALN ? "misaligned address" : code == BUS_ADRERR ? "nonexistent address" : "bus error";
+    case SIGFPE:
+        switch (code)
+        {
+        case FPE_INTDIV:
+            return "integer divide by zero";
+        case FPE_INTOVF:
+            return "integer overflow";
+        case FPE_FLTDIV:
+            return "floating-point divide by zero";
+        case FPE_FLTOVF:
+            return "floating-point overflow";
+        case FPE_FLTINV:
+            return "invalid floating-point operation";
+        default:
+            return "arithmetic error";
+        }
+    case SIGILL:
+        return code == ILL_ILLOPC ? "illegal opcode" : code == ILL_PRVOPC ? "privileged opcode" : "illegal instruction";
+    default:
+        return "unknown";
+    }
+}
+
+// Describes the crash in fossil_maip_failure and, unless quiet, prints it with its backtrace
+static void fossil_maip_crash_report(const fossil_maip_case_t *test_case, bool quiet)
+{
+    const fossil_maip_crash_t *crash = &fossil_maip_crash;
+    int length = snprintf(fossil_maip_failure, sizeof(fossil_maip_failure), "%s (%s)",
+                          fossil_maip_crash_name(crash->signal), fossil_maip_crash_reason(crash->signal, crash->code));
+    if (crash->code > 0 && length > 0 && (size_t)length < sizeof(fossil_maip_failure))
+    {
+        // Only faults carry an address; sent signals fill si_addr with the sender
+        snprintf(fossil_maip_failure + length, sizeof(fossil_maip_failure) - (size_t)length, " at 0x%" PRIxPTR,
+                 (uintptr_t)crash->address);
+    }
+    fossil_maip_failure_at.file = null;
+    fossil_maip_failure_at.func = null;
+    fossil_maip_failure_at.line = 0;
+    if (quiet)
+        return;
+
+    fossil_maip_output_lock();
+    maip_io_printf("{red}Crashed in %s: %s{reset}\n", test_case->name ? test_case->name : "case", fossil_maip_failure);
+#ifdef FOSSIL_MAIP_HAVE_BACKTRACE
+    // Frames 0 and 1 are the handler and the kernel's signal trampoline
+    char **symbols = crash->depth > 2 ? backtrace_symbols(crash->frames, crash->depth) : null;
+    for (int i = 2; i < crash->depth; ++i)
+    {
+        if (symbols)
+            maip_io_printf("{gray}  #%-2d %s{reset}\n", i - 2, symbols[i]);
+        else
+            maip_io_printf("{gray}  #%-2d 0x%" PRIxPTR "{reset}\n", i - 2, (uintptr_t)crash->frames[i]);
+    }
+    free(symbols);
+#endif
+    fossil_maip_output_unlock();
+}
+
+#else
+
+// Structured exception handling would be needed on Windows; crashes end the run
+static void fossil_maip_crash_arm(bool recover)
+{
+    (void)recover;
+}
+
+static void fossil_maip_crash_disarm(void)
+{
+}
+
+static void fossil_maip_crash_recover(void)
+{
+}
+
+static void fossil_maip_crash_report(const fossil_maip_case_t *test_case, bool quiet)
+{
+    (void)test_case;
+    (void)quiet;
+}
+
+#endif
+
+// Runs one iteration of a case: setup, the body under the watchdog, teardown.
+static void fossil_maip_execute_once(const fossil_maip_engine_t *engine, const fossil_maip_case_t *test_case,
+                                     uint64_t timeout_ns, fossil_maip_state_t *state, uint64_t *elapsed_ns)
+{
+    bool recover = !engine->pallet.run.no_recover;
+
+    if (test_case->alloc)
+        fossil_maip_alloc_begin(test_case->alloc);
+
+    if (test_case->setup)
+        test_case->setup();
+
+    *state = FOSSIL_MAIP_CASE_EMPTY;
+    *elapsed_ns = 0;
+    _ASSERT_COUNT = 0; // Reset before running test
+    fossil_maip_failure[0] = '\0';
+    uint64_t start_time = fossil_maip_now_ns();
+
+    // A jump out of the case can leave the console locked or a quiet section
+    // open, e.g. a crash inside maip_io_printf; put them back the way they were
+    maip_sys_section_t sections = maip_sys_section_save();
+
+    if (test_case->run)
+    {
+        switch (fossil_maip_setjmp(test_jump_buffer))
+        {
+        case 0:
+        {
+            fossil_maip_watch_arm(timeout_ns);
+            fossil_maip_crash_arm(recover);
+            test_case->run();
+            fossil_maip_crash_disarm();
+            fossil_maip_watch_disarm();
+
+            uint64_t elapsed = fossil_maip_now_ns() - start_time;
+            *elapsed_ns = elapsed;
+
+            if (elapsed > timeout_ns)
+            {
+                *state = FOSSIL_MAIP_CASE_TIMEOUT;
+            }
+            else if (_ASSERT_COUNT == 0)
+            {
+                *state = FOSSIL_MAIP_CASE_EMPTY;
+            }
+            else
+            {
+                *state = FOSSIL_MAIP_CASE_PASS;
+            }
+            break;
+        }
+        case FOSSIL_MAIP_JUMP_TIMEOUT:
+            maip_sys_section_restore(sections);
+            fossil_maip_crash_disarm();
+            fossil_maip_watch_disarm();
+            fossil_maip_watch_recover();
+            fossil_maip_alloc_unwind();
+            *state = FOSSIL_MAIP_CASE_TIMEOUT;
+            *elapsed_ns = fossil_maip_now_ns() - start_time;
+            break;
+        case FOSSIL_MAIP_JUMP_CRASH:
+            maip_sys_section_restore(sections);
+            fossil_maip_watch_disarm();
+            fossil_maip_crash_recover();
+            fossil_maip_alloc_unwind();
+            *state = FOSSIL_MAIP_CASE_UNEXPECTED;
+            *elapsed_ns = fossil_maip_now_ns() - start_time;
+            fossil_maip_crash_report(test_case, engine->quiet);
+            break;
+        default:
+            maip_sys_section_restore(sections);
+            fossil_maip_crash_disarm();
+            fossil_maip_watch_disarm();
+            *state = FOSSIL_MAIP_CASE_FAIL;
+            *elapsed_ns = fossil_maip_now_ns() - start_time;
+            break;
+        }
+    }
+
+    if (test_case->teardown)
+        test_case->teardown();
+
+    fossil_maip_fixture_release_case(); // Each repeat gets fresh case fixtures
+    fossil_maip_alloc_end();             // Whatever is still live now leaked
+}
+
+// Orders outcomes so a repeated case reports its worst iteration
+static int fossil_maip_state_rank(fossil_maip_state_t state)
+{
+    switch (state)
+    {
+    case FOSSIL_MAIP_CASE_UNEXPECTED:
+        return 4;
+    case FOSSIL_MAIP_CASE_FAIL:
+        return 3;
+    case FOSSIL_MAIP_CASE_TIMEOUT:
+        return 2;
+    case FOSSIL_MAIP_CASE_PASS:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Shared iteration counter for --repeat-jobs; each slot is written by the
+// thread that ran that iteration, so results keep the run order.
+typedef struct
+{
+    const fossil_maip_engine_t *engine;
+    const fossil_maip_case_t *test_case;
+    const void *suite; // owner of suite fixtures first used by an iteration
+    uint64_t timeout_ns;
+    size_t count;
+    size_t next;
+    bool stop; // set by --fail-fast
+    fossil_maip_state_t *states;
+    uint64_t *elapsed;
+    bool *ran;
+    char failure[sizeof(fossil_maip_failure)]; // first failed assertion
+    fossil_maip_failure_at_t failure_at;
+    maip_sys_mutex_t lock;
+} fossil_maip_repeat_pool_t;
+
+static void *fossil_maip_repeat_main(void *arg)
+{
+    fossil_maip_repeat_pool_t *pool = (fossil_maip_repeat_pool_t *)arg;
+    fossil_maip_fixture_suite = pool->suite;
+
+    for (;;)
+    {
+        maip_sys_mutex_lock(&pool->lock);
+        if (pool->stop || pool->next >= pool->count)
+        {
+            maip_sys_mutex_unlock(&pool->lock);
+            break;
+        }
+        size_t i = pool->next++;
+        maip_sys_mutex_unlock(&pool->lock);
+
+        fossil_maip_execute_once(pool->engine, pool->test_case, pool->timeout_ns,
+                                 &pool->states[i], &pool->elapsed[i]);
+        pool->ran[i] = true;
+
+        if (pool->states[i] == FOSSIL_MAIP_CASE_FAIL || pool->states[i] == FOSSIL_MAIP_CASE_UNEXPECTED)
+        {
+            maip_sys_mutex_lock(&pool->lock);
+            if (!pool->failure[0])
+            {
+                memcpy(pool->failure, fossil_maip_failure, sizeof(pool->failure));
+                pool->failure_at = fossil_maip_failure_at;
+            }
+            if (pool->engine->pallet.run.fail_fast)
+                pool->stop = true;
+            maip_sys_mutex_unlock(&pool->lock);
+        }
+    }
+
+    fossil_maip_failure_flush();
+    return null;
+}
+
+// Runs the iterations on up to `jobs` threads. Returns false when the pool
+// could not be set up, leaving the caller to run them in order.
+static bool fossil_maip_repeat_parallel(const fossil_maip_engine_t *engine, fossil_maip_case_t *test_case,
+                                        uint64_t timeout_ns, size_t count, size_t jobs, bool *stopped)
+{
+    fossil_maip_repeat_pool_t pool;
+    maip_sys_memory_set(&pool, 0, sizeof(pool));
+    pool.engine = engine;
+    pool.test_case = test_case;
+    pool.suite = fossil_maip_fixture_suite;
+    pool.timeout_ns = timeout_ns;
+    pool.count = count;
+    pool.states = (fossil_maip_state_t *)maip_sys_memory_calloc(count, sizeof(*pool.states));
+    pool.elapsed = (uint64_t *)maip_sys_memory_calloc(count, sizeof(*pool.elapsed));
+    pool.ran = (bool *)maip_sys_memory_calloc(count, sizeof(*pool.ran));
+    maip_sys_thread_t *threads = (maip_sys_thread_t *)maip_sys_memory_calloc(jobs, sizeof(*threads));
+
+    bool ok = pool.states && pool.elapsed && pool.ran && threads && maip_sys_mutex_init(&pool.lock) == 0;
+    size_t started = 0;
+    if (ok)
+    {
+        for (; started < jobs; ++started)
+        {
+            if (maip_sys_thread_create(&threads[started], fossil_maip_repeat_main, &pool) != 0)
+                break;
+        }
+        // No thread could be started: drain the iterations on this thread instead
+        if (started == 0)
+            fossil_maip_repeat_main(&pool);
+        for (size_t i = 0; i < started; ++i)
+            maip_sys_thread_join(threads[i]);
+        maip_sys_mutex_destroy(&pool.lock);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (pool.ran[i])
+                fossil_maip_samples_add(test_case->samples, pool.elapsed[i], pool.states[i]);
+        }
+        memcpy(fossil_maip_failure, pool.failure, sizeof(fossil_maip_failure));
+        fossil_maip_failure_at = pool.failure_at;
+        *stopped = pool.stop;
+    }
+
+    maip_sys_memory_free(pool.states);
+    maip_sys_memory_free(pool.elapsed);
+    maip_sys_memory_free(pool.ran);
+    maip_sys_memory_free(threads);
+    return ok;
+}
+
+// Runs the repeat loop for one case and records its state and elapsed time.
+// With --repeat every iteration goes into test_case->samples; the case then
+// reports its worst outcome and mean time. Returns FOSSIL_MAIP_FAILURE when
+// --fail-fast cut the case short.
+static int fossil_maip_execute_repeats(const fossil_maip_engine_t *engine, fossil_maip_case_t *test_case)
+{
+    size_t repeat_count =
+        (size_t)(engine->pallet.run.repeat > 0 ? engine->pallet.run.repeat : 1);
+    uint64_t timeout_ns = fossil_maip_case_timeout_ns(engine, test_case);
+
+    if (repeat_count == 1)
+    {
+        if (test_case->samples)
+            fossil_maip_samples_reset(test_case->samples); // Left over from an earlier --repeat run
+        fossil_maip_execute_once(engine, test_case, timeout_ns, &test_case->state, &test_case->elapsed_ns);
+        if ((test_case->state == FOSSIL_MAIP_CASE_FAIL || test_case->state == FOSSIL_MAIP_CASE_UNEXPECTED) &&
+            engine->pallet.run.fail_fast)
+            return FOSSIL_MAIP_FAILURE;
+        return FOSSIL_MAIP_SUCCESS;
+    }
+
+    if (!test_case->samples)
+        test_case->samples = (fossil_maip_samples_t *)maip_sys_memory_calloc(1, sizeof(*test_case->samples));
+    if (!test_case->samples)
+    {
+        test_case->state = FOSSIL_MAIP_CASE_UNEXPECTED;
+        return FOSSIL_MAIP_SUCCESS;
+    }
+    fossil_maip_samples_t *samples = test_case->samples;
+    fossil_maip_samples_reset(samples);
+
+    bool stopped = false;
+    size_t jobs = engine->pallet.run.repeat_jobs > 1 ? (size_t)engine->pallet.run.repeat_jobs : 1;
+    if (jobs > repeat_count)
+        jobs = repeat_count;
+
+    if (jobs <= 1 || !fossil_maip_repeat_parallel(engine, test_case, timeout_ns, repeat_count, jobs, &stopped))
+    {
+        char failure[sizeof(fossil_maip_failure)] = "";
+        fossil_maip_failure_at_t failure_at = {null, null, 0};
+        for (size_t i = 0; i < repeat_count && !stopped; ++i)
+        {
+            fossil_maip_state_t state;
+            uint64_t elapsed;
+            fossil_maip_execute_once(engine, test_case, timeout_ns, &state, &elapsed);
+            fossil_maip_samples_add(samples, elapsed, state);
+
+            if (state == FOSSIL_MAIP_CASE_FAIL || state == FOSSIL_MAIP_CASE_UNEXPECTED)
+            {
+                if (!failure[0])
+                {
+                    memcpy(failure, fossil_maip_failure, sizeof(failure));
+                    failure_at = fossil_maip_failure_at;
+                }
+                stopped = engine->pallet.run.fail_fast != 0;
+            }
+        }
+        memcpy(fossil_maip_failure, failure, sizeof(failure)); // Report the first failure, not the last run
+        fossil_maip_failure_at = failure_at;
+    }
+
+    fossil_maip_state_t worst = FOSSIL_MAIP_CASE_EMPTY;
+    for (int state = 0; state <= FOSSIL_MAIP_CASE_UNEXPECTED; ++state)
+    {
+        if (samples->outcomes[state] > 0 &&
+            fossil_maip_state_rank((fossil_maip_state_t)state) > fossil_maip_state_rank(worst))
+            worst = (fossil_maip_state_t)state;
+    }
+    test_case->state = worst;
+    test_case->elapsed_ns = (uint64_t)(samples->mean_ns + 0.5);
+
+    return stopped ? FOSSIL_MAIP_FAILURE : FOSSIL_MAIP_SUCCESS;
+}
+
+static int fossil_maip_execute_case(const fossil_maip_engine_t *engine, fossil_maip_case_t *test_case)
+{
+    if (fossil_maip_alloc_tracking())
+    {
+        if (!test_case->alloc)
+            test_case->alloc = (fossil_maip_alloc_stats_t *)maip_sys_memory_calloc(1, sizeof(*test_case->alloc));
+        else
+            maip_sys_memory_set(test_case->alloc, 0, sizeof(*test_case->alloc));
+    }
+
+    int result = fossil_maip_execute_repeats(engine, test_case);
+    fossil_maip_fixture_release_case(); // --fail-fast returns mid-repeat
+    return result;
+}
+
+static bool fossil_maip_case_skipped(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case);
+
+// Applies the compiled --skip selection. Returns false when the case should
+// not run; skipped cases are marked as such. --only is part of the filter.
+static bool fossil_maip_run_selected(const fossil_maip_engine_t *engine,
+                                     const fossil_maip_suite_t *suite, fossil_maip_case_t *test_case)
+{
+    if (fossil_maip_case_skipped(engine, suite, test_case))
+    {
+        test_case->state = FOSSIL_MAIP_CASE_SKIPPED;
+        return false;
+    }
+
+    return true;
+}
+
+// Same check as fossil_maip_run_selected, without marking skips
+static bool fossil_maip_runs_any(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite,
+                                 fossil_maip_case_t **cases, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!fossil_maip_case_skipped(engine, suite, cases[i]))
+            return true;
+    }
+    return false;
+}
+
+void fossil_maip_run_test(const fossil_maip_engine_t *engine,
+                           fossil_maip_case_t *test_case,
+                           fossil_maip_suite_t *suite)
+{
+    if (!test_case || !suite || !engine)
+        return;
+
+    if (!fossil_maip_run_selected(engine, suite, test_case))
+    {
+        if (test_case->state == FOSSIL_MAIP_CASE_SKIPPED)
+        {
+            fossil_maip_update_score(test_case, suite);
+            fossil_maip_report_case(engine, suite, test_case, null);
+        }
+        return;
+    }
+
+    // Callers other than fossil_maip_run_suite may run this on any thread
+    const void *outer_suite = fossil_maip_fixture_suite;
+    fossil_maip_fixture_suite = suite;
+    fossil_maip_execute_case(engine, test_case);
+    fossil_maip_fixture_suite = outer_suite;
+
+    fossil_maip_update_score(test_case, suite);
+    fossil_maip_report_case(engine, suite, test_case, fossil_maip_failure);
+    fossil_maip_output_lock();
+    fossil_maip_show_cases(suite, test_case, engine);
+    fossil_maip_output_unlock();
+}
+
+// --- Parallel Execution ---
+
+// Shared work queue for one suite; workers claim the next case index under lock
+typedef struct
+{
+    const fossil_maip_engine_t *engine;
+    fossil_maip_suite_t *suite;
+    fossil_maip_case_t **cases;
+    size_t count;
+    size_t next;
+    bool stop; // set by --fail-fast
+    maip_sys_mutex_t lock;
+} fossil_maip_pool_t;
+
+// Each worker keeps a private score that is merged after join
+typedef struct
+{
+    fossil_maip_pool_t *pool;
+    fossil_maip_score_t score;
+    maip_sys_thread_t thread;
+} fossil_maip_worker_t;
+
+static void *fossil_maip_worker_main(void *arg)
+{
+    fossil_maip_worker_t *worker = (fossil_maip_worker_t *)arg;
+    fossil_maip_pool_t *pool = worker->pool;
+    const void *outer_suite = fossil_maip_fixture_suite;
+    fossil_maip_fixture_suite = pool->suite;
+
+    for (;;)
+    {
+        maip_sys_mutex_lock(&pool->lock);
+        if (pool->stop || pool->next >= pool->count)
+        {
+            maip_sys_mutex_unlock(&pool->lock);
+            break;
+        }
+        fossil_maip_case_t *test_case = pool->cases[pool->next++];
+        maip_sys_mutex_unlock(&pool->lock);
+
+        if (!fossil_maip_run_selected(pool->engine, pool->suite, test_case))
+        {
+            if (test_case->state == FOSSIL_MAIP_CASE_SKIPPED)
+            {
+                fossil_maip_score_record(&worker->score, test_case);
+                fossil_maip_report_case(pool->engine, pool->suite, test_case, null);
+            }
+            continue;
+        }
+
+        if (fossil_maip_execute_case(pool->engine, test_case) != FOSSIL_MAIP_SUCCESS)
+        {
+            maip_sys_mutex_lock(&pool->lock);
+            pool->stop = true;
+            maip_sys_mutex_unlock(&pool->lock);
+        }
+
+        fossil_maip_score_record(&worker->score, test_case);
+        fossil_maip_report_case(pool->engine, pool->suite, test_case, fossil_maip_failure);
+        fossil_maip_output_lock();
+        fossil_maip_show_cases(pool->suite, test_case, pool->engine);
+        fossil_maip_output_unlock();
+    }
+
+    fossil_maip_fixture_suite = outer_suite;
+    fossil_maip_failure_flush();
+    return null;
+}
+
+// Runs the given cases on up to `jobs` worker threads. Falls back to running
+// inline for whatever the pool could not pick up if thread creation fails.
+static void fossil_maip_run_parallel(const fossil_maip_engine_t *engine,
+                                     fossil_maip_suite_t *suite,
+                                     fossil_maip_case_t **cases,
+                                     size_t count,
+                                     size_t jobs)
+{
+    if (jobs > count)
+        jobs = count;
+
+    fossil_maip_pool_t pool;
+    pool.engine = engine;
+    pool.suite = suite;
+    pool.cases = cases;
+    pool.count = count;
+    pool.next = 0;
+    pool.stop = false;
+
+    fossil_maip_worker_t *workers = (fossil_maip_worker_t *)maip_sys_memory_calloc(jobs, sizeof(*workers));
+    if (!workers || maip_sys_mutex_init(&pool.lock) != 0)
+    {
+        if (workers)
+            maip_sys_memory_free(workers);
+        for (size_t i = 0; i < count; ++i)
+            fossil_maip_run_test(engine, cases[i], suite);
+        return;
+    }
+
+    size_t started = 0;
+    for (size_t i = 0; i < jobs; ++i)
+    {
+        workers[i].pool = &pool;
+        if (maip_sys_thread_create(&workers[i].thread, fossil_maip_worker_main, &workers[i]) != 0)
+            break;
+        started++;
+    }
+
+    // No thread could be started: drain the queue on this thread instead
+    if (started == 0)
+    {
+        workers[0].pool = &pool;
+        fossil_maip_worker_main(&workers[0]);
+        started = 1;
+    }
+    else
+    {
+        for (size_t i = 0; i < started; ++i)
+            maip_sys_thread_join(workers[i].thread);
+    }
+
+    for (size_t i = 0; i < started; ++i)
+        fossil_maip_score_merge(&suite->score, &workers[i].score);
+    fossil_maip_update_totals(suite);
+
+    maip_sys_mutex_destroy(&pool.lock);
+    maip_sys_memory_free(workers);
+}
+
+// --- Process Isolation ---
+
+#ifndef _WIN32
+
+// Result of one case as streamed from a worker process back to the runner
+typedef struct
+{
+    uint32_t index;      // position in the dispatched case list
+    int32_t state;       // fossil_maip_state_t
+    uint64_t elapsed_ns; // measured inside the worker
+    uint32_t flags;      // FOSSIL_MAIP_RECORD_*
+    char message[256];   // failed assertion, for the report sinks
+    uint32_t samples;    // --repeat times that follow the record
+    fossil_maip_failure_at_t failure_at; // valid here too: the worker is a fork of the runner
+    int32_t outcomes[FOSSIL_MAIP_CASE_UNEXPECTED + 1]; // --repeat iterations per state
+    fossil_maip_alloc_stats_t alloc; // heap use; the sites are valid in the runner as above
+} fossil_maip_record_t;
+
+enum
+{
+    FOSSIL_MAIP_RECORD_RAN = 1 << 0,       // the case executed (report it)
+    FOSSIL_MAIP_RECORD_SKIPPED = 1 << 1,   // the case was skipped by --skip
+    FOSSIL_MAIP_RECORD_FAIL_FAST = 1 << 2  // --fail-fast tripped
+};
+
+typedef struct
+{
+    pid_t pid;
+    int cmd_fd;      // runner -> worker: case indices
+    int res_fd;      // worker -> runner: fossil_maip_record_t
+    long busy;       // index being run, or -1 when idle
+    uint64_t start;  // dispatch time of the busy case
+    uint64_t kill_at; // hard deadline for the busy case
+} fossil_maip_process_t;
+
+// Extra time a worker gets to report a timeout itself before it is killed
+#define FOSSIL_MAIP_KILL_GRACE_NS 250000000ULL
+
+static bool fossil_maip_write_full(int fd, const void *data, size_t size)
+{
+    const char *p = (const char *)data;
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool fossil_maip_read_full(int fd, void *data, size_t size)
+{
+    char *p = (char *)data;
+    while (size > 0)
+    {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// Reads the --repeat times that follow a record into the runner's copy of the case
+static bool fossil_maip_read_samples(int fd, fossil_maip_case_t *test_case, const fossil_maip_record_t *record)
+{
+    if (record->samples == 0)
+        return true;
+
+    if (!test_case->samples)
+        test_case->samples = (fossil_maip_samples_t *)maip_sys_memory_calloc(1, sizeof(*test_case->samples));
+    fossil_maip_samples_t *samples = test_case->samples;
+    if (samples)
+        fossil_maip_samples_reset(samples);
+
+    uint64_t chunk[64];
+    for (size_t left = record->samples; left > 0;)
+    {
+        size_t n = left < 64 ? left : 64;
+        if (!fossil_maip_read_full(fd, chunk, n * sizeof(chunk[0])))
+            return false;
+        for (size_t i = 0; samples && i < n; ++i)
+            fossil_maip_samples_push(samples, chunk[i]);
+        left -= n;
+    }
+
+    if (samples)
+    {
+        for (int state = 0; state <= FOSSIL_MAIP_CASE_UNEXPECTED; ++state)
+            samples->outcomes[state] = record->outcomes[state];
+    }
+    return true;
+}
+
+// Worker loop: run each index received until the runner closes the pipe.
+static void fossil_maip_process_main(const fossil_maip_engine_t *engine,
+                                     const fossil_maip_suite_t *suite,
+                                     fossil_maip_case_t **cases,
+                                     int cmd_fd, int res_fd)
+{
+    uint32_t index;
+    while (fossil_maip_read_full(cmd_fd, &index, sizeof(index)))
+    {
+        fossil_maip_case_t *test_case = cases[index];
+        fossil_maip_record_t record;
+        maip_sys_memory_set(&record, 0, sizeof(record));
+        record.index = index;
+
+        if (fossil_maip_run_selected(engine, suite, test_case))
+        {
+            fossil_maip_fixture_suite = suite;
+            if (fossil_maip_execute_case(engine, test_case) != FOSSIL_MAIP_SUCCESS)
+                record.flags |= FOSSIL_MAIP_RECORD_FAIL_FAST;
+            record.flags |= FOSSIL_MAIP_RECORD_RAN;
+        }
+        else if (test_case->state == FOSSIL_MAIP_CASE_SKIPPED)
+        {
+            record.flags |= FOSSIL_MAIP_RECORD_SKIPPED;
+        }
+
+        record.state = (int32_t)test_case->state;
+        record.elapsed_ns = test_case->elapsed_ns;
+        memcpy(record.message, fossil_maip_failure, sizeof(record.message));
+        if (test_case->state == FOSSIL_MAIP_CASE_FAIL)
+            record.failure_at = fossil_maip_failure_at;
+        if ((record.flags & FOSSIL_MAIP_RECORD_RAN) && test_case->alloc)
+            record.alloc = *test_case->alloc;
+
+        const fossil_maip_samples_t *samples = test_case->samples;
+        if ((record.flags & FOSSIL_MAIP_RECORD_RAN) && samples && samples->count > 0)
+        {
+            record.samples = (uint32_t)samples->count;
+            for (int state = 0; state <= FOSSIL_MAIP_CASE_UNEXPECTED; ++state)
+                record.outcomes[state] = samples->outcomes[state];
+        }
+
+        fflush(stdout); // assertion output must reach the terminal before the report line
+        if (!fossil_maip_write_full(res_fd, &record, sizeof(record)) ||
+            !fossil_maip_write_full(res_fd, record.samples ? samples->values : null,
+                                    record.samples * sizeof(uint64_t)))
+            break;
+    }
+}
+
+static bool fossil_maip_process_spawn(fossil_maip_process_t *workers, size_t slot, size_t total,
+                                      const fossil_maip_engine_t *engine,
+                                      const fossil_maip_suite_t *suite,
+                                      fossil_maip_case_t **cases)
+{
+    int cmd[2], res[2];
+    if (pipe(cmd) != 0)
+        return false;
+    if (pipe(res) != 0)
+    {
+        close(cmd[0]);
+        close(cmd[1]);
+        return false;
+    }
+
+    fflush(stdout); // don't let the child inherit and replay buffered output
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(cmd[0]);
+        close(cmd[1]);
+        close(res[0]);
+        close(res[1]);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        // Drop the runner's ends of every other worker so their crashes
+        // still show up as EOF in the runner.
+        for (size_t i = 0; i < total; ++i)
+        {
+            if (i != slot && workers[i].pid > 0)
+            {
+                close(workers[i].cmd_fd);
+                close(workers[i].res_fd);
+            }
+        }
+        close(cmd[1]);
+        close(res[0]);
+        fossil_maip_watchdog_after_fork();
+        fossil_maip_process_main(engine, suite, cases, cmd[0], res[1]);
+        fflush(stdout);
+        _exit(0);
+    }
+
+    close(cmd[0]);
+    close(res[1]);
+    workers[slot].pid = pid;
+    workers[slot].cmd_fd = cmd[1];
+    workers[slot].res_fd = res[0];
+    workers[slot].busy = -1;
+    return true;
+}
+
+static void fossil_maip_process_reap(fossil_maip_process_t *worker, int *signal_out)
+{
+    int status = 0;
+    close(worker->cmd_fd);
+    close(worker->res_fd);
+    while (waitpid(worker->pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+    if (signal_out)
+        *signal_out = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    worker->pid = -1;
+    worker->busy = -1;
+}
+
+// Scores a case that no worker process could run
+static void fossil_maip_process_abandon(const fossil_maip_engine_t *engine,
+                                        fossil_maip_suite_t *suite,
+                                        fossil_maip_case_t *test_case)
+{
+    test_case->state = FOSSIL_MAIP_CASE_UNEXPECTED;
+    test_case->elapsed_ns = 0;
+    maip_io_printf("{red}No worker available for %s{reset}\n", test_case->name);
+    fossil_maip_update_score(test_case, suite);
+    fossil_maip_report_case(engine, suite, test_case, "no worker available");
+    fossil_maip_show_cases(suite, test_case, engine);
+}
+
+// Hands the cases out one at a time to `procs` forked workers. A worker that
+// dies mid-case gets that case marked unexpected and is replaced; if no
+// replacement can be started the remaining cases are marked unexpected too.
+static int fossil_maip_run_isolated(const fossil_maip_engine_t *engine,
+                                    fossil_maip_suite_t *suite,
+                                    fossil_maip_case_t **cases,
+                                    size_t count,
+                                    size_t procs)
+{
+    if (procs > count)
+        procs = count;
+
+    fossil_maip_process_t *workers = (fossil_maip_process_t *)maip_sys_memory_calloc(procs, sizeof(*workers));
+    struct pollfd *fds = (struct pollfd *)maip_sys_memory_calloc(procs, sizeof(*fds));
+    size_t *slots = (size_t *)maip_sys_memory_calloc(procs, sizeof(*slots));
+    if (!workers || !fds || !slots)
+    {
+        maip_sys_memory_free(workers);
+        maip_sys_memory_free(fds);
+        maip_sys_memory_free(slots);
+        return FOSSIL_MAIP_FAILURE;
+    }
+
+    // A worker can die between dispatch and write; report that via EPIPE
+    void (*old_sigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+
+    size_t alive = 0;
+    for (size_t i = 0; i < procs; ++i)
+    {
+        workers[i].pid = -1;
+        workers[i].busy = -1;
+        if (fossil_maip_process_spawn(workers, i, procs, engine, suite, cases))
+            alive++;
+    }
+
+    if (alive == 0)
+    {
+        signal(SIGPIPE, old_sigpipe);
+        maip_sys_memory_free(workers);
+        maip_sys_memory_free(fds);
+        maip_sys_memory_free(slots);
+        return FOSSIL_MAIP_FAILURE;
+    }
+
+    size_t next = 0;
+    bool stop = false;
+
+    for (;;)
+    {
+        // Dispatch to idle workers
+        for (size_t i = 0; i < procs && next < count && !stop; ++i)
+        {
+            if (workers[i].pid <= 0 || workers[i].busy >= 0)
+                continue;
+            uint32_t index = (uint32_t)next;
+            size_t repeat = engine->pallet.run.repeat > 0 ? (size_t)engine->pallet.run.repeat : 1;
+            workers[i].busy = (long)next;
+            workers[i].start = fossil_maip_now_ns();
+            workers[i].kill_at = workers[i].start +
+                                 fossil_maip_case_timeout_ns(engine, cases[next]) * repeat +
+                                 FOSSIL_MAIP_KILL_GRACE_NS;
+            next++;
+            // A failed write means the worker is gone; poll reports it below
+            fossil_maip_write_full(workers[i].cmd_fd, &index, sizeof(index));
+        }
+
+        nfds_t nfds = 0;
+        uint64_t now = fossil_maip_now_ns();
+        uint64_t wait_ns = UINT64_MAX;
+        for (size_t i = 0; i < procs; ++i)
+        {
+            if (workers[i].pid > 0 && workers[i].busy >= 0)
+            {
+                fds[nfds].fd = workers[i].res_fd;
+                fds[nfds].events = POLLIN;
+                fds[nfds].revents = 0;
+                slots[nfds++] = i;
+
+                uint64_t left = workers[i].kill_at > now ? workers[i].kill_at - now : 0;
+                if (left < wait_ns)
+                    wait_ns = left;
+            }
+        }
+        if (nfds == 0)
+            break; // nothing in flight, and nothing left or no worker to take it
+
+        // Round up so we wake just after the earliest hard deadline
+        uint64_t wait_ms = wait_ns / 1000000ULL + 1;
+        int ready = poll(fds, nfds, wait_ms > INT_MAX ? INT_MAX : (int)wait_ms);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        // Hard timeout: the worker could not unwind the case itself
+        now = fossil_maip_now_ns();
+        for (nfds_t k = 0; k < nfds; ++k)
+        {
+            fossil_maip_process_t *worker = &workers[slots[k]];
+            if (fds[k].revents || now < worker->kill_at)
+                continue;
+
+            fossil_maip_case_t *test_case = cases[worker->busy];
+            kill(worker->pid, SIGKILL);
+            fossil_maip_process_reap(worker, null);
+
+            test_case->state = FOSSIL_MAIP_CASE_TIMEOUT;
+            test_case->elapsed_ns = now - worker->start;
+            if (!engine->quiet)
+                maip_io_printf("{red}Worker killed after timeout in %s{reset}\n", test_case->name);
+            fossil_maip_update_score(test_case, suite);
+            fossil_maip_report_case(engine, suite, test_case, "worker killed after timeout");
+            fossil_maip_show_cases(suite, test_case, engine);
+
+            if (!stop && next < count)
+                fossil_maip_process_spawn(workers, slots[k], procs, engine, suite, cases);
+        }
+
+        for (nfds_t k = 0; k < nfds; ++k)
+        {
+            if (!fds[k].revents)
+                continue;
+
+            fossil_maip_process_t *worker = &workers[slots[k]];
+            fossil_maip_case_t *test_case = cases[worker->busy];
+            fossil_maip_record_t record;
+
+            if (fossil_maip_read_full(worker->res_fd, &record, sizeof(record)) &&
+                record.index == (uint32_t)worker->busy &&
+                fossil_maip_read_samples(worker->res_fd, test_case, &record))
+            {
+                worker->busy = -1;
+                test_case->state = (fossil_maip_state_t)record.state;
+                test_case->elapsed_ns = record.elapsed_ns;
+                if (record.alloc.allocations > 0)
+                {
+                    if (!test_case->alloc)
+                        test_case->alloc = (fossil_maip_alloc_stats_t *)maip_sys_memory_alloc(sizeof(*test_case->alloc));
+                    if (test_case->alloc)
+                        *test_case->alloc = record.alloc;
+                }
+
+                if (record.flags & FOSSIL_MAIP_RECORD_FAIL_FAST)
+                    stop = true;
+                if (record.flags & (FOSSIL_MAIP_RECORD_RAN | FOSSIL_MAIP_RECORD_SKIPPED))
+                {
+                    record.message[sizeof(record.message) - 1] = '\0';
+                    // The worker's own index dies with it; count its failure here
+                    if (record.failure_at.file)
+                        fossil_maip_failure_record(record.failure_at.file, record.failure_at.line,
+                                                   record.failure_at.func, record.message);
+                    fossil_maip_update_score(test_case, suite);
+                    fossil_maip_report_case(engine, suite, test_case, record.message);
+                }
+                if (record.flags & FOSSIL_MAIP_RECORD_RAN)
+                    fossil_maip_show_cases(suite, test_case, engine);
+                continue;
+            }
+
+            // Worker died mid-case: record it and put a fresh one in its place
+            int sig = 0;
+            uint64_t elapsed = fossil_maip_now_ns() - worker->start;
+            fossil_maip_process_reap(worker, &sig);
+
+            test_case->state = FOSSIL_MAIP_CASE_UNEXPECTED;
+            test_case->elapsed_ns = elapsed;
+            if (!engine->quiet)
+                maip_io_printf("{red}Worker crashed in %s (signal %d){reset}\n", test_case->name, sig);
+            fossil_maip_update_score(test_case, suite);
+
+            char reason[64];
+            snprintf(reason, sizeof(reason), "worker crashed (signal %d)", sig);
+            fossil_maip_report_case(engine, suite, test_case, reason);
+            fossil_maip_show_cases(suite, test_case, engine);
+
+            if (engine->pallet.run.fail_fast)
+                stop = true;
+            if (!stop && next < count)
+                fossil_maip_process_spawn(workers, slots[k], procs, engine, suite, cases);
+        }
+    }
+
+    // Every replacement failed to spawn, or poll gave up: the cases still
+    // in flight or never handed out get a result rather than vanishing
+    for (size_t i = 0; i < procs; ++i)
+    {
+        if (workers[i].pid > 0 && workers[i].busy >= 0)
+        {
+            fossil_maip_case_t *test_case = cases[workers[i].busy];
+            kill(workers[i].pid, SIGKILL);
+            fossil_maip_process_reap(&workers[i], null);
+            fossil_maip_process_abandon(engine, suite, test_case);
+        }
+    }
+    for (; !stop && next < count; ++next)
+        fossil_maip_process_abandon(engine, suite, cases[next]);
+
+    // Closing the command pipes lets the workers exit
+    for (size_t i = 0; i < procs; ++i)
+    {
+        if (workers[i].pid > 0)
+            fossil_maip_process_reap(&workers[i], null);
+    }
+
+    signal(SIGPIPE, old_sigpipe);
+    maip_sys_memory_free(workers);
+    maip_sys_memory_free(fds);
+    maip_sys_memory_free(slots);
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+#endif
+
+// --- Algorithmic modifications ---
+
+// --- Sorting Test Cases ---
+// Sort keys are extracted once into a compact array of 64-bit words, then a
+// stable merge sort permutes 32-bit indices into that array. Comparisons never
+// chase case pointers except to break ties between long names.
+
+enum
+{
+    FOSSIL_MAIP_SORT_KEYS = 4,        // --by plus up to three --then-by keys
+    FOSSIL_MAIP_SORT_NAME_WORDS = 2   // Names are keyed on their first 16 bytes
+};
+
+typedef enum
+{
+    FOSSIL_MAIP_SORT_NAME,
+    FOSSIL_MAIP_SORT_RESULT,
+    FOSSIL_MAIP_SORT_TIME,
+    FOSSIL_MAIP_SORT_PRIORITY
+} fossil_maip_sort_field_t;
+
+typedef struct
+{
+    fossil_maip_sort_field_t field;
+    bool desc;
+    size_t word;  // First word of this key within an entry
+    size_t width; // Words the key occupies
+} fossil_maip_sort_key_t;
+
+typedef struct
+{
+    fossil_maip_sort_key_t keys[FOSSIL_MAIP_SORT_KEYS];
+    size_t key_count;
+    size_t stride;         // Words per entry
+    const uint64_t *words; // count * stride extracted keys
+    fossil_maip_case_t **cases;
+} fossil_maip_sort_plan_t;
+
+// Parses "field[:asc|:desc]"; a bare field takes default_order
+static bool fossil_maip_sort_key_parse(fossil_maip_sort_key_t *key, const char *spec, size_t length, const char *default_order)
+{
+    static const struct
+    {
+        const char *name;
+        fossil_maip_sort_field_t field;
+    } fields[] = {
+        {"name", FOSSIL_MAIP_SORT_NAME},
+        {"result", FOSSIL_MAIP_SORT_RESULT},
+        {"time", FOSSIL_MAIP_SORT_TIME},
+        {"priority", FOSSIL_MAIP_SORT_PRIORITY},
+    };
+
+    const char *order = default_order;
+    const char *colon = memchr(spec, ':', length);
+    size_t field_length = colon ? (size_t)(colon - spec) : length;
+    if (colon)
+        order = colon + 1;
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+    {
+        if (strlen(fields[i].name) == field_length && strncmp(spec, fields[i].name, field_length) == 0)
+        {
+            key->field = fields[i].field;
+            key->desc = order && strncmp(order, "desc", 4) == 0;
+            key->width = fields[i].field == FOSSIL_MAIP_SORT_NAME ? FOSSIL_MAIP_SORT_NAME_WORDS : 1;
+            return true;
+        }
+    }
+    return false; // Invalid sort criteria
+}
+
+static bool fossil_maip_sort_plan(fossil_maip_sort_plan_t *plan, const char *by, const char *order, const char *then_by)
+{
+    maip_sys_memory_set(plan, 0, sizeof(*plan));
+    if (!by || !fossil_maip_sort_key_parse(&plan->keys[0], by, strlen(by), order))
+        return false;
+    plan->key_count = 1;
+
+    for (const char *spec = then_by; spec && *spec;)
+    {
+        size_t length = strcspn(spec, ",");
+        if (length > 0)
+        {
+            if (plan->key_count == FOSSIL_MAIP_SORT_KEYS ||
+                !fossil_maip_sort_key_parse(&plan->keys[plan->key_count], spec, length, "asc"))
+                return false;
+            plan->key_count++;
+        }
+        spec += length + (spec[length] == ',');
+    }
+
+    for (size_t k = 0; k < plan->key_count; ++k)
+    {
+        plan->keys[k].word = plan->stride;
+        plan->stride += plan->keys[k].width;
+    }
+    return true;
+}
+
+static void fossil_maip_sort_extract(const fossil_maip_sort_plan_t *plan, const fossil_maip_case_t *test_case, uint64_t *words)
+{
+    for (size_t k = 0; k < plan->key_count; ++k)
+    {
+        const fossil_maip_sort_key_t *key = &plan->keys[k];
+        uint64_t *out = words + key->word;
+        switch (key->field)
+        {
+        case FOSSIL_MAIP_SORT_NAME:
+        {
+            // Big-endian packing so word order matches strcmp byte order
+            const char *name = test_case->name ? test_case->name : "";
+            bool ended = false;
+            for (size_t w = 0; w < FOSSIL_MAIP_SORT_NAME_WORDS; ++w)
+            {
+                uint64_t word = 0;
+                for (size_t b = 0; b < 8; ++b)
+                {
+                    unsigned char c = ended ? 0 : (unsigned char)*name;
+                    if (c == 0)
+                        ended = true;
+                    else
+                        name++;
+                    word = (word << 8) | c;
+                }
+                out[w] = word;
+            }
+            break;
+        }
+        case FOSSIL_MAIP_SORT_RESULT:
+            out[0] = (uint64_t)test_case->state;
+            break;
+        case FOSSIL_MAIP_SORT_TIME:
+            out[0] = test_case->elapsed_ns;
+            break;
+        case FOSSIL_MAIP_SORT_PRIORITY:
+            out[0] = (uint64_t)test_case->priority ^ (1ULL << 63); // Signed order as unsigned
+            break;
+        }
+
+        if (key->desc)
+        {
+            for (size_t w = 0; w < key->width; ++w)
+                out[w] = ~out[w];
+        }
+    }
+}
+
+static int fossil_maip_sort_compare(const fossil_maip_sort_plan_t *plan, uint32_t a, uint32_t b)
+{
+    const uint64_t *wa = plan->words + (size_t)a * plan->stride;
+    const uint64_t *wb = plan->words + (size_t)b * plan->stride;
+    for (size_t k = 0; k < plan->key_count; ++k)
+    {
+        const fossil_maip_sort_key_t *key = &plan->keys[k];
+        for (size_t w = key->word; w < key->word + key->width; ++w)
+        {
+            if (wa[w] != wb[w])
+                return wa[w] < wb[w] ? -1 : 1;
+        }
+
+        // Equal 16-byte prefixes that don't end in NUL need the full names
+        uint64_t last = wa[key->word + key->width - 1];
+        if (key->field == FOSSIL_MAIP_SORT_NAME && ((key->desc ? ~last : last) & 0xff) != 0)
+        {
+            const char *na = plan->cases[a]->name ? plan->cases[a]->name : "";
+            const char *nb = plan->cases[b]->name ? plan->cases[b]->name : "";
+            int order = strcmp(na, nb);
+            if (order != 0)
+                return key->desc ? -order : order;
+        }
+    }
+    return 0;
+}
+
+// Bottom-up merge sort of the index permutation. Stable, so cases with equal
+// keys keep their registration order, and O(n log n) with one scratch array.
+static void fossil_maip_sort_stable(const fossil_maip_sort_plan_t *plan, uint32_t *order, uint32_t *scratch, size_t count)
+{
+    uint32_t *from = order;
+    uint32_t *to = scratch;
+    for (size_t width = 1; width < count; width *= 2)
+    {
+        for (size_t lo = 0; lo < count; lo += 2 * width)
+        {
+            size_t mid = lo + width < count ? lo + width : count;
+            size_t hi = lo + 2 * width < count ? lo + 2 * width : count;
+            size_t i = lo, j = mid, k = lo;
+
+            while (i < mid && j < hi)
+                to[k++] = fossil_maip_sort_compare(plan, from[j], from[i]) < 0 ? from[j++] : from[i++];
+            while (i < mid)
+                to[k++] = from[i++];
+            while (j < hi)
+                to[k++] = from[j++];
+        }
+
+        uint32_t *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != order)
+        memcpy(order, from, count * sizeof(*order));
+}
+
+// Sorts on keys already extracted into plan->words and reorders the cases
+static void fossil_maip_sort_permute(fossil_maip_sort_plan_t *plan, fossil_maip_case_t **cases, size_t count)
+{
+    uint32_t *order = maip_sys_memory_alloc(2 * count * sizeof(*order));
+    fossil_maip_case_t **sorted = maip_sys_memory_alloc(count * sizeof(*sorted));
+    if (!order || !sorted)
+    {
+        // Leave the order as selected
+        maip_sys_memory_free(order);
+        maip_sys_memory_free(sorted);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        order[i] = (uint32_t)i;
+    plan->cases = cases;
+
+    fossil_maip_sort_stable(plan, order, order + count, count);
+
+    for (size_t i = 0; i < count; ++i)
+        sorted[i] = cases[order[i]];
+    memcpy(cases, sorted, count * sizeof(*cases));
+
+    maip_sys_memory_free(order);
+    maip_sys_memory_free(sorted);
+}
+
+static void fossil_maip_sort_by(fossil_maip_case_t **cases, size_t count,
+                                const char *by, const char *direction, const char *then_by)
+{
+    if (count > UINT32_MAX)
+        return;
+
+    fossil_maip_sort_plan_t plan;
+    if (!fossil_maip_sort_plan(&plan, by, direction, then_by))
+        return; // No or invalid criteria: keep the order as selected
+
+    uint64_t *words = maip_sys_memory_alloc(count * plan.stride * sizeof(*words));
+    if (!words)
+        return;
+    for (size_t i = 0; i < count; ++i)
+        fossil_maip_sort_extract(&plan, cases[i], words + i * plan.stride);
+    plan.words = words;
+
+    fossil_maip_sort_permute(&plan, cases, count);
+    maip_sys_memory_free(words);
+}
+
+void fossil_maip_sort_cases(fossil_maip_case_t **cases, size_t count, const fossil_maip_engine_t *engine)
+{
+    if (!cases || count <= 1 || !engine)
+        return;
+
+    fossil_maip_sort_by(cases, count, engine->pallet.sort.by, engine->pallet.sort.order, engine->pallet.sort.then_by);
+}
+
+// --- Run History ---
+// A memory-mapped, open-addressed table of per-case records keyed by a hash
+// of suite and case name. Records keep rolling duration estimates and the
+// latest failure, so the next run can put likely failures and long cases
+// first. Only the runner thread touches it, between suites. A process holds
+// an exclusive lock on the file from open to close, so concurrent runs
+// sharing one history take turns instead of growing it under each other.
+
+#define FOSSIL_MAIP_HISTORY_MAGIC "FMHIST02" // 02: case keys from fossil_maip_hash
+
+enum
+{
+    FOSSIL_MAIP_HISTORY_MIN_CAPACITY = 256, // Records in a new file, a power of two
+    FOSSIL_MAIP_HISTORY_SHIFT = 2           // Estimates move 1/4 of the way to each sample
+};
+
+typedef struct
+{
+    char magic[8];
+    uint32_t capacity; // Record slots, a power of two
+    uint32_t count;    // Occupied slots
+    uint64_t runs;     // Bumped on every open
+    uint64_t reserved;
+} fossil_maip_history_header_t;
+
+typedef struct
+{
+    uint64_t key;         // Hash of suite and case name, 0 marks a free slot
+    uint64_t mean_ns;     // Rolling mean duration
+    uint64_t dev_ns;      // Rolling mean absolute deviation
+    uint64_t failed_run;  // Run of the latest failure, 0 = never failed
+    uint32_t runs;        // Recorded outcomes
+    uint32_t failures;    // Recorded failures, timeouts and crashes
+    uint32_t last_state;  // Latest fossil_maip_state_t
+    uint32_t reserved;
+} fossil_maip_history_record_t;
+
+struct fossil_maip_history
+{
+    int fd;
+    size_t size;       // Bytes mapped
+    uint32_t capacity; // Record slots mapped; lookups never trust the header for this
+    fossil_maip_history_header_t *header;
+    fossil_maip_history_record_t *records;
+};
+
+static uint64_t fossil_maip_case_key(const char *suite_name, const char *case_name)
+{
+    if (!suite_name)
+        suite_name = cempty;
+    if (!case_name)
+        case_name = cempty;
+
+    // The suite's terminator separates the names, so "ab"+"c" != "a"+"bc"
+    fossil_maip_hash_state_t state;
+    fossil_maip_hash_init(&state, 0);
+    fossil_maip_hash_update(&state, suite_name, strlen(suite_name) + 1);
+    fossil_maip_hash_update(&state, case_name, strlen(case_name));
+    uint64_t hash = fossil_maip_hash_final64(&state);
+    return hash ? hash : 1;
+}
+
+// The mapping is only used while the header agrees with what was mapped
+static bool fossil_maip_history_usable(const fossil_maip_history_t *history)
+{
+    return history && history->header && history->header->capacity == history->capacity &&
+           history->header->count < history->capacity;
+}
+
+// Returns the record's slot, or the free slot it would take
+static fossil_maip_history_record_t *fossil_maip_history_slot(const fossil_maip_history_t *history, uint64_t key)
+{
+    size_t mask = history->capacity - 1;
+    for (size_t slot = (size_t)key & mask;; slot = (slot + 1) & mask)
+    {
+        fossil_maip_history_record_t *record = &history->records[slot];
+        if (record->key == key || record->key == 0)
+            return record;
+    }
+}
+
+#ifndef _WIN32
+static size_t fossil_maip_history_size(uint32_t capacity)
+{
+    return sizeof(fossil_maip_history_header_t) + (size_t)capacity * sizeof(fossil_maip_history_record_t);
+}
+
+static bool fossil_maip_history_map(fossil_maip_history_t *history, uint32_t capacity)
+{
+    size_t size = fossil_maip_history_size(capacity);
+    void *base = mmap(null, size, PROT_READ | PROT_WRITE, MAP_SHARED, history->fd, 0);
+    if (base == MAP_FAILED)
+        return false;
+    history->size = size;
+    history->capacity = capacity;
+    history->header = (fossil_maip_history_header_t *)base;
+    history->records = (fossil_maip_history_record_t *)(history->header + 1);
+    return true;
+}
+
+// Doubles the table and rehashes every record into the larger mapping
+static bool fossil_maip_history_grow(fossil_maip_history_t *history)
+{
+    fossil_maip_history_header_t header = *history->header;
+    uint32_t old_capacity = history->capacity;
+    size_t bytes = (size_t)old_capacity * sizeof(fossil_maip_history_record_t);
+    fossil_maip_history_record_t *old = maip_sys_memory_alloc(bytes);
+    if (!old)
+        return false;
+    memcpy(old, history->records, bytes);
+
+    uint32_t capacity = old_capacity * 2;
+    munmap(history->header, history->size);
+    if (ftruncate(history->fd, (off_t)fossil_maip_history_size(capacity)) != 0 ||
+        !fossil_maip_history_map(history, capacity))
+    {
+        maip_sys_memory_free(old);
+        history->header = null;
+        return false;
+    }
+
+    *history->header = header;
+    history->header->capacity = capacity;
+    maip_sys_memory_set(history->records, 0, (size_t)capacity * sizeof(fossil_maip_history_record_t));
+    for (uint32_t i = 0; i < old_capacity; ++i)
+    {
+        if (old[i].key != 0)
+            *fossil_maip_history_slot(history, old[i].key) = old[i];
+    }
+    maip_sys_memory_free(old);
+    return true;
+}
+
+fossil_maip_history_t *fossil_maip_history_open(const char *path)
+{
+    if (!path)
+        return null;
+
+    fossil_maip_history_t *history = maip_sys_memory_alloc(sizeof(*history));
+    if (!history)
+        return null;
+    maip_sys_memory_set(history, 0, sizeof(*history));
+
+    // Held until close; F_SETLKW waits for any other run using this file
+    struct flock lock;
+    maip_sys_memory_set(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+
+    history->fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat info;
+    int locked = -1;
+    if (history->fd >= 0)
+    {
+        while ((locked = fcntl(history->fd, F_SETLKW, &lock)) != 0 && errno == EINTR)
+            ;
+    }
+    if (history->fd < 0 || locked != 0 || fstat(history->fd, &info) != 0)
+    {
+        maip_io_printf("{red}Error: cannot open run history %s: %s{reset}\n", path, strerror(errno));
+        if (history->fd >= 0)
+            close(history->fd);
+        maip_sys_memory_free(history);
+        return null;
+    }
+
+    // Anything that isn't a whole table of ours starts over empty
+    fossil_maip_history_header_t header;
+    bool valid = (size_t)info.st_size >= sizeof(header) &&
+                 read(history->fd, &header, sizeof(header)) == (ssize_t)sizeof(header) &&
+                 memcmp(header.magic, FOSSIL_MAIP_HISTORY_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.capacity >= FOSSIL_MAIP_HISTORY_MIN_CAPACITY &&
+                 (header.capacity & (header.capacity - 1)) == 0 &&
+                 header.count < header.capacity &&
+                 (size_t)info.st_size == fossil_maip_history_size(header.capacity);
+    if (!valid)
+    {
+        if ((size_t)info.st_size > 0)
+            maip_io_printf("{yellow}Warning: run history %s is not usable, starting a new one{reset}\n", path);
+        maip_sys_memory_set(&header, 0, sizeof(header));
+        memcpy(header.magic, FOSSIL_MAIP_HISTORY_MAGIC, sizeof(header.magic));
+        header.capacity = FOSSIL_MAIP_HISTORY_MIN_CAPACITY;
+        if (ftruncate(history->fd, 0) != 0 ||
+            ftruncate(history->fd, (off_t)fossil_maip_history_size(header.capacity)) != 0)
+            header.capacity = 0;
+    }
+
+    if (header.capacity == 0 || !fossil_maip_history_map(history, header.capacity))
+    {
+        maip_io_printf("{red}Error: cannot map run history %s{reset}\n", path);
+        close(history->fd);
+        maip_sys_memory_free(history);
+        return null;
+    }
+
+    if (!valid)
+        *history->header = header;
+    history->header->runs++;
+    return history;
+}
+
+void fossil_maip_history_close(fossil_maip_history_t *history)
+{
+    if (!history)
+        return;
+    if (history->header)
+    {
+        msync(history->header, history->size, MS_SYNC);
+        munmap(history->header, history->size);
+    }
+    close(history->fd); // Drops the lock
+    maip_sys_memory_free(history);
+}
+
+#else
+
+fossil_maip_history_t *fossil_maip_history_open(const char *path)
+{
+    (void)path;
+    maip_io_printf("{red}Error: --history needs memory-mapped files, which this platform build lacks{reset}\n");
+    return null;
+}
+
+void fossil_maip_history_close(fossil_maip_history_t *history)
+{
+    (void)history;
+}
+
+static bool fossil_maip_history_grow(fossil_maip_history_t *history)
+{
+    (void)history;
+    return false;
+}
+
+#endif
+
+static bool fossil_maip_history_failed(fossil_maip_state_t state)
+{
+    return state == FOSSIL_MAIP_CASE_FAIL || state == FOSSIL_MAIP_CASE_TIMEOUT ||
+           state == FOSSIL_MAIP_CASE_UNEXPECTED;
+}
+
+void fossil_maip_history_record(fossil_maip_history_t *history, const fossil_maip_suite_t *suite,
+                                fossil_maip_case_t **cases, size_t count)
+{
+    if (!fossil_maip_history_usable(history) || !suite || !cases)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const fossil_maip_case_t *test_case = cases[i];
+        if (test_case->state == FOSSIL_MAIP_CASE_EMPTY || test_case->state == FOSSIL_MAIP_CASE_SKIPPED)
+            continue; // Never ran
+
+        // Keep the table at most half full
+        if (2 * (history->header->count + 1) > history->capacity && !fossil_maip_history_grow(history))
+            return;
+
+        uint64_t key = fossil_maip_case_key(suite->name, test_case->name);
+        fossil_maip_history_record_t *record = fossil_maip_history_slot(history, key);
+        uint64_t sample = test_case->elapsed_ns;
+        if (record->key == 0)
+        {
+            record->key = key;
+            record->mean_ns = sample;
+            record->dev_ns = 0;
+            history->header->count++;
+        }
+        else
+        {
+            uint64_t diff = sample > record->mean_ns ? sample - record->mean_ns : record->mean_ns - sample;
+            if (sample > record->mean_ns)
+                record->mean_ns += diff >> FOSSIL_MAIP_HISTORY_SHIFT;
+            else
+                record->mean_ns -= diff >> FOSSIL_MAIP_HISTORY_SHIFT;
+            if (diff > record->dev_ns)
+                record->dev_ns += (diff - record->dev_ns) >> FOSSIL_MAIP_HISTORY_SHIFT;
+            else
+                record->dev_ns -= (record->dev_ns - diff) >> FOSSIL_MAIP_HISTORY_SHIFT;
+        }
+
+        record->runs++;
+        record->last_state = (uint32_t)test_case->state;
+        if (fossil_maip_history_failed(test_case->state))
+        {
+            record->failures++;
+            record->failed_run = history->header->runs;
+        }
+    }
+}
+
+void fossil_maip_history_schedule(const fossil_maip_history_t *history, const fossil_maip_suite_t *suite,
+                                  fossil_maip_case_t **cases, size_t count, bool parallel)
+{
+    if (!fossil_maip_history_usable(history) || !suite || !cases || count < 2 || count > UINT32_MAX)
+        return;
+
+    fossil_maip_sort_plan_t plan;
+    maip_sys_memory_set(&plan, 0, sizeof(plan));
+    plan.key_count = 2;
+    plan.stride = 2;
+    plan.keys[0] = (fossil_maip_sort_key_t){FOSSIL_MAIP_SORT_TIME, false, 0, 1};
+    plan.keys[1] = (fossil_maip_sort_key_t){FOSSIL_MAIP_SORT_TIME, false, 1, 1};
+
+    uint64_t *words = maip_sys_memory_alloc(2 * count * sizeof(*words));
+    if (!words)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const fossil_maip_history_record_t *record =
+            fossil_maip_history_slot(history, fossil_maip_case_key(suite->name, cases[i]->name));
+
+        // Group: runs since the latest failure, then new cases, then the rest
+        uint64_t group = UINT64_MAX;
+        if (record->key == 0)
+            group = UINT64_MAX - 1;
+        else if (record->failed_run != 0)
+            group = history->header->runs - record->failed_run;
+
+        uint64_t expected = record->key ? record->mean_ns : 0;
+        words[2 * i] = group;
+        words[2 * i + 1] = parallel ? ~expected : expected;
+    }
+    plan.words = words;
+
+    fossil_maip_sort_permute(&plan, cases, count);
+    maip_sys_memory_free(words);
+}
+
+uint64_t fossil_maip_history_expected_ns(const fossil_maip_history_t *history,
+                                         const char *suite_name, const char *case_name)
+{
+    if (!fossil_maip_history_usable(history))
+        return 0;
+    const fossil_maip_history_record_t *record =
+        fossil_maip_history_slot(history, fossil_maip_case_key(suite_name, case_name));
+    return record->key ? record->mean_ns : 0;
+}
+
+double fossil_maip_history_failure_rate(const fossil_maip_history_t *history,
+                                        const char *suite_name, const char *case_name)
+{
+    if (!fossil_maip_history_usable(history))
+        return 0.5;
+    const fossil_maip_history_record_t *record =
+        fossil_maip_history_slot(history, fossil_maip_case_key(suite_name, case_name));
+    if (!record->key)
+        return 0.5;
+    return ((double)record->failures + 1.0) / ((double)record->runs + 2.0);
+}
+
+// --- Filtering Test Cases ---
+// Filters compile once per run into postfix programs. Tag terms become masks
+// over the interned tag sets, name and suite terms become glob matchers, and
+// every case is then judged by a handful of bit operations.
+
+typedef enum
+{
+    FOSSIL_MAIP_GLOB_ANY,      // "*"
+    FOSSIL_MAIP_GLOB_EXACT,    // "abc"
+    FOSSIL_MAIP_GLOB_PREFIX,   // "abc*"
+    FOSSIL_MAIP_GLOB_SUFFIX,   // "*abc"
+    FOSSIL_MAIP_GLOB_CONTAINS, // "*abc*"
+    FOSSIL_MAIP_GLOB_GENERAL   // anything else with '*' or '?'
+} fossil_maip_glob_kind_t;
+
+typedef struct
+{
+    fossil_maip_glob_kind_t kind;
+    char *text;    // Pattern, or just its literal part for the fast kinds
+    size_t length; // Length of text
+} fossil_maip_glob_t;
+
+typedef enum
+{
+    FOSSIL_MAIP_SELECT_TAG,
+    FOSSIL_MAIP_SELECT_NAME,
+    FOSSIL_MAIP_SELECT_SUITE,
+    FOSSIL_MAIP_SELECT_NOT,
+    FOSSIL_MAIP_SELECT_AND,
+    FOSSIL_MAIP_SELECT_OR
+} fossil_maip_select_kind_t;
+
+typedef struct
+{
+    fossil_maip_select_kind_t kind;
+    fossil_maip_glob_t glob;                 // Name, suite and tag terms
+    uint64_t tags[FOSSIL_MAIP_TAG_WORDS];   // Tag terms: interned tags the glob matches
+} fossil_maip_select_op_t;
+
+typedef struct
+{
+    fossil_maip_select_op_t *ops;
+    size_t count;
+    size_t capacity;
+    size_t depth; // Current stack depth while compiling
+} fossil_maip_select_program_t;
+
+struct fossil_maip_selection
+{
+    fossil_maip_select_program_t filter; // Cases that run (empty selects all)
+    fossil_maip_select_program_t skip;   // Selected cases recorded as skipped
+    size_t tag_count;                    // Interned tags the tag masks cover
+
+    uint64_t shard_index;   // This process's shard
+    uint64_t shard_count;   // 1 runs every selected case
+    bool shard_by_duration; // Balance history durations instead of hashing
+    bool shard_planned;     // shard_keys holds this shard's cases
+    uint64_t *shard_keys;   // Sorted case keys owned by this shard
+    size_t shard_key_count;
+};
+
+enum
+{
+    FOSSIL_MAIP_SELECT_DEPTH = 64 // Bits in the evaluation stack
+};
+
+static void fossil_maip_glob_compile(fossil_maip_glob_t *glob, const char *pattern, size_t length)
+{
+    bool leading = length > 0 && pattern[0] == '*';
+    bool trailing = length > 1 && pattern[length - 1] == '*';
+    size_t inner_stars = 0;
+    bool question = false;
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (pattern[i] == '?')
+            question = true;
+        else if (pattern[i] == '*' && i != 0 && i != length - 1)
+            inner_stars++;
+    }
+
+    size_t start = 0;
+    size_t end = length;
+    if (length == 1 && leading)
+        glob->kind = FOSSIL_MAIP_GLOB_ANY;
+    else if (question || inner_stars > 0)
+        glob->kind = FOSSIL_MAIP_GLOB_GENERAL;
+    else if (leading && trailing)
+        glob->kind = FOSSIL_MAIP_GLOB_CONTAINS, start = 1, end = length - 1;
+    else if (leading)
+        glob->kind = FOSSIL_MAIP_GLOB_SUFFIX, start = 1;
+    else if (trailing)
+        glob->kind = FOSSIL_MAIP_GLOB_PREFIX, end = length - 1;
+    else
+        glob->kind = FOSSIL_MAIP_GLOB_EXACT;
+
+    glob->length = end - start;
+    glob->text = (char *)maip_sys_memory_alloc(glob->length + 1);
+    if (glob->text)
+    {
+        memcpy(glob->text, pattern + start, glob->length);
+        glob->text[glob->length] = '\0';
+    }
+}
+
+// '*' matches any run, '?' any one character; backtracks to the last star only
+static bool fossil_maip_glob_general(const char *pattern, const char *text)
+{
+    const char *star = null;
+    const char *resume = null;
+    while (*text)
+    {
+        if (*pattern == '?' || (*pattern && *pattern != '*' && *pattern == *text))
+        {
+            pattern++;
+            text++;
+        }
+        else if (*pattern == '*')
+        {
+            star = pattern++;
+            resume = text;
+        }
+        else if (star)
+        {
+            pattern = star + 1;
+            text = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (*pattern == '*')
+        pattern++;
+    return *pattern == '\0';
+}
+
+static bool fossil_maip_glob_match(const fossil_maip_glob_t *glob, const char *text, size_t length)
+{
+    if (!text || !glob->text)
+        return false;
+
+    switch (glob->kind)
+    {
+    case FOSSIL_MAIP_GLOB_ANY:
+        return true;
+    case FOSSIL_MAIP_GLOB_EXACT:
+        return length == glob->length && memcmp(text, glob->text, length) == 0;
+    case FOSSIL_MAIP_GLOB_PREFIX:
+        return length >= glob->length && memcmp(text, glob->text, glob->length) == 0;
+    case FOSSIL_MAIP_GLOB_SUFFIX:
+        return length >= glob->length && memcmp(text + length - glob->length, glob->text, glob->length) == 0;
+    case FOSSIL_MAIP_GLOB_CONTAINS:
+        return strstr(text, glob->text) != null;
+    default:
+        return fossil_maip_glob_general(glob->text, text);
+    }
+}
+
+static bool fossil_maip_select_emit(fossil_maip_select_program_t *program, fossil_maip_select_kind_t kind)
+{
+    if (program->count >= program->capacity)
+    {
+        size_t new_cap = program->capacity ? program->capacity * 2 : 8;
+        fossil_maip_select_op_t *resized = maip_sys_memory_realloc(program->ops, new_cap * sizeof(*program->ops));
+        if (!resized)
+            return false;
+        program->ops = resized;
+        program->capacity = new_cap;
+    }
+
+    // Terms push a bit, NOT rewrites the top, AND/OR fold two into one
+    if (kind <= FOSSIL_MAIP_SELECT_SUITE)
+    {
+        if (++program->depth > FOSSIL_MAIP_SELECT_DEPTH)
+            return false;
+    }
+    else if (kind != FOSSIL_MAIP_SELECT_NOT)
+    {
+        program->depth--;
+    }
+
+    fossil_maip_select_op_t *op = &program->ops[program->count++];
+    maip_sys_memory_set(op, 0, sizeof(*op));
+    op->kind = kind;
+    return true;
+}
+
+// Resolves a tag glob against the interned tags
+static void fossil_maip_select_resolve_tags(fossil_maip_select_op_t *op)
+{
+    maip_sys_memory_set(op->tags, 0, sizeof(op->tags));
+    for (size_t i = 0; i < fossil_maip_tag_count; ++i)
+    {
+        if (fossil_maip_glob_match(&op->glob, fossil_maip_tags[i], strlen(fossil_maip_tags[i])))
+            op->tags[i / 64] |= 1ULL << (i % 64);
+    }
+}
+
+// Emits `key:pattern`; a bare pattern is a case name
+static bool fossil_maip_select_term(fossil_maip_select_program_t *program, const char *spec, size_t length)
+{
+    fossil_maip_select_kind_t kind = FOSSIL_MAIP_SELECT_NAME;
+    const char *colon = memchr(spec, ':', length);
+    if (colon)
+    {
+        size_t key = (size_t)(colon - spec);
+        if (key == 3 && strncmp(spec, "tag", 3) == 0)
+            kind = FOSSIL_MAIP_SELECT_TAG;
+        else if (key == 5 && strncmp(spec, "suite", 5) == 0)
+            kind = FOSSIL_MAIP_SELECT_SUITE;
+        else if (!(key == 4 && (strncmp(spec, "name", 4) == 0 || strncmp(spec, "test", 4) == 0)))
+            return false;
+        length -= key + 1;
+        spec = colon + 1;
+    }
+    if (length == 0 || !fossil_maip_select_emit(program, kind))
+        return false;
+
+    fossil_maip_select_op_t *op = &program->ops[program->count - 1];
+    fossil_maip_glob_compile(&op->glob, spec, length);
+    if (!op->glob.text)
+        return false;
+    if (kind == FOSSIL_MAIP_SELECT_TAG)
+        fossil_maip_select_resolve_tags(op);
+    return true;
+}
+
+// Emits one term per comma-separated item, joined by OR
+static bool fossil_maip_select_list(fossil_maip_select_program_t *program, const char *key, const char *list)
+{
+    size_t terms = 0;
+    for (const char *item = list; item && *item;)
+    {
+        size_t length = strcspn(item, ",");
+        if (length > 0)
+        {
+            char spec[256];
+            int written = snprintf(spec, sizeof(spec), "%s:%.*s", key, (int)length, item);
+            if (written < 0 || (size_t)written >= sizeof(spec) ||
+                !fossil_maip_select_term(program, spec, (size_t)written))
+                return false;
+            if (terms++ > 0 && !fossil_maip_select_emit(program, FOSSIL_MAIP_SELECT_OR))
+                return false;
+        }
+        item += length + (item[length] == ',');
     }
-    else if (maip_io_cstr_compare(mode, "graph") == 0)
+    return terms > 0;
+}
+
+// Recursive descent over: or := and ('|' and)*, and := unary ('&' unary)*,
+// unary := '!' unary | '(' or ')' | term
+typedef struct
+{
+    const char *text;
+    size_t at;
+    fossil_maip_select_program_t *program;
+} fossil_maip_select_parser_t;
+
+static char fossil_maip_select_peek(fossil_maip_select_parser_t *parser)
+{
+    while (parser->text[parser->at] == ' ' || parser->text[parser->at] == '\t')
+        parser->at++;
+    return parser->text[parser->at];
+}
+
+static bool fossil_maip_select_parse_or(fossil_maip_select_parser_t *parser);
+
+static bool fossil_maip_select_parse_unary(fossil_maip_select_parser_t *parser)
+{
+    char next = fossil_maip_select_peek(parser);
+    if (next == '!')
     {
-        switch (engine ? engine->pallet.theme : MAIP_THEME_FOSSIL)
+        parser->at++;
+        return fossil_maip_select_parse_unary(parser) &&
+               fossil_maip_select_emit(parser->program, FOSSIL_MAIP_SELECT_NOT);
+    }
+    if (next == '(')
+    {
+        parser->at++;
+        if (!fossil_maip_select_parse_or(parser) || fossil_maip_select_peek(parser) != ')')
+            return false;
+        parser->at++;
+        return true;
+    }
+
+    const char *spec = parser->text + parser->at;
+    size_t length = strcspn(spec, " \t()!&|");
+    parser->at += length;
+    return length > 0 && fossil_maip_select_term(parser->program, spec, length);
+}
+
+static bool fossil_maip_select_parse_and(fossil_maip_select_parser_t *parser)
+{
+    if (!fossil_maip_select_parse_unary(parser))
+        return false;
+    while (fossil_maip_select_peek(parser) == '&')
+    {
+        while (parser->text[parser->at] == '&')
+            parser->at++;
+        if (!fossil_maip_select_parse_unary(parser) ||
+            !fossil_maip_select_emit(parser->program, FOSSIL_MAIP_SELECT_AND))
+            return false;
+    }
+    return true;
+}
+
+static bool fossil_maip_select_parse_or(fossil_maip_select_parser_t *parser)
+{
+    if (!fossil_maip_select_parse_and(parser))
+        return false;
+    while (fossil_maip_select_peek(parser) == '|')
+    {
+        while (parser->text[parser->at] == '|')
+            parser->at++;
+        if (!fossil_maip_select_parse_and(parser) ||
+            !fossil_maip_select_emit(parser->program, FOSSIL_MAIP_SELECT_OR))
+            return false;
+    }
+    return true;
+}
+
+// ANDs a newly compiled part onto what the program already holds
+static bool fossil_maip_select_join(fossil_maip_select_program_t *program, size_t before)
+{
+    return before == 0 || fossil_maip_select_emit(program, FOSSIL_MAIP_SELECT_AND);
+}
+
+static bool fossil_maip_select_expression(fossil_maip_select_program_t *program, const char *expression)
+{
+    size_t before = program->count;
+    fossil_maip_select_parser_t parser = {expression, 0, program};
+    if (!fossil_maip_select_parse_or(&parser) || fossil_maip_select_peek(&parser) != '\0')
+    {
+        maip_io_printf("{red}Invalid selection expression at column %zu: %s{reset}\n", parser.at + 1, expression);
+        return false;
+    }
+    return fossil_maip_select_join(program, before);
+}
+
+static void fossil_maip_select_program_free(fossil_maip_select_program_t *program)
+{
+    for (size_t i = 0; i < program->count; ++i)
+        maip_sys_memory_free(program->ops[i].glob.text);
+    maip_sys_memory_free(program->ops);
+    maip_sys_memory_set(program, 0, sizeof(*program));
+}
+
+static bool fossil_maip_select_tag(const fossil_maip_select_op_t *op, const fossil_maip_case_t *test_case)
+{
+    uint64_t any = 0;
+    for (size_t w = 0; w < FOSSIL_MAIP_TAG_WORDS; ++w)
+        any |= test_case->tag_set[w] & op->tags[w];
+    if (any)
+        return true;
+
+    // Tags past the table were never interned; look at the text for those
+    const uint64_t overflow = 1ULL << (FOSSIL_MAIP_TAG_OVERFLOW % 64);
+    if (!(test_case->tag_set[FOSSIL_MAIP_TAG_WORDS - 1] & overflow))
+        return false;
+    for (const char *tag = test_case->tags; tag && *tag;)
+    {
+        while (*tag == ' ')
+            tag++;
+        size_t length = strcspn(tag, ",");
+        size_t trimmed = length;
+        while (trimmed > 0 && tag[trimmed - 1] == ' ')
+            trimmed--;
+        char item[128];
+        snprintf(item, sizeof(item), "%.*s", (int)trimmed, tag);
+        if (fossil_maip_glob_match(&op->glob, item, strlen(item)))
+            return true;
+        tag += length + (tag[length] == ',');
+    }
+    return false;
+}
+
+static bool fossil_maip_select_run(const fossil_maip_select_program_t *program,
+                                   const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case)
+{
+    uint64_t stack = 0; // One bit per pending value, top in bit 0
+    for (size_t i = 0; i < program->count; ++i)
+    {
+        const fossil_maip_select_op_t *op = &program->ops[i];
+        switch (op->kind)
         {
-        case MAIP_THEME_FOSSIL:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} {blue}[test case]{reset} --[{orange}tags:{reset}{white}%s{reset} {orange}[with tag]{reset},{orange}criteria:{reset}{white}%s{reset} {orange}[given criteria]{reset},{orange}time:{reset}{white}%s{reset} {orange}[the time]{reset},{orange}result:{reset}%s {orange}[the result]{reset}]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{cyan}CASE{gray}:: {cyan}%s{reset} --[{orange}::TAGS::{reset}{white} %s{reset},{orange}::CRITERIA::{reset}{white} %s{reset},{orange}::TIME::{reset}{white} %s{reset},{orange}::RESULT::{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} --[{orange}tags:{reset}{white}%s{reset},{orange}criteria:{reset}{white}%s{reset},{orange}time:{reset}{white}%s{reset},{orange}result:{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
+        case FOSSIL_MAIP_SELECT_TAG:
+            stack = (stack << 1) | fossil_maip_select_tag(op, test_case);
             break;
-        case MAIP_THEME_LIGHT:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {bright_cyan}%s{reset} {bright_blue}[test case]{reset} --[{orange}tags:{reset}{white}%s{reset} {orange}[with tag]{reset},{orange}criteria:{reset}{white}%s{reset} {orange}[given criteria]{reset},{orange}time:{reset}{white}%s{reset} {orange}[the time]{reset},{orange}result:{reset}%s {orange}[the result]{reset}]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{cyan}CASE{gray}:: {bright_cyan}%s{reset} --[{orange}::TAGS::{reset}{white} %s{reset},{orange}::CRITERIA::{reset}{white} %s{reset},{orange}::TIME::{reset}{white} %s{reset},{orange}::RESULT::{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {bright_cyan}%s{reset} --[{orange}tags:{reset}{white}%s{reset},{orange}criteria:{reset}{white}%s{reset},{orange}time:{reset}{white}%s{reset},{orange}result:{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
+        case FOSSIL_MAIP_SELECT_NAME:
+            stack = (stack << 1) | fossil_maip_glob_match(&op->glob, test_case->name,
+                                                          test_case->name ? strlen(test_case->name) : 0);
             break;
-        case MAIP_THEME_DARK:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} {blue}[test case]{reset} --[{orange}tags:{reset}{white}%s{reset} {orange}[with tag]{reset},{orange}criteria:{reset}{white}%s{reset} {orange}[given criteria]{reset},{orange}time:{reset}{white}%s{reset} {orange}[the time]{reset},{orange}result:{reset}%s {orange}[the result]{reset}]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{cyan}CASE{gray}:: {cyan}%s{reset} --[{orange}::TAGS::{reset}{white} %s{reset},{orange}::CRITERIA::{reset}{white} %s{reset},{orange}::TIME::{reset}{white} %s{reset},{orange}::RESULT::{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} --[{orange}tags:{reset}{white}%s{reset},{orange}criteria:{reset}{white}%s{reset},{orange}time:{reset}{white}%s{reset},{orange}result:{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
+        case FOSSIL_MAIP_SELECT_SUITE:
+            stack = (stack << 1) | fossil_maip_glob_match(&op->glob, suite->name,
+                                                          suite->name ? strlen(suite->name) : 0);
             break;
-        case MAIP_THEME_MAGA:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} {red}[test case]{reset} --[{red}tags:{reset}{white}%s{reset} {red}[with tag]{reset},{red}criteria:{reset}{white}%s{reset} {red}[given criteria]{reset},{red}time:{reset}{white}%s{reset} {red}[the time]{reset},{red}result:{reset}%s {red}[the result]{reset}]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{red}CASE{gray}:: {white}%s{reset} --[{red}::TAGS::{reset}{white} %s{reset},{red}::CRITERIA::{reset}{white} %s{reset},{red}::TIME::{reset}{white} %s{reset},{red}::RESULT::{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} --[{red}tags:{reset}{white}%s{reset},{red}criteria:{reset}{white}%s{reset},{red}time:{reset}{white}%s{reset},{red}result:{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
+        case FOSSIL_MAIP_SELECT_NOT:
+            stack ^= 1;
             break;
-        case MAIP_THEME_MINT:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} {green}[test case]{reset} --[{green}tags:{reset}{bright_green}%s{reset} {green}[with tag]{reset},{green}criteria:{reset}{bright_green}%s{reset} {green}[given criteria]{reset},{green}time:{reset}{bright_green}%s{reset} {green}[the time]{reset},{green}result:{reset}%s {green}[the result]{reset}]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{green}CASE{gray}:: {white}%s{reset} --[{green}::TAGS::{reset}{bright_green} %s{reset},{green}::CRITERIA::{reset}{bright_green} %s{reset},{green}::TIME::{reset}{bright_green} %s{reset},{green}::RESULT::{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} --[{green}tags:{reset}{bright_green}%s{reset},{green}criteria:{reset}{bright_green}%s{reset},{green}time:{reset}{bright_green}%s{reset},{green}result:{reset} %s]\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
+        case FOSSIL_MAIP_SELECT_AND:
+            stack = (stack >> 1) & (stack | ~1ULL);
             break;
-        default:
-            maip_io_printf("- %s (Tags: %s, Criteria: %s, Time: %s, Result: %s)\n",
-                            test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
+        case FOSSIL_MAIP_SELECT_OR:
+            stack = (stack >> 1) | (stack & 1);
             break;
         }
     }
-    else
-    { // list (default)
-        switch (engine ? engine->pallet.theme : MAIP_THEME_FOSSIL)
+    return program->count == 0 || (stack & 1);
+}
+
+int fossil_maip_selection_compile(fossil_maip_engine_t *engine)
+{
+    if (!engine)
+        return FOSSIL_MAIP_FAILURE;
+    fossil_maip_selection_free(engine);
+
+    const fossil_maip_pallet_t *pallet = &engine->pallet;
+    struct fossil_maip_selection *selection = maip_sys_memory_alloc(sizeof(*selection));
+    if (!selection)
+        return FOSSIL_MAIP_FAILURE;
+    maip_sys_memory_set(selection, 0, sizeof(*selection));
+    engine->selection = selection;
+
+    fossil_maip_select_program_t *filter = &selection->filter;
+    bool ok = true;
+    size_t before;
+
+    if (ok && pallet->filter.test_name)
+        before = filter->count, ok = fossil_maip_select_list(filter, "name", pallet->filter.test_name) &&
+                                     fossil_maip_select_join(filter, before);
+    if (ok && pallet->filter.name)
+        before = filter->count, ok = fossil_maip_select_list(filter, "suite", pallet->filter.name) &&
+                                     fossil_maip_select_join(filter, before);
+    if (ok && pallet->filter.tag)
+        before = filter->count, ok = fossil_maip_select_list(filter, "tag", pallet->filter.tag) &&
+                                     fossil_maip_select_join(filter, before);
+    if (ok && pallet->filter.expr)
+        ok = fossil_maip_select_expression(filter, pallet->filter.expr);
+    if (ok && pallet->run.only_count > 0)
+    {
+        before = filter->count;
+        for (size_t i = 0; ok && i < pallet->run.only_count; ++i)
         {
-        case MAIP_THEME_FOSSIL:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{cyan}CASE{gray}] {cyan}%s{reset} {orange}[test case]{reset} ({orange}Tags:{reset} {white}%s{reset} {orange}[with tag]{reset}, {orange}Criteria:{reset} {white}%s{reset} {orange}[given criteria]{reset}, {orange}Time:{reset} {white}%s{reset} {orange}[the time]{reset}, {orange}Result:{reset} %s {orange}[the result]{reset})\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{cyan}CASE{gray}:: {cyan}%s{reset} ( {orange}::TAGS::{reset} {white}%s{reset}, {orange}::CRITERIA::{reset} {white}%s{reset}, {orange}::TIME::{reset} {white}%s{reset}, {orange}::RESULT::{reset} %s )\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{blue}CASE{gray}] {cyan}%s{reset} ({orange}Tags:{reset} {white}%s{reset}, {orange}Criteria:{reset} {white}%s{reset}, {orange}Time:{reset} {white}%s{reset}, {orange}Result:{reset} %s)\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            break;
-        case MAIP_THEME_LIGHT:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{bright_blue}CASE{gray}] {cyan}%s{reset} {orange}[test case]{reset} ({orange}Tags:{reset} {white}%s{reset} {orange}[with tag]{reset}, {orange}Criteria:{reset} {white}%s{reset} {orange}[given criteria]{reset}, {orange}Time:{reset} {white}%s{reset} {orange}[the time]{reset}, {orange}Result:{reset} %s {orange}[the result]{reset})\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{bright_blue}CASE{gray}:: {cyan}%s{reset} ( {orange}::TAGS::{reset} {white}%s{reset}, {orange}::CRITERIA::{reset} {white}%s{reset}, {orange}::TIME::{reset} {white}%s{reset}, {orange}::RESULT::{reset} %s )\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{bright_blue}CASE{gray}] {cyan}%s{reset} ({orange}Tags:{reset} {white}%s{reset}, {orange}Criteria:{reset} {white}%s{reset}, {orange}Time:{reset} {white}%s{reset}, {orange}Result:{reset} %s)\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            break;
-        case MAIP_THEME_DARK:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{blue}CASE{gray}] {cyan}%s{reset} {orange}[test case]{reset} ({orange}Tags:{reset} {white}%s{reset} {orange}[with tag]{reset}, {orange}Criteria:{reset} {white}%s{reset} {orange}[given criteria]{reset}, {orange}Time:{reset} {white}%s{reset} {orange}[the time]{reset}, {orange}Result:{reset} %s {orange}[the result]{reset})\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{blue}CASE{gray}:: {cyan}%s{reset} ( {orange}::TAGS::{reset} {white}%s{reset}, {orange}::CRITERIA::{reset} {white}%s{reset}, {orange}::TIME::{reset} {white}%s{reset}, {orange}::RESULT::{reset} %s )\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{blue}CASE{gray}] {cyan}%s{reset} ({orange}Tags:{reset} {white}%s{reset}, {orange}Criteria:{reset} {white}%s{reset}, {orange}Time:{reset} {white}%s{reset}, {orange}Result:{reset} %s)\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            break;
-        case MAIP_THEME_MAGA:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} {red}[test case]{reset} ({red}Tags:{reset} {white}%s{reset} {red}[with tag]{reset}, {red}Criteria:{reset} {white}%s{reset} {red}[given criteria]{reset}, {red}Time:{reset} {white}%s{reset} {red}[the time]{reset}, {red}Result:{reset} %s {red}[the result]{reset})\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{red}CASE{gray}:: {white}%s{reset} ( {red}::TAGS::{reset} {white}%s{reset}, {red}::CRITERIA::{reset} {white}%s{reset}, {red}::TIME::{reset} {white}%s{reset}, {red}::RESULT::{reset} %s )\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{red}CASE{gray}] {white}%s{reset} ({red}Tags:{reset} {white}%s{reset}, {red}Criteria:{reset} {white}%s{reset}, {red}Time:{reset} {white}%s{reset}, {red}Result:{reset} %s)\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            break;
-        case MAIP_THEME_MINT:
-            if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "doge") == 0)
-            {
-                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} {green}[test case]{reset} ({green}Tags:{reset} {white}%s{reset} {green}[with tag]{reset}, {green}Criteria:{reset} {white}%s{reset} {green}[given criteria]{reset}, {green}Time:{reset} {white}%s{reset} {green}[the time]{reset}, {green}Result:{reset} %s {green}[the result]{reset})\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else if (engine && engine->pallet.show.verbose && maip_io_cstr_compare(engine->pallet.show.verbose, "ci") == 0)
-            {
-                maip_io_printf("{gray}::{green}CASE{gray}:: {white}%s{reset} ( {green}::TAGS::{reset} {white}%s{reset}, {green}::CRITERIA::{reset} {white}%s{reset}, {green}::TIME::{reset} {white}%s{reset}, {green}::RESULT::{reset} %s )\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            else
-            { // plain or default
-                maip_io_printf("{gray}[{green}CASE{gray}] {white}%s{reset} ({green}Tags:{reset} {white}%s{reset}, {green}Criteria:{reset} {white}%s{reset}, {green}Time:{reset} {white}%s{reset}, {green}Result:{reset} %s)\n",
-                                test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            }
-            break;
-        default:
-            maip_io_printf("- %s (Tags: %s, Criteria: %s, Time: %s, Result: %s)\n",
-                            test_case->name, test_case->tags, test_case->criteria, fossil_maip_format_ns(test_case->elapsed_ns), result_str);
-            break;
+            ok = fossil_maip_select_list(filter, "name", pallet->run.only_cases[i]);
+            if (ok && i > 0)
+                ok = fossil_maip_select_emit(filter, FOSSIL_MAIP_SELECT_OR);
+        }
+        ok = ok && fossil_maip_select_join(filter, before);
+    }
+    if (ok && pallet->run.skip)
+        ok = fossil_maip_select_list(&selection->skip, "name", pallet->run.skip);
+
+    if (!ok)
+    {
+        fossil_maip_selection_free(engine);
+        return FOSSIL_MAIP_FAILURE;
+    }
+    selection->tag_count = fossil_maip_tag_count;
+
+    selection->shard_count = 1;
+    if (pallet->run.shard_count > 1)
+    {
+        selection->shard_count = (uint64_t)pallet->run.shard_count;
+        selection->shard_index = (uint64_t)pallet->run.shard_index;
+        selection->shard_by_duration = maip_io_cstr_compare(pallet->run.shard_by, "duration") == 0;
+        if (selection->shard_by_duration && !engine->history)
+        {
+            maip_io_printf("{yellow}Warning: --shard-by duration needs --history, sharding by hash{reset}\n");
+            selection->shard_by_duration = false;
         }
     }
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+void fossil_maip_selection_free(fossil_maip_engine_t *engine)
+{
+    if (!engine || !engine->selection)
+        return;
+    fossil_maip_select_program_free(&engine->selection->filter);
+    fossil_maip_select_program_free(&engine->selection->skip);
+    maip_sys_memory_free(engine->selection->shard_keys);
+    maip_sys_memory_free(engine->selection);
+    engine->selection = null;
+}
+
+// Tags interned after compiling (late groups, bundles) extend the tag masks
+static void fossil_maip_selection_refresh(struct fossil_maip_selection *selection)
+{
+    if (selection->tag_count == fossil_maip_tag_count)
+        return;
+    fossil_maip_select_program_t *filter = &selection->filter;
+    for (size_t i = 0; i < filter->count; ++i)
+    {
+        if (filter->ops[i].kind == FOSSIL_MAIP_SELECT_TAG)
+            fossil_maip_select_resolve_tags(&filter->ops[i]);
+    }
+    selection->tag_count = fossil_maip_tag_count;
+}
+
+static bool fossil_maip_case_in_shard(const struct fossil_maip_selection *selection,
+                                      const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case)
+{
+    if (selection->shard_count <= 1)
+        return true;
+
+    uint64_t key = fossil_maip_case_key(suite->name, test_case->name);
+    if (!selection->shard_by_duration)
+        return key % selection->shard_count == selection->shard_index;
+    if (!selection->shard_planned)
+        return true; // Until run_all plans the shards, any case may be ours
+
+    size_t lo = 0, hi = selection->shard_key_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (selection->shard_keys[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < selection->shard_key_count && selection->shard_keys[lo] == key;
 }
 
-// --- Run One Test ---
+static bool fossil_maip_case_matches(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case)
+{
+    if (!engine->selection)
+        return true;
+    fossil_maip_selection_refresh(engine->selection);
+    return fossil_maip_select_run(&engine->selection->filter, suite, test_case) &&
+           fossil_maip_case_in_shard(engine->selection, suite, test_case);
+}
 
-// Utility function to convert seconds to nanoseconds
-static uint64_t seconds_to_nanoseconds(uint64_t seconds)
+// --- Sharding ---
+// Hash shards need no coordination: every process keeps the cases whose
+// key lands on its index. Duration shards replay the same greedy longest
+// first assignment over the shared history on every machine, so the
+// partition agrees as long as the history file does.
+
+typedef struct
 {
-    return seconds * 1000000000ULL;
+    uint64_t key;
+    uint64_t cost;
+} fossil_maip_shard_item_t;
+
+static int fossil_maip_shard_item_compare(const void *a, const void *b)
+{
+    const fossil_maip_shard_item_t *x = (const fossil_maip_shard_item_t *)a;
+    const fossil_maip_shard_item_t *y = (const fossil_maip_shard_item_t *)b;
+    if (x->cost != y->cost)
+        return x->cost > y->cost ? -1 : 1;
+    if (x->key != y->key)
+        return x->key < y->key ? -1 : 1;
+    return 0;
 }
 
-// from sanity, should be implemented and placed in common.c
-extern uint64_t get_maip_time_microseconds(void);
+static int fossil_maip_shard_key_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
 
-void fossil_maip_run_test(const fossil_maip_engine_t *engine,
-                           fossil_maip_case_t *test_case,
-                           fossil_maip_suite_t *suite)
+// Min-heap of shard loads, ties broken by the lower shard index
+static bool fossil_maip_shard_lighter(const uint64_t *load, uint64_t a, uint64_t b)
 {
-    if (!test_case || !suite || !engine)
-        return;
+    return load[a] != load[b] ? load[a] < load[b] : a < b;
+}
 
-    // --- Filter: --only ---
-    if (engine->pallet.run.only &&
-        maip_io_cstr_compare(engine->pallet.run.only, test_case->name) != 0)
+static void fossil_maip_shard_sift(uint64_t *heap, const uint64_t *load, size_t count, size_t at)
+{
+    for (;;)
     {
-        return;
+        size_t least = at;
+        size_t left = 2 * at + 1;
+        size_t right = left + 1;
+        if (left < count && fossil_maip_shard_lighter(load, heap[left], heap[least]))
+            least = left;
+        if (right < count && fossil_maip_shard_lighter(load, heap[right], heap[least]))
+            least = right;
+        if (least == at)
+            return;
+        uint64_t swap = heap[at];
+        heap[at] = heap[least];
+        heap[least] = swap;
+        at = least;
     }
+}
 
-    // --- Filter: --skip ---
-    if (engine->pallet.run.skip &&
-        maip_io_cstr_compare(engine->pallet.run.skip, test_case->name) == 0)
+int fossil_maip_shard_plan(fossil_maip_engine_t *engine)
+{
+    struct fossil_maip_selection *selection = engine ? engine->selection : null;
+    if (!selection || selection->shard_count <= 1 || !selection->shard_by_duration)
+        return FOSSIL_MAIP_SUCCESS;
+
+    fossil_maip_selection_refresh(selection);
+    size_t total = 0;
+    for (size_t i = 0; i < engine->count; ++i)
+        total += engine->suites[i].count;
+
+    size_t shards = (size_t)selection->shard_count;
+    fossil_maip_shard_item_t *items = maip_sys_memory_alloc((total ? total : 1) * sizeof(*items));
+    uint64_t *load = maip_sys_memory_alloc(shards * sizeof(*load));
+    uint64_t *heap = maip_sys_memory_alloc(shards * sizeof(*heap));
+    uint64_t *mine = maip_sys_memory_alloc((total ? total : 1) * sizeof(*mine));
+    if (!items || !load || !heap || !mine)
     {
-        test_case->state = FOSSIL_MAIP_CASE_SKIPPED;
-        fossil_maip_update_score(test_case, suite);
-        return;
+        maip_sys_memory_free(items);
+        maip_sys_memory_free(load);
+        maip_sys_memory_free(heap);
+        maip_sys_memory_free(mine);
+        return FOSSIL_MAIP_FAILURE;
     }
 
-    size_t repeat_count =
-        (size_t)(engine->pallet.run.repeat > 0 ? engine->pallet.run.repeat : 1);
+    size_t count = 0;
+    for (size_t i = 0; i < engine->count; ++i)
+    {
+        const fossil_maip_suite_t *suite = &engine->suites[i];
+        for (size_t j = 0; j < suite->count; ++j)
+        {
+            const fossil_maip_case_t *test_case = &suite->cases[j];
+            if (!fossil_maip_select_run(&selection->filter, suite, test_case))
+                continue;
+            uint64_t expected = fossil_maip_history_expected_ns(engine->history, suite->name, test_case->name);
+            items[count].key = fossil_maip_case_key(suite->name, test_case->name);
+            items[count].cost = expected ? expected : 1; // New cases still spread out
+            count++;
+        }
+    }
+    qsort(items, count, sizeof(*items), fossil_maip_shard_item_compare);
+
+    for (size_t s = 0; s < shards; ++s)
+    {
+        load[s] = 0;
+        heap[s] = s;
+    }
 
-    for (size_t i = 0; i < repeat_count; ++i)
+    // Longest first onto the least loaded shard
+    size_t owned = 0;
+    for (size_t i = 0; i < count; ++i)
     {
-        if (test_case->setup)
-            test_case->setup();
+        uint64_t shard = heap[0];
+        if (shard == selection->shard_index)
+            mine[owned++] = items[i].key;
+        load[shard] += items[i].cost;
+        fossil_maip_shard_sift(heap, load, shards, 0);
+    }
+    qsort(mine, owned, sizeof(*mine), fossil_maip_shard_key_compare);
+
+    maip_sys_memory_free(items);
+    maip_sys_memory_free(load);
+    maip_sys_memory_free(heap);
+    maip_sys_memory_free(selection->shard_keys);
+    selection->shard_keys = mine;
+    selection->shard_key_count = owned;
+    selection->shard_planned = true;
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+static bool fossil_maip_case_skipped(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite, const fossil_maip_case_t *test_case)
+{
+    return engine->selection && engine->selection->skip.count > 0 &&
+           fossil_maip_select_run(&engine->selection->skip, suite, test_case);
+}
+
+size_t fossil_maip_filter_cases(fossil_maip_suite_t *suite, const fossil_maip_engine_t *engine, fossil_maip_case_t **filtered_cases)
+{
+    if (!suite || !suite->cases || !filtered_cases || !engine)
+        return 0;
 
-        test_case->state = FOSSIL_MAIP_CASE_EMPTY;
-        _ASSERT_COUNT = 0; // Reset before running test
-        uint64_t start_time = fossil_maip_now_ns();
+    size_t count = 0;
+    for (size_t i = 0; i < suite->count; ++i)
+    {
+        fossil_maip_case_t *test_case = &suite->cases[i];
 
-        if (test_case->run)
+        if (!fossil_maip_case_matches(engine, suite, test_case))
         {
-            if (setjmp(test_jump_buffer) == 0)
-            {
-                test_case->run();
+            continue;
+        }
 
-                uint64_t end_time = fossil_maip_now_ns();
-                uint64_t elapsed = end_time - start_time;
-                test_case->elapsed_ns = elapsed;
+        filtered_cases[count++] = test_case;
+    }
+    return count;
+}
 
-#ifndef FOSSIL_MAIP_TIMEOUT
-#define FOSSIL_MAIP_TIMEOUT 60
+// --- Bundles ---
+// Shared objects holding test groups. Their FOSSIL_TEST_GROUP constructors
+// register into the same list as the linked-in groups when they are opened.
+
+typedef struct
+{
+    void *handle;
+    fossil_maip_group_t **tail; // Registry tail before the bundle was opened
+} fossil_maip_bundle_t;
+
+static fossil_maip_bundle_t *fossil_maip_bundles = null;
+static size_t fossil_maip_bundle_count = 0;
+
+static void *fossil_maip_bundle_open(const char *path)
+{
+#ifdef _WIN32
+    return (void *)LoadLibraryA(path);
+#else
+    return dlopen(path, RTLD_NOW | RTLD_LOCAL);
 #endif
+}
 
-                if (elapsed > seconds_to_nanoseconds(FOSSIL_MAIP_TIMEOUT))
-                {
-                    test_case->state = FOSSIL_MAIP_CASE_TIMEOUT;
-                }
-                else if (_ASSERT_COUNT == 0)
-                {
-                    test_case->state = FOSSIL_MAIP_CASE_EMPTY;
-                }
-                else
-                {
-                    test_case->state = FOSSIL_MAIP_CASE_PASS;
-                }
-            }
-            else
-            {
-                test_case->state = FOSSIL_MAIP_CASE_FAIL;
-                test_case->elapsed_ns = fossil_maip_now_ns() - start_time;
+static void fossil_maip_bundle_close(void *handle)
+{
+#ifdef _WIN32
+    FreeLibrary((HMODULE)handle);
+#else
+    dlclose(handle);
+#endif
+}
 
-                if (engine->pallet.run.fail_fast)
-                {
-                    fossil_maip_update_score(test_case, suite);
-                    fossil_maip_show_cases(suite, test_case, engine);
-                    return;
-                }
-            }
-        }
-        else
+static const char *fossil_maip_bundle_error(void)
+{
+#ifdef _WIN32
+    static char message[32];
+    snprintf(message, sizeof(message), "error %lu", (unsigned long)GetLastError());
+    return message;
+#else
+    const char *message = dlerror();
+    return message ? message : "unknown error";
+#endif
+}
+
+// Drops the groups a bundle registered so the list never points into
+// unmapped memory
+static void fossil_maip_registry_rewind(fossil_maip_group_t **tail)
+{
+    *tail = NULL;
+    fossil_maip_group_tail = tail;
+}
+
+// True when no filter is active or one of the suites has a selected case
+static bool fossil_maip_bundle_selected(const fossil_maip_engine_t *engine, size_t first_suite)
+{
+    if (!engine->selection || (engine->selection->filter.count == 0 && engine->selection->shard_count <= 1))
+        return true;
+
+    for (size_t i = first_suite; i < engine->count; ++i)
+    {
+        const fossil_maip_suite_t *suite = &engine->suites[i];
+        for (size_t j = 0; j < suite->count; ++j)
         {
-            test_case->state = FOSSIL_MAIP_CASE_EMPTY;
-            test_case->elapsed_ns = 0;
+            if (fossil_maip_case_matches(engine, suite, &suite->cases[j]))
+                return true;
         }
+    }
+    return false;
+}
+
+int fossil_maip_load_bundle(fossil_maip_engine_t *engine, const char *path)
+{
+    if (!engine || !path)
+        return FOSSIL_MAIP_FAILURE;
 
-        if (test_case->teardown)
-            test_case->teardown();
+    fossil_maip_bundle_t *resized = maip_sys_memory_realloc(fossil_maip_bundles,
+                                                            (fossil_maip_bundle_count + 1) * sizeof(*fossil_maip_bundles));
+    if (!resized)
+        return FOSSIL_MAIP_FAILURE;
+    fossil_maip_bundles = resized;
+
+    fossil_maip_group_t **tail = fossil_maip_group_tail;
+    size_t first_suite = engine->count;
+
+    void *handle = fossil_maip_bundle_open(path);
+    if (!handle)
+    {
+        fossil_maip_registry_rewind(tail);
+        maip_io_printf("{red}Cannot load bundle %s: %s{reset}\n", path, fossil_maip_bundle_error());
+        return FOSSIL_MAIP_FAILURE;
     }
 
-    fossil_maip_update_score(test_case, suite);
-    fossil_maip_show_cases(suite, test_case, engine);
+    fossil_maip_load_groups(engine);
+
+    // Nothing in the bundle survives the filters, so don't keep it mapped
+    if (!fossil_maip_bundle_selected(engine, first_suite))
+    {
+        for (size_t i = first_suite; i < engine->count; ++i)
+            maip_sys_memory_free(engine->suites[i].cases);
+        engine->count = first_suite;
+        fossil_maip_registry_rewind(tail);
+        fossil_maip_bundle_close(handle);
+        return FOSSIL_MAIP_SUCCESS;
+    }
+
+    fossil_maip_bundles[fossil_maip_bundle_count].handle = handle;
+    fossil_maip_bundles[fossil_maip_bundle_count].tail = tail;
+    fossil_maip_bundle_count++;
+    return FOSSIL_MAIP_SUCCESS;
 }
 
-// --- Algorithmic modifications ---
+// Closes bundles newest first, once nothing can call into them anymore
+static void fossil_maip_unload_bundles(void)
+{
+    while (fossil_maip_bundle_count > 0)
+    {
+        fossil_maip_bundle_t *bundle = &fossil_maip_bundles[--fossil_maip_bundle_count];
+        fossil_maip_registry_rewind(bundle->tail);
+        fossil_maip_bundle_close(bundle->handle);
+    }
+    maip_sys_memory_free(fossil_maip_bundles);
+    fossil_maip_bundles = null;
+}
 
-// --- Sorting Test Cases ---
-static int compare_name_asc(const void *a, const void *b)
+// --- Random Numbers ---
+// xoshiro256** (Blackman and Vigna) seeded through splitmix64, so any seed,
+// 0 included, gives a well-mixed state and the same sequence everywhere.
+
+static uint64_t fossil_maip_splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t fossil_maip_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+void fossil_maip_rng_seed(fossil_maip_rng_t *rng, uint64_t seed)
 {
-    return maip_io_cstr_compare(((fossil_maip_case_t *)a)->name, ((fossil_maip_case_t *)b)->name);
+    if (!rng)
+        return;
+    uint64_t x = seed;
+    rng->seed = seed;
+    for (size_t i = 0; i < 4; ++i)
+        rng->state[i] = fossil_maip_splitmix64(&x);
 }
 
-static int compare_name_desc(const void *a, const void *b)
+uint64_t fossil_maip_rng_next(fossil_maip_rng_t *rng)
 {
-    return maip_io_cstr_compare(((fossil_maip_case_t *)b)->name, ((fossil_maip_case_t *)a)->name);
+    uint64_t *s = rng->state;
+    uint64_t result = fossil_maip_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = fossil_maip_rotl(s[3], 45);
+    return result;
 }
 
-static int compare_result_asc(const void *a, const void *b)
+uint64_t fossil_maip_rng_below(fossil_maip_rng_t *rng, uint64_t bound)
 {
-    return ((fossil_maip_case_t *)a)->state - ((fossil_maip_case_t *)b)->state;
+    if (bound == 0)
+        return 0;
+    // Reject the low values that would make the modulo uneven
+    uint64_t threshold = (0 - bound) % bound;
+    for (;;)
+    {
+        uint64_t r = fossil_maip_rng_next(rng);
+        if (r >= threshold)
+            return r % bound;
+    }
 }
 
-static int compare_result_desc(const void *a, const void *b)
+double fossil_maip_rng_unit(fossil_maip_rng_t *rng)
 {
-    return ((fossil_maip_case_t *)b)->state - ((fossil_maip_case_t *)a)->state;
+    return (double)(fossil_maip_rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
 }
 
-static int compare_time_asc(const void *a, const void *b)
+// Seed from shuffle --seed: a number as given, any other text hashed.
+// Without one, the clock, pid and stack address are mixed together.
+static uint64_t fossil_maip_shuffle_seed(const fossil_maip_engine_t *engine)
 {
-    return ((fossil_maip_case_t *)a)->elapsed_ns - ((fossil_maip_case_t *)b)->elapsed_ns;
+    const char *text = engine->pallet.shuffle.seed;
+    if (text && *text)
+    {
+        char *end = null;
+        errno = 0;
+        unsigned long long value = strtoull(text, &end, 0);
+        if (errno == 0 && end && *end == '\0')
+            return (uint64_t)value;
+        return fossil_maip_case_key(text, "");
+    }
+
+    uint64_t x = fossil_maip_now_ns() ^ ((uint64_t)(uintptr_t)&text << 16);
+#ifndef _WIN32
+    x ^= (uint64_t)getpid() << 40;
+#endif
+    return fossil_maip_splitmix64(&x);
 }
 
-static int compare_time_desc(const void *a, const void *b)
+// --- Shuffling Test Cases ---
+// The selection is permuted through an index array; only the final pass
+// moves case pointers. Weighted mode uses Efraimidis-Spirakis keys,
+// log(u) / weight sorted descending, so heavier cases tend to come first
+// while every order stays possible.
+
+typedef struct
+{
+    double key;
+    uint32_t index;
+} fossil_maip_shuffle_key_t;
+
+static int fossil_maip_shuffle_key_compare(const void *a, const void *b)
 {
-    return ((fossil_maip_case_t *)b)->elapsed_ns - ((fossil_maip_case_t *)a)->elapsed_ns;
+    const fossil_maip_shuffle_key_t *x = (const fossil_maip_shuffle_key_t *)a;
+    const fossil_maip_shuffle_key_t *y = (const fossil_maip_shuffle_key_t *)b;
+    if (x->key != y->key)
+        return x->key > y->key ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
 }
 
-static int compare_priority_asc(const void *a, const void *b)
+static int fossil_maip_index_compare(const void *a, const void *b)
 {
-    return ((fossil_maip_case_t *)a)->priority - ((fossil_maip_case_t *)b)->priority;
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
 }
 
-static int compare_priority_desc(const void *a, const void *b)
+// Weight of a case for --mode weighted, always > 0
+static double fossil_maip_shuffle_weight(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite,
+                                         const fossil_maip_case_t *test_case, int64_t min_priority)
 {
-    return ((fossil_maip_case_t *)b)->priority - ((fossil_maip_case_t *)a)->priority;
+    if (suite && maip_io_cstr_compare(engine->pallet.shuffle.by, "failures") == 0)
+        return fossil_maip_history_failure_rate(engine->history, suite->name, test_case->name);
+
+    // Lower priority values are more important
+    return 1.0 / (1.0 + (double)(test_case->priority - min_priority));
 }
 
-void fossil_maip_sort_cases(fossil_maip_suite_t *suite, const fossil_maip_engine_t *engine)
+static void fossil_maip_shuffle_suite(const fossil_maip_engine_t *engine, const fossil_maip_suite_t *suite,
+                                      fossil_maip_case_t **cases, size_t count)
 {
-    if (!suite || !suite->cases || suite->count <= 1 || !engine)
+    if (!cases || count < 2 || !engine || !engine->pallet.shuffle.enabled || count > UINT32_MAX)
         return;
 
-    int (*compare)(const void *, const void *) = NULL;
+    // Engines set up by fossil_maip_start share one stream across suites
+    fossil_maip_rng_t local;
+    fossil_maip_rng_t *rng = engine->rng;
+    if (!rng)
+    {
+        rng = &local;
+        fossil_maip_rng_seed(rng, fossil_maip_shuffle_seed(engine));
+    }
+
+    size_t draw = engine->pallet.shuffle.count > 0 && (size_t)engine->pallet.shuffle.count < count
+                      ? (size_t)engine->pallet.shuffle.count
+                      : count;
+    bool weighted = maip_io_cstr_compare(engine->pallet.shuffle.mode, "weighted") == 0;
+
+    uint32_t *order = (uint32_t *)maip_sys_memory_alloc(count * sizeof(*order));
+    fossil_maip_case_t **moved = (fossil_maip_case_t **)maip_sys_memory_alloc(count * sizeof(*moved));
+    fossil_maip_shuffle_key_t *keys = weighted ? (fossil_maip_shuffle_key_t *)maip_sys_memory_alloc(count * sizeof(*keys)) : null;
+    if (!order || !moved || (weighted && !keys))
+    {
+        maip_sys_memory_free(order);
+        maip_sys_memory_free(moved);
+        maip_sys_memory_free(keys);
+        return;
+    }
 
-    if (engine->pallet.sort.by)
+    if (weighted)
     {
-        if (maip_io_cstr_compare(engine->pallet.sort.by, "name") == 0)
+        int64_t min_priority = cases[0]->priority;
+        for (size_t i = 1; i < count; ++i)
+        {
+            if (cases[i]->priority < min_priority)
+                min_priority = cases[i]->priority;
+        }
+        for (size_t i = 0; i < count; ++i)
         {
-            compare = (maip_io_cstr_compare(engine->pallet.sort.order, "desc") == 0) ? compare_name_desc : compare_name_asc;
+            // 1 - unit is in (0, 1], so the log is finite
+            double u = 1.0 - fossil_maip_rng_unit(rng);
+            keys[i].key = log(u) / fossil_maip_shuffle_weight(engine, suite, cases[i], min_priority);
+            keys[i].index = (uint32_t)i;
         }
-        else if (maip_io_cstr_compare(engine->pallet.sort.by, "result") == 0)
+        qsort(keys, count, sizeof(*keys), fossil_maip_shuffle_key_compare);
+        for (size_t i = 0; i < count; ++i)
+            order[i] = keys[i].index;
+    }
+    else
+    {
+        // Fisher-Yates from the front; stopping after `draw` steps leaves a
+        // uniform sample of that size in the first positions
+        for (size_t i = 0; i < count; ++i)
+            order[i] = (uint32_t)i;
+        for (size_t i = 0; i < draw && i + 1 < count; ++i)
         {
-            compare = (maip_io_cstr_compare(engine->pallet.sort.order, "desc") == 0) ? compare_result_desc : compare_result_asc;
+            size_t j = i + (size_t)fossil_maip_rng_below(rng, count - i);
+            uint32_t temp = order[i];
+            order[i] = order[j];
+            order[j] = temp;
         }
-        else if (maip_io_cstr_compare(engine->pallet.sort.by, "time") == 0)
+    }
+
+    // With --count only the drawn cases move up; the rest keep their order
+    if (draw < count)
+        qsort(order + draw, count - draw, sizeof(*order), fossil_maip_index_compare);
+
+    for (size_t i = 0; i < count; ++i)
+        moved[i] = cases[order[i]];
+    memcpy(cases, moved, count * sizeof(*cases));
+
+    maip_sys_memory_free(order);
+    maip_sys_memory_free(moved);
+    maip_sys_memory_free(keys);
+}
+
+void fossil_maip_shuffle_cases(fossil_maip_case_t **cases, size_t count, const fossil_maip_engine_t *engine)
+{
+    fossil_maip_shuffle_suite(engine, null, cases, count);
+}
+
+// --- Run One Suite ---
+int fossil_maip_run_suite(const fossil_maip_engine_t *engine, fossil_maip_suite_t *suite)
+{
+    if (!suite || !suite->cases)
+        return FOSSIL_MAIP_FAILURE;
+
+    // --- Filtering ---
+    // Pointers into suite->cases, which never moves; sort and shuffle only
+    // permute this array, so the selection and its order stay in step
+    fossil_maip_case_t **filtered_cases = null;
+    size_t filtered_count = 0;
+    if (suite->count > 0)
+    {
+        filtered_cases = maip_sys_memory_alloc(suite->count * sizeof(*filtered_cases));
+        if (!filtered_cases)
+            return FOSSIL_MAIP_FAILURE;
+        filtered_count = fossil_maip_filter_cases(suite, engine, filtered_cases);
+    }
+
+    // A nested run restores the enclosing suite when it returns
+    const void *outer_suite = fossil_maip_fixture_suite;
+    fossil_maip_fixture_suite = suite;
+
+    // Suite setup only pays off when one of its cases will actually run
+    bool needed = fossil_maip_runs_any(engine, suite, filtered_cases, filtered_count);
+    if (needed && suite->setup)
+        suite->setup();
+
+    // --- Reset suite stats ---
+    suite->time_elapsed_ns = fossil_maip_now_ns();
+    suite->total_score = 0;
+    suite->total_possible = 0;
+    maip_sys_memory_set(&suite->score, 0, sizeof(suite->score));
+
+    fossil_maip_report_suite(engine, suite, true);
+
+    if (filtered_count > 0)
+    {
+        fossil_maip_sort_cases(filtered_cases, filtered_count, engine);
+        fossil_maip_shuffle_suite(engine, suite, filtered_cases, filtered_count);
+
+        size_t jobs = engine->pallet.run.jobs > 1 ? (size_t)engine->pallet.run.jobs : 1;
+        size_t procs = engine->pallet.run.isolate > 0 ? (size_t)engine->pallet.run.isolate : 0;
+
+        // An explicit sort or shuffle wins over the history's schedule
+        if (!engine->pallet.sort.by && !engine->pallet.shuffle.enabled)
+            fossil_maip_history_schedule(engine->history, suite, filtered_cases, filtered_count, jobs > 1 || procs > 1);
+
+#ifndef _WIN32
+
+        if (procs > 0 &&
+            fossil_maip_run_isolated(engine, suite, filtered_cases, filtered_count, procs) == FOSSIL_MAIP_SUCCESS)
         {
-            compare = (maip_io_cstr_compare(engine->pallet.sort.order, "desc") == 0) ? compare_time_desc : compare_time_asc;
+            // cases ran in worker processes
         }
-        else if (maip_io_cstr_compare(engine->pallet.sort.by, "priority") == 0)
+        else
+#endif
+        if (jobs > 1 && filtered_count > 1)
         {
-            compare = (maip_io_cstr_compare(engine->pallet.sort.order, "desc") == 0) ? compare_priority_desc : compare_priority_asc;
+            fossil_maip_run_parallel(engine, suite, filtered_cases, filtered_count, jobs);
         }
         else
         {
-            // Invalid sort criteria
-            return;
+            for (size_t i = 0; i < filtered_count; ++i)
+            {
+                fossil_maip_case_t *test_case = filtered_cases[i];
+                fossil_maip_run_test(engine, test_case, suite);
+            }
+        }
+    }
+
+    suite->time_elapsed_ns = fossil_maip_now_ns() - suite->time_elapsed_ns;
+
+    fossil_maip_report_suite(engine, suite, false);
+    fossil_maip_history_record(engine->history, suite, filtered_cases, filtered_count);
+    maip_sys_memory_free(filtered_cases);
+
+    if (needed && suite->teardown)
+        suite->teardown();
+
+    // After the suite teardown, which may still use them
+    fossil_maip_fixture_release(FOSSIL_MAIP_SCOPE_SUITE, suite);
+    fossil_maip_fixture_suite = outer_suite;
+
+    return FOSSIL_MAIP_SUCCESS;
+}
+
+// --- Shard Merging ---
+// Replays the JSON Lines reports of several shards onto the engine's suites,
+// as if the cases had run here, so the score, summary and any report sink
+// see one run. Cases are matched by suite and name; unknown ones are added.
+
+typedef struct
+{
+    uint64_t key;    // Case key, 0 marks a free slot
+    size_t suite;    // Index into engine->suites
+    size_t index;    // Index into the suite's cases
+    char *message;   // Failure message from the report, may be null
+    size_t records;  // Report lines that carried this case
+} fossil_maip_merge_entry_t;
+
+typedef struct
+{
+    fossil_maip_merge_entry_t *entries;
+    size_t capacity; // Power of two
+    size_t count;
+} fossil_maip_merge_index_t;
+
+// Strings owned by merged suites and cases, released by fossil_maip_end
+static char **fossil_maip_merge_strings = null;
+static size_t fossil_maip_merge_string_count = 0;
+
+static char *fossil_maip_merge_keep(const char *text)
+{
+    char **resized = maip_sys_memory_realloc(fossil_maip_merge_strings,
+                                             (fossil_maip_merge_string_count + 1) * sizeof(*fossil_maip_merge_strings));
+    if (!resized)
+        return null;
+    fossil_maip_merge_strings = resized;
+
+    size_t length = strlen(text);
+    char *copy = (char *)maip_sys_memory_alloc(length + 1);
+    if (copy)
+    {
+        memcpy(copy, text, length + 1);
+        fossil_maip_merge_strings[fossil_maip_merge_string_count++] = copy;
+    }
+    return copy;
+}
+
+static void fossil_maip_merge_release(void)
+{
+    for (size_t i = 0; i < fossil_maip_merge_string_count; ++i)
+        maip_sys_memory_free(fossil_maip_merge_strings[i]);
+    maip_sys_memory_free(fossil_maip_merge_strings);
+    fossil_maip_merge_strings = null;
+    fossil_maip_merge_string_count = 0;
+}
+
+static fossil_maip_merge_entry_t *fossil_maip_merge_slot(const fossil_maip_merge_index_t *index, uint64_t key)
+{
+    size_t mask = index->capacity - 1;
+    for (size_t slot = (size_t)key & mask;; slot = (slot + 1) & mask)
+    {
+        fossil_maip_merge_entry_t *entry = &index->entries[slot];
+        if (entry->key == key || entry->key == 0)
+            return entry;
+    }
+}
+
+static bool fossil_maip_merge_insert(fossil_maip_merge_index_t *index, uint64_t key, size_t suite, size_t position)
+{
+    if (2 * (index->count + 1) > index->capacity)
+    {
+        size_t capacity = index->capacity ? index->capacity * 2 : 1024;
+        fossil_maip_merge_entry_t *entries = maip_sys_memory_alloc(capacity * sizeof(*entries));
+        if (!entries)
+            return false;
+        maip_sys_memory_set(entries, 0, capacity * sizeof(*entries));
+
+        fossil_maip_merge_index_t grown = {entries, capacity, index->count};
+        for (size_t i = 0; i < index->capacity; ++i)
+        {
+            if (index->entries[i].key != 0)
+                *fossil_maip_merge_slot(&grown, index->entries[i].key) = index->entries[i];
         }
+        maip_sys_memory_free(index->entries);
+        *index = grown;
     }
 
-    if (compare)
+    fossil_maip_merge_entry_t *entry = fossil_maip_merge_slot(index, key);
+    if (entry->key == 0)
+    {
+        entry->key = key;
+        entry->suite = suite;
+        entry->index = position;
+        index->count++;
+    }
+    return true;
+}
+
+// Copies the string value of "key" out of a report line, undoing the
+// escapes fossil_maip_report_json_string writes
+static bool fossil_maip_merge_string(const char *line, const char *key, char *out, size_t size)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    const char *p = strstr(line, pattern);
+    if (!p)
+        return false;
+    p += strlen(pattern);
+
+    size_t n = 0;
+    for (; *p && *p != '"' && n + 1 < size; ++p)
+    {
+        char c = *p;
+        if (c == '\\' && p[1])
+        {
+            c = *++p;
+            if (c == 'n')
+                c = '\n';
+            else if (c == 'r')
+                c = '\r';
+            else if (c == 't')
+                c = '\t';
+            else if (c == 'u')
+            {
+                unsigned int code = 0;
+                if (sscanf(p + 1, "%4x", &code) != 1)
+                    return false;
+                c = code < 0x80 ? (char)code : '?';
+                p += 4;
+            }
+        }
+        out[n++] = c;
+    }
+    out[n] = '\0';
+    return *p == '"';
+}
+
+static uint64_t fossil_maip_merge_number(const char *line, const char *key)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *p = strstr(line, pattern);
+    return p ? strtoull(p + strlen(pattern), null, 10) : 0;
+}
+
+static fossil_maip_state_t fossil_maip_merge_state(const char *result)
+{
+    for (int state = FOSSIL_MAIP_CASE_EMPTY; state <= FOSSIL_MAIP_CASE_UNEXPECTED; ++state)
     {
-        qsort(suite->cases, suite->count, sizeof(fossil_maip_case_t), compare);
+        if (strcmp(fossil_maip_state_name((fossil_maip_state_t)state), result) == 0)
+            return (fossil_maip_state_t)state;
     }
+    return FOSSIL_MAIP_CASE_UNEXPECTED;
 }
 
-// --- Filtering Test Cases ---
-size_t fossil_maip_filter_cases(fossil_maip_suite_t *suite, const fossil_maip_engine_t *engine, fossil_maip_case_t **filtered_cases)
+static size_t fossil_maip_merge_suite(fossil_maip_engine_t *engine, const char *name)
 {
-    if (!suite || !suite->cases || !filtered_cases || !engine)
-        return 0;
-
-    size_t count = 0;
-    for (size_t i = 0; i < suite->count; ++i)
+    for (size_t i = 0; i < engine->count; ++i)
     {
-        fossil_maip_case_t *test_case = &suite->cases[i];
+        if (maip_io_cstr_compare(engine->suites[i].name, name) == 0)
+            return i;
+    }
 
-        // Apply filters based on engine->pallet.filter
-        if (engine->pallet.filter.test_name && maip_io_cstr_compare(test_case->name, engine->pallet.filter.test_name) != 0)
-        {
-            continue;
-        }
-        if (engine->pallet.filter.name && maip_io_cstr_compare(suite->name, engine->pallet.filter.name) != 0)
-        {
-            continue;
-        }
-        if (engine->pallet.filter.tag && (!test_case->tags || !strstr(test_case->tags, engine->pallet.filter.tag)))
-        {
-            continue;
-        }
+    fossil_maip_suite_t suite;
+    maip_sys_memory_set(&suite, 0, sizeof(suite));
+    suite.name = fossil_maip_merge_keep(name);
+    if (!suite.name || fossil_maip_add_suite(engine, suite) != FOSSIL_MAIP_SUCCESS)
+        return SIZE_MAX;
+    return engine->count - 1;
+}
 
-        filtered_cases[count++] = test_case;
+// Sums the suites into the engine, as run_all does after running them
+static void fossil_maip_engine_tally(fossil_maip_engine_t *engine)
+{
+    maip_sys_memory_set(&engine->score, 0, sizeof(engine->score));
+    engine->score_total = 0;
+    engine->score_possible = 0;
+    for (size_t i = 0; i < engine->count; ++i)
+    {
+        engine->score_total += engine->suites[i].total_score;
+        engine->score_possible += engine->suites[i].total_possible;
+        fossil_maip_score_merge(&engine->score, &engine->suites[i].score);
     }
-    return count;
 }
 
-// --- Shuffling Test Cases ---
-void fossil_maip_shuffle_cases(fossil_maip_suite_t *suite, const fossil_maip_engine_t *engine)
+int fossil_maip_merge_reports(fossil_maip_engine_t *engine, const char *const *paths, size_t count)
 {
-    if (!suite || !suite->cases || suite->count < 2)
-        return;
-
-    unsigned int seed = (engine && engine->pallet.shuffle.seed)
-                            ? (unsigned int)atoi(engine->pallet.shuffle.seed)
-                            : (unsigned int)time(NULL);
-    srand(seed);
+    if (!engine || !paths)
+        return FOSSIL_MAIP_FAILURE;
 
-    // Fisher-Yates shuffle
-    for (size_t i = suite->count - 1; i > 0; --i)
+    for (size_t i = 0; i < engine->count; ++i)
     {
-        size_t j = rand() % (i + 1);
-        fossil_maip_case_t temp = suite->cases[i];
-        suite->cases[i] = suite->cases[j];
-        suite->cases[j] = temp;
+        fossil_maip_suite_t *suite = &engine->suites[i];
+        suite->time_elapsed_ns = 0;
+        suite->total_score = 0;
+        suite->total_possible = 0;
+        maip_sys_memory_set(&suite->score, 0, sizeof(suite->score));
     }
 
-    // Optional secondary shuffle/sort by field
-    if (engine && engine->pallet.shuffle.by)
+    fossil_maip_merge_index_t index = {null, 0, 0};
+    int status = FOSSIL_MAIP_SUCCESS;
+    for (size_t i = 0; status == FOSSIL_MAIP_SUCCESS && i < engine->count; ++i)
     {
-        if (maip_io_cstr_compare(engine->pallet.shuffle.by, "name") == 0)
-        {
-            qsort(suite->cases, suite->count, sizeof(fossil_maip_case_t), compare_name_asc);
-        }
-        else if (maip_io_cstr_compare(engine->pallet.shuffle.by, "result") == 0)
-        {
-            qsort(suite->cases, suite->count, sizeof(fossil_maip_case_t), compare_result_asc);
-        }
-        else if (maip_io_cstr_compare(engine->pallet.shuffle.by, "time") == 0)
-        {
-            qsort(suite->cases, suite->count, sizeof(fossil_maip_case_t), compare_time_asc);
-        }
-        else if (maip_io_cstr_compare(engine->pallet.shuffle.by, "priority") == 0)
+        for (size_t j = 0; j < engine->suites[i].count; ++j)
         {
-            qsort(suite->cases, suite->count, sizeof(fossil_maip_case_t), compare_priority_asc);
+            uint64_t key = fossil_maip_case_key(engine->suites[i].name, engine->suites[i].cases[j].name);
+            if (!fossil_maip_merge_insert(&index, key, i, j))
+                status = FOSSIL_MAIP_FAILURE;
         }
     }
-}
 
-// --- Run One Suite ---
-int fossil_maip_run_suite(const fossil_maip_engine_t *engine, fossil_maip_suite_t *suite)
-{
-    if (!suite || !suite->cases)
-        return FOSSIL_MAIP_FAILURE;
+    char *line = (char *)maip_sys_memory_alloc(FOSSIL_MAIP_REPORT_BUFFER);
+    char *suite_name = (char *)maip_sys_memory_alloc(FOSSIL_MAIP_REPORT_BUFFER);
+    char *text = (char *)maip_sys_memory_alloc(FOSSIL_MAIP_REPORT_BUFFER);
+    if (!line || !suite_name || !text)
+        status = FOSSIL_MAIP_FAILURE;
 
-    if (suite->setup)
-        suite->setup();
+    for (size_t f = 0; status == FOSSIL_MAIP_SUCCESS && f < count; ++f)
+    {
+        FILE *in = fopen(paths[f], "r");
+        if (!in)
+        {
+            maip_io_printf("{red}Cannot open shard report: %s{reset}\n", paths[f]);
+            status = FOSSIL_MAIP_FAILURE;
+            break;
+        }
 
-    // --- Reset suite stats ---
-    suite->time_elapsed_ns = fossil_maip_now_ns();
-    suite->total_score = 0;
-    suite->total_possible = 0;
-    maip_sys_memory_set(&suite->score, 0, sizeof(suite->score));
+        while (status == FOSSIL_MAIP_SUCCESS && fgets(line, FOSSIL_MAIP_REPORT_BUFFER, in))
+        {
+            bool suite_record = strncmp(line, "{\"type\":\"suite\"", 15) == 0;
+            if ((!suite_record && strncmp(line, "{\"type\":\"case\"", 14) != 0) ||
+                !fossil_maip_merge_string(line, "suite", suite_name, FOSSIL_MAIP_REPORT_BUFFER))
+                continue; // Summary lines, or not one of ours
 
-    // --- Filtering ---
-    fossil_maip_case_t *filtered_cases[suite->count];
-    size_t filtered_count = fossil_maip_filter_cases(suite, engine, filtered_cases);
+            size_t s = fossil_maip_merge_suite(engine, suite_name);
+            if (s == SIZE_MAX)
+            {
+                status = FOSSIL_MAIP_FAILURE;
+                break;
+            }
+            fossil_maip_suite_t *suite = &engine->suites[s];
+            if (suite_record)
+            {
+                suite->time_elapsed_ns += fossil_maip_merge_number(line, "elapsed_ns");
+                continue;
+            }
 
-    if (filtered_count > 0)
-    {
-        fossil_maip_sort_cases(suite, engine);
-        fossil_maip_shuffle_cases(suite, engine);
+            if (!fossil_maip_merge_string(line, "case", text, FOSSIL_MAIP_REPORT_BUFFER))
+                continue;
+            uint64_t key = fossil_maip_case_key(suite->name, text);
+            if (!fossil_maip_merge_insert(&index, key, s, suite->count))
+            {
+                status = FOSSIL_MAIP_FAILURE;
+                break;
+            }
+            fossil_maip_merge_entry_t *entry = fossil_maip_merge_slot(&index, key);
+            if (entry->suite == s && entry->index == suite->count)
+            {
+                // Not registered here: keep a record of it
+                fossil_maip_case_t test_case;
+                maip_sys_memory_set(&test_case, 0, sizeof(test_case));
+                test_case.name = fossil_maip_merge_keep(text);
+                if (fossil_maip_merge_string(line, "tags", text, FOSSIL_MAIP_REPORT_BUFFER))
+                    test_case.tags = fossil_maip_merge_keep(text);
+                if (!test_case.name || fossil_maip_add_case(suite, test_case) != FOSSIL_MAIP_SUCCESS)
+                {
+                    status = FOSSIL_MAIP_FAILURE;
+                    break;
+                }
+            }
+            fossil_maip_case_t *test_case = &engine->suites[entry->suite].cases[entry->index];
+            test_case->state = fossil_maip_merge_state(fossil_maip_merge_string(line, "result", text, FOSSIL_MAIP_REPORT_BUFFER) ? text : "");
+            test_case->elapsed_ns = fossil_maip_merge_number(line, "elapsed_ns");
+            if (fossil_maip_merge_string(line, "message", text, FOSSIL_MAIP_REPORT_BUFFER))
+                entry->message = fossil_maip_merge_keep(text);
+            entry->records++; // Cases registered twice run, and report, twice
+            fossil_maip_update_score(test_case, &engine->suites[entry->suite]);
+        }
+        fclose(in);
+    }
 
-        for (size_t i = 0; i < filtered_count; ++i)
+    // Report suite by suite, so grouped formats such as JUnit stay well formed
+    for (size_t i = 0; status == FOSSIL_MAIP_SUCCESS && i < engine->count; ++i)
+    {
+        fossil_maip_suite_t *suite = &engine->suites[i];
+        fossil_maip_report_suite(engine, suite, true);
+        for (size_t j = 0; j < suite->count; ++j)
         {
-            fossil_maip_case_t *test_case = filtered_cases[i];
-            fossil_maip_run_test(engine, test_case, suite);
+            const fossil_maip_merge_entry_t *entry =
+                fossil_maip_merge_slot(&index, fossil_maip_case_key(suite->name, suite->cases[j].name));
+            for (size_t r = 0; entry->suite == i && entry->index == j && r < entry->records; ++r)
+                fossil_maip_report_case(engine, suite, &suite->cases[j], entry->message);
         }
+        fossil_maip_report_suite(engine, suite, false);
     }
 
-    suite->time_elapsed_ns = fossil_maip_now_ns() - suite->time_elapsed_ns;
-
-    if (suite->teardown)
-        suite->teardown();
-
-    return FOSSIL_MAIP_SUCCESS;
+    fossil_maip_engine_tally(engine);
+    maip_sys_memory_free(index.entries);
+    maip_sys_memory_free(line);
+    maip_sys_memory_free(suite_name);
+    maip_sys_memory_free(text);
+    return status;
 }
 
 // --- Run All Suites ---
@@ -863,29 +6055,28 @@ int fossil_maip_run_all(fossil_maip_engine_t *engine)
     if (!engine)
         return FOSSIL_MAIP_FAILURE;
 
-    // --- Reset global engine score ---
-    maip_sys_memory_set(&engine->score, 0, sizeof(engine->score));
-    engine->score_total = 0;
-    engine->score_possible = 0;
+    fossil_maip_report_open(engine);
+    fossil_maip_shard_plan(engine);
 
-    // --- Run all test suites ---
-    for (size_t i = 0; i < engine->count; ++i)
+    // Shard reports stand in for running the suites
+    int status = FOSSIL_MAIP_SUCCESS;
+    if (engine->pallet.report.merge_count > 0)
     {
-        fossil_maip_run_suite(engine, &engine->suites[i]);
-
-        engine->score_total += engine->suites[i].total_score;
-        engine->score_possible += engine->suites[i].total_possible;
-
-        const fossil_maip_score_t *src = &engine->suites[i].score;
-        engine->score.passed += src->passed;
-        engine->score.failed += src->failed;
-        engine->score.skipped += src->skipped;
-        engine->score.timeout += src->timeout;
-        engine->score.unexpected += src->unexpected;
-        engine->score.empty += src->empty;
+        status = fossil_maip_merge_reports(engine, (const char *const *)engine->pallet.report.merge,
+                                           engine->pallet.report.merge_count);
+        engine->merge_failed = status != FOSSIL_MAIP_SUCCESS; // Reported again by fossil_maip_end
+    }
+    else
+    {
+        // --- Run all test suites ---
+        for (size_t i = 0; i < engine->count; ++i)
+            fossil_maip_run_suite(engine, &engine->suites[i]);
+        fossil_maip_engine_tally(engine);
     }
 
-    return FOSSIL_MAIP_SUCCESS;
+    fossil_maip_report_close();
+
+    return status;
 }
 
 // --- Summary Report ---
@@ -1613,6 +6804,33 @@ void fossil_maip_ai_feedback(const fossil_maip_engine_t *engine)
     }
 }
 
+// Failed assertions grouped by fingerprint, largest clusters first
+void fossil_maip_summary_failures(const fossil_maip_engine_t *engine)
+{
+    if (!engine)
+        return;
+
+    fossil_maip_failure_flush();
+    size_t failures = 0, clusters = 0, sites = 0;
+    fossil_maip_failure_totals(&failures, &clusters, &sites);
+    if (failures == 0)
+        return;
+
+    maip_io_printf("{bright_black}[{cyan}::{bright_black}] {blue}Failures     {reset}: {cyan}%zu{reset} failed assertion%s, {cyan}%zu{reset} distinct root site%s, {cyan}%zu{reset} cluster%s\n",
+                   failures, failures == 1 ? "" : "s", sites, sites == 1 ? "" : "s", clusters, clusters == 1 ? "" : "s");
+
+    fossil_maip_failure_cluster_t top[5];
+    size_t shown = fossil_maip_failure_top(top, sizeof(top) / sizeof(top[0]));
+    for (size_t i = 0; i < shown; ++i)
+    {
+        maip_io_printf("{bright_black}[{cyan}::{bright_black}]   {cyan}%6zux{reset} {orange}%s:%d{reset} {gray}%s{reset}\n",
+                       top[i].count, top[i].file ? top[i].file : "?", top[i].line, top[i].message);
+    }
+    if (clusters > shown)
+        maip_io_printf("{bright_black}[{cyan}::{bright_black}]   {gray}... %zu more cluster%s{reset}\n",
+                       clusters - shown, clusters - shown == 1 ? "" : "s");
+}
+
 void fossil_maip_summary(const fossil_maip_engine_t *engine)
 {
     if (!engine)
@@ -1621,6 +6839,7 @@ void fossil_maip_summary(const fossil_maip_engine_t *engine)
     // Classic Summary Components
     fossil_maip_summary_heading(engine);
     fossil_maip_summary_scoreboard(engine);
+    fossil_maip_summary_failures(engine);
     fossil_maip_summary_timestamp(engine);
 
     // AI-Generated Feedback
@@ -1644,320 +6863,77 @@ int32_t fossil_maip_end(fossil_maip_engine_t *engine)
                 {
                     test_case->teardown();
                 }
+                fossil_maip_samples_free(test_case->samples);
+                test_case->samples = null;
+                if (test_case->alloc)
+                    maip_sys_memory_free(test_case->alloc);
+                test_case->alloc = null;
             }
             maip_sys_memory_free(suite->cases);
         }
     }
     maip_sys_memory_free(engine->suites);
-    return FOSSIL_MAIP_SUCCESS;
-}
-
-// -- Assume --
-
-// --- AI Result Struct ---
-typedef struct
-{
-    char *message;
-    uint8_t hash[FOSSIL_MAIP_HASH_SIZE];
-    uint64_t timestamp;
-    int root_cause_code; // 0: unknown, 1: logic, 2: timeout, 3: memory, 4: io, 5: coverage, 6: range, 7: float, 8: string, 9: soap/text
-} maip_assert_ti_result;
-
-extern uint64_t get_maip_time_microseconds(void); // from common utilities
-
-// --- Root Cause Detection Helper ---
-// Enhanced to support assumption macros and their message patterns
-static int maip_test_detect_root_cause(const char *message)
-{
-    if (!message)
-        return 0;
-
-    // --- Advanced: Multiple root cause detection as bitmask ---
-    int root_cause = 0;
-    if (!message)
-        return 0;
-
-    // Context-aware logic error
-    if (strstr(message, ".c:") || strstr(message, ".cpp:") ||
-        strstr(message, ".m:") || strstr(message, ".mm:") ||
-        strstr(message, " in ") || strstr(message, " at ") ||
-        strstr(message, "function ") || strstr(message, "func="))
-    {
-        root_cause |= (1 << 1); // logic
-    }
-
-    // Memory errors
-    if (strstr(message, "null pointer") || strstr(message, "NULL pointer") ||
-        strstr(message, "cnull") || strstr(message, "not cnull") ||
-        strstr(message, "dangling pointer") || strstr(message, "invalid pointer") ||
-        strstr(message, "memory leak") || strstr(message, "buffer overflow") ||
-        strstr(message, "buffer underflow") || strstr(message, "out of bounds") ||
-        strstr(message, "valid memory") || strstr(message, "not valid memory") ||
-        strstr(message, "zeroed memory") || strstr(message, "not zeroed") ||
-        strstr(message, "uninitialized memory") || strstr(message, "double free"))
-    {
-        root_cause |= (1 << 3); // memory
-    }
-
-    // Timeout
-    if (strstr(message, "timeout") || strstr(message, "timed out") ||
-        strstr(message, "exceeded time limit") || strstr(message, "hang detected"))
-    {
-        root_cause |= (1 << 2); // timeout
-    }
-
-    // I/O errors
-    if (strstr(message, "file not found") || strstr(message, "I/O error") ||
-        strstr(message, "io error") || strstr(message, "read error") ||
-        strstr(message, "write error") || strstr(message, "permission denied") ||
-        strstr(message, "disk full") || strstr(message, "cannot open file"))
-    {
-        root_cause |= (1 << 4); // io
-    }
-
-    // Range errors
-    if (strstr(message, "out of range") || strstr(message, "not within range") ||
-        strstr(message, "within range") || strstr(message, "overflow") ||
-        strstr(message, "underflow") || strstr(message, "index out of bounds") ||
-        strstr(message, "exceeds maximum") || strstr(message, "below minimum"))
-    {
-        root_cause |= (1 << 6); // range
-    }
-
-    // Floating-point errors
-    if (strstr(message, "float") || strstr(message, "double") ||
-        strstr(message, "NaN") || strstr(message, "nan") ||
-        strstr(message, "infinity") || strstr(message, "infinite") ||
-        strstr(message, "tolerance") || strstr(message, "precision error") ||
-        strstr(message, "loss of significance") || strstr(message, "rounding error"))
-    {
-        root_cause |= (1 << 7); // float
-    }
-
-    // String/buffer errors
-    if (strstr(message, "string") || strstr(message, "C string") ||
-        strstr(message, "strlen") || strstr(message, "cstr") ||
-        strstr(message, "starts with") || strstr(message, "ends with") ||
-        strstr(message, "contains") || strstr(message, "not contain") ||
-        strstr(message, "length of") || strstr(message, "substring") ||
-        strstr(message, "buffer overflow") || strstr(message, "buffer underflow"))
-    {
-        root_cause |= (1 << 8); // string
-    }
-
-    // SOAP/text errors
-    if (strstr(message, "soap") || strstr(message, "text") ||
-        strstr(message, "tone") || strstr(message, "rot-brain") ||
-        strstr(message, "sentiment") || strstr(message, "language model"))
+    fossil_maip_watchdog_shutdown();
+    fossil_maip_fixture_release(FOSSIL_MAIP_SCOPE_PROCESS, null);
+    if (fossil_maip_fixture_lock_ready)
     {
-        root_cause |= (1 << 9); // soap/text
+        maip_sys_mutex_destroy(&fossil_maip_fixture_lock);
+        fossil_maip_fixture_lock_ready = false;
     }
-
-    // Coverage/empty/skipped/not implemented
-    if (strstr(message, "empty") || strstr(message, "skipped") ||
-        strstr(message, "not implemented") || strstr(message, "unreachable code") ||
-        strstr(message, "not covered") || strstr(message, "todo"))
-    {
-        root_cause |= (1 << 5); // coverage
-    }
-
-    // Logic errors (default for assumption failures)
-    if (strstr(message, "Expected") || strstr(message, "not be") ||
-        strstr(message, "to be") || strstr(message, "fail") ||
-        strstr(message, "logic") || strstr(message, "assert") ||
-        strstr(message, "incorrect result") || strstr(message, "unexpected value") ||
-        strstr(message, "condition failed") || strstr(message, "mismatch"))
+    fossil_maip_failure_reset();
+    if (fossil_maip_failure_lock_ready)
     {
-        root_cause |= (1 << 1); // logic
+        maip_sys_mutex_destroy(&fossil_maip_failure_lock);
+        fossil_maip_failure_lock_ready = false;
     }
-
-    // If only one bit set, return its code, otherwise return bitmask value
-    int count = 0, last = 0;
-    for (int i = 1; i <= 9; ++i)
+    fossil_maip_root_cause_reset();
+    if (fossil_maip_cause_lock_ready)
     {
-        if (root_cause & (1 << i))
-        {
-            count++;
-            last = i;
-        }
+        maip_sys_mutex_destroy(&fossil_maip_cause_lock);
+        fossil_maip_cause_lock_ready = false;
     }
-    if (count == 1)
-        return last;
-    if (count > 1)
-        return root_cause;
-
-    return 0; // unknown
+    fossil_maip_unload_bundles();
+    fossil_maip_selection_free(engine);
+    fossil_maip_history_close(engine->history);
+    engine->history = null;
+    maip_sys_memory_free(engine->rng);
+    engine->rng = null;
+    fossil_maip_merge_release();
+
+    // A benchmark regression against --compare fails the run, and so does a
+    // merge that lost a shard, even if the runner ignored fossil_maip_run_all
+    if (fossil_benchmark_baseline_close() > 0 || engine->merge_failed)
+        return FOSSIL_MAIP_FAILURE;
+    return FOSSIL_MAIP_SUCCESS;
 }
 
+// -- Assume --
+
 char *maip_test_assert_messagef(const char *message, ...)
 {
+    // Only reached on the failure path, so a single reusable buffer is enough:
+    // maip_test_assert_internal prints it before unwinding out of the case.
+    static FOSSIL_MAIP_THREAD_LOCAL char formatted_message[1024];
+
     va_list args;
     va_start(args, message);
-
-    size_t buffer_size = 1024;
-    char *formatted_message = (char *)maip_sys_memory_alloc(buffer_size);
-
-    maip_assert_ti_result result = {0};
-
-    if (formatted_message)
-    {
-        maip_io_vsnprintf(formatted_message, buffer_size, message, args);
-        formatted_message[buffer_size - 1] = '\0'; // Ensure null-termination
-
-        // TI upgrade: compute hash and timestamp
-        result.message = formatted_message;
-        result.timestamp = get_maip_time_microseconds();
-
-        // Hash both format string and final message to detect templating vs content errors
-        fossil_maip_hash(message, formatted_message, result.hash);
-
-        // Root cause detection
-        result.root_cause_code = maip_test_detect_root_cause(formatted_message);
-    }
-
+    maip_io_vsnprintf(formatted_message, sizeof(formatted_message), message, args);
     va_end(args);
+
+    formatted_message[sizeof(formatted_message) - 1] = '\0'; // Ensure null-termination
     return formatted_message;
 }
 
-void maip_test_assert_internal_output(const char *message, const char *file, int line, const char *func, int anomaly_count, int root_cause_code)
+void maip_test_assert_internal_output(const char *message, const char *file, int line, const char *func, int anomaly_count, uint32_t root_cause_mask)
 {
     // Advanced root cause analysis and suggestion hints
 
     // --- Advanced root cause detection ---
-    // If root_cause_code is a bitmask (multiple bits set), handle all detected causes
-    char root_cause_buf[128] = {0};
-    int root_cause_mask = root_cause_code;
-    if (root_cause_mask > 9)
-    { // bitmask, not single code
-        int first = 1;
-        if (root_cause_mask & (1 << 3))
-        {
-            strcat(root_cause_buf, first ? "Memory error" : ", Memory error");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 2))
-        {
-            strcat(root_cause_buf, first ? "Timeout" : ", Timeout");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 4))
-        {
-            strcat(root_cause_buf, first ? "I/O error" : ", I/O error");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 6))
-        {
-            strcat(root_cause_buf, first ? "Range error" : ", Range error");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 7))
-        {
-            strcat(root_cause_buf, first ? "Floating-point" : ", Floating-point");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 8))
-        {
-            strcat(root_cause_buf, first ? "String/buffer" : ", String/buffer");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 9))
-        {
-            strcat(root_cause_buf, first ? "Text/SOAP" : ", Text/SOAP");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 5))
-        {
-            strcat(root_cause_buf, first ? "Coverage/Empty" : ", Coverage/Empty");
-            first = 0;
-        }
-        if (root_cause_mask & (1 << 1))
-        {
-            strcat(root_cause_buf, first ? "Logic error" : ", Logic error");
-            first = 0;
-        }
-    }
-
-    if ((root_cause_code == 0 || root_cause_mask > 9) && message)
+    // The vocabulary scan gives the mask; the one thing it cannot see is a
+    // message that quotes the failing source location.
+    if (root_cause_mask == 0 && message && file && func && strstr(message, file) && strstr(message, func))
     {
-        // Context-aware: check for file/func/line context in message
-        if (file && func && strstr(message, file) && strstr(message, func))
-        {
-            root_cause_code = 1; // logic (context matches source location)
-        }
-        // Boolean assumption patterns
-        else if (strstr(message, "Expected") && strstr(message, "to be true"))
-        {
-            root_cause_code = 1; // logic
-        }
-        else if (strstr(message, "Expected") && strstr(message, "to be false"))
-        {
-            root_cause_code = 1; // logic
-        }
-        else if (strstr(message, "to not be true") || strstr(message, "to not be false"))
-        {
-            root_cause_code = 1; // logic
-        }
-        // Floating point assumption patterns
-        else if (strstr(message, "within tolerance") || strstr(message, "to be equal") || strstr(message, "to not be equal"))
-        {
-            if (strstr(message, "value %f") || strstr(message, "value %lf"))
-            {
-                root_cause_code = 7; // float
-            }
-        }
-        else if (strstr(message, "to be less than") || strstr(message, "to be more than") ||
-                 strstr(message, "to be less than or equal to") || strstr(message, "to be more than or equal to") ||
-                 strstr(message, "to not be less than") || strstr(message, "to not be more than") ||
-                 strstr(message, "to not be less than or equal to") || strstr(message, "to not be more than or equal to"))
-        {
-            if (strstr(message, "value %f") || strstr(message, "value %lf"))
-            {
-                root_cause_code = 7; // float
-            }
-        }
-        else if (strstr(message, "to be NaN") || strstr(message, "to be infinity"))
-        {
-            root_cause_code = 7; // float
-        }
-        // Numeric/range assumption patterns
-        else if (strstr(message, "is not within range") || strstr(message, "is within range"))
-        {
-            root_cause_code = 6; // range
-        }
-        // Memory assumption patterns
-        else if (strstr(message, "to be zeroed") || strstr(message, "to not be zeroed") ||
-                 strstr(message, "to be equal") || strstr(message, "to not be equal") ||
-                 strstr(message, "to be more than") || strstr(message, "to be less than") ||
-                 strstr(message, "to be more than or equal to") || strstr(message, "to be less than or equal to") ||
-                 strstr(message, "to not be more than") || strstr(message, "to not be less than") ||
-                 strstr(message, "to not be more than or equal to") || strstr(message, "to not be less than or equal to") ||
-                 strstr(message, "to be valid") || strstr(message, "to not be valid"))
-        {
-            if (strstr(message, "memory") || strstr(message, "pointer"))
-            {
-                root_cause_code = 3; // memory
-            }
-        }
-        // Null pointer assumption patterns
-        else if (strstr(message, "to be cnull") || strstr(message, "to not be cnull"))
-        {
-            root_cause_code = 3; // memory (null pointer)
-        }
-        // String assumption patterns
-        else if (strstr(message, "C string") || strstr(message, "cstr") ||
-                 strstr(message, "to be equal") || strstr(message, "to not be equal") ||
-                 strstr(message, "length of") || strstr(message, "to start with prefix") ||
-                 strstr(message, "to end with suffix") || strstr(message, "to contain substring") ||
-                 strstr(message, "to not contain substring") || strstr(message, "to contain") ||
-                 strstr(message, "to not contain") || strstr(message, "occurrences of substring"))
-        {
-            root_cause_code = 8; // string
-        }
-        // SOAP/text assumption patterns
-        else if (strstr(message, "rot-brain") || strstr(message, "tone of text"))
-        {
-            root_cause_code = 9; // soap/text
-        }
+        root_cause_mask = 1u << 1; // logic (context matches source location)
     }
 
     // --- Suggestion hints for assumption failures ---
@@ -2109,47 +7085,9 @@ void maip_test_assert_internal_output(const char *message, const char *file, int
         }
     }
 
-    const char *root_cause_str = NULL;
-    if (root_cause_mask > 9 && root_cause_buf[0])
-    {
-        root_cause_str = root_cause_buf;
-    }
-    else
-    {
-        switch (root_cause_code)
-        {
-        case 1:
-            root_cause_str = "Logic error";
-            break;
-        case 2:
-            root_cause_str = "Timeout";
-            break;
-        case 3:
-            root_cause_str = "Memory error";
-            break;
-        case 4:
-            root_cause_str = "I/O error";
-            break;
-        case 5:
-            root_cause_str = "Coverage/Empty";
-            break;
-        case 6:
-            root_cause_str = "Range error";
-            break;
-        case 7:
-            root_cause_str = "Floating-point";
-            break;
-        case 8:
-            root_cause_str = "String/buffer";
-            break;
-        case 9:
-            root_cause_str = "Text/SOAP";
-            break;
-        default:
-            root_cause_str = NULL;
-            break;
-        }
-    }
+    char root_cause_buf[256];
+    const char *root_cause_str =
+        fossil_maip_root_cause_describe(root_cause_mask, root_cause_buf, sizeof(root_cause_buf)) ? root_cause_buf : NULL;
 
     switch (G_MAIP_THEME)
     {
@@ -2250,31 +7188,9 @@ void maip_test_assert_internal_output(const char *message, const char *file, int
     }
 }
 
-static int maip_test_assert_internal_detect_ti(const char *message, const char *file, int line, const char *func)
+void maip_test_assert_pass(void)
 {
-    static uint8_t last_hash[FOSSIL_MAIP_HASH_SIZE] = {0};
-    static int anomaly_count = 0;
-
-    char input_buf[512], output_buf[64];
-    snprintf(input_buf, sizeof(input_buf), "%s:%d:%s", file, line, func);
-    snprintf(output_buf, sizeof(output_buf), "%s", message);
-
-    uint8_t current_hash[FOSSIL_MAIP_HASH_SIZE];
-    fossil_maip_hash(input_buf, output_buf, current_hash);
-
-    bool same_hash = memcmp(last_hash, current_hash, FOSSIL_MAIP_HASH_SIZE) == 0;
-
-    if (same_hash)
-    {
-        anomaly_count++;
-    }
-    else
-    {
-        anomaly_count = 0;
-        memcpy(last_hash, current_hash, FOSSIL_MAIP_HASH_SIZE);
-    }
-
-    return anomaly_count;
+    _ASSERT_COUNT++;
 }
 
 void maip_test_assert_internal(bool condition, const char *message, const char *file, int line, const char *func)
@@ -2283,21 +7199,32 @@ void maip_test_assert_internal(bool condition, const char *message, const char *
 
     if (!condition)
     {
-        int anomaly_count = maip_test_assert_internal_detect_ti(message, file, line, func);
-
-        // Compute hash for clustering
-        char input_buf[512], output_buf[64];
-        snprintf(input_buf, sizeof(input_buf), "%s:%d:%s", file, line, func);
-        snprintf(output_buf, sizeof(output_buf), "%s", message);
-        uint8_t hash[FOSSIL_MAIP_HASH_SIZE];
-        fossil_maip_hash(input_buf, output_buf, hash);
-
-        int root_cause_code = maip_test_detect_root_cause(message);
-
-        // Enhanced output includes anomaly count and root cause
-        maip_test_assert_internal_output(message, file, line, func, anomaly_count, root_cause_code);
+        // Fingerprinting and classification are deferred to here so passing
+        // assertions never pay for them.
+        maip_sys_memory_quiet_begin();
+        int anomaly_count = (int)fossil_maip_failure_record(file, line, func, message) - 1;
+        snprintf(fossil_maip_failure, sizeof(fossil_maip_failure), "%s", message ? message : "");
+        fossil_maip_failure_at.file = file;
+        fossil_maip_failure_at.func = func;
+        fossil_maip_failure_at.line = line;
+
+        fossil_maip_output_lock();
+        if (anomaly_count >= FOSSIL_MAIP_FAILURE_QUIET)
+        {
+            // The full report was printed already; the summary has the totals
+            maip_io_printf("{gray}Assertion failed again:{reset} %s {gray}(%s:%d, seen %d times){reset}\n",
+                           message ? message : "", file, line, anomaly_count + 1);
+        }
+        else
+        {
+            // Enhanced output includes anomaly count and root cause
+            maip_test_assert_internal_output(message, file, line, func, anomaly_count,
+                                             fossil_maip_root_cause_scan(message));
+        }
+        fossil_maip_output_unlock();
+        maip_sys_memory_quiet_end();
 
-        longjmp(test_jump_buffer, 1);
+        fossil_maip_longjmp(test_jump_buffer, FOSSIL_MAIP_JUMP_FAIL);
     }
 }
 
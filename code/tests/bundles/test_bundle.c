@@ -0,0 +1,50 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2013
+ *
+ * Copyright (C) 2013-Current Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+
+#include "fossil/maip/framework.h"
+
+// Built as a shared module and loaded with `maip run --bundle <path>`
+
+FOSSIL_SETUP(c_bundle_suite)
+{
+    // Setup code here
+}
+
+FOSSIL_TEARDOWN(c_bundle_suite)
+{
+    // Teardown code here
+}
+
+FOSSIL_SUITE(c_bundle_suite);
+
+FOSSIL_TEST(c_bundle_loaded)
+{
+    // The group that added this case came from the bundle's constructor
+    bool found = false;
+    for (const fossil_maip_group_t *group = fossil_maip_groups(); group; group = group->next)
+    {
+        if (strcmp(group->name, "c_bundle_test_cases") == 0)
+            found = group->engine != NULL;
+    }
+
+    FOSSIL_TEST_ASSUME(found, "Bundle group should be registered and loaded");
+}
+
+FOSSIL_TEST_GROUP(c_bundle_test_cases)
+{
+    FOSSIL_ADD_TEST(c_bundle_suite, c_bundle_loaded);
+
+    FOSSIL_ADD_SUITE(c_bundle_suite);
+}
@@ -114,6 +114,243 @@ FOSSIL_TEST(c_mark_reset_benchmark) {
     ASSUME_ITS_EQUAL_I32(benchmark_reset_test.num_samples, 0);
 }
 
+// Test case for the framework clock never going backwards
+FOSSIL_TEST(c_mark_clock_monotonic) {
+    uint64_t last = maip_sys_time_now_ns();
+    for (int i = 0; i < 1000; i++) {
+        uint64_t now = maip_sys_time_now_ns();
+        ASSUME_ITS_TRUE(now >= last);
+        last = now;
+    }
+}
+
+// Test case for the measured clock resolution and overhead
+FOSSIL_TEST(c_mark_clock_resolution) {
+    ASSUME_NOT_CNULL(maip_sys_time_source());
+    ASSUME_ITS_TRUE(maip_sys_time_resolution_ns() > 0);
+    ASSUME_ITS_TRUE(maip_sys_time_resolution_ns() < 1000000); // sub-millisecond
+    ASSUME_ITS_TRUE(maip_sys_time_overhead_ns() < 1000000);
+}
+
+// Workload for the statistical driver tests
+static void c_mark_spin(void *context) {
+    volatile uint32_t *counter = (volatile uint32_t *)context;
+    for (int i = 0; i < 64; i++) {
+        *counter += (uint32_t)i;
+    }
+}
+
+// Test case for the statistical benchmark driver
+FOSSIL_TEST(c_mark_run_statistics) {
+    volatile uint32_t counter = 0;
+    fossil_mark_config_t config;
+    fossil_benchmark_config_default(&config);
+    config.warmup_ns = 2000000;  // 2 ms
+    config.target_ns = 20000000; // 20 ms
+    config.outliers = FOSSIL_MARK_OUTLIER_TUKEY;
+
+    MARK_BENCHMARK(run_test);
+    ASSUME_ITS_EQUAL_I32(fossil_benchmark_run(&benchmark_run_test, c_mark_spin, (void *)&counter, &config), 0);
+
+    const fossil_mark_stats_t *stats = &benchmark_run_test.stats;
+    ASSUME_ITS_TRUE(stats->batch >= 1);
+    ASSUME_ITS_TRUE(stats->samples + stats->outliers >= config.min_samples);
+    ASSUME_ITS_TRUE(stats->min_ns <= stats->p50_ns);
+    ASSUME_ITS_TRUE(stats->p50_ns <= stats->p90_ns);
+    ASSUME_ITS_TRUE(stats->p90_ns <= stats->p99_ns);
+    ASSUME_ITS_TRUE(stats->p99_ns <= stats->p999_ns);
+    ASSUME_ITS_TRUE(stats->p999_ns <= stats->max_ns);
+    ASSUME_ITS_TRUE(stats->ci_low_ns <= stats->mean_ns);
+    ASSUME_ITS_TRUE(stats->mean_ns <= stats->ci_high_ns);
+    ASSUME_ITS_TRUE(counter > 0);
+    fossil_benchmark_destroy(&benchmark_run_test);
+}
+
+// Test case for the configurable warmup of start/stop benchmarks
+FOSSIL_TEST(c_mark_warmup) {
+    MARK_BENCHMARK(warmup_test);
+    fossil_benchmark_set_warmup(&benchmark_warmup_test, 2);
+    for (int i = 0; i < 5; i++) {
+        MARK_START(warmup_test);
+        MARK_STOP(warmup_test);
+    }
+    ASSUME_ITS_EQUAL_I32(benchmark_warmup_test.num_samples, 3);
+    fossil_benchmark_destroy(&benchmark_warmup_test);
+}
+
+// Test case for the baseline regression test on shifted distributions
+FOSSIL_TEST(c_mark_mann_whitney) {
+    double baseline[20];
+    double slower[20];
+    double faster[20];
+    for (int i = 0; i < 20; i++) {
+        baseline[i] = 100.0 + i;
+        slower[i] = 110.0 + i;
+        faster[i] = 90.0 + i;
+    }
+    ASSUME_ITS_TRUE(fossil_benchmark_mann_whitney(baseline, 20, slower, 20) < 0.05);
+    ASSUME_ITS_TRUE(fossil_benchmark_mann_whitney(baseline, 20, faster, 20) > 0.95);
+    ASSUME_ITS_TRUE(fossil_benchmark_mann_whitney(baseline, 20, baseline, 20) > 0.05);
+    ASSUME_ITS_EQUAL_F64(fossil_benchmark_mann_whitney(baseline, 0, slower, 20), 1.0, 1e-9);
+}
+
+// Synthetic suite pushed through registration, filtering, ordering and
+// execution on a private engine. It runs on its own thread so the engine's
+// per-thread jump buffer and watchdog slot of the calling case are untouched.
+typedef struct {
+    size_t count;
+    size_t selected;
+    bool ordered;
+    int passed;
+} c_mark_stress_t;
+
+static void c_mark_stress_case(void) {
+    FOSSIL_TEST_ASSUME(true, "Synthetic case should pass");
+}
+
+static void *c_mark_stress_main(void *arg) {
+    c_mark_stress_t *stress = (c_mark_stress_t *)arg;
+    char (*names)[32] = malloc(stress->count * sizeof(*names));
+    fossil_maip_case_t **selection = malloc(stress->count * sizeof(*selection));
+    if (!names || !selection) {
+        free(names);
+        free(selection);
+        return NULL;
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.pallet.filter.tag = "even";   // select half
+    engine.pallet.sort.by = "name";
+    engine.pallet.sort.order = "desc";
+    engine.pallet.show.result = "fail";  // stay quiet for passing cases
+    if (fossil_maip_selection_compile(&engine) != FOSSIL_MAIP_SUCCESS) {
+        free(names);
+        free(selection);
+        return NULL;
+    }
+
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"c_mark_stress_suite";
+
+    for (size_t i = 0; i < stress->count; i++) {
+        snprintf(names[i], sizeof(names[i]), "case_%09lu", (unsigned long)((i * 2654435761u) % stress->count));
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = names[i];
+        test_case.tags = (char *)((i & 1) ? "fossil,odd" : "fossil,even");
+        test_case.criteria = (char *)"stress";
+        test_case.run = c_mark_stress_case;
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    stress->selected = fossil_maip_filter_cases(&suite, &engine, selection);
+    fossil_maip_sort_cases(selection, stress->selected, &engine);
+    stress->ordered = true;
+    for (size_t i = 1; i < stress->selected; i++) {
+        if (strcmp(selection[i - 1]->name, selection[i]->name) < 0)
+            stress->ordered = false;
+    }
+
+    fossil_maip_run_suite(&engine, &suite);
+    stress->passed = suite.score.passed;
+
+    fossil_maip_selection_free(&engine);
+    free(suite.cases);
+    free(selection);
+    free(names);
+    return NULL;
+}
+
+// Test case for selection over a larger synthetic suite
+FOSSIL_TEST(c_mark_selection_stress) {
+    c_mark_stress_t stress;
+    memset(&stress, 0, sizeof(stress));
+    stress.count = 1u << 12;
+    maip_sys_thread_t thread;
+    ASSUME_ITS_EQUAL_I32(maip_sys_thread_create(&thread, c_mark_stress_main, &stress), 0);
+    maip_sys_thread_join(thread);
+
+    ASSUME_ITS_EQUAL_SIZE(stress.selected, stress.count / 2);
+    ASSUME_ITS_TRUE(stress.ordered);
+    ASSUME_ITS_EQUAL_I32(stress.passed, (int)(stress.count / 2));
+}
+
+// Test case for hardware counters, which may be unavailable on this host
+FOSSIL_TEST(c_mark_counters) {
+    MARK_BENCHMARK(counter_test);
+    int available = MARK_COUNTERS(counter_test);
+    ASSUME_ITS_TRUE(available >= 0 && available <= FOSSIL_MARK_COUNTER_COUNT);
+    for (int i = 0; i < 10; i++) {
+        MARK_START(counter_test);
+        MARK_STOP(counter_test);
+    }
+    if (available == 0) {
+        ASSUME_ITS_TRUE(fossil_benchmark_counter(&benchmark_counter_test, FOSSIL_MARK_COUNTER_CYCLES) < 0.0);
+    } else {
+        ASSUME_ITS_EQUAL_I32(benchmark_counter_test.counters.iterations, 10);
+    }
+    ASSUME_ITS_EQUAL_I32(benchmark_counter_test.num_samples, 10);
+    fossil_benchmark_destroy(&benchmark_counter_test);
+    ASSUME_ITS_EQUAL_I32(benchmark_counter_test.counters.leader, -1);
+}
+
+// Hash throughput against a byte-at-a-time FNV-1a over the same buffer
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    volatile uint64_t sink;
+} c_mark_hash_t;
+
+static void c_mark_hash_fast(void *context) {
+    c_mark_hash_t *hash = (c_mark_hash_t *)context;
+    hash->sink = fossil_maip_hash64(hash->data, hash->len, 0);
+}
+
+static void c_mark_hash_bytes(void *context) {
+    c_mark_hash_t *hash = (c_mark_hash_t *)context;
+    uint64_t state = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < hash->len; i++) {
+        state ^= hash->data[i];
+        state *= 0x100000001b3ULL;
+    }
+    hash->sink = state;
+}
+
+// Test case for the throughput of the word-at-a-time hash; reported, not judged
+FOSSIL_TEST(c_mark_hash_throughput) {
+    c_mark_hash_t hash;
+    hash.len = 1u << 16;
+    uint8_t *data = malloc(hash.len);
+    ASSUME_NOT_CNULL(data);
+    for (size_t i = 0; i < hash.len; i++) {
+        data[i] = (uint8_t)(i * 2654435761u >> 13);
+    }
+    hash.data = data;
+
+    fossil_mark_config_t config;
+    fossil_benchmark_config_default(&config);
+    config.warmup_ns = 2000000;  // 2 ms
+    config.target_ns = 20000000; // 20 ms
+
+    MARK_BENCHMARK(hash_fast);
+    MARK_BENCHMARK(hash_bytes);
+    ASSUME_ITS_EQUAL_I32(fossil_benchmark_run(&benchmark_hash_fast, c_mark_hash_fast, &hash, &config), 0);
+    ASSUME_ITS_EQUAL_I32(fossil_benchmark_run(&benchmark_hash_bytes, c_mark_hash_bytes, &hash, &config), 0);
+
+    double fast_ns = benchmark_hash_fast.stats.p50_ns;
+    double bytes_ns = benchmark_hash_bytes.stats.p50_ns;
+    maip_io_printf("{blue}Hash      : {cyan}%.2f GB/s{reset}  (byte-wise FNV-1a %.2f GB/s)\n",
+                   hash.len / fast_ns, hash.len / bytes_ns);
+    ASSUME_ITS_TRUE(fast_ns > 0.0);
+    ASSUME_ITS_TRUE(bytes_ns > 0.0);
+
+    fossil_benchmark_destroy(&benchmark_hash_fast);
+    fossil_benchmark_destroy(&benchmark_hash_bytes);
+    free(data);
+}
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -127,6 +364,14 @@ FOSSIL_TEST_GROUP(c_mark_test_cases) {
     FOSSIL_ADD_TEST(c_mark_suite, c_mark_stop_without_start);
     FOSSIL_ADD_TEST(c_mark_suite, c_mark_nested_benchmarks);
     FOSSIL_ADD_TEST(c_mark_suite, c_mark_reset_benchmark);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_clock_monotonic);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_clock_resolution);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_run_statistics);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_warmup);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_mann_whitney);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_counters);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_selection_stress);
+    FOSSIL_ADD_TEST(c_mark_suite, c_mark_hash_throughput);
 
     FOSSIL_ADD_SUITE(c_mark_suite);
 }
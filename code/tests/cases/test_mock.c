@@ -57,6 +57,10 @@ FOSSIL_MOCK_FUNC(void, mock_function_redirection, void) {
     maip_io_printf("Testing macro redirection!");
 }
 
+FOSSIL_MOCK_FUNC(void, c_mock_function_with_markup, void) {
+    maip_io_printf_color(0, "{red}%s{reset} %d%% {open", "{green}ok{reset}", 100);
+}
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Cases
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -346,6 +350,16 @@ FOSSIL_TEST(c_mock_io_capture_output) {
     FOSSIL_TEST_ASSUME(strcmp(buffer, "Hello, Fossil Logic!") == 0, "Captured output should match expected output");
 } // end case
 
+FOSSIL_TEST(c_mock_io_markup_output) {
+    char buffer[256];
+
+    // Tags in the format and in arguments are stripped, '%' is formatted once
+    // and an unmatched '{' is printed as-is
+    fossil_mock_capture_output(buffer, sizeof(buffer), MOCK_FUNC_CALL(c_mock_function_with_markup));
+
+    FOSSIL_TEST_ASSUME(strcmp(buffer, "ok 100% {open") == 0, "Markup should render without color codes");
+} // end case
+
 FOSSIL_TEST(c_mock_io_compare_output) {
     // Captured and expected outputs
     const char *captured = "Hello, Fossil Logic!";
@@ -400,6 +414,7 @@ FOSSIL_TEST_GROUP(c_mock_test_cases) {
     FOSSIL_ADD_TEST(c_mock_suite, c_mock_macro_destruction);
 
     FOSSIL_ADD_TEST(c_mock_suite, c_mock_io_capture_output);
+    FOSSIL_ADD_TEST(c_mock_suite, c_mock_io_markup_output);
     FOSSIL_ADD_TEST(c_mock_suite, c_mock_io_compare_output);
     FOSSIL_ADD_TEST(c_mock_suite, c_mock_io_redirect_stdout_macro);
     FOSSIL_ADD_TEST(c_mock_suite, c_mock_io_compare_output_macro);
@@ -15,6 +15,11 @@
 
 #include "fossil/maip/framework.h"
 
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#endif
+
 // Test data structure for a sample test
 FOSSIL_MOCK_STRUCT(CSampleTestData)
 {
@@ -158,6 +163,1040 @@ FOSSIL_TEST(math_addition_scopes)
     }
 }
 
+FOSSIL_TEST(groups_register_themselves)
+{
+    // Both groups in this file were found without a generated runner
+    const fossil_maip_group_t *sample = NULL;
+    const fossil_maip_group_t *second = NULL;
+    for (const fossil_maip_group_t *group = fossil_maip_groups(); group; group = group->next)
+    {
+        if (strcmp(group->name, "c_sample_test_cases") == 0)
+            sample = group;
+        else if (strcmp(group->name, "c_second_test_cases") == 0)
+            second = group;
+    }
+
+    FOSSIL_TEST_ASSUME(sample != NULL, "c_sample_test_cases should be registered");
+    FOSSIL_TEST_ASSUME(second != NULL, "c_second_test_cases should be registered");
+    FOSSIL_TEST_ASSUME(sample->engine != NULL, "Registered groups should be loaded at start");
+    FOSSIL_TEST_ASSUME(sample->engine == second->engine, "Groups should share one engine");
+}
+
+// Suite fixture shared by the cases below, built once on first use
+static int sample_numbers_setups = 0;
+static int sample_numbers_teardowns = 0;
+
+FOSSIL_FIXTURE(sample_numbers, FOSSIL_MAIP_SCOPE_SUITE)
+{
+    static int numbers[] = {2, 3, 5, 7};
+    sample_numbers_setups++;
+    return numbers;
+}
+
+FOSSIL_FIXTURE_TEARDOWN(sample_numbers, value)
+{
+    (void)value;
+    sample_numbers_teardowns++;
+}
+
+// Case fixture, rebuilt for every case that uses it
+FOSSIL_FIXTURE(sample_scratch, FOSSIL_MAIP_SCOPE_CASE)
+{
+    return calloc(16, sizeof(int));
+}
+
+FOSSIL_FIXTURE_TEARDOWN(sample_scratch, value)
+{
+    free(value);
+}
+
+FOSSIL_TEST(fixture_suite_first_use)
+{
+    const int *numbers = (const int *)FOSSIL_FIXTURE_USE(sample_numbers);
+
+    FOSSIL_TEST_ASSUME(numbers != NULL && numbers[0] == 2, "Suite fixture should provide its value");
+    FOSSIL_TEST_ASSUME(sample_numbers_setups == 1, "Suite fixture should be set up once");
+}
+
+FOSSIL_TEST(fixture_suite_shared)
+{
+    const int *first = (const int *)FOSSIL_FIXTURE_USE(sample_numbers);
+    const int *again = (const int *)FOSSIL_FIXTURE_USE(sample_numbers);
+
+    FOSSIL_TEST_ASSUME(first == again, "Suite fixture should be shared across uses");
+    FOSSIL_TEST_ASSUME(sample_numbers_setups == 1, "Suite fixture should not be set up again");
+    FOSSIL_TEST_ASSUME(sample_numbers_teardowns == 0, "Suite fixture should live until the suite ends");
+}
+
+FOSSIL_TEST(fixture_case_scoped)
+{
+    int *scratch = (int *)FOSSIL_FIXTURE_USE(sample_scratch);
+    FOSSIL_TEST_ASSUME(scratch != NULL && scratch[0] == 0, "Case fixture should start zeroed");
+
+    scratch[0] = 42;
+    int *again = (int *)FOSSIL_FIXTURE_USE(sample_scratch);
+    FOSSIL_TEST_ASSUME(again == scratch && again[0] == 42, "Case fixture should be reused within the case");
+}
+
+static void sample_selection_case(void)
+{
+}
+
+FOSSIL_TEST(selection_expression)
+{
+    static const struct { const char *name; const char *tags; } cases[] = {
+        {"cache_hit", "fast"},
+        {"cache_fetch", "fast,net"},
+        {"io_read", "net"},
+        {"io_write", "slow"},
+        {"parse_all", "slow"},
+    };
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.pallet.filter.expr = "tag:fast & !tag:net | name:io_*";
+    FOSSIL_TEST_ASSUME(fossil_maip_selection_compile(&engine) == FOSSIL_MAIP_SUCCESS, "Expression should compile");
+
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"selection_suite";
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = (char *)cases[i].name;
+        test_case.tags = (char *)cases[i].tags;
+        test_case.run = sample_selection_case;
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_case_t *selected[5];
+    size_t count = fossil_maip_filter_cases(&suite, &engine, selected);
+    FOSSIL_TEST_ASSUME(count == 3, "Expression should select three cases");
+    FOSSIL_TEST_ASSUME(count == 3 && strcmp(selected[0]->name, "cache_hit") == 0 &&
+                       strcmp(selected[1]->name, "io_read") == 0 &&
+                       strcmp(selected[2]->name, "io_write") == 0,
+                       "Expression should keep fast local cases and io_* cases");
+
+    // Comma lists on the plain filters OR together and AND with the expression
+    fossil_maip_selection_free(&engine);
+    engine.pallet.filter.tag = "slow,net";
+    engine.pallet.filter.expr = "!name:*_write";
+    FOSSIL_TEST_ASSUME(fossil_maip_selection_compile(&engine) == FOSSIL_MAIP_SUCCESS, "Filters should compile");
+    count = fossil_maip_filter_cases(&suite, &engine, selected);
+    FOSSIL_TEST_ASSUME(count == 3, "Tag list and expression should select three cases");
+
+    fossil_maip_selection_free(&engine);
+    free(suite.cases);
+}
+
+FOSSIL_TEST(selection_rejects_bad_expression)
+{
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.pallet.filter.expr = "(tag:fast | owner:me";
+    FOSSIL_TEST_ASSUME(fossil_maip_selection_compile(&engine) == FOSSIL_MAIP_FAILURE, "Unbalanced expression should fail");
+    FOSSIL_TEST_ASSUME(engine.selection == NULL, "Failed compile should leave no selection");
+}
+
+FOSSIL_TEST(sort_multi_key)
+{
+    // Names share a 16-byte prefix, priorities are signed and times overflow
+    // 32 bits, which a subtracting comparator would get wrong
+    fossil_maip_case_t cases[5];
+    memset(cases, 0, sizeof(cases));
+    cases[0].name = (char *)"sort_multi_key_common_b";
+    cases[0].priority = 1;
+    cases[0].elapsed_ns = 5000000000ULL;
+    cases[1].name = (char *)"sort_multi_key_common_a";
+    cases[1].priority = -3;
+    cases[1].elapsed_ns = 1;
+    cases[2].name = (char *)"sort_multi_key_common_c";
+    cases[2].priority = 1;
+    cases[2].elapsed_ns = 1;
+    cases[3].name = (char *)"short";
+    cases[3].priority = INT64_MIN;
+    cases[3].elapsed_ns = 5000000000ULL;
+    cases[4].name = (char *)"sort_multi_key_common_a";
+    cases[4].priority = 1;
+    cases[4].elapsed_ns = 5000000000ULL;
+
+    fossil_maip_case_t *order[5];
+    for (size_t i = 0; i < 5; i++)
+        order[i] = &cases[i];
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.pallet.sort.by = "time";
+    engine.pallet.sort.order = "desc";
+    engine.pallet.sort.then_by = "priority,name:desc";
+    fossil_maip_sort_cases(order, 5, &engine);
+
+    FOSSIL_TEST_ASSUME(order[0] == &cases[3], "Most negative priority should lead the slow cases");
+    FOSSIL_TEST_ASSUME(order[1] == &cases[0] && order[2] == &cases[4], "Long names should break ties in descending order");
+    FOSSIL_TEST_ASSUME(order[3] == &cases[1] && order[4] == &cases[2], "Fast cases should follow by priority");
+
+    // Equal keys keep their incoming order
+    engine.pallet.sort.by = "priority";
+    engine.pallet.sort.order = "asc";
+    engine.pallet.sort.then_by = NULL;
+    for (size_t i = 0; i < 5; i++)
+        order[i] = &cases[i];
+    fossil_maip_sort_cases(order, 5, &engine);
+    FOSSIL_TEST_ASSUME(order[0] == &cases[3] && order[1] == &cases[1], "Lowest priorities should come first");
+    FOSSIL_TEST_ASSUME(order[2] == &cases[0] && order[3] == &cases[2] && order[4] == &cases[4], "Sort should be stable");
+}
+
+FOSSIL_TEST(history_schedule)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"history_suite";
+
+    // Unique per process and per thread: meson runs several runners in one build dir
+    char path[64];
+    snprintf(path, sizeof(path), "sample_history_%d_%p.tmp", FOSSIL_SANITY_SYS_GETPID(), (void *)&suite);
+    remove(path);
+
+    fossil_maip_case_t cases[4];
+    memset(cases, 0, sizeof(cases));
+    cases[0].name = (char *)"quick";
+    cases[0].state = FOSSIL_MAIP_CASE_PASS;
+    cases[0].elapsed_ns = 1000;
+    cases[1].name = (char *)"slow";
+    cases[1].state = FOSSIL_MAIP_CASE_PASS;
+    cases[1].elapsed_ns = 900000;
+    cases[2].name = (char *)"broken";
+    cases[2].state = FOSSIL_MAIP_CASE_FAIL;
+    cases[2].elapsed_ns = 5000;
+    cases[3].name = (char *)"fresh"; // never recorded
+
+    fossil_maip_case_t *order[4] = {&cases[0], &cases[1], &cases[2], &cases[3]};
+
+    fossil_maip_history_t *history = fossil_maip_history_open(path);
+    if (!history)
+        remove(path);
+    FOSSIL_TEST_ASSUME(history != NULL, "History file should open");
+    fossil_maip_history_record(history, &suite, order, 3);
+    fossil_maip_history_close(history);
+
+    // Estimates survive a reopen
+    history = fossil_maip_history_open(path);
+    remove(path); // The open mapping outlives the name, so a failed assumption leaves nothing behind
+    FOSSIL_TEST_ASSUME(history != NULL, "History file should reopen");
+    FOSSIL_TEST_ASSUME(fossil_maip_history_expected_ns(history, "history_suite", "slow") == 900000,
+                       "Duration estimate should be kept");
+    FOSSIL_TEST_ASSUME(fossil_maip_history_expected_ns(history, "other_suite", "slow") == 0,
+                       "Histories should be keyed by suite as well");
+
+    fossil_maip_history_schedule(history, &suite, order, 4, true);
+    FOSSIL_TEST_ASSUME(order[0] == &cases[2] && order[1] == &cases[3], "Failed then new cases should lead");
+    FOSSIL_TEST_ASSUME(order[2] == &cases[1] && order[3] == &cases[0], "Parallel runs should start the longest case first");
+
+    fossil_maip_history_schedule(history, &suite, order, 4, false);
+    FOSSIL_TEST_ASSUME(order[2] == &cases[0] && order[3] == &cases[1], "Serial runs should start the shortest case first");
+
+    fossil_maip_history_close(history);
+}
+
+FOSSIL_TEST(shard_partition)
+{
+    enum { CASES = 64, SHARDS = 3 };
+    char names[CASES][16];
+
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"shard_suite";
+    for (size_t i = 0; i < CASES; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "shard_%02u", (unsigned)i);
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = names[i];
+        test_case.run = sample_selection_case;
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    // Every case lands in exactly one shard
+    int owners[CASES] = {0};
+    size_t total = 0;
+    for (int shard = 0; shard < SHARDS; shard++)
+    {
+        fossil_maip_engine_t engine;
+        memset(&engine, 0, sizeof(engine));
+        engine.pallet.run.shard_index = shard;
+        engine.pallet.run.shard_count = SHARDS;
+        engine.pallet.run.shard_by = "hash";
+        FOSSIL_TEST_ASSUME(fossil_maip_selection_compile(&engine) == FOSSIL_MAIP_SUCCESS, "Shard selection should compile");
+
+        fossil_maip_case_t *selected[CASES];
+        size_t count = fossil_maip_filter_cases(&suite, &engine, selected);
+        for (size_t i = 0; i < count; i++)
+            owners[selected[i] - suite.cases]++;
+        total += count;
+        FOSSIL_TEST_ASSUME(count > 0 && count < CASES, "Each shard should get a share of the cases");
+        fossil_maip_selection_free(&engine);
+    }
+
+    FOSSIL_TEST_ASSUME(total == CASES, "Shards should cover every case once");
+    for (size_t i = 0; i < CASES; i++)
+        FOSSIL_TEST_ASSUME(owners[i] == 1, "A case should belong to exactly one shard");
+    free(suite.cases);
+}
+
+FOSSIL_TEST(shard_merge_reports)
+{
+    // Unique per process and per thread: the sharded runners share the build dir
+    char names[2][64];
+    for (int i = 0; i < 2; i++)
+        snprintf(names[i], sizeof(names[i]), "sample_shard_%d_%d_%p.tmp", i, FOSSIL_SANITY_SYS_GETPID(), (void *)names);
+    const char *paths[] = {names[0], names[1]};
+    FILE *out = fopen(paths[0], "w");
+    FOSSIL_TEST_ASSUME(out != NULL, "Shard report should be writable");
+    if (!out)
+        return;
+    fputs("{\"type\":\"case\",\"suite\":\"merge_suite\",\"case\":\"merge_a\",\"tags\":\"fossil\",\"result\":\"pass\",\"elapsed_ns\":10}\n", out);
+    fputs("{\"type\":\"suite\",\"suite\":\"merge_suite\",\"elapsed_ns\":100}\n", out);
+    fputs("{\"type\":\"summary\",\"passed\":1,\"failed\":0,\"skipped\":0,\"timeout\":0,\"unexpected\":0,\"empty\":0}\n", out);
+    fclose(out);
+
+    out = fopen(paths[1], "w");
+    FOSSIL_TEST_ASSUME(out != NULL, "Shard report should be writable");
+    if (!out)
+        return;
+    fputs("{\"type\":\"case\",\"suite\":\"merge_suite\",\"case\":\"merge_b\",\"tags\":\"fossil\",\"result\":\"fail\",\"elapsed_ns\":20,\"message\":\"said \\\"no\\\"\"}\n", out);
+    fputs("{\"type\":\"suite\",\"suite\":\"merge_suite\",\"elapsed_ns\":50}\n", out);
+    fputs("{\"type\":\"suite\",\"suite\":\"other_suite\",\"elapsed_ns\":5}\n", out);
+    fclose(out);
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    int status = fossil_maip_merge_reports(&engine, paths, 2);
+    remove(paths[0]);
+    remove(paths[1]);
+
+    FOSSIL_TEST_ASSUME(status == FOSSIL_MAIP_SUCCESS, "Shard reports should merge");
+    FOSSIL_TEST_ASSUME(engine.count == 2, "Suites from every shard should be kept");
+    FOSSIL_TEST_ASSUME(engine.score_possible == 2 && engine.score_total == 1, "Merged score should cover both shards");
+    FOSSIL_TEST_ASSUME(engine.score.passed == 1 && engine.score.failed == 1, "Merged outcomes should be kept");
+    FOSSIL_TEST_ASSUME(engine.count > 0 && engine.suites[0].time_elapsed_ns == 150, "Suite times should add up across shards");
+    FOSSIL_TEST_ASSUME(engine.count > 0 && engine.suites[0].count == 2 &&
+                       engine.suites[0].cases[1].elapsed_ns == 20, "Merged cases should keep their timing");
+
+    for (size_t i = 0; i < engine.count; i++)
+        free(engine.suites[i].cases);
+    free(engine.suites);
+
+    // A lost shard must fail the merge, not just print an error
+    memset(&engine, 0, sizeof(engine));
+    status = fossil_maip_merge_reports(&engine, paths, 1);
+    FOSSIL_TEST_ASSUME(status == FOSSIL_MAIP_FAILURE, "A missing shard should fail the merge");
+    for (size_t i = 0; i < engine.count; i++)
+        free(engine.suites[i].cases);
+    free(engine.suites);
+}
+
+FOSSIL_TEST(repeat_statistics)
+{
+    fossil_maip_samples_t samples;
+    memset(&samples, 0, sizeof(samples));
+
+    // 1..100 in a scrambled order, with every tenth iteration failing
+    for (uint64_t i = 0; i < 100; i++)
+    {
+        uint64_t value = (i * 37) % 100 + 1;
+        fossil_maip_samples_add(&samples, value, value % 10 == 0 ? FOSSIL_MAIP_CASE_FAIL : FOSSIL_MAIP_CASE_PASS);
+    }
+
+    FOSSIL_TEST_ASSUME(samples.count == 100, "Every iteration should be kept");
+    FOSSIL_TEST_ASSUME(samples.values[1] == 38, "Samples should stay in run order");
+    FOSSIL_TEST_ASSUME(samples.min_ns == 1 && samples.max_ns == 100, "Min and max should be tracked");
+    FOSSIL_TEST_ASSUME(samples.mean_ns > 50.49 && samples.mean_ns < 50.51, "Mean should be 50.5");
+    double dev = fossil_maip_samples_stddev(&samples);
+    FOSSIL_TEST_ASSUME(dev > 29.0 && dev < 29.02, "Stddev should be the sample deviation");
+    FOSSIL_TEST_ASSUME(fossil_maip_samples_percentile(&samples, 50.0) == 50, "p50 should use the nearest rank");
+    FOSSIL_TEST_ASSUME(fossil_maip_samples_percentile(&samples, 90.0) == 90, "p90 should use the nearest rank");
+    FOSSIL_TEST_ASSUME(fossil_maip_samples_percentile(&samples, 99.0) == 99, "p99 should use the nearest rank");
+    FOSSIL_TEST_ASSUME(samples.outcomes[FOSSIL_MAIP_CASE_FAIL] == 10 &&
+                       samples.outcomes[FOSSIL_MAIP_CASE_PASS] == 90, "Outcomes should be counted per iteration");
+    free(samples.values);
+}
+
+static int sample_repeat_calls = 0;
+
+static void sample_repeat_flaky_case(void)
+{
+    sample_repeat_calls++;
+    FOSSIL_TEST_ASSUME(sample_repeat_calls % 4 != 0, "Every fourth call fails");
+}
+
+static void sample_repeat_pass_case(void)
+{
+    FOSSIL_TEST_ASSUME(true, "Always passes");
+}
+
+// Runs the suite on its own thread so its assertions do not unwind this test
+static void *sample_repeat_thread(void *arg)
+{
+    fossil_maip_engine_t *engine = (fossil_maip_engine_t *)arg;
+    fossil_maip_run_suite(engine, &engine->suites[0]);
+    return NULL;
+}
+
+FOSSIL_TEST(repeat_iterations)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"repeat_suite";
+    fossil_maip_case_t test_case;
+    memset(&test_case, 0, sizeof(test_case));
+    test_case.name = (char *)"repeat_case";
+    test_case.run = sample_repeat_flaky_case;
+    fossil_maip_add_case(&suite, test_case);
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+    engine.pallet.run.repeat = 8;
+
+    // Serial repeats keep every outcome and report the worst one
+    sample_repeat_calls = 0;
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+
+    fossil_maip_samples_t *samples = suite.cases[0].samples;
+    FOSSIL_TEST_ASSUME(samples != NULL && samples->count == 8, "Each iteration should be sampled");
+    FOSSIL_TEST_ASSUME(samples && samples->outcomes[FOSSIL_MAIP_CASE_FAIL] == 2 &&
+                       samples->outcomes[FOSSIL_MAIP_CASE_PASS] == 6, "Iteration outcomes should be counted");
+    FOSSIL_TEST_ASSUME(suite.cases[0].state == FOSSIL_MAIP_CASE_FAIL, "A failed iteration should fail the case");
+
+    // Parallel repeats fill the same buffer
+    suite.cases[0].run = sample_repeat_pass_case;
+    engine.pallet.run.repeat = 16;
+    engine.pallet.run.repeat_jobs = 4;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+
+    samples = suite.cases[0].samples;
+    FOSSIL_TEST_ASSUME(samples && samples->count == 16 && samples->outcomes[FOSSIL_MAIP_CASE_PASS] == 16,
+                       "Parallel iterations should all be sampled");
+    FOSSIL_TEST_ASSUME(suite.cases[0].state == FOSSIL_MAIP_CASE_PASS, "Passing iterations should pass the case");
+
+    fossil_maip_samples_free(suite.cases[0].samples);
+    free(suite.cases);
+}
+
+FOSSIL_TEST(fixture_nested_suite)
+{
+    const int *numbers = (const int *)FOSSIL_FIXTURE_USE(sample_numbers);
+    int teardowns = sample_numbers_teardowns;
+
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"nested_suite";
+    fossil_maip_case_t test_case;
+    memset(&test_case, 0, sizeof(test_case));
+    test_case.name = (char *)"nested_case";
+    test_case.run = sample_repeat_pass_case;
+    fossil_maip_add_case(&suite, test_case);
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+    free(suite.cases);
+
+    FOSSIL_TEST_ASSUME(sample_numbers_teardowns == teardowns, "A nested suite should leave this suite's fixtures alone");
+    FOSSIL_TEST_ASSUME(FOSSIL_FIXTURE_USE(sample_numbers) == numbers, "The suite fixture should still be shared");
+}
+
+FOSSIL_TEST(rng_reproducible)
+{
+    fossil_maip_rng_t a, b;
+    fossil_maip_rng_seed(&a, 42);
+    fossil_maip_rng_seed(&b, 42);
+    bool same = true;
+    for (int i = 0; i < 64; i++)
+        same = same && fossil_maip_rng_next(&a) == fossil_maip_rng_next(&b);
+    FOSSIL_TEST_ASSUME(same, "Equal seeds should give equal streams");
+
+    fossil_maip_rng_seed(&b, 43);
+    FOSSIL_TEST_ASSUME(fossil_maip_rng_next(&a) != fossil_maip_rng_next(&b), "Different seeds should diverge");
+
+    // 60000 draws over six buckets put each within 3% of the expected 10000
+    int buckets[6] = {0};
+    bool in_range = true;
+    for (int i = 0; i < 60000; i++)
+    {
+        uint64_t value = fossil_maip_rng_below(&a, 6);
+        in_range = in_range && value < 6;
+        if (value < 6)
+            buckets[value]++;
+    }
+    FOSSIL_TEST_ASSUME(in_range, "Bounded draws should stay below the bound");
+    for (int i = 0; i < 6; i++)
+        FOSSIL_TEST_ASSUME(buckets[i] > 9700 && buckets[i] < 10300, "Bounded draws should be uniform");
+
+    double unit = fossil_maip_rng_unit(&a);
+    FOSSIL_TEST_ASSUME(unit >= 0.0 && unit < 1.0, "Unit draws should be in [0, 1)");
+}
+
+FOSSIL_TEST(shuffle_modes)
+{
+    enum { CASES = 20 };
+    fossil_maip_case_t cases[CASES];
+    fossil_maip_case_t *order[CASES], *again[CASES];
+    memset(cases, 0, sizeof(cases));
+    for (int i = 0; i < CASES; i++)
+    {
+        cases[i].priority = i;
+        order[i] = again[i] = &cases[i];
+    }
+
+    fossil_maip_rng_t rng;
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.rng = &rng;
+    engine.pallet.shuffle.enabled = 1;
+    engine.pallet.shuffle.mode = "uniform";
+
+    // Same seed, same order; and every case is still there once
+    fossil_maip_rng_seed(&rng, 7);
+    fossil_maip_shuffle_cases(order, CASES, &engine);
+    fossil_maip_rng_seed(&rng, 7);
+    fossil_maip_shuffle_cases(again, CASES, &engine);
+    int seen[CASES] = {0};
+    bool same = true;
+    for (int i = 0; i < CASES; i++)
+    {
+        same = same && order[i] == again[i];
+        seen[order[i] - cases]++;
+    }
+    FOSSIL_TEST_ASSUME(same, "A seed should replay the same order");
+    for (int i = 0; i < CASES; i++)
+        FOSSIL_TEST_ASSUME(seen[i] == 1, "Shuffling should keep every case once");
+
+    // --count draws a few cases to the front and keeps the rest in order
+    for (int i = 0; i < CASES; i++)
+        order[i] = &cases[i];
+    engine.pallet.shuffle.count = 3;
+    fossil_maip_shuffle_cases(order, CASES, &engine);
+    bool ordered = true;
+    for (int i = 4; i < CASES; i++)
+        ordered = ordered && order[i - 1] < order[i];
+    FOSSIL_TEST_ASSUME(ordered, "Undrawn cases should keep their order");
+    engine.pallet.shuffle.count = 0;
+
+    // Weighted by priority: priority 0 leads far more often than priority 19
+    engine.pallet.shuffle.mode = "weighted";
+    engine.pallet.shuffle.by = "priority";
+    int first_high = 0, first_low = 0;
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        for (int i = 0; i < CASES; i++)
+            order[i] = &cases[i];
+        fossil_maip_shuffle_cases(order, CASES, &engine);
+        first_high += order[0] == &cases[0];
+        first_low += order[0] == &cases[CASES - 1];
+    }
+    FOSSIL_TEST_ASSUME(first_high > 5 * (first_low + 1), "Weighted mode should favour high-priority cases");
+}
+
+// Records failures in its own thread's table. It never flushes, so the
+// made-up failures stay out of this run's summary when the thread exits.
+static void *sample_failure_thread(void *arg)
+{
+    size_t *last = (size_t *)arg;
+    char message[64];
+    for (int i = 0; i < 1000; i++)
+    {
+        snprintf(message, sizeof(message), "expected %d, got %d", i, i + 1);
+        last[0] = fossil_maip_failure_record("sample_failure_site.c", 10, "site_a", message);
+    }
+    for (int i = 0; i < 600; i++)
+        last[1] = fossil_maip_failure_record("sample_failure_site.c", 20, "site_b", "buffer overflow");
+
+    // Another message from the first site that folds into the same cluster
+    last[2] = fossil_maip_failure_record("sample_failure_site.c", 10, "site_a", "expected 1, got 2");
+    return NULL;
+}
+
+FOSSIL_TEST(failure_index_clusters)
+{
+    uint64_t a = fossil_maip_failure_fingerprint("x.c", 1, "f", "expected 3, got 4");
+    uint64_t b = fossil_maip_failure_fingerprint("x.c", 1, "f", "expected 17, got 900");
+    FOSSIL_TEST_ASSUME(a == b, "Changing numbers should not split a cluster");
+    FOSSIL_TEST_ASSUME(a != fossil_maip_failure_fingerprint("x.c", 2, "f", "expected 3, got 4"),
+                       "Different lines should be different clusters");
+    FOSSIL_TEST_ASSUME(a != fossil_maip_failure_fingerprint("x.c", 1, "f", "expected x, got 4"),
+                       "Different messages should be different clusters");
+    FOSSIL_TEST_ASSUME(a != 0, "Fingerprints should never be the free-slot marker");
+
+    size_t before = 0;
+    fossil_maip_failure_totals(&before, NULL, NULL);
+
+    size_t last[3] = {0, 0, 0};
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_failure_thread, last) == 0, "Recorder thread should start");
+    maip_sys_thread_join(thread);
+    FOSSIL_TEST_ASSUME(last[0] == 1000 && last[1] == 600, "A thread should count repeats of a fingerprint");
+    FOSSIL_TEST_ASSUME(last[2] == 1001, "Folded messages should land in the same cluster");
+
+    size_t after = 0;
+    fossil_maip_failure_totals(&after, NULL, NULL);
+    FOSSIL_TEST_ASSUME(after == before, "An unflushed thread table should stay private");
+}
+
+FOSSIL_TEST(hash_vectors)
+{
+    // The 64-bit digest is XXH64, so published vectors pin it down
+    FOSSIL_TEST_ASSUME(fossil_maip_hash64("", 0, 0) == 0xEF46DB3751D8E999ULL, "Empty input should match XXH64");
+    FOSSIL_TEST_ASSUME(fossil_maip_hash64("a", 1, 0) == 0xD24EC4F1A98C6E5BULL, "Short input should match XXH64");
+    FOSSIL_TEST_ASSUME(fossil_maip_hash64("abc", 3, 0) == 0x44BC2CF5AD770999ULL, "Short input should match XXH64");
+    const char *stripe = "Nobody inspects the spammish repetition";
+    FOSSIL_TEST_ASSUME(fossil_maip_hash64(stripe, strlen(stripe), 0) == 0xFBCEA83C8A378BF1ULL,
+                       "Striped input should match XXH64");
+
+    uint8_t a[FOSSIL_MAIP_HASH_SIZE], b[FOSSIL_MAIP_HASH_SIZE];
+    fossil_maip_hash("input", "output", a);
+    fossil_maip_hash("input", "output", b);
+    FOSSIL_TEST_ASSUME(memcmp(a, b, sizeof(a)) == 0, "The pair hash should be deterministic");
+    fossil_maip_hash("inpu", "toutput", b);
+    FOSSIL_TEST_ASSUME(memcmp(a, b, sizeof(a)) != 0, "Moving the boundary should change the hash");
+    fossil_maip_hash_seeded("input", "output", fossil_maip_hash_salt() | 1, b);
+    FOSSIL_TEST_ASSUME(memcmp(a, b, sizeof(a)) != 0, "A seed should change the hash");
+    FOSSIL_TEST_ASSUME(fossil_maip_hash64(stripe, 8, 1) != fossil_maip_hash64(stripe, 8, 2),
+                       "Different seeds should diverge");
+}
+
+FOSSIL_TEST(hash_streaming)
+{
+    uint8_t data[200];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 131 + 7);
+
+    // Every split point, and byte-at-a-time, must match the one-shot digest
+    uint8_t whole[FOSSIL_MAIP_HASH_SIZE], parts[FOSSIL_MAIP_HASH_SIZE];
+    fossil_maip_hash128(data, sizeof(data), 99, whole);
+    uint64_t whole64 = fossil_maip_hash64(data, sizeof(data), 99);
+    bool same = true;
+    for (size_t i = 0; i < 8; i++)
+        same = same && whole[i] == (uint8_t)(whole64 >> (8 * i));
+    FOSSIL_TEST_ASSUME(same, "The 128-bit digest should start with the 64-bit one");
+    for (size_t split = 0; split <= sizeof(data); split++)
+    {
+        fossil_maip_hash_state_t state;
+        fossil_maip_hash_init(&state, 99);
+        fossil_maip_hash_update(&state, data, split);
+        fossil_maip_hash_update(&state, data + split, sizeof(data) - split);
+        fossil_maip_hash_final128(&state, parts);
+        same = same && memcmp(whole, parts, sizeof(whole)) == 0 && fossil_maip_hash_final64(&state) == whole64;
+    }
+    FOSSIL_TEST_ASSUME(same, "Two-part updates should match the one-shot digest");
+
+    fossil_maip_hash_state_t state;
+    fossil_maip_hash_init(&state, 99);
+    for (size_t i = 0; i < sizeof(data); i++)
+        fossil_maip_hash_update(&state, data + i, 1);
+    FOSSIL_TEST_ASSUME(fossil_maip_hash_final64(&state) == whole64, "Byte updates should match the one-shot digest");
+}
+
+FOSSIL_TEST(root_cause_vocabulary)
+{
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_detect("operation timed out") == 2, "A single cause should give its code");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_detect("Expected ptr to not be cnull") == ((1 << 1) | (1 << 3)),
+                       "Several causes should give a bitmask");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_detect("all good") == 0, "Unknown messages should give 0");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_scan("double free") == ((1u << 3) | (1u << 7)),
+                       "Overlapping keywords should all be found");
+
+    int database = fossil_maip_root_cause_define("Database");
+    FOSSIL_TEST_ASSUME(database >= 10, "Defined causes should follow the built-in codes");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_define("Database") == database, "Labels should be defined once");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_define("Timeout") == 2, "Built-in labels should resolve");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_add(database, "SQLITE_BUSY") == FOSSIL_MAIP_SUCCESS, "Keywords should be added");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_add(31, "x") == FOSSIL_MAIP_FAILURE, "Undefined codes should be refused");
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_detect("got SQLITE_BUSY") == database, "Added keywords should classify");
+
+    char text[64];
+    fossil_maip_root_cause_describe(fossil_maip_root_cause_scan("timed out on SQLITE_BUSY"), text, sizeof(text));
+    FOSSIL_TEST_ASSUME(strcmp(text, "Timeout, Database") == 0, "Labels should follow the cause order");
+
+    fossil_maip_root_cause_reset();
+    FOSSIL_TEST_ASSUME(fossil_maip_root_cause_detect("got SQLITE_BUSY") == 0, "Reset should drop added keywords");
+}
+
+#ifndef _WIN32
+// Crash recovery is POSIX-only
+static void sample_crash_null_case(void)
+{
+    FOSSIL_TEST_ASSUME(true, "Reached the crash");
+    volatile int *volatile nowhere = NULL;
+    *nowhere = 1;
+}
+
+static int sample_crash_recurse(int depth)
+{
+    volatile char pad[1024];
+    pad[0] = (char)depth;
+    if (depth == INT_MAX)
+        return 0;
+    return sample_crash_recurse(depth + 1) + pad[0];
+}
+
+static void sample_crash_overflow_case(void)
+{
+    sample_crash_recurse(0);
+}
+
+// Each case crashes on the runner thread; the thread must carry on
+static void *sample_crash_thread(void *arg)
+{
+    fossil_maip_engine_t *engine = (fossil_maip_engine_t *)arg;
+    for (size_t i = 0; i < engine->suites[0].count; ++i)
+        fossil_maip_run_test(engine, &engine->suites[0].cases[i], &engine->suites[0]);
+    return NULL;
+}
+
+FOSSIL_TEST(crash_recovery)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"crash_suite";
+    void (*runs[])(void) = {sample_crash_null_case, sample_crash_null_case, sample_crash_overflow_case,
+                            sample_repeat_pass_case};
+    const char *names[] = {"crash_null", "crash_again", "crash_overflow", "after_crashes"};
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); ++i)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = (char *)names[i];
+        test_case.run = runs[i];
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+    engine.quiet = true; // the crashes are expected; keep their backtraces out of the run
+
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_crash_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+
+    for (size_t i = 0; i < 3; ++i)
+        FOSSIL_TEST_ASSUME(suite.cases[i].state == FOSSIL_MAIP_CASE_UNEXPECTED, "A crash should be unexpected");
+    FOSSIL_TEST_ASSUME(suite.cases[3].state == FOSSIL_MAIP_CASE_PASS, "Cases after a crash should still run");
+    FOSSIL_TEST_ASSUME(suite.score.unexpected == 3 && suite.score.passed == 1, "Crashes should be scored");
+    free(suite.cases);
+}
+
+// Crashes while maip_io_printf holds the console lock and a quiet section
+static void sample_crash_in_output_case(void)
+{
+    FOSSIL_TEST_ASSUME(true, "Reached the crash");
+    maip_io_printf("{red}%s{reset}\n", (char *)16);
+}
+
+// Prints nothing, but needs the console lock the crash may have left behind
+static void sample_output_after_crash_case(void)
+{
+    maip_io_printf("");
+    FOSSIL_TEST_ASSUME(!maip_sys_memory_quiet(), "A crash should not leave the thread quiet");
+}
+
+FOSSIL_TEST(crash_in_output)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"crash_output_suite";
+    void (*runs[])(void) = {sample_crash_in_output_case, sample_output_after_crash_case,
+                            sample_output_after_crash_case, sample_output_after_crash_case,
+                            sample_output_after_crash_case};
+    const char *names[] = {"crash_printf", "print_1", "print_2", "print_3", "print_4"};
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); ++i)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = (char *)names[i];
+        test_case.run = runs[i];
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+    engine.quiet = true;
+    engine.pallet.run.jobs = 2; // the other worker hangs if the lock is never released
+
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+
+    FOSSIL_TEST_ASSUME(suite.cases[0].state == FOSSIL_MAIP_CASE_UNEXPECTED, "The crash should be unexpected");
+    for (size_t i = 1; i < suite.count; ++i)
+        FOSSIL_TEST_ASSUME(suite.cases[i].state == FOSSIL_MAIP_CASE_PASS, "Printing after the crash should work");
+    free(suite.cases);
+}
+
+static void sample_hang_case(void)
+{
+    FOSSIL_TEST_ASSUME(true, "Reached the hang");
+    for (volatile int spin = 0;; spin++)
+    {
+#ifdef __SANITIZE_THREAD__
+        // ThreadSanitizer only delivers signals inside calls it intercepts
+        struct timespec nap = {0, 100000};
+        nanosleep(&nap, NULL);
+#endif
+    }
+}
+
+// Spends most of its time inside the runner's console lock when the deadline hits
+static void sample_hang_printing_case(void)
+{
+    FOSSIL_TEST_ASSUME(true, "Reached the hang");
+    for (;;)
+        maip_io_printf("");
+}
+
+FOSSIL_TEST(watchdog_timeout)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"watchdog_suite";
+    void (*runs[])(void) = {sample_hang_case, sample_hang_printing_case, sample_hang_printing_case,
+                            sample_repeat_pass_case};
+    const char *names[] = {"hang", "hang_printing", "hang_printing_again", "after_hangs"};
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); ++i)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = (char *)names[i];
+        test_case.run = runs[i];
+        test_case.timeout_ns = 20 * 1000000ULL;
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+    engine.quiet = true;
+
+    // In order on one thread, then again on two workers
+    for (int jobs = 1; jobs <= 2; ++jobs)
+    {
+        engine.pallet.run.jobs = jobs;
+        memset(&suite.score, 0, sizeof(suite.score));
+        maip_sys_thread_t thread;
+        FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+        maip_sys_thread_join(thread);
+
+        for (size_t i = 0; i < 3; ++i)
+            FOSSIL_TEST_ASSUME(suite.cases[i].state == FOSSIL_MAIP_CASE_TIMEOUT, "A hung case should time out");
+        FOSSIL_TEST_ASSUME(suite.cases[3].state == FOSSIL_MAIP_CASE_PASS, "Cases after a timeout should still run");
+        FOSSIL_TEST_ASSUME(suite.score.timeout == 3 && suite.score.passed == 1, "Timeouts should be scored");
+    }
+    free(suite.cases);
+}
+
+FOSSIL_TEST(parallel_score_merge)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"parallel_suite";
+    char names[24][16];
+    for (size_t i = 0; i < 24; ++i)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        if (i % 12 == 5)
+            snprintf(names[i], sizeof(names[i]), "skipped_%zu", i);
+        else
+            snprintf(names[i], sizeof(names[i]), "case_%zu", i);
+        test_case.name = names[i];
+        test_case.run = i % 4 == 0 ? sample_crash_null_case
+                      : i % 4 == 1 ? sample_selection_case
+                                   : sample_repeat_pass_case;
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+    engine.quiet = true;
+    engine.pallet.run.skip = "skipped_5,skipped_17";
+    FOSSIL_TEST_ASSUME(fossil_maip_selection_compile(&engine) == FOSSIL_MAIP_SUCCESS, "Skip list should compile");
+
+    // Each worker scores its own cases; after the join the suite must match the serial run
+    for (int jobs = 1; jobs <= 4; jobs += 3)
+    {
+        engine.pallet.run.jobs = jobs;
+        maip_sys_thread_t thread;
+        FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+        maip_sys_thread_join(thread);
+
+        for (size_t i = 0; i < suite.count; ++i)
+        {
+            fossil_maip_state_t expected = i % 12 == 5 ? FOSSIL_MAIP_CASE_SKIPPED
+                                         : i % 4 == 0  ? FOSSIL_MAIP_CASE_UNEXPECTED
+                                         : i % 4 == 1  ? FOSSIL_MAIP_CASE_EMPTY
+                                                       : FOSSIL_MAIP_CASE_PASS;
+            FOSSIL_TEST_ASSUME(suite.cases[i].state == expected, "Every case should keep its own outcome");
+        }
+        FOSSIL_TEST_ASSUME(suite.score.passed == 12 && suite.score.unexpected == 6 && suite.score.skipped == 2 &&
+                           suite.score.failed == 0 && suite.score.timeout == 0,
+                           "Worker scores should merge into the suite");
+        FOSSIL_TEST_ASSUME(suite.total_score == 12 && suite.total_possible == 20,
+                           "Suite totals should follow the merged score");
+    }
+
+    fossil_maip_selection_free(&engine);
+    free(suite.cases);
+}
+
+// Leaves the worker process without reporting a result
+static void sample_exit_case(void)
+{
+    FOSSIL_TEST_ASSUME(true, "Reached the exit");
+    _Exit(3);
+}
+
+// Blocks the watchdog's signal, so only the runner's hard deadline can stop it
+static void sample_stuck_case(void)
+{
+    sigset_t alarm, previous;
+    sigemptyset(&alarm);
+    sigaddset(&alarm, SIGALRM);
+    pthread_sigmask(SIG_BLOCK, &alarm, &previous);
+    FOSSIL_TEST_ASSUME(true, "Reached the stall");
+    for (int i = 0; i < 200; ++i)
+    {
+        struct timespec nap = {0, 10000000};
+        nanosleep(&nap, NULL);
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+FOSSIL_TEST(isolate_workers)
+{
+#ifdef __SANITIZE_THREAD__
+    // ThreadSanitizer kills a child of a threaded process once it starts a thread
+    return;
+#endif
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"isolate_suite";
+    void (*runs[])(void) = {sample_repeat_pass_case, sample_crash_null_case, sample_repeat_pass_case,
+                            sample_exit_case, sample_repeat_pass_case, sample_stuck_case,
+                            sample_repeat_pass_case};
+    const char *names[] = {"first", "crash", "after_crash", "exit", "after_exit", "stuck", "after_stuck"};
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); ++i)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = (char *)names[i];
+        test_case.run = runs[i];
+        test_case.timeout_ns = 20 * 1000000ULL;
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+    engine.quiet = true;
+    engine.pallet.run.isolate = 1;      // one worker, so each later case needs a replacement
+    engine.pallet.run.no_recover = true; // crashes take the worker down with them
+
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_repeat_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+
+    FOSSIL_TEST_ASSUME(suite.cases[1].state == FOSSIL_MAIP_CASE_UNEXPECTED, "A crashed worker should be unexpected");
+    FOSSIL_TEST_ASSUME(suite.cases[3].state == FOSSIL_MAIP_CASE_UNEXPECTED, "An exited worker should be unexpected");
+    FOSSIL_TEST_ASSUME(suite.cases[5].state == FOSSIL_MAIP_CASE_TIMEOUT, "A stuck worker should be killed at the deadline");
+    for (size_t i = 0; i < suite.count; i += 2)
+        FOSSIL_TEST_ASSUME(suite.cases[i].state == FOSSIL_MAIP_CASE_PASS, "A fresh worker should run the next case");
+    FOSSIL_TEST_ASSUME(suite.score.passed == 4 && suite.score.unexpected == 2 && suite.score.timeout == 1,
+                       "Worker deaths should be scored");
+    free(suite.cases);
+}
+
+static void *volatile sample_alloc_kept = NULL;
+
+static void sample_alloc_leak_case(void)
+{
+    void *volatile scratch = malloc(100);
+    sample_alloc_kept = malloc(50);
+    free(scratch);
+    FOSSIL_TEST_ASSUME(sample_alloc_kept != NULL, "Allocation should succeed");
+}
+
+FOSSIL_TEST(alloc_accounting)
+{
+    fossil_maip_suite_t suite;
+    memset(&suite, 0, sizeof(suite));
+    suite.name = (char *)"alloc_suite";
+    // The clean case goes first, so runner setup on the thread is not charged to it
+    void (*runs[])(void) = {sample_repeat_pass_case, sample_alloc_leak_case};
+    const char *names[] = {"alloc_clean", "alloc_leak"};
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); ++i)
+    {
+        fossil_maip_case_t test_case;
+        memset(&test_case, 0, sizeof(test_case));
+        test_case.name = (char *)names[i];
+        test_case.run = runs[i];
+        fossil_maip_add_case(&suite, test_case);
+    }
+
+    fossil_maip_engine_t engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.suites = &suite;
+    engine.count = 1;
+
+    // A fresh thread, so the case is not counted against this one
+    maip_sys_thread_t thread;
+    FOSSIL_TEST_ASSUME(maip_sys_thread_create(&thread, sample_crash_thread, &engine) == 0, "Runner thread should start");
+    maip_sys_thread_join(thread);
+    FOSSIL_TEST_ASSUME(suite.cases[1].state == FOSSIL_MAIP_CASE_PASS, "Leaking case should still pass");
+
+    const fossil_maip_alloc_stats_t *clean = suite.cases[0].alloc;
+    const fossil_maip_alloc_stats_t *alloc = suite.cases[1].alloc;
+    if (fossil_maip_alloc_tracking())
+    {
+        FOSSIL_TEST_ASSUME(clean != NULL && clean->allocations == 0 && clean->leaks == 0,
+                           "The first case on a thread should not be charged for the runner");
+        FOSSIL_TEST_ASSUME(alloc != NULL, "Tracked case should carry stats");
+        FOSSIL_TEST_ASSUME(alloc->allocations == 2 && alloc->frees == 1, "Both allocations and the free should count");
+        FOSSIL_TEST_ASSUME(alloc->bytes == 150 && alloc->peak_bytes == 150, "Bytes and peak should add up");
+        FOSSIL_TEST_ASSUME(alloc->leaks == 1 && alloc->leaked_bytes == 50, "The kept block should leak");
+        FOSSIL_TEST_ASSUME(alloc->site_count == 1 && alloc->sites[0].bytes == 50, "The leak should have its site");
+        FOSSIL_TEST_ASSUME(alloc->live_blocks == 0, "Leaks should no longer be tracked");
+    }
+    else
+    {
+        FOSSIL_TEST_ASSUME(clean == NULL && alloc == NULL, "Untracked builds should not allocate stats");
+    }
+
+    free(sample_alloc_kept);
+    sample_alloc_kept = NULL;
+    free(suite.cases[0].alloc);
+    free(suite.cases[1].alloc);
+    free(suite.cases);
+}
+#endif
+
 // FOSSIL_TEST(test_empty_case) {
 //     // test the absence of an assumption .
 // }
@@ -183,6 +1222,13 @@ FOSSIL_TEST(second_test_case)
     FOSSIL_TEST_ASSUME(sum == 30, "Sum of 10 and 20 should be 30");
 }
 
+FOSSIL_TEST(fixture_suite_torn_down)
+{
+    // sample_suite has finished, so its suite fixture must be gone again
+    FOSSIL_TEST_ASSUME(sample_numbers_teardowns == sample_numbers_setups,
+                       "Suite fixture should be torn down when its suite ends");
+}
+
 FOSSIL_TEST_GROUP(c_sample_test_cases)
 {
     FOSSIL_ADD_TEST(sample_suite, test_input_increment);
@@ -194,6 +1240,33 @@ FOSSIL_TEST_GROUP(c_sample_test_cases)
     FOSSIL_ADD_TEST(sample_suite, test_input_equal);
     FOSSIL_ADD_TEST(sample_suite, edge_cases);
     FOSSIL_ADD_TEST(sample_suite, math_addition_scopes);
+    FOSSIL_ADD_TEST(sample_suite, groups_register_themselves);
+    FOSSIL_ADD_TEST(sample_suite, fixture_suite_first_use);
+    FOSSIL_ADD_TEST(sample_suite, fixture_suite_shared);
+    FOSSIL_ADD_TEST(sample_suite, fixture_case_scoped);
+    FOSSIL_ADD_TEST(sample_suite, selection_expression);
+    FOSSIL_ADD_TEST(sample_suite, selection_rejects_bad_expression);
+    FOSSIL_ADD_TEST(sample_suite, sort_multi_key);
+    FOSSIL_ADD_TEST(sample_suite, history_schedule);
+    FOSSIL_ADD_TEST(sample_suite, shard_partition);
+    FOSSIL_ADD_TEST(sample_suite, shard_merge_reports);
+    FOSSIL_ADD_TEST(sample_suite, repeat_statistics);
+    FOSSIL_ADD_TEST(sample_suite, repeat_iterations);
+    FOSSIL_ADD_TEST(sample_suite, fixture_nested_suite);
+    FOSSIL_ADD_TEST(sample_suite, rng_reproducible);
+    FOSSIL_ADD_TEST(sample_suite, shuffle_modes);
+    FOSSIL_ADD_TEST(sample_suite, failure_index_clusters);
+    FOSSIL_ADD_TEST(sample_suite, hash_vectors);
+    FOSSIL_ADD_TEST(sample_suite, hash_streaming);
+    FOSSIL_ADD_TEST(sample_suite, root_cause_vocabulary);
+#ifndef _WIN32
+    FOSSIL_ADD_TEST(sample_suite, crash_recovery);
+    FOSSIL_ADD_TEST(sample_suite, crash_in_output);
+    FOSSIL_ADD_TEST(sample_suite, watchdog_timeout);
+    FOSSIL_ADD_TEST(sample_suite, parallel_score_merge);
+    FOSSIL_ADD_TEST(sample_suite, isolate_workers);
+    FOSSIL_ADD_TEST(sample_suite, alloc_accounting);
+#endif
     // FOSSIL_ADD_TEST(sample_suite, test_empty_case);
 
     FOSSIL_ADD_SUITE(sample_suite);
@@ -202,6 +1275,7 @@ FOSSIL_TEST_GROUP(c_sample_test_cases)
 FOSSIL_TEST_GROUP(c_second_test_cases)
 {
     FOSSIL_ADD_TEST(second_suite, second_test_case);
+    FOSSIL_ADD_TEST(second_suite, fixture_suite_torn_down);
 
     FOSSIL_ADD_SUITE(second_suite);
 }
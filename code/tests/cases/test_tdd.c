@@ -1462,6 +1462,23 @@ FOSSIL_TEST(c_assume_run_of_bounds_checked_boundary) {
     ASSUME_ITS_BOUNDS_CHECKED(index_last, array_size);
 } // end case
 
+static int c_tdd_message_calls = 0;
+
+static int c_tdd_count_message_call(int value) {
+    c_tdd_message_calls++;
+    return value;
+}
+
+FOSSIL_TEST(c_assume_run_of_lazy_message_on_pass) {
+    c_tdd_message_calls = 0;
+
+    // Passing assumptions must not evaluate their message arguments
+    for (int i = 0; i < 1000; i++) {
+        ASSUME_ITS_EQUAL_I32(i, c_tdd_count_message_call(i));
+    }
+    FOSSIL_TEST_ASSUME(c_tdd_message_calls == 1000, _FOSSIL_TEST_ASSUME_MESSAGE("Message formatted on pass: %d calls", c_tdd_count_message_call(c_tdd_message_calls)));
+} // end case
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -1606,6 +1623,7 @@ FOSSIL_TEST_GROUP(c_tdd_test_cases) {
     FOSSIL_ADD_TEST(c_tdd_suite, c_assume_run_of_session_valid_future);
     FOSSIL_ADD_TEST(c_tdd_suite, c_assume_run_of_bounds_checked);
     FOSSIL_ADD_TEST(c_tdd_suite, c_assume_run_of_bounds_checked_boundary);
+    FOSSIL_ADD_TEST(c_tdd_suite, c_assume_run_of_lazy_message_on_pass);
 
     FOSSIL_ADD_SUITE(c_tdd_suite);
 } // end of group
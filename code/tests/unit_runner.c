@@ -0,0 +1,27 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2013
+ *
+ * Copyright (C) 2013-Current Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+
+#include "fossil/maip/framework.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Runner
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Test groups register themselves, FOSSIL_TEST_START loads them all.
+int main(int argc, char **argv) {
+    FOSSIL_TEST_START(argc, argv);
+    FOSSIL_RUN_ALL();
+    FOSSIL_SUMMARY();
+    return FOSSIL_END();
+} // end of main